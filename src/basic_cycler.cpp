@@ -3,7 +3,8 @@
  *
  * Class to implement a 'basic cycler', which represents the battery tester (and can be used similarly)
  *
- * A basic cycler implements functions to load a cell with a (combination of) constant current (CC) and constant voltage (CV).
+ * A basic cycler implements functions to load a cell with a (combination of) constant current (CC) and constant voltage (CV),
+ * or at constant power (CP) or through a constant resistance (CR).
  * A basic cycler automatically handles the so-called 'cycling data', which are periodic measurements of the cell's voltage,  temperature and current.
  * This data is stored locally in arrays, and when the arrays are full (or when the user 'pushes' the data), the cycling data is written to a csv file.
  * The csv files are grouped in a subfolder of this project folder. The name of the subfolder is the identifier of this basic cycler.
@@ -13,7 +14,10 @@
  * See the licence file LICENCE.txt for more information.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <limits>
 
 #include "basic_cycler.hpp"
 #include "read_CSVfiles.h"
@@ -65,6 +69,11 @@ BasicCycler::BasicCycler(Cell &ci, std::string IDi, int verbosei, int CyclingDat
 	AhDisout.reserve(maxLength);
 	WhDisout.reserve(maxLength);
 	timeResout.reserve(maxLength);
+	dLout.reserve(maxLength);
+	Pout.reserve(maxLength);
+	SOCout.reserve(maxLength);
+	SOHout.reserve(maxLength);
+	Eout.reserve(maxLength);
 
 	// Some vector reservation for getOCV;
 	OCVni_vec.reserve(100e3);
@@ -127,6 +136,161 @@ void BasicCycler::setCyclingDataTimeResolution(int timeResolution)
 		std::cout << "BasicCycler::setCyclingDataTimeResolution terminating\n";
 }
 
+void BasicCycler::setLogPolicy(const LogPolicy &pol)
+{
+	/*
+	 * Collect the cycling data per phase (CC, CV, rest or profile) instead of at the fixed time resolution CyclingDataTimeInterval.
+	 * If pol.on is false, the fixed time resolution is used again.
+	 *
+	 * IN
+	 * pol 		data collection policy, see LogPolicy and LogRule
+	 *
+	 * THROWS
+	 * 1000 	a rule has a negative time interval or trigger, or a growth factor below 1
+	 */
+
+	for (auto ph : {LogPhase::CC, LogPhase::CV, LogPhase::rest, LogPhase::profile})
+	{
+		const auto &r = pol.rule(ph);
+		if (r.dt < 0 || r.growth < 1 || r.dV < 0 || r.dI < 0)
+		{
+			std::cerr << "ERROR in BasicCycler::setLogPolicy, the rule of phase " << static_cast<int>(ph) << " has time interval " << r.dt << ", growth factor " << r.growth
+					  << ", voltage trigger " << r.dV << " and current trigger " << r.dI << ". They can't be negative and the growth factor must be at least 1. Throwing an error.\n";
+			throw 1000;
+		}
+	}
+
+	logPolicy = pol;
+	logState = LogState{};
+}
+
+void BasicCycler::setLogSwelling(bool on)
+{
+	/*
+	 * Add the change in cell thickness and the stack pressure (see Cell::getSwelling) as two extra columns to the cycling data.
+	 * They are off by default since they take time at every data point, and without a fixture the pressure is 0.
+	 * The data stored so far is written first, so all rows of a file have the same columns.
+	 *
+	 * IN
+	 * on 		if true, the columns are added
+	 */
+
+	if (on != logSwelling && !Tout.empty())
+		writeCyclingData();
+	logSwelling = on;
+}
+
+void BasicCycler::setLogIndicators(bool on)
+{
+	/*
+	 * Add the SOC, SOH and available energy of the model (see Cell::getIndicators) as three extra columns to the cycling data.
+	 * They are off by default since they take time at every data point.
+	 * The data stored so far is written first, so all rows of a file have the same columns.
+	 *
+	 * IN
+	 * on 		if true, the columns are added
+	 */
+
+	if (on != logIndicators && !Tout.empty())
+		writeCyclingData();
+	logIndicators = on;
+}
+
+bool BasicCycler::logBegin(LogPhase ph)
+{
+	/*
+	 * Start the data collection of a primitive (CC_t_V, load_t_V_E, CV_t_I or protocolStep).
+	 * With a LogPolicy, the primitives called by a profile continue its phase, the first one starts it.
+	 *
+	 * IN
+	 * ph 		phase of the primitive
+	 *
+	 * OUT
+	 * bool 	true if the first point of the primitive is stored
+	 */
+
+	logState.steps = 0;
+	if (!logPolicy.on)
+		return CyclingDataTimeInterval > 0;
+
+	if (logState.profile == 2)
+		return false; // the next step of a profile
+
+	logState.phase = (logState.profile == 1) ? LogPhase::profile : ph;
+	logState.profile = (logState.profile == 1) ? 2 : 0;
+	logState.t = 0;
+	logState.gap = logPolicy.rule(logState.phase).dt;
+	logState.tNext = logState.gap;
+	return logPolicy.rule(logState.phase).edges;
+}
+
+bool BasicCycler::logDue(double I, double v, double dt)
+{
+	/*
+	 * Decide if the point after a time step is stored.
+	 * At the fixed time resolution, every CyclingDataTimeInterval / dt time steps are stored.
+	 * With a LogPolicy, the point is stored if the time since the start of the phase has reached the next point of the time trigger
+	 * or if the voltage or current changed by more than the triggers since the last stored point.
+	 *
+	 * IN
+	 * I 		current in this time step [A]
+	 * v 		voltage after this time step [V]
+	 * dt 		length of this time step [s]
+	 *
+	 * OUT
+	 * bool 	true if the point is stored
+	 */
+
+	if (!logPolicy.on)
+	{
+		const int nstore = std::max(static_cast<int>(CyclingDataTimeInterval / dt), 1); // number of time steps between two data collection points
+		return CyclingDataTimeInterval > 0 && (logState.steps++ % nstore) == 0;
+	}
+
+	const auto &r = logPolicy.rule(logState.phase);
+	logState.t += dt;
+	if (r.tmax >= 0 && logState.t > r.tmax)
+		return false;
+
+	bool due = (r.dV > 0 && std::abs(v - logState.V) >= r.dV) || (r.dI > 0 && std::abs(I - logState.I) >= r.dI);
+	if (r.dt > 0 && logState.t >= logState.tNext - 1e-9)
+	{
+		due = true;
+		do // skip the points which fall in this time step
+		{
+			logState.gap *= r.growth;
+			logState.tNext += logState.gap;
+		} while (logState.tNext <= logState.t + 1e-9);
+	}
+	return due;
+}
+
+bool BasicCycler::logEnd()
+{
+	// a primitive ends, its last point is stored unless it is a step of a profile
+	if (!logPolicy.on)
+		return CyclingDataTimeInterval > 0;
+	return logState.profile == 0 && logPolicy.rule(logState.phase).edges;
+}
+
+bool BasicCycler::logProfile(bool start)
+{
+	/*
+	 * followI and followP start or end a profile, all primitives in between form one profile phase if there is a LogPolicy.
+	 * At the fixed time resolution, the primitives store their data as usual.
+	 *
+	 * IN
+	 * start 	true at the start of the profile, false at its end (also when an error is thrown)
+	 *
+	 * OUT
+	 * bool 	true at the end of a profile if its last point is stored
+	 */
+
+	const bool last = !start && logPolicy.on && logState.profile == 2 && logPolicy.profile.edges;
+	logState.profile = (start && logPolicy.on) ? 1 : 0;
+	return last;
+}
+
 void BasicCycler::writeCyclingData()
 {
 	/*
@@ -166,6 +330,11 @@ void BasicCycler::writeCyclingData(const std::string &name, bool clear)
 	 * 		discharge_Ah 	the total discharged charge in [Ah] since the start of this data batch
 	 * 		discharge_Wh 	the total discharged energy in [Wh] since the start of this data batch
 	 * 		rest_time		the total time spend on resting in seconds since the start of this data batch
+	 * 		dL 				the change in cell thickness in [m], only if setLogSwelling is on
+	 * 		P 				the stack pressure in [Pa], only if setLogSwelling is on
+	 * 		SOC 			the state of charge of the model [-] (see Cell::getIndicators), only if setLogIndicators is on
+	 * 		SOH 			the present capacity relative to the nominal capacity [-], only if setLogIndicators is on
+	 * 		E_available 	the energy of an equilibrium discharge to the minimum voltage in [Wh], only if setLogIndicators is on
 	 *
 	 * IN
 	 * name 	name of the CSV file in which the cycling data will be written
@@ -179,7 +348,7 @@ void BasicCycler::writeCyclingData(const std::string &name, bool clear)
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "BasicCycler::writeCyclingData(string, bool) starting\n";
 
-	if (CyclingDataTimeInterval != 0 && !Tout.empty())
+	if ((CyclingDataTimeInterval != 0 || logPolicy.on) && !Tout.empty())
 	{
 
 		// Open the file
@@ -202,7 +371,12 @@ void BasicCycler::writeCyclingData(const std::string &name, bool clear)
 					   << Iout[i] << "," << Vout[i] << "," << OCVpout[i] << "," << OCVnout[i] << "," << Tout[i] << "," // I V OCV_pos OCV_neg T
 					   << timeChaout[i] << "," << AhChaout[i] << "," << WhChaout[i] << ","							   // time on charge, charged charge, charged energy
 					   << timeDisout[i] << "," << AhDisout[i] << "," << WhDisout[i] << ","							   // time on discharge, discharged charge, discharged energy
-					   << timeResout[i] << '\n';																	   // time on rest
+					   << timeResout[i];																			   // time on rest
+				if (logSwelling)
+					output << "," << dLout[i] << "," << Pout[i];													   // change in thickness, stack pressure
+				if (logIndicators)
+					output << "," << SOCout[i] << "," << SOHout[i] << "," << Eout[i];								   // SOC, SOH, available energy
+				output << '\n';
 			}
 			output.close(); // close the file
 		}
@@ -239,6 +413,11 @@ void BasicCycler::clearData()
 	AhDisout.clear();
 	WhDisout.clear();
 	timeResout.clear();
+	dLout.clear();
+	Pout.clear();
+	SOCout.clear();
+	SOHout.clear();
+	Eout.clear();
 	Iout.clear();
 	Vout.clear();
 	OCVpout.clear();
@@ -312,9 +491,11 @@ void BasicCycler::storeResults(double I, double v, double ocvp, double ocvn, dou
 		newdata = newcha || newdis || newres;
 	}
 
-	// If CyclingDataTimeInterval is 0, or if no time has passed since the previous data point, no data is stored
-	if (CyclingDataTimeInterval != 0 && newdata)
+	// If CyclingDataTimeInterval is 0 without a LogPolicy, or if no time has passed since the previous data point, no data is stored
+	if ((CyclingDataTimeInterval != 0 || logPolicy.on) && newdata)
 	{
+		logState.V = v; // reference for the change triggers of the LogPolicy
+		logState.I = I;
 
 		// If the internal arrays are full, write the results to csv files & clear the internal arrays
 		if (index > (maxLength - 1)) // length -1 because you start at row [0]
@@ -334,6 +515,23 @@ void BasicCycler::storeResults(double I, double v, double ocvp, double ocvn, dou
 		WhDisout.push_back(WhDis);
 		timeResout.push_back(timeRes);
 
+		if (logSwelling)
+		{
+			double dL, P;
+			c.getSwelling(&dL, &P);
+			dLout.push_back(dL);
+			Pout.push_back(P);
+		}
+
+		if (logIndicators)
+		{
+			double soc, cap, soh, E;
+			c.getIndicators(&soc, &cap, &soh, &E);
+			SOCout.push_back(soc);
+			SOHout.push_back(soh);
+			Eout.push_back(E);
+		}
+
 		// increase the counter for the number of data points stored
 		index++;
 	}
@@ -516,7 +714,7 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 	 * 				should be small enough to ensure numerical stability. The stability depends on the cell current and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds.
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CC
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * 				if false, the cell is degraded during the CC phase.
@@ -578,8 +776,8 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
 		std::cout << "BasicCycler::CC_t_V is making the variables\n";
 
-	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data)
-	if (CyclingDataTimeInterval > 0)
+	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data at a fixed time resolution)
+	if (CyclingDataTimeInterval > 0 && !logPolicy.on)
 		dt = std::min(dt, static_cast<double>(CyclingDataTimeInterval));
 
 	// check that the total time is still multiple of the time step, if not set the time step to 1sec (which always works)
@@ -587,8 +785,7 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 		dt = 1;
 
 	// number of time steps
-	const int ttot = static_cast<int>(time / dt);					   // number of time steps needed in total
-	const int nstore = static_cast<int>(CyclingDataTimeInterval / dt); // number of time steps between two data collection points
+	const int ttot = static_cast<int>(time / dt); // number of time steps needed in total
 
 	// store initial states to restore them if needed
 	slide::State s, s2;
@@ -611,7 +808,8 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 
 	// store the initial battery state if we are storing data
 	// If the cell is in an invalid condition, this will produce an error
-	if (CyclingDataTimeInterval > 0)
+	const bool edge = logBegin((I == 0) ? LogPhase::rest : LogPhase::CC); // store the first points of the phase
+	if (edge)
 	{
 		try
 		{
@@ -663,7 +861,7 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 	}
 
 	// store the battery state (after setting the current) if we are storing data
-	if (CyclingDataTimeInterval > 0)
+	if (edge)
 	{
 		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
 		timeRes += 0.0001;							// add a small amount to the rest time to ensure the new data point is different from the point before
@@ -764,7 +962,7 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 			}
 
 			// store the results at the specified time resolution
-			if (remainder(t, nstore) == 0)
+			if (logDue(I, v, dt))
 			{
 				if constexpr (settings::verbose >= printLevel::printCyclerDetail)
 					std::cout << "BasicCycler::CC_t_V is storing cycling data in time step " << t << '\n';
@@ -784,7 +982,7 @@ int BasicCycler::CC_t_V(double I, double dt, bool blockDegradation, double time,
 	// *********************************************************** 4 output parameters ***********************************************************************
 
 	// store the last data point if we are storing data
-	if (CyclingDataTimeInterval > 0)
+	if (logEnd())
 	{
 		try
 		{
@@ -822,7 +1020,7 @@ int BasicCycler::CC_t(double I, double dt, bool blockDegradation, double time, d
 	 * 				should be small enough to ensure numerical stability. The stability depends on the current rating and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds.
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CC
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * time 		total time for which this current should be applied [sec]
@@ -906,7 +1104,7 @@ int BasicCycler::CC_V(double I, double dt, bool blockDegradation, double Vset, d
 	 * 				should be small enough to ensure numerical stability. The stability depends on the current rating and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CC
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * Vset 		the voltage to which you want to (dis)charge the cell, Cell.Vmin <= Vset <= Cell.Vmax [V]
@@ -1143,129 +1341,672 @@ void BasicCycler::CC_halfCell_full(double I, double dt, bool pos, std::vector<do
 		std::cout << "BasicCycler::CC_halfCell_full is terminating\n";
 }
 
-void BasicCycler::findCVcurrent_recursive(double Imin, double Imax, int sign, double Vset, double dt, bool blockDegradation, double *Il, double *Vl)
+bool BasicCycler::findLoadCurrent(bool power, double X, double Iguess, double *I)
 {
 	/*
-	 * This is a recursive function which solves the nonlinear equation to find the current needed to reach a given voltage after a given time step.
+	 * Function to find the current at which the cell delivers a certain power or at which its voltage matches a load resistance.
+	 * The cell voltage is evaluated at trial currents without changing the states (see Cell::getVoltageAt),
+	 * and the secant method is used to solve
+	 * 		V(I) * I = P 	for a constant power
+	 * 		V(I) = R * I 	for a constant resistance
+	 * Starting from the current of the previous time step, this typically converges in 2 or 3 voltage evaluations.
+	 * For a constant power there are two solutions, the secant method started from a small current finds the one with the smallest magnitude.
 	 *
-	 * The current will produce a voltage which has a relative error below 0.1%, i.e. (Vl - Vset)/Vset < 0.001
-	 * Additionally, it will always be an 'undershoot' (we always stop 'too soon'):
-	 * 		if you are charging, Vl will be below Vset (by max 0.1%)
-	 * 		if you are discharging, Vl will be above Vset (by max 0.1%)
-	 * 		this is to avoid that you violate the voltage limits of the cell (e.g. if you do a CV at Vmax, an overshoot would produce V > Vmax), which would result in an error
-	 * If no such current can be found (e.g. the step size becomes too small), the current returned is a best-guess.
-	 * 		in most cases, this current will undershoot the set voltage but with a relative error above 0.1%
+	 * IN
+	 * power 	if true, X is the power [W], > 0 for discharge, < 0 for charge
+	 * 			if false, X is the load resistance [Ohm], > 0
+	 * X 		power or resistance
+	 * Iguess 	initial guess for the current [A]
 	 *
-	 * The search algorithm recursively refines the lower and upper bound on the current which reaches the set voltage.
-	 * Initially, this function must be called with some bounds.
-	 * the algorithm then takes 11 discrete steps between these bounds and searches when the error changes sign
-	 * 		i.e. step i gives a positive error while step i+1 gives a negative error or vice versa. then we know the sought current is between those two
-	 * 		these two values will be the new bounds for the lower-level recursion (which will have a smaller range and therefore a smaller step size)
-	 * 		this process continues until a current is found which satisfies the end-conditions
-	 * In case none of the currents in the search space is small enough (no undershoot), the lower bound is halved in the next recursion level
-	 * in case none of the currents in the search space is large enough (no overshoot), the upper bound is doubled in the next recursion level
-	 * If the step size becomes too small, the algorithm is terminated with the best-guess so far in order to avoid a slow convergence or an an infinite loop.
-	 * 		this best-guess will still produce an undershoot but with a larger relative error
+	 * OUT
+	 * I 		current which gives the power or resistance [A], > 0 for discharge, < 0 for charge
+	 * bool 	true if a current was found, false if the power or resistance can't be reached
+	 * 			(e.g. the power is above the maximum power the cell can deliver, or the cell voltage is illegal at the current)
+	 */
+
+	const double tol = 1e-6 * c.getNominalCap(); // tolerance on the current [A]
+	const int nmax = 20;						 // maximum number of iterations
+
+	auto residual = [&](double Ii) {
+		const double v = c.getVoltageAt(settings::verbose >= printLevel::printNonCrit, Ii);
+		return power ? v * Ii - X : v - X * Ii;
+	};
+
+	try
+	{
+		double I0 = Iguess;
+		double I1 = (I0 == 0) ? 1e-3 * c.getNominalCap() * (X < 0 ? -1 : 1) : 1.001 * I0;
+		double g0 = residual(I0);
+		double g1 = residual(I1);
+		for (int i = 0; i < nmax; i++)
+		{
+			if (g1 == g0)
+				break;
+			const double I2 = I1 - g1 * (I1 - I0) / (g1 - g0);
+			I0 = I1;
+			g0 = g1;
+			I1 = I2;
+			g1 = residual(I1);
+			if (std::abs(I1 - I0) < tol)
+			{
+				*I = I1;
+				return power ? I1 * X >= 0 : I1 > 0; // the solution must have the same direction as the load
+			}
+		}
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+			std::cout << "BasicCycler::findLoadCurrent got error " << e << " when getting the voltage at a trial current, the load can't be sustained.\n";
+	}
+
+	return false;
+}
+
+bool BasicCycler::findPlatingCurrent(double Iset, double margin, double Iguess, double *I)
+{
+	/*
+	 * Function to find the charging current of a plating-limited charge.
+	 * The set current is used if the anode potential relative to the plating reaction stays above the margin (see Cell::getPlatingPotentialAt),
+	 * else the secant method is used to find the current at which it is equal to the margin, as in findLoadCurrent.
 	 *
-	 * Note: function does not alter the battery state, i.e. at the end of the function, the original battery state is restored.
-	 * It merely searches for the required current.
+	 * IN
+	 * Iset 	maximum charging current [A], < 0
+	 * margin 	minimum potential of the anode relative to the plating reaction [V]
+	 * Iguess 	initial guess for the current [A], e.g. the current of the previous time step
+	 *
+	 * OUT
+	 * I 		charging current [A], Iset <= I < 0
+	 * bool 	true if a current was found, false if even a very small charging current brings the anode potential below the margin
+	 */
+
+	const double tol = 1e-6 * c.getNominalCap(); // tolerance on the current [A]
+	const int nmax = 20;						 // maximum number of iterations
+
+	auto residual = [&](double Ii) { return c.getPlatingPotentialAt(settings::verbose >= printLevel::printNonCrit, Ii) - margin; };
+
+	try
+	{
+		if (residual(Iset) >= 0)
+		{
+			*I = Iset;
+			return true;
+		}
+
+		double I0 = (Iguess < 0 && Iguess > Iset) ? Iguess : 0.5 * Iset;
+		double I1 = 0.999 * I0;
+		double g0 = residual(I0);
+		double g1 = residual(I1);
+		for (int i = 0; i < nmax; i++)
+		{
+			if (g1 == g0)
+				break;
+			const double I2 = I1 - g1 * (I1 - I0) / (g1 - g0);
+			I0 = I1;
+			g0 = g1;
+			I1 = std::max(I2, Iset);
+			g1 = residual(I1);
+			if (std::abs(I1 - I0) < tol)
+			{
+				*I = I1;
+				return I1 < 0; // the solution must charge the cell
+			}
+		}
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+			std::cout << "BasicCycler::findPlatingCurrent got error " << e << " when getting the plating potential at a trial current.\n";
+	}
+
+	return false;
+}
+
+int BasicCycler::load_t_V_E(bool power, double X, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to load the battery at a constant power or with a constant resistance with four end-conditions
+	 * 		load for a given amount of time
+	 * 		charge until the voltage is above an upper voltage limit
+	 * 		discharge until the voltage is below a lower voltage limit
+	 * 		load until the energy throughput reaches a limit
+	 * The first condition satisfied terminates the load.
+	 * The current is solved again in every time step (see findLoadCurrent) such that it follows the voltage of the cell as it (dis)charges and ages.
 	 *
 	 * IN
-	 * Imin 	the lower bound on the absolute value of the current needed to reach the voltage [A], > 0
-	 * Imax 	the upper bound on the absolute value of the current needed to reach the voltage [A], > 0
-	 * sign 	the sign of the current (i.e. do we need to charge or discharge to reach the voltage), 1 for discharge, -1 for charge
-	 * Vset 	the voltage we are trying to reach, [V]
-	 * dt 		the time step after which we need to reach the voltage
-	 * blockDegradation if true, degradation is not accounted for during this CV
-	 * 			set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
+	 * power 		if true, X is the power [W], > 0 for discharge, < 0 for charge
+	 * 				if false, X is the load resistance [Ohm], > 0 (i.e. the cell is discharged)
+	 * X 			power or resistance
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this load
+	 * time 		total time for which this load should be applied [sec], must be a multiple of dt
+	 * Vupp			upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax [V]
+	 * Vlow			lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax [V]
+	 * Emax 		maximum energy throughput [Wh], > 0
 	 *
 	 * OUT
-	 * Il 		the current which is necessary to reach this voltage after the given time step
-	 *  			this current results in a voltage which has a relative error below 0.1% and is in undershoot (above Vset if discharging; below Vset if charging)
-	 * 				in case on good current could be found (e.g. an error), Il is a best-guess is returned which will always undershoot the target voltage (but with a larger error)
-	 * Vl 		voltage you can expect to get after applying Il for the specified time step
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time the cell has been loaded [sec]
+	 * int 			which end condition was reached
+	 * 					-3 	the minimum cell voltage was exceeded
+	 * 					-2 	the maximum cell voltage was exceeded
+	 * 					0 	an error occurred
+	 * 					1 	the full time was completed
+	 * 					2 	the upper voltage limit was reached while charging the cell
+	 * 					3 	the lower voltage limit was reached while discharging the cell
+	 * 					4 	the energy limit was reached
+	 * 				the cell can't sustain a power above its maximum power, so this is reported as reaching the voltage limit (2 or 3) in the direction of the load
 	 *
 	 * THROWS
-	 * 1005		the voltage Vset has an illegal value
-	 * 1006 	the bounds have an illegal value: negative or the upper bound is below the lower bound (this should never happen)
-	 * 1007 	the step size in the search algorithm has become too small before the end conditions have been met (Il becomes the best-guess)
+	 * 1003 		the total time is not a multiple of dt
+	 * 1004 		illegal voltage, resistance or energy input
 	 */
 
+	const std::string name = power ? "BasicCycler::CP_t_V_E" : "BasicCycler::CR_t_V_E";
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
-		std::cout << "BasicCycler::findCVcurrent_recursive is starting with set voltage " << Vset << " and range " << Imin << " to " << Imax << '\n';
+		std::cout << name << " with time = " << time << ", voltage limits " << Vupp << " to " << Vlow << ", energy limit " << Emax
+				  << " and " << (power ? "power " : "resistance ") << X << " is starting\n";
 
-	// check if the voltage is valid
-	bool vmax = Vset > c.getVmax(); // check if the maximum voltage is below the cell maximum voltage
-	if (vmax)
-		std::cerr << "Error in BasicCycler::findCVcurrent_recursive. The voltage " << Vset << " is too high. The maximum value is " << c.getVmax() << '\n'
-				  << std::flush;
-	bool vmin = Vset < c.getVmin(); // check if the minimum voltage is above the cell minimum voltage
-	if (vmin)
-		std::cerr << "Error in BasicCycler::findCVcurrent_recursive. The voltage " << Vset << " is too low. The minimum value is " << c.getVmin() << '\n'
-				  << std::flush;
-	if (vmax || vmin)
-		throw 1005;
+	// Check that the total time is a multiple of the time step
+	if (remainder(time, dt) > 0.01)
+	{
+		std::cerr << "Error in " << name << ". The total time " << time << " is not a multiple of the time step dt " << dt << '\n';
+		throw 1003;
+	}
 
-	// check if the bounds on the current have legal values
-	bool imin = Imin < 0;
-	if (imin)
-		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The lower bound " << Imin << " is negative but it has to be positive. Throwing an error\n";
-	bool imax = Imax <= 0;
-	if (imax)
-		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The upper bound " << Imax << " is negative but it has to be strictly positive. Throwing an error\n";
-	bool lim = Imax <= Imin;
-	if (lim)
-		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The upper bound " << Imax << " is below the lower bound " << Imin << ". Throwing an error\n";
-	if (imin || imax || lim)
-		throw 1006;
+	// Check the voltage limits, the resistance and the energy limit
+	const bool vlim = Vupp > c.getVmax() || Vupp < c.getVmin() || Vlow > c.getVmax() || Vlow < c.getVmin();
+	if (vlim)
+		std::cerr << "Error in " << name << ". The voltage limits " << Vupp << " to " << Vlow << " must be between the minimum and maximum voltage of the cell "
+				  << c.getVmin() << " to " << c.getVmax() << ".\n";
 
-	// *********************************************************** 1 variables & settings ***********************************************************************
-	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-		std::cout << "BasicCycler::findCVcurrent_recursive with set voltage " << Vset << " and range " << Imin << " to " << Imax << " is initialising\n";
+	const bool rlim = !power && X <= 0;
+	if (rlim)
+		std::cerr << "Error in " << name << ". The load resistance " << X << " must be strictly positive.\n";
 
-	// store the initial battery states to restore them at the end
-	slide::State s;
-	double Iini;
-	c.getStates(s, &Iini);
+	const bool elim = Emax <= 0;
+	if (elim)
+		std::cerr << "Error in " << name << ". The energy limit " << Emax << " must be strictly positive.\n";
 
-	// variables
-	double ocvp, ocvn, etap, etan, rdrop, tem; // unneeded feedback variables
-	bool check = false;						   // we don't want to check if the state is valid after setting a current, because we know that the search algorithm will occasionally exceed the voltage limit
-	int nstep = 10;							   // number of steps in the search space for the current
-	double dI = sign * (Imax - Imin) / nstep;  // step size for the current [A]
-	double Itest = sign * Imin;				   // current in this iteration for the search for Il [A]
-	double Vtest;							   // voltage in this iteration for the search for Il
-	double err;								   // relative error between the actual cell voltage and the desired cell voltage [-]
-	double iminnew = -1;					   // new estimate for the lower bound on the absolute value of Il [A]
-	double imaxnew = -1;					   // new estimate for the upper bound on the absolute value of Il [A]
-	bool found = false;						   // boolean indicating if the current has been found
+	if (vlim || rlim || elim)
+		throw 1004;
 
-	// check that the step size is large enough in order to avoid an infinite loop or very slow convergence
-	if (std::abs(dI) < 1e-6)
-	{
+	// *********************************************************** 1 variables & settings ***********************************************************************
 
-		// our best guess is the lower bound, which should be an undershoot
-		c.setI(settings::verbose >= printLevel::printCrit, check, Imin);
-		c.ETI(settings::verbose >= printLevel::printCrit, dt, blockDegradation);
-		c.getVoltage(settings::verbose >= printLevel::printCrit, &Vtest, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
-		*Il = Imin;
-		*Vl = Vtest;
+	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data at a fixed time resolution)
+	if (CyclingDataTimeInterval > 0 && !logPolicy.on)
+		dt = std::min(dt, static_cast<double>(CyclingDataTimeInterval));
 
-		// print a warning and throw the error
-		if constexpr (settings::verbose >= printLevel::printNonCrit)
-			std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The current step " << dI
-					  << " is too small Throwing an error and returning best guess Il = " << Imin
-					  << " which produces voltage " << Vtest << " instead of " << Vset << '\n';
-		throw 1007;
-	}
+	// check that the total time is still multiple of the time step, if not set the time step to 1sec (which always works)
+	if (remainder(time, dt) > 0.01)
+		dt = 1;
 
-	// *********************************************************** 3 search for the required current ****************************************************************************
-	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-		std::cout << "BasicCycler::findCVcurrent_recursive is starting to scan the search space\n";
+	const int ttot = static_cast<int>(time / dt);						  // number of time steps needed in total
+	const int dir = (power && X < 0) ? -1 : ((power && X == 0) ? 0 : 1); // direction of the load: 1 discharge, -1 charge, 0 rest
 
-	// loop through the search space, starting at the lower bound and gradually increasing the (absolute value of) the test current
-	for (int i = 0; i < nstep + 1; i++)
-	{
+	slide::State s2; // state to restore if a limit is exceeded
+	double Iprev;	 // current in the previous time step [A]
+	double I;		 // current in this time step [A]
+	double v, ocvp, ocvn, etap, etan, rdrop, tem;
+	double ah = 0;		   // discharged charge [Ah]
+	double wh = 0;		   // discharged energy [Wh]
+	double tt = 0;		   // time on load
+	int ti = 0;			   // number of time steps taken
+	int endcriterion = 99; // integer indicating why the function terminated
+
+	// get the initial voltage, which is used for the first guess of the current
+	try
+	{
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "error in " << name << " when getting the initial cell voltage. This means the cell is in an illegal state when this function is called: "
+					  << e << ". Throwing on the error.\n";
+		throw e;
+	}
+	if (logBegin(dir == 0 ? LogPhase::rest : LogPhase::CC))
+	{
+		timeRes += 0.000001;						// add a small amount to the rest time to ensure the new data point is different from the point before
+		storeResults(c.getI(), v, ocvp, ocvn, tem); // store the initial data point
+	}
+
+	// *********************************************************** 2 loop for the total time ******************************************************************
+
+	for (int t = 0; t < ttot; t++)
+	{
+		c.getStates(s2, &Iprev);
+
+		// solve the current, starting from the current of the previous time step if it has the same direction
+		const double Iguess = (Iprev * dir > 0) ? Iprev : (power ? X / v : v / X);
+		if (!findLoadCurrent(power, X, Iguess, &I))
+		{
+			endcriterion = (dir < 0) ? 2 : 3; // the load can't be sustained, which is a voltage limit in the direction of the load
+			break;
+		}
+
+		// take the time step
+		bool er = false;
+		try
+		{
+			c.setI(settings::verbose >= printLevel::printCrit, false, I);
+			c.ETI(settings::verbose >= printLevel::printCrit, dt, blockDegradation);
+			c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		}
+		catch (int err)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in " << name << " while cycling, error " << err << " in time step " << t << " and the last voltage was " << v << '\n';
+			er = true;
+		}
+
+		// Check the end criteria. Undo the last iteration if a limit is exceeded such that we stay within the limits at all times
+		if (er)
+			endcriterion = 0;
+		else if (I < 0 && v > Vupp)
+			endcriterion = 2;
+		else if (I > 0 && v < Vlow)
+			endcriterion = 3;
+		else if (v > c.getVmax())
+			endcriterion = -2;
+		else if (v < c.getVmin())
+			endcriterion = -3;
+		if (er || endcriterion != 99)
+		{
+			c.setStates(s2, Iprev);
+			break;
+		}
+
+		// this is a valid iteration, so update the time and throughput
+		const double d_ah = I * dt / 3600.0;
+		const double d_wh = d_ah * v;
+		tt += dt;
+		ah += d_ah;
+		wh += d_wh;
+		ti++;
+
+		if (I > 0)
+		{ // discharging
+			timeDis += dt;
+			AhDis += std::abs(d_ah);
+			WhDis += std::abs(d_wh);
+		}
+		else if (I < 0)
+		{ // charging
+			timeCha += dt;
+			AhCha += std::abs(d_ah);
+			WhCha += std::abs(d_wh);
+		}
+		else // resting
+			timeRes += dt;
+
+		// store the results at the specified time resolution
+		if (logDue(I, v, dt))
+			storeResults(I, v, ocvp, ocvn, tem);
+
+		// stop if the energy limit is reached
+		if (std::abs(wh) >= Emax)
+		{
+			endcriterion = 4;
+			break;
+		}
+	}
+
+	// Check if the loop ended because we have reached the time limit
+	if (ti == ttot)
+		endcriterion = 1;
+
+	// *********************************************************** 3 output parameters ***********************************************************************
+
+	// store the last data point if we are storing data
+	if (logEnd())
+	{
+		try
+		{
+			c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in " << name << " when getting the voltage at the end, error " << e << ". Return 0.\n";
+			endcriterion = 0;
+		}
+		storeResults(c.getI(), v, ocvp, ocvn, tem);
+	}
+
+	*ahi = ah;
+	*whi = wh;
+	*timei = tt;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << name << " with time = " << time << " and " << (power ? "power " : "resistance ") << X << " is terminating with " << endcriterion << '\n';
+
+	return endcriterion;
+}
+
+int BasicCycler::CP_t_V_E(double P, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to load the battery at a constant power with four end-conditions
+	 * 		load for a given amount of time
+	 * 		charge until the voltage is above an upper voltage limit
+	 * 		discharge until the voltage is below a lower voltage limit
+	 * 		load until the energy throughput reaches a limit
+	 * The first condition satisfied terminates the CP.
+	 * The current is adapted every time step to the cell voltage, so the power stays correct as the cell (dis)charges and ages.
+	 *
+	 * IN
+	 * P 			power [W], positive = discharge, negative = charge
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this CP
+	 * time 		total time for which this power should be applied [sec], must be a multiple of dt
+	 * Vupp			upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax [V]
+	 * Vlow			lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax [V]
+	 * Emax 		maximum energy throughput [Wh], > 0
+	 *
+	 * OUT
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time the cell has been loaded with the CP [sec]
+	 * int 			which end condition was reached
+	 * 					-3 	the minimum cell voltage was exceeded
+	 * 					-2 	the maximum cell voltage was exceeded
+	 * 					0 	an error occurred
+	 * 					1 	the full time was completed
+	 * 					2 	the upper voltage limit was reached while charging the cell (or the charging power can't be sustained)
+	 * 					3 	the lower voltage limit was reached while discharging the cell (or the discharging power can't be sustained)
+	 * 					4 	the energy limit was reached
+	 *
+	 * THROWS
+	 * 1003 		the total time is not a multiple of dt
+	 * 1004 		illegal voltage or energy input
+	 */
+
+	return load_t_V_E(true, P, dt, blockDegradation, time, Vupp, Vlow, Emax, ahi, whi, timei);
+}
+
+int BasicCycler::CP_t(double P, double dt, bool blockDegradation, double time, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to load the battery at a constant power for a given amount of time.
+	 * The CP stops early if the voltage limits of the cell are reached.
+	 *
+	 * IN
+	 * P 			power [W], positive = discharge, negative = charge
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this CP
+	 * time 		total time for which this power should be applied [sec]
+	 *
+	 * OUT
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time it took [sec]
+	 * int 			integer indicating why the CP phase stopped
+	 * 					-3 	the minimum cell voltage was exceeded (or the discharging power can't be sustained)
+	 * 					-2 	the maximum cell voltage was exceeded (or the charging power can't be sustained)
+	 * 					0 	an error occurred
+	 * 					1 	the full time was completed
+	 */
+
+	int endcr = CP_t_V_E(P, dt, blockDegradation, time, c.getVmax(), c.getVmin(), std::numeric_limits<double>::max(), ahi, whi, timei);
+
+	// there were no upper and lower voltage limits, so replace these end conditions with the cell voltage limits
+	if (endcr == 2)
+		endcr = -2;
+	if (endcr == 3)
+		endcr = -3;
+
+	return endcr;
+}
+
+int BasicCycler::CP_V(double P, double dt, bool blockDegradation, double Vset, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to load the battery at a constant power until a given voltage is reached.
+	 *
+	 * IN
+	 * P 			power [W], positive = discharge, negative = charge
+	 * 				must be compatible with the voltage limit, i.e. charge if Vset is above the cell voltage and discharge if it is below
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this CP
+	 * Vset 		the voltage to which you want to (dis)charge the cell, Cell.Vmin <= Vset <= Cell.Vmax [V]
+	 *
+	 * OUT
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time it took [sec]
+	 * int 			integer indicating why the CP phase ended
+	 * 					-3 	the minimum cell voltage was exceeded
+	 * 					-2 	the maximum cell voltage was exceeded
+	 * 					0 	an error occurred
+	 * 					2 	the voltage was reached while charging the cell (or the charging power can't be sustained)
+	 * 					3 	the voltage was reached while discharging the cell (or the discharging power can't be sustained)
+	 *
+	 * THROWS
+	 * 1004 		illegal voltage or power input
+	 * 1016 		the time limit was reached instead of the voltage limit.
+	 */
+
+	// check if the voltage is allowed and the power has the correct sign
+	double v, ocvp, ocvn, etap, etan, rdrop, tem;
+	c.getVoltage(settings::verbose >= printLevel::printNonCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+	if (Vset > c.getVmax() || Vset < c.getVmin() || (v < Vset && P >= 0) || (v > Vset && P <= 0))
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "Error in BasicCycler::CP_V. The cell voltage is " << v << " and you want to get to " << Vset << " with a power of " << P
+					  << ". The voltage must be within the voltage limits of the cell and a power < 0 means the cell is charging, > 0 means it is discharging.\n";
+		throw 1004;
+	}
+
+	const double Vupp = (P > 0) ? c.getVmax() : Vset;
+	const double Vlow = (P > 0) ? Vset : c.getVmin();
+	const double time = 99999999; // set the time limit very high so this is never the problem
+
+	const int endcr = CP_t_V_E(P, dt, blockDegradation, time, Vupp, Vlow, std::numeric_limits<double>::max(), ahi, whi, timei);
+	if (endcr == 1)
+	{
+		std::cerr << "Error in BasicCycler::CP_V, the CP phase terminated because the time limit was reached instead of the voltage limit. Throwing an error.\n";
+		throw 1016;
+	}
+
+	return endcr;
+}
+
+int BasicCycler::CR_t_V_E(double R, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to discharge the battery through a constant load resistance with four end-conditions
+	 * 		load for a given amount of time
+	 * 		discharge until the voltage is below a lower voltage limit
+	 * 		load until the discharged energy reaches a limit
+	 * 		(the upper voltage limit is only used if the cell voltage exceeds it)
+	 * The first condition satisfied terminates the CR.
+	 * The current is solved every time step from V = R * I.
+	 *
+	 * IN
+	 * R 			load resistance [Ohm], > 0
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this CR
+	 * time 		total time for which the load should be applied [sec], must be a multiple of dt
+	 * Vupp			upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax [V]
+	 * Vlow			lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax [V]
+	 * Emax 		maximum energy throughput [Wh], > 0
+	 *
+	 * OUT
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time the cell has been loaded [sec]
+	 * int 			which end condition was reached, see CP_t_V_E
+	 *
+	 * THROWS
+	 * 1003 		the total time is not a multiple of dt
+	 * 1004 		illegal voltage, resistance or energy input
+	 */
+
+	return load_t_V_E(false, R, dt, blockDegradation, time, Vupp, Vlow, Emax, ahi, whi, timei);
+}
+
+int BasicCycler::CR_V(double R, double dt, bool blockDegradation, double Vset, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to discharge the battery through a constant load resistance until a given voltage is reached.
+	 *
+	 * IN
+	 * R 			load resistance [Ohm], > 0
+	 * dt 			time step to be taken in the time integration [sec], see CC_t_V
+	 * blockDegradation if true, degradation is not accounted for during this CR
+	 * Vset 		the voltage to which you want to discharge the cell, Cell.Vmin <= Vset <= cell voltage [V]
+	 *
+	 * OUT
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time it took [sec]
+	 * int 			integer indicating why the CR phase ended
+	 * 					-3 	the minimum cell voltage was exceeded
+	 * 					0 	an error occurred
+	 * 					3 	the voltage was reached
+	 *
+	 * THROWS
+	 * 1004 		illegal voltage or resistance input
+	 * 1016 		the time limit was reached instead of the voltage limit.
+	 */
+
+	const double time = 99999999; // set the time limit very high so this is never the problem
+	const int endcr = CR_t_V_E(R, dt, blockDegradation, time, c.getVmax(), Vset, std::numeric_limits<double>::max(), ahi, whi, timei);
+	if (endcr == 1)
+	{
+		std::cerr << "Error in BasicCycler::CR_V, the CR phase terminated because the time limit was reached instead of the voltage limit. Throwing an error.\n";
+		throw 1016;
+	}
+
+	return endcr;
+}
+
+void BasicCycler::findCVcurrent_recursive(double Imin, double Imax, int sign, double Vset, double dt, bool blockDegradation, double *Il, double *Vl)
+{
+	/*
+	 * This is a recursive function which solves the nonlinear equation to find the current needed to reach a given voltage after a given time step.
+	 *
+	 * The current will produce a voltage which has a relative error below 0.1%, i.e. (Vl - Vset)/Vset < 0.001
+	 * Additionally, it will always be an 'undershoot' (we always stop 'too soon'):
+	 * 		if you are charging, Vl will be below Vset (by max 0.1%)
+	 * 		if you are discharging, Vl will be above Vset (by max 0.1%)
+	 * 		this is to avoid that you violate the voltage limits of the cell (e.g. if you do a CV at Vmax, an overshoot would produce V > Vmax), which would result in an error
+	 * If no such current can be found (e.g. the step size becomes too small), the current returned is a best-guess.
+	 * 		in most cases, this current will undershoot the set voltage but with a relative error above 0.1%
+	 *
+	 * The search algorithm recursively refines the lower and upper bound on the current which reaches the set voltage.
+	 * Initially, this function must be called with some bounds.
+	 * the algorithm then takes 11 discrete steps between these bounds and searches when the error changes sign
+	 * 		i.e. step i gives a positive error while step i+1 gives a negative error or vice versa. then we know the sought current is between those two
+	 * 		these two values will be the new bounds for the lower-level recursion (which will have a smaller range and therefore a smaller step size)
+	 * 		this process continues until a current is found which satisfies the end-conditions
+	 * In case none of the currents in the search space is small enough (no undershoot), the lower bound is halved in the next recursion level
+	 * in case none of the currents in the search space is large enough (no overshoot), the upper bound is doubled in the next recursion level
+	 * If the step size becomes too small, the algorithm is terminated with the best-guess so far in order to avoid a slow convergence or an an infinite loop.
+	 * 		this best-guess will still produce an undershoot but with a larger relative error
+	 *
+	 * Note: function does not alter the battery state, i.e. at the end of the function, the original battery state is restored.
+	 * It merely searches for the required current.
+	 *
+	 * IN
+	 * Imin 	the lower bound on the absolute value of the current needed to reach the voltage [A], > 0
+	 * Imax 	the upper bound on the absolute value of the current needed to reach the voltage [A], > 0
+	 * sign 	the sign of the current (i.e. do we need to charge or discharge to reach the voltage), 1 for discharge, -1 for charge
+	 * Vset 	the voltage we are trying to reach, [V]
+	 * dt 		the time step after which we need to reach the voltage
+	 * blockDegradation if true, degradation is not accounted for during this CV
+	 * 			set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
+	 *
+	 * OUT
+	 * Il 		the current which is necessary to reach this voltage after the given time step
+	 *  			this current results in a voltage which has a relative error below 0.1% and is in undershoot (above Vset if discharging; below Vset if charging)
+	 * 				in case on good current could be found (e.g. an error), Il is a best-guess is returned which will always undershoot the target voltage (but with a larger error)
+	 * Vl 		voltage you can expect to get after applying Il for the specified time step
+	 *
+	 * THROWS
+	 * 1005		the voltage Vset has an illegal value
+	 * 1006 	the bounds have an illegal value: negative or the upper bound is below the lower bound (this should never happen)
+	 * 1007 	the step size in the search algorithm has become too small before the end conditions have been met (Il becomes the best-guess)
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::findCVcurrent_recursive is starting with set voltage " << Vset << " and range " << Imin << " to " << Imax << '\n';
+
+	// check if the voltage is valid
+	bool vmax = Vset > c.getVmax(); // check if the maximum voltage is below the cell maximum voltage
+	if (vmax)
+		std::cerr << "Error in BasicCycler::findCVcurrent_recursive. The voltage " << Vset << " is too high. The maximum value is " << c.getVmax() << '\n'
+				  << std::flush;
+	bool vmin = Vset < c.getVmin(); // check if the minimum voltage is above the cell minimum voltage
+	if (vmin)
+		std::cerr << "Error in BasicCycler::findCVcurrent_recursive. The voltage " << Vset << " is too low. The minimum value is " << c.getVmin() << '\n'
+				  << std::flush;
+	if (vmax || vmin)
+		throw 1005;
+
+	// check if the bounds on the current have legal values
+	bool imin = Imin < 0;
+	if (imin)
+		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The lower bound " << Imin << " is negative but it has to be positive. Throwing an error\n";
+	bool imax = Imax <= 0;
+	if (imax)
+		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The upper bound " << Imax << " is negative but it has to be strictly positive. Throwing an error\n";
+	bool lim = Imax <= Imin;
+	if (lim)
+		std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The upper bound " << Imax << " is below the lower bound " << Imin << ". Throwing an error\n";
+	if (imin || imax || lim)
+		throw 1006;
+
+	// *********************************************************** 1 variables & settings ***********************************************************************
+	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+		std::cout << "BasicCycler::findCVcurrent_recursive with set voltage " << Vset << " and range " << Imin << " to " << Imax << " is initialising\n";
+
+	// store the initial battery states to restore them at the end
+	slide::State s;
+	double Iini;
+	c.getStates(s, &Iini);
+
+	// variables
+	double ocvp, ocvn, etap, etan, rdrop, tem; // unneeded feedback variables
+	bool check = false;						   // we don't want to check if the state is valid after setting a current, because we know that the search algorithm will occasionally exceed the voltage limit
+	int nstep = 10;							   // number of steps in the search space for the current
+	double dI = sign * (Imax - Imin) / nstep;  // step size for the current [A]
+	double Itest = sign * Imin;				   // current in this iteration for the search for Il [A]
+	double Vtest;							   // voltage in this iteration for the search for Il
+	double err;								   // relative error between the actual cell voltage and the desired cell voltage [-]
+	double iminnew = -1;					   // new estimate for the lower bound on the absolute value of Il [A]
+	double imaxnew = -1;					   // new estimate for the upper bound on the absolute value of Il [A]
+	bool found = false;						   // boolean indicating if the current has been found
+
+	// check that the step size is large enough in order to avoid an infinite loop or very slow convergence
+	if (std::abs(dI) < 1e-6)
+	{
+
+		// our best guess is the lower bound, which should be an undershoot
+		c.setI(settings::verbose >= printLevel::printCrit, check, Imin);
+		c.ETI(settings::verbose >= printLevel::printCrit, dt, blockDegradation);
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &Vtest, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		*Il = Imin;
+		*Vl = Vtest;
+
+		// print a warning and throw the error
+		if constexpr (settings::verbose >= printLevel::printNonCrit)
+			std::cerr << "ERROR in BasicCycler::findCVcurrent_recursive. The current step " << dI
+					  << " is too small Throwing an error and returning best guess Il = " << Imin
+					  << " which produces voltage " << Vtest << " instead of " << Vset << '\n';
+		throw 1007;
+	}
+
+	// *********************************************************** 3 search for the required current ****************************************************************************
+	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+		std::cout << "BasicCycler::findCVcurrent_recursive is starting to scan the search space\n";
+
+	// loop through the search space, starting at the lower bound and gradually increasing the (absolute value of) the test current
+	for (int i = 0; i < nstep + 1; i++)
+	{
 
 		// restore the original battery state
 		c.setStates(s, Iini);
@@ -1525,7 +2266,7 @@ int BasicCycler::CV_t_I(double Vset, double dt, bool blockDegradation, double ti
 	 * 				should be small enough to ensure numerical stability. The stability depends on the current rating and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CV
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * time 		total time for which this voltage should be applied [sec]
@@ -1571,9 +2312,9 @@ int BasicCycler::CV_t_I(double Vset, double dt, bool blockDegradation, double ti
 		throw 1003;
 	}
 
-	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data)
+	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data at a fixed time resolution)
 	double feedb = CyclingDataTimeInterval;
-	if (feedb > 0)
+	if (feedb > 0 && !logPolicy.on)
 		dt = std::min(dt, feedb);
 
 	// check that the total time is still multiple of the time step, if not set the time step to 1sec (which always works)
@@ -1589,14 +2330,13 @@ int BasicCycler::CV_t_I(double Vset, double dt, bool blockDegradation, double ti
 	double wh = 0;												 // cumulative discharged energy up to now [Wh]
 	double tt = 0;												 // cumulative time up to now [sec]
 	int t = 0;													 // number of time steps
-	int nstore = static_cast<int>(CyclingDataTimeInterval / dt); // number of time steps it takes to cover 'CyclingDataTimeInterval' seconds
 	double v;													 // cell voltage in this time step [V]
 	double ocvp, ocvn, tem, etap, etan, rdrop;					 // feedback variables not needed
 	int endcr = 99;												 // integer indicating why the CV phase terminated
 
 	// store the initial battery state if we are storing data
 	// If the cell is in an invalid condition, this will produce an error
-	if (CyclingDataTimeInterval > 0)
+	if (logBegin(LogPhase::CV))
 	{
 		try
 		{
@@ -1707,7 +2447,7 @@ int BasicCycler::CV_t_I(double Vset, double dt, bool blockDegradation, double ti
 			}
 
 			// store the results at the specified time resolution
-			if (remainder(t, nstore) == 0)
+			if (logDue(Il, v, dt))
 				storeResults(Il, v, ocvp, ocvn, tem);
 			t++;
 		}
@@ -1727,7 +2467,7 @@ int BasicCycler::CV_t_I(double Vset, double dt, bool blockDegradation, double ti
 	// *********************************************************** 3 output parameters ***********************************************************************
 
 	// store what happened since the last time we stored data if we are storing data
-	if (CyclingDataTimeInterval > 0)
+	if (logEnd())
 	{
 		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
 		storeResults(Il, v, ocvp, ocvn, tem);
@@ -1756,7 +2496,7 @@ void BasicCycler::CV_t(double Vset, double dt, bool blockDegradation, double tim
 	 * 				should be small enough to ensure numerical stability. The stability depends on the current rating and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CV
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * time 		total time for which this voltage should be applied [sec]
@@ -1838,7 +2578,7 @@ void BasicCycler::CV_I(double Vset, double dt, bool blockDegradation, double Icu
 	 * 				should be small enough to ensure numerical stability. The stability depends on the current rating and the temperature
 	 * 				the order of magnitude is 1 to 5 seconds
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * blockDegradation if true, degradation is not accounted for during this CV
 	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
 	 * Icut 		the absolute value of the lowest current allowed [A]
@@ -1928,7 +2668,7 @@ int BasicCycler::CC_t_CV_t(double I, double dt, bool blockDegradation, double ti
 	 * time 		time for which this current should be applied [sec]
 	 *				must be a multiple of dt
 	 * 				If the data-collection time interval is smaller than dt, the data-collection time interval is used instead of the specified value
-	 * 				i.e. dt = min(dt,CyclingDataTimeInterval)
+	 * 				i.e. dt = min(dt,CyclingDataTimeInterval), this is not done with a LogPolicy
 	 * Vupp			upper voltage limit, must be in the voltage range of the cell, Cell.Vmin <= Vupp <= Cell.Vmax, [V]
 	 * Vlow			lower voltage limit, nust be in the voltage range of the cell, Cell.Vmin <= Vlow <= Cell.Vmax, [V]
 	 *
@@ -1962,9 +2702,9 @@ int BasicCycler::CC_t_CV_t(double I, double dt, bool blockDegradation, double ti
 		throw 1003;
 	}
 
-	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data)
+	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data at a fixed time resolution)
 	double feedb = CyclingDataTimeInterval;
-	if (feedb > 0)
+	if (feedb > 0 && !logPolicy.on)
 		dt = std::min(dt, feedb);
 	// check that the total time is still multiple of the time step, if not set the time step to 1sec (which always works)
 	if (remainder(time, dt) > 0.01)
@@ -2259,7 +2999,238 @@ int BasicCycler::followI(int nI, const std::vector<double> &I, const std::vector
 	double Iprev;											 // current in the previous time step
 	double ah, wh;											 // capacity/energy discharged during this step in the profile [Ah]/[Wh]
 	double tt;												 // time spent during this step in the profile [sec]
-	int vlim;												 // integer indicating why the CC phase finished
+	int vlim;												 // integer indicating why the CC phase finished
+	double ahtot{0}, whtot{0};								 // charge/energy throughput up to this step in the profile [Ah]/[Wh]
+	double tttot = 0;										 // cumulative time up to this step in the profile [sec]
+	bool vminlim{false}, vmaxlim{false};					 // boolean to indicate if the minimum/maximum voltage limit was hit
+	bool verr = false;										 // boolean to indicate if an unknown error occurred
+
+	// ****************************************************** 2 loop through the profile ***********************************************************************
+
+	logProfile(true); // with a LogPolicy, all steps of the profile are one phase
+
+	for (size_t i = 0; i < I.size(); i++)
+	{
+
+		if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+			std::cout << "BasicCycler::followI is in step " << i << " with a current of " << I[i] << " and time of " << T[i] << " seconds.\n";
+
+		// Determine the time step to be used for the time integration in this step of the profile
+		const bool Ilow = std::abs(I[i]) < 1.5 * c.getNominalCap(); // is the current below 1.5C?
+		const bool Imed = std::abs(I[i]) < 3 * c.getNominalCap();	// is the current below 3C?
+		if (std::fmod(T[i], 3) == 0 && Tlow && Ilow)				// if the temperature is low, the current is low, and the time of the step is a multiple of 3 sec
+			dt = 3;													// then use 3 seconds as time step
+		else if (std::fmod(T[i], 2) == 0 && Imed)					// the current is medium, and the time of the step is a multiple of 2 sec
+			dt = 2;													// then use 2 seconds as time step
+		else														// else use the lower value of 1 second or the time step
+			dt = std::min(1.0, T[i]);
+		// note: if the data collection time interval is smaller than dt, this will be corrected in the underlying functions (in CC_t_V)
+
+		// print a warning if the current is large since this might cause numerical problems
+		if (!Imed)
+			std::cout << "Warning in BasicCycler::followI. The current in step " << i << " is " << I[i]
+					  << ", which is above 3C. Very large currents might lead to errors in the model.\n";
+		// large currents are a problem because then charge throughput in one time step is too high, and the concentration difference between 2 time steps is too large
+		// such that it is possible that in time step t, all is fine (e.g. v = 3.9), and in time step t+1, the li-concentration is larger than the maximum concentration (and the cell voltage would be 8V)
+
+		// store initial states such they can be restored if needed
+		c.getStates(s, &Iprev);
+
+		// Follow this step of the profile
+		try
+		{
+			if (limit == 0) // follow the profile as long as we can, skip the rest of the step if we hit a voltage limit
+				vlim = CC_t_V(I[i], dt, blockDegradation, T[i], Vupp, Vlow, &ah, &wh, &tt);
+			else if (limit == 1) // keep the voltage constant for the rest of the step if we hit a voltage limit
+				vlim = CC_t_CV_t(I[i], dt, blockDegradation, T[i], Vupp, Vlow, &ah, &wh, &tt);
+		}
+		catch (int e)
+		{
+			std::cout << "Error in a subfunction of BasicCycler::followI when following step " << i << " of the profile, which has current " << I[i]
+					  << " A for a duration of " << T[i] << " seconds. Error" << e << ". Throwing it on.\n";
+			logProfile(false);
+			throw e;
+		}
+
+		// check if a voltage limit was hit
+		if (vlim == 2 || vlim == -2)
+		{ // the upper voltage limit (or the maximum cell voltage) was reached
+			vmaxlim = true;
+			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+				std::cout << "BasicCycler::followI has hit the upper voltage limit during step " << i << ".\n";
+		}
+		else if (vlim == 3 || vlim == -3)
+		{ // the lower voltage limit (or the minimum cell voltage) was reached
+			vminlim = true;
+			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+				std::cout << "BasicCycler::followI has hit the lower voltage limit during step " << i << ".\n";
+		}
+		else if (vlim == 1)
+		{
+		} // no voltage limit was reached
+		else
+		{
+			verr = true; // an error occurred and we don't know which voltage limit was reached
+			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+				std::cout << "BasicCycler::followI has encountered an error so we don't know if a voltage limit was reached during step " << i << ".\n";
+		}
+
+		// update the cumulative throughput
+		ahtot += std::abs(ah);
+		whtot += std::abs(wh);
+		tttot += tt;
+	}
+
+	// *********************************************************** 3 output parameters ***********************************************************************
+
+	// store the last data point of the profile if we are storing data per phase
+	if (logProfile(false))
+	{
+		double v, ocvp, ocvn, etap, etan, rdrop, tem;
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		storeResults(c.getI(), v, ocvp, ocvn, tem);
+	}
+
+	// return the throughput
+	*ahi = ahtot;
+	*whi = whtot;
+	*timei = tttot;
+
+	// set the value of the return-integer to indicate which voltage limit was hit
+	int endvalue;
+	if (verr) // an unknown voltage limit was hit while following the profile
+		endvalue = 100;
+	else if (vminlim && vmaxlim) // both lower and upper voltage limits were hit
+		endvalue = 10;
+	else if (vminlim) // lower voltage limit was hit
+		endvalue = -1;
+	else if (vmaxlim) // upper voltage limit was hit
+		endvalue = 1;
+	else // no voltage limit was hit
+		endvalue = 0;
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::followI with given profile and voltage limits " << Vupp
+				  << " to " << Vlow << ", is terminating with " << endvalue << ".\n";
+
+	return endvalue;
+}
+
+int BasicCycler::followI(int nI, const std::string &nameI, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to follow a certain current pattern.
+	 * The cell tries to follow the current every time step.
+	 *
+	 * IN
+	 * nI 		length of the current profile (i.e. number of rows in the csv file)
+	 * 				if n is too small, only the first n steps of the profile are simulated
+	 * 				if 0 or large than number of rows, then all rows are simulated. 
+	 * nameI 	name of the CSV-file with the current profile
+	 * 				the first column contains the current in [A], positive for discharge, negative for charge
+	 * 				the second column contains the time in [sec] the current should be maintained
+	 * blockDegradation if true, degradation is not accounted for during this current profile
+	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
+	 * limit 	integer describing what to do if the current can't be maintained because a voltage limit is reached
+	 * 				0 	immediately go to the next current step of the profile (i.e. reduce the time of this step)
+	 * 				1 	keep the voltage constant for the rest of this step of the profile (i.e. reduce the current for the rest of this step)
+	 * Vupp		upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax, [V]
+	 * Vlow		lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax, [V]
+	 *
+	 * OUT
+	 * ahi		charge throughput while following the profile [Ah]
+	 * whi		energy throughput while following the profile [Wh]
+	 * timei	time spent while following the profile [sec]
+	 * int 		integer indicating if a voltage limit was hit while following the current profile
+	 * 				-1 if the lower voltage limit was hit while following the original profile
+	 * 				0 if the profile could be followed, i.e. no voltage limit was hit while following this profile
+	 * 				1 if the upper voltage limit was hit while following the original profile
+	 * 				10 if both the lower and upper voltage limits were hit while following the original profile
+	 * 				100 if we don't know which voltage limit was hit while following the original profile
+	 *
+	 * throws
+	 * 1011 	limit has an illegal value (it is not 0, 1 or 2)
+	 * 1012 	if the cell is in an illegal state (i.e. even a current of 0A still violates the voltage constraints of the cell)
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::followI with profile = " << nameI << ", and voltage limits " << Vupp << " to " << Vlow << ", is starting\n";
+
+	if (limit < 0 || limit > 1)
+	{
+		std::cerr << "ERROR in BasicCycler::followI, illegal value for the limit setting: " << limit
+				  << ", only the values 0 and 1 are allowed. Throwing an error.\n";
+		throw 1011;
+	}
+
+	// *********************************************************** 1 read the current profile & variables ***********************************************************************
+	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
+		std::cout << "BasicCycler::followI is reading the current profile\n";
+
+	// Read the current profile
+	static thread_local std::vector<double> I(nI), T(nI);
+	try
+	{
+		loadCSV_2col(PathVar::data + nameI, I, T, nI); // read the file
+	}
+	catch (int e)
+	{
+		std::cout << "error in BasicCycler::followI when reading the file with the current profile called "
+				  << nameI << ", error " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	auto endvalue = followI(nI, I, T, blockDegradation, limit, Vupp, Vlow, ahi, whi, timei);
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::followI with profile = " << nameI << ", and voltage limits " << Vupp
+				  << " to " << Vlow << ", is terminating with " << endvalue << ".\n";
+
+	return endvalue;
+}
+
+int BasicCycler::followP(int nP, const std::vector<double> &P, const std::vector<double> &T, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei)
+{
+	/*
+	 * function to follow a certain power pattern.
+	 * Every step of the profile is a CP phase (see CP_t_V_E), so the current follows the cell voltage as the cell ages.
+	 *
+	 * IN
+	 * nP 		length of the power profile
+	 * P 		power of every step of the profile [W], positive for discharge, negative for charge
+	 * T 		time of every step of the profile [sec]
+	 * blockDegradation if true, degradation is not accounted for during this power profile
+	 * limit 	integer describing what to do if the power can't be maintained because a voltage limit is reached
+	 * 				0 	immediately go to the next step of the profile (i.e. reduce the time of this step)
+	 * 				1 	keep the voltage constant for the rest of this step of the profile (i.e. reduce the power for the rest of this step)
+	 * Vupp		upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax, [V]
+	 * Vlow		lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax, [V]
+	 *
+	 * OUT
+	 * ahi		charge throughput while following the profile [Ah]
+	 * whi		energy throughput while following the profile [Wh]
+	 * timei	time spent while following the profile [sec]
+	 * int 		integer indicating if a voltage limit was hit while following the power profile, see followI
+	 *
+	 * throws
+	 * 1011 	limit has an illegal value (it is not 0 or 1)
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::followP with given profile and voltage limits " << Vupp << " to " << Vlow << ", is starting\n";
+
+	if (limit < 0 || limit > 1)
+	{
+		std::cerr << "ERROR in BasicCycler::followP, illegal value for the limit setting: " << limit
+				  << ", only the values 0 and 1 are allowed. Throwing an error.\n";
+		throw 1011;
+	}
+
+	// *********************************************************** 1 variables ***********************************************************************
+	double dt;												 // time step to be used for this step in the profile [sec]
+	const bool Tlow = c.getTenv() < (PhyConst::Kelvin + 45); // boolean indicating if the environmental temperature is below 45 degrees
+	double ah, wh;											 // capacity/energy discharged during this step in the profile [Ah]/[Wh]
+	double tt;												 // time spent during this step in the profile [sec]
+	int vlim;												 // integer indicating why the CP phase finished
 	double ahtot{0}, whtot{0};								 // charge/energy throughput up to this step in the profile [Ah]/[Wh]
 	double tttot = 0;										 // cumulative time up to this step in the profile [sec]
 	bool vminlim{false}, vmaxlim{false};					 // boolean to indicate if the minimum/maximum voltage limit was hit
@@ -2267,70 +3238,55 @@ int BasicCycler::followI(int nI, const std::vector<double> &I, const std::vector
 
 	// ****************************************************** 2 loop through the profile ***********************************************************************
 
-	for (size_t i = 0; i < I.size(); i++)
-	{
+	logProfile(true); // with a LogPolicy, all steps of the profile are one phase
 
+	const auto n = (nP > 0) ? std::min(P.size(), static_cast<size_t>(nP)) : P.size();
+	for (size_t i = 0; i < n; i++)
+	{
 		if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-			std::cout << "BasicCycler::followI is in step " << i << " with a current of " << I[i] << " and time of " << T[i] << " seconds.\n";
-
-		// Determine the time step to be used for the time integration in this step of the profile
-		const bool Ilow = std::abs(I[i]) < 1.5 * c.getNominalCap(); // is the current below 1.5C?
-		const bool Imed = std::abs(I[i]) < 3 * c.getNominalCap();	// is the current below 3C?
-		if (std::fmod(T[i], 3) == 0 && Tlow && Ilow)				// if the temperature is low, the current is low, and the time of the step is a multiple of 3 sec
-			dt = 3;													// then use 3 seconds as time step
-		else if (std::fmod(T[i], 2) == 0 && Imed)					// the current is medium, and the time of the step is a multiple of 2 sec
-			dt = 2;													// then use 2 seconds as time step
-		else														// else use the lower value of 1 second or the time step
+			std::cout << "BasicCycler::followP is in step " << i << " with a power of " << P[i] << " and time of " << T[i] << " seconds.\n";
+
+		// Determine the time step like in followI, using the highest current this power can need (at the minimum voltage)
+		const double Imax = std::abs(P[i]) / c.getVmin();
+		const bool Ilow = Imax < 1.5 * c.getNominalCap(); // is the current below 1.5C?
+		const bool Imed = Imax < 3 * c.getNominalCap();	  // is the current below 3C?
+		if (std::fmod(T[i], 3) == 0 && Tlow && Ilow)
+			dt = 3;
+		else if (std::fmod(T[i], 2) == 0 && Imed)
+			dt = 2;
+		else
 			dt = std::min(1.0, T[i]);
-		// note: if the data collection time interval is smaller than dt, this will be corrected in the underlying functions (in CC_t_V)
-
-		// print a warning if the current is large since this might cause numerical problems
-		if (!Imed)
-			std::cout << "Warning in BasicCycler::followI. The current in step " << i << " is " << I[i]
-					  << ", which is above 3C. Very large currents might lead to errors in the model.\n";
-		// large currents are a problem because then charge throughput in one time step is too high, and the concentration difference between 2 time steps is too large
-		// such that it is possible that in time step t, all is fine (e.g. v = 3.9), and in time step t+1, the li-concentration is larger than the maximum concentration (and the cell voltage would be 8V)
-
-		// store initial states such they can be restored if needed
-		c.getStates(s, &Iprev);
 
 		// Follow this step of the profile
 		try
 		{
-			if (limit == 0) // follow the profile as long as we can, skip the rest of the step if we hit a voltage limit
-				vlim = CC_t_V(I[i], dt, blockDegradation, T[i], Vupp, Vlow, &ah, &wh, &tt);
-			else if (limit == 1) // keep the voltage constant for the rest of the step if we hit a voltage limit
-				vlim = CC_t_CV_t(I[i], dt, blockDegradation, T[i], Vupp, Vlow, &ah, &wh, &tt);
+			vlim = CP_t_V_E(P[i], dt, blockDegradation, T[i], Vupp, Vlow, std::numeric_limits<double>::max(), &ah, &wh, &tt);
+
+			// keep the voltage constant for the rest of this step if we hit a voltage limit
+			if (limit == 1 && (vlim == 2 || vlim == 3) && T[i] - tt >= dt)
+			{
+				double ahcv, whcv, ttcv;
+				CV_t((vlim == 2) ? Vupp : Vlow, dt, blockDegradation, T[i] - tt, &ahcv, &whcv, &ttcv);
+				ah += ahcv;
+				wh += whcv;
+				tt += ttcv;
+			}
 		}
 		catch (int e)
 		{
-			std::cout << "Error in a subfunction of BasicCycler::followI when following step " << i << " of the profile, which has current " << I[i]
-					  << " A for a duration of " << T[i] << " seconds. Error" << e << ". Throwing it on.\n";
+			std::cout << "Error in a subfunction of BasicCycler::followP when following step " << i << " of the profile, which has power " << P[i]
+					  << " W for a duration of " << T[i] << " seconds. Error" << e << ". Throwing it on.\n";
+			logProfile(false);
 			throw e;
 		}
 
 		// check if a voltage limit was hit
 		if (vlim == 2 || vlim == -2)
-		{ // the upper voltage limit (or the maximum cell voltage) was reached
 			vmaxlim = true;
-			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-				std::cout << "BasicCycler::followI has hit the upper voltage limit during step " << i << ".\n";
-		}
 		else if (vlim == 3 || vlim == -3)
-		{ // the lower voltage limit (or the minimum cell voltage) was reached
 			vminlim = true;
-			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-				std::cout << "BasicCycler::followI has hit the lower voltage limit during step " << i << ".\n";
-		}
-		else if (vlim == 1)
-		{
-		} // no voltage limit was reached
-		else
-		{
-			verr = true; // an error occurred and we don't know which voltage limit was reached
-			if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-				std::cout << "BasicCycler::followI has encountered an error so we don't know if a voltage limit was reached during step " << i << ".\n";
-		}
+		else if (vlim != 1)
+			verr = true;
 
 		// update the cumulative throughput
 		ahtot += std::abs(ah);
@@ -2340,12 +3296,18 @@ int BasicCycler::followI(int nI, const std::vector<double> &I, const std::vector
 
 	// *********************************************************** 3 output parameters ***********************************************************************
 
-	// return the throughput
+	// store the last data point of the profile if we are storing data per phase
+	if (logProfile(false))
+	{
+		double v, ocvp, ocvn, etap, etan, rdrop, tem;
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		storeResults(c.getI(), v, ocvp, ocvn, tem);
+	}
+
 	*ahi = ahtot;
 	*whi = whtot;
 	*timei = tttot;
 
-	// set the value of the return-integer to indicate which voltage limit was hit
 	int endvalue;
 	if (verr) // an unknown voltage limit was hit while following the profile
 		endvalue = 100;
@@ -2357,82 +3319,445 @@ int BasicCycler::followI(int nI, const std::vector<double> &I, const std::vector
 		endvalue = 1;
 	else // no voltage limit was hit
 		endvalue = 0;
+
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
-		std::cout << "BasicCycler::followI with given profile and voltage limits " << Vupp
+		std::cout << "BasicCycler::followP with given profile and voltage limits " << Vupp
 				  << " to " << Vlow << ", is terminating with " << endvalue << ".\n";
 
 	return endvalue;
 }
 
-int BasicCycler::followI(int nI, const std::string &nameI, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei)
+int BasicCycler::followP(int nP, const std::string &nameP, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei)
 {
 	/*
-	 * function to follow a certain current pattern.
-	 * The cell tries to follow the current every time step.
+	 * function to follow a certain power pattern from a CSV file.
 	 *
 	 * IN
-	 * nI 		length of the current profile (i.e. number of rows in the csv file)
-	 * 				if n is too small, only the first n steps of the profile are simulated
-	 * 				if 0 or large than number of rows, then all rows are simulated. 
-	 * nameI 	name of the CSV-file with the current profile
-	 * 				the first column contains the current in [A], positive for discharge, negative for charge
-	 * 				the second column contains the time in [sec] the current should be maintained
-	 * blockDegradation if true, degradation is not accounted for during this current profile
-	 * 				set this to 'true' if you want to ignore degradation for now (e.g. if you're characterising a cell)
-	 * limit 	integer describing what to do if the current can't be maintained because a voltage limit is reached
-	 * 				0 	immediately go to the next current step of the profile (i.e. reduce the time of this step)
-	 * 				1 	keep the voltage constant for the rest of this step of the profile (i.e. reduce the current for the rest of this step)
-	 * Vupp		upper voltage limit, Cell.Vmin <= Vupp <= Cell.Vmax, [V]
-	 * Vlow		lower voltage limit, Cell.Vmin <= Vlow <= Cell.Vmax, [V]
+	 * nP 		length of the power profile (i.e. number of rows in the csv file)
+	 * nameP 	name of the CSV-file with the power profile
+	 * 				the first column contains the power in [W], positive for discharge, negative for charge
+	 * 				the second column contains the time in [sec] the power should be maintained
+	 * other inputs and outputs, see the other followP
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::followP with profile = " << nameP << ", and voltage limits " << Vupp << " to " << Vlow << ", is starting\n";
+
+	// Read the power profile
+	static thread_local std::vector<double> P(nP), T(nP);
+	try
+	{
+		loadCSV_2col(PathVar::data + nameP, P, T, nP); // read the file
+	}
+	catch (int e)
+	{
+		std::cout << "error in BasicCycler::followP when reading the file with the power profile called "
+				  << nameP << ", error " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	return followP(nP, P, T, blockDegradation, limit, Vupp, Vlow, ahi, whi, timei);
+}
+
+int BasicCycler::protocolStep(const slide::protocol::Instr &in, bool blockDegradation, double x[], double *ahi, double *whi, double *timei,
+							  const slide::protocol::Condition *mark, double *tmark, double *Tmax)
+{
+	/*
+	 * function to do one CC, CV, CP, CCpl, rest or restFast step of a protocol (see protocol.hpp).
+	 * The step ends when its maximum time has passed or when one of its limits is met.
+	 * Voltage limits are not exceeded: the time step in which the voltage crosses a limit is undone, as in CC_V.
+	 * The other limits are checked after every time step, and the step ends after the time step in which one of them is met.
+	 * The state of charge, SOH, available energy and plating potential are only calculated if one of the limits (or the mark) needs them.
+	 * A restFast step starts with the time step in.dt, which grows by 20% per step up to in.value (see Cell::ETI_rest).
+	 *
+	 * IN
+	 * in 			instruction of the step, in.op must be CC, CV, CP, CCpl, rest or restFast
+	 * blockDegradation if true, degradation is not accounted for during this step
+	 * mark 		optional condition whose time is recorded (e.g. the time to reach 80% SOC), nullptr if not needed
 	 *
 	 * OUT
-	 * ahi		charge throughput while following the profile [Ah]
-	 * whi		energy throughput while following the profile [Wh]
-	 * timei	time spent while following the profile [sec]
-	 * int 		integer indicating if a voltage limit was hit while following the current profile
-	 * 				-1 if the lower voltage limit was hit while following the original profile
-	 * 				0 if the profile could be followed, i.e. no voltage limit was hit while following this profile
-	 * 				1 if the upper voltage limit was hit while following the original profile
-	 * 				10 if both the lower and upper voltage limits were hit while following the original profile
-	 * 				100 if we don't know which voltage limit was hit while following the original profile
+	 * x 			value of the quantities of slide::protocol::Var at the end of the step (except the cycle number), Ah and t are for this step
+	 * ahi 			the total discharged capacity [Ah]
+	 * whi 			the total discharged energy [Wh]
+	 * timei		the total time the cell has been loaded [sec]
+	 * tmark 		time in the step at which mark was first met [sec], only set if it is negative when the function is called
+	 * Tmax 		maximum cell temperature [K], raised to the temperature after every time step which is above it
+	 * int 			which end condition was reached
+	 * 					-3 	the minimum cell voltage was exceeded
+	 * 					-2 	the maximum cell voltage was exceeded
+	 * 					0 	an error occurred
+	 * 					1 	the full time was completed
+	 * 					2 	no charging current keeps the anode potential above the plating margin of a CCpl step
+	 * 					10 + k 	limit k was met, a constant power which can't be sustained meets the first voltage limit in the direction of the load
 	 *
-	 * throws
-	 * 1011 	limit has an illegal value (it is not 0, 1 or 2)
-	 * 1012 	if the cell is in an illegal state (i.e. even a current of 0A still violates the voltage constraints of the cell)
+	 * THROWS
+	 * 1004 		illegal operation
 	 */
 
-	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
-		std::cout << "BasicCycler::followI with profile = " << nameI << ", and voltage limits " << Vupp << " to " << Vlow << ", is starting\n";
+	using slide::protocol::Op;
+	using slide::protocol::Var;
 
-	if (limit < 0 || limit > 1)
+	if (in.op != Op::CC && in.op != Op::CV && in.op != Op::CP && in.op != Op::CCpl && in.op != Op::rest && in.op != Op::restFast)
 	{
-		std::cerr << "ERROR in BasicCycler::followI, illegal value for the limit setting: " << limit
-				  << ", only the values 0 and 1 are allowed. Throwing an error.\n";
-		throw 1011;
+		std::cerr << "Error in BasicCycler::protocolStep. Only CC, CV, CP, CCpl, rest and restFast steps can be done, not operation " << static_cast<int>(in.op) << ".\n";
+		throw 1004;
 	}
 
-	// *********************************************************** 1 read the current profile & variables ***********************************************************************
-	if constexpr (settings::verbose >= printLevel::printCyclerDetail)
-		std::cout << "BasicCycler::followI is reading the current profile\n";
+	// *********************************************************** 1 variables & settings ***********************************************************************
+
+	// ensure the time steps is smaller than the data collection time resolution (if we are collecting data at a fixed time resolution)
+	double dt = in.dt;
+	double dtmax = (in.op == Op::restFast) ? in.value : dt; // largest time step [s]
+	if (CyclingDataTimeInterval > 0 && !logPolicy.on)
+	{
+		dt = std::min(dt, static_cast<double>(CyclingDataTimeInterval));
+		dtmax = std::min(dtmax, static_cast<double>(CyclingDataTimeInterval));
+	}
+
+	auto needs = [&](Var var) { return (mark && mark->var == var) || std::any_of(in.lim.begin(), in.lim.begin() + in.nlim, [&](const auto &l) { return l.var == var; }); };
+	const bool needSOC = needs(Var::SOC) || needs(Var::SOH) || needs(Var::E);
+	const bool needVpl = needs(Var::Vpl);
+
+	slide::State s2; // state to restore if a limit is exceeded
+	double Iprev;	 // current in the previous time step [A]
+	double I = 0;	 // current in this time step [A]
+	double v, ocvp, ocvn, etap, etan, rdrop, tem;
+	double ah = 0;		   // discharged charge [Ah]
+	double wh = 0;		   // discharged energy [Wh]
+	double tt = 0;		   // time on load
+	int t = 0;			   // number of time steps taken
+	int endcriterion = 99; // integer indicating why the function terminated
+
+	// SOC, SOH and available energy, which are only calculated if they are needed
+	auto indicators = [&](bool need) {
+		double cap;
+		if (need)
+			c.getIndicators(&x[static_cast<int>(Var::SOC)], &cap, &x[static_cast<int>(Var::SOH)], &x[static_cast<int>(Var::E)]);
+		else
+			x[static_cast<int>(Var::SOC)] = x[static_cast<int>(Var::SOH)] = x[static_cast<int>(Var::E)] = 0;
+	};
+
+	// quantities which are compared with the limits
+	auto fill = [&]() {
+		x[static_cast<int>(Var::V)] = v;
+		x[static_cast<int>(Var::I)] = std::abs(I);
+		x[static_cast<int>(Var::T)] = tem;
+		x[static_cast<int>(Var::Ah)] = std::abs(ah);
+		x[static_cast<int>(Var::t)] = tt;
+		x[static_cast<int>(Var::Vpl)] = needVpl ? c.getPlatingPotentialAt(settings::verbose >= printLevel::printCrit, I) : 0;
+		indicators(needSOC);
+	};
 
-	// Read the current profile
-	static thread_local std::vector<double> I(nI), T(nI);
 	try
 	{
-		loadCSV_2col(PathVar::data + nameI, I, T, nI); // read the file
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
 	}
 	catch (int e)
 	{
-		std::cout << "error in BasicCycler::followI when reading the file with the current profile called "
-				  << nameI << ", error " << e << ". Throwing it on.\n";
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "error in BasicCycler::protocolStep when getting the initial cell voltage. This means the cell is in an illegal state when this function is called: "
+					  << e << ". Throwing on the error.\n";
 		throw e;
 	}
+	const bool zero = in.op == Op::rest || in.op == Op::restFast || (in.op == Op::CC && in.value == 0); // the step has no current
+	if (logBegin(in.op == Op::CV ? LogPhase::CV : (zero ? LogPhase::rest : LogPhase::CC)))
+	{
+		timeRes += 0.000001;						// add a small amount to the rest time to ensure the new data point is different from the point before
+		storeResults(c.getI(), v, ocvp, ocvn, tem); // store the initial data point
+	}
 
-	auto endvalue = followI(nI, I, T, blockDegradation, limit, Vupp, Vlow, ahi, whi, timei);
+	// *********************************************************** 2 loop until the time or a limit is reached ******************************************************************
+
+	while (tt < in.time && endcriterion == 99)
+	{
+		const double dti = std::min(dt, in.time - tt); // the last time step ends at the maximum time
+		c.getStates(s2, &Iprev);
+
+		// the current for this time step
+		if (in.op == Op::CC)
+			I = in.value;
+		else if (in.op == Op::rest || in.op == Op::restFast)
+			I = 0;
+		else if (in.op == Op::CCpl)
+		{
+			if (!findPlatingCurrent(in.value, in.margin, Iprev, &I))
+			{
+				endcriterion = 2;
+				break;
+			}
+		}
+		else if (in.op == Op::CP)
+		{
+			const double Iguess = (Iprev * in.value > 0) ? Iprev : in.value / v;
+			if (!findLoadCurrent(true, in.value, Iguess, &I))
+			{
+				// the power can't be sustained, which meets the first voltage limit in the direction of the load
+				const auto k = std::find_if(in.lim.begin(), in.lim.begin() + in.nlim, [&](const auto &l) {
+					return l.var == Var::V && ((in.value < 0) == (l.cmp == slide::protocol::Cmp::above));
+				});
+				endcriterion = (k != in.lim.begin() + in.nlim) ? 10 + static_cast<int>(k - in.lim.begin()) : ((in.value < 0) ? -2 : -3);
+				break;
+			}
+		}
+		else
+		{
+			double Vl = std::nan(""); // stays NaN if the search fails before it gets a voltage
+			try
+			{
+				findCVcurrent(in.value, dti, blockDegradation, &I, &Vl);
+			}
+			catch (int e)
+			{
+				// accept the current if the voltage stays in the valid range and the error is below 10 mV, as in CV_t_I
+				if (std::isnan(Vl) || Vl < c.getVmin() || Vl > c.getVmax() || std::abs(Vl - in.value) >= 0.01)
+				{
+					if constexpr (settings::verbose >= printLevel::printCrit)
+						std::cerr << "Error in BasicCycler::protocolStep when finding the CV current, best guess = " << I
+								  << ", which would give voltage " << Vl << " instead of " << in.value << ", error " << e << ".\n";
+					endcriterion = 0;
+					break;
+				}
+			}
+		}
+
+		// take the time step
+		bool er = false;
+		try
+		{
+			c.setI(settings::verbose >= printLevel::printCrit, false, I);
+			if (in.op == Op::restFast)
+			{
+				c.ETI_rest(settings::verbose >= printLevel::printCrit, dti, blockDegradation);
+				dt = std::min(1.2 * dt, dtmax);
+			}
+			else
+				c.ETI(settings::verbose >= printLevel::printCrit, dti, blockDegradation);
+			c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		}
+		catch (int err)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in BasicCycler::protocolStep while cycling, error " << err << " in time step " << t << " and the last voltage was " << v << '\n';
+			er = true;
+		}
+
+		// Undo the time step if the cell or a voltage limit is exceeded such that we stay within the limits at all times
+		if (er)
+			endcriterion = 0;
+		for (int k = 0; k < in.nlim && endcriterion == 99; k++)
+			if (in.lim[k].var == Var::V && in.lim[k].met(v))
+				endcriterion = 10 + k;
+		if (endcriterion == 99 && v > c.getVmax())
+			endcriterion = -2;
+		else if (endcriterion == 99 && v < c.getVmin())
+			endcriterion = -3;
+		if (endcriterion != 99)
+		{
+			c.setStates(s2, Iprev);
+			c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+			break;
+		}
+
+		// this is a valid iteration, so update the time and throughput
+		const double d_ah = I * dti / 3600.0;
+		const double d_wh = d_ah * v;
+		tt += dti;
+		ah += d_ah;
+		wh += d_wh;
+
+		if (I > 0)
+		{ // discharging
+			timeDis += dti;
+			AhDis += std::abs(d_ah);
+			WhDis += std::abs(d_wh);
+		}
+		else if (I < 0)
+		{ // charging
+			timeCha += dti;
+			AhCha += std::abs(d_ah);
+			WhCha += std::abs(d_wh);
+		}
+		else // resting
+			timeRes += dti;
+
+		// store the results at the specified time resolution
+		if (logDue(I, v, dti))
+			storeResults(I, v, ocvp, ocvn, tem);
+		t++;
+		if (Tmax)
+			*Tmax = std::max(*Tmax, tem);
+
+		// check the other limits and the mark
+		fill();
+		if (mark && tmark && *tmark < 0 && mark->met(x[static_cast<int>(mark->var)]))
+			*tmark = tt;
+		for (int k = 0; k < in.nlim; k++)
+			if (in.lim[k].var != Var::V && in.lim[k].met(x[static_cast<int>(in.lim[k].var)]))
+			{
+				endcriterion = 10 + k;
+				break;
+			}
+	}
+
+	if (endcriterion == 99)
+		endcriterion = 1; // the full time was completed
+
+	// *********************************************************** 3 output parameters ***********************************************************************
+
+	fill();
+	if (logEnd())
+		storeResults(c.getI(), v, ocvp, ocvn, tem); // store the final data point
+
+	*ahi = ah;
+	*whi = wh;
+	*timei = tt;
 
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
-		std::cout << "BasicCycler::followI with profile = " << nameI << ", and voltage limits " << Vupp
-				  << " to " << Vlow << ", is terminating with " << endvalue << ".\n";
+		std::cout << "BasicCycler::protocolStep is terminating with end criterion " << endcriterion << " after " << tt << " seconds.\n";
 
-	return endvalue;
-}
\ No newline at end of file
+	return endcriterion;
+}
+
+void BasicCycler::runProtocol(slide::protocol::Protocol &p, bool blockDegradation, double Vupp, double Vlow, slide::protocol::Run &r,
+							  const std::function<bool(int)> &checkUp, const slide::protocol::Condition *mark)
+{
+	/*
+	 * Function to execute a protocol (see protocol.hpp).
+	 * The instructions are executed one by one, the loops and jumps move to the instruction they point to.
+	 * The protocol stops at its end, when a step takes the cell outside its voltage range, or when a check-up asks to stop.
+	 *
+	 * IN
+	 * p 			protocol, it is compiled if this was not done yet
+	 * blockDegradation if true, degradation is not accounted for during the protocol
+	 * Vupp 		maximum voltage of the profile steps [V]
+	 * Vlow 		minimum voltage of the profile steps [V]
+	 * checkUp 		function called at the check-up instructions whose interval is a multiple of the iteration number of their loop,
+	 * 				with the total number of iterations done by the innermost loop around the check-up as argument.
+	 * 				It returns false to stop the protocol. If it is empty, the check-up instructions are skipped.
+	 * mark 		optional condition whose time is recorded in r.tmark, it is only checked during the CC, CV, CP, CCpl, rest and restFast steps
+	 *
+	 * OUT
+	 * r 			totals of the run, the values it has when the function is called are increased
+	 * 				at the end, r.nrCycles is at least the largest number of iterations done by a loop
+	 *
+	 * THROWS
+	 * 1020 		the protocol can't be compiled (see Protocol::compile)
+	 * errors of the steps and profiles are thrown on
+	 */
+
+	using slide::protocol::Op;
+	using slide::protocol::Var;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::runProtocol starting.\n";
+
+	p.compile();
+	const auto &instr = p.instructions();
+
+	double ahi;										 // discharged charge in this step [Ah]
+	double whi;										 // discharged energy in this step [Wh]
+	double ti;										 // time spent in this step [sec]
+	std::vector<int> counter(p.nCounter(), 0);		 // number of completed iterations of every loop since its start
+	std::vector<int> total(p.nCounter(), 0);		 // total number of completed iterations of every loop
+	double x[static_cast<int>(Var::cycle) + 1] = {}; // value of the quantities of the conditions at the end of the last step
+	int pc = 0;										 // index of the instruction being executed
+
+	// iteration number of the innermost loop around an instruction
+	auto cycle = [&](const slide::protocol::Instr &in) { return (in.counter < 0) ? 1 : counter[in.counter] + 1; };
+
+	// quantities used in the conditions at the start and after a profile (the steps update them themselves)
+	auto state = [&](double ah, double t) {
+		double v, ocvp, ocvn, etap, etan, rdrop, tem;
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		x[static_cast<int>(Var::V)] = v;
+		x[static_cast<int>(Var::I)] = std::abs(c.getI());
+		x[static_cast<int>(Var::T)] = tem;
+		x[static_cast<int>(Var::Ah)] = std::abs(ah);
+		x[static_cast<int>(Var::t)] = t;
+		x[static_cast<int>(Var::Vpl)] = c.getPlatingPotentialAt(settings::verbose >= printLevel::printCrit, c.getI());
+		double cap;
+		c.getIndicators(&x[static_cast<int>(Var::SOC)], &cap, &x[static_cast<int>(Var::SOH)], &x[static_cast<int>(Var::E)]);
+	};
+	state(0, 0);
+
+	while (instr[pc].op != Op::end)
+	{
+		const auto &in = instr[pc];
+		int next = pc + 1; // index of the next instruction
+		bool stop = false; // stop the protocol after this instruction
+		double tm = -1;	   // time in this step at which the mark was met [s]
+		switch (in.op)
+		{
+		case Op::CC:
+		case Op::CV:
+		case Op::CP:
+		case Op::CCpl:
+		case Op::rest:
+		case Op::restFast:
+			r.end = protocolStep(in, blockDegradation, x, &ahi, &whi, &ti, mark, &tm, &r.Tmax);
+			if (tm >= 0 && r.tmark < 0)
+				r.tmark = r.time + tm;
+			stop = r.end <= 0; // the cell went outside its voltage range or an error occurred
+			break;
+		case Op::profileI:
+			followI(static_cast<int>(p.profileX(in.profile).size()), p.profileX(in.profile), p.profileT(in.profile), blockDegradation, 1, Vupp, Vlow, &ahi, &whi, &ti);
+			state(ahi, ti);
+			break;
+		case Op::profileP:
+			followP(static_cast<int>(p.profileX(in.profile).size()), p.profileX(in.profile), p.profileT(in.profile), blockDegradation, 1, Vupp, Vlow, &ahi, &whi, &ti);
+			state(ahi, ti);
+			break;
+		case Op::Tenv:
+			c.setTenv(in.value);
+			break;
+		case Op::loop:
+			counter[in.counter] = 0;
+			break;
+		case Op::endLoop:
+			counter[in.counter]++;
+			total[in.counter]++;
+			if (counter[in.counter] < in.value)
+				next = in.target;
+			break;
+		case Op::jump:
+			// the steps only calculate the SOC, SOH, available energy and the plating potential if their limits need them
+			if (in.conditional && (in.cond.var == Var::SOC || in.cond.var == Var::SOH || in.cond.var == Var::E))
+			{
+				double cap;
+				c.getIndicators(&x[static_cast<int>(Var::SOC)], &cap, &x[static_cast<int>(Var::SOH)], &x[static_cast<int>(Var::E)]);
+			}
+			else if (in.conditional && in.cond.var == Var::Vpl)
+				x[static_cast<int>(Var::Vpl)] = c.getPlatingPotentialAt(settings::verbose >= printLevel::printCrit, c.getI());
+			if (!in.conditional || in.cond.met(in.cond.var == Var::cycle ? cycle(in) : x[static_cast<int>(in.cond.var)]))
+				next = in.target;
+			break;
+		case Op::checkUp:
+			if (checkUp && cycle(in) % static_cast<int>(in.value) == 0)
+			{
+				r.nrCycles = (in.counter < 0) ? r.nrCycles + 1 : total[in.counter] + 1;
+				stop = !checkUp(r.nrCycles);
+			}
+			break;
+		default:
+			break;
+		}
+
+		// the throughput of the steps and profiles
+		if (in.op == Op::CC || in.op == Op::CV || in.op == Op::CP || in.op == Op::CCpl || in.op == Op::rest || in.op == Op::restFast || in.op == Op::profileI || in.op == Op::profileP)
+		{
+			r.Ah += std::abs(ahi);
+			r.Wh += std::abs(whi);
+			r.time += ti;
+		}
+
+		if (stop)
+			break;
+		pc = next;
+	}
+
+	for (const auto n : total)
+		r.nrCycles = std::max(r.nrCycles, n);
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "BasicCycler::runProtocol terminating after instruction " << pc << ".\n";
+}
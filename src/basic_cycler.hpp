@@ -3,7 +3,7 @@
  *
  * Header for the class implementing a basic cycler.
  * A basic cycler simulates a battery tester (and can be programmed similarly)
- * It offers functions to load a cell with a CC and/or CV.
+ * It offers functions to load a cell with a CC and/or CV, or at constant power (CP) or constant resistance (CR).
  *
  * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
  * of Oxford, VITO nv, and the 'Slide' Developers.
@@ -20,16 +20,29 @@
 #include <vector>
 #include <array>
 #include <filesystem>
+#include <functional>
 #include <string>
 
 #include "cell.hpp"
+#include "protocol.hpp"
 
 namespace fs = std::filesystem;
 
 struct FileStatus
 {
 	bool is_DegradationData_batteryState_created{false};
+	bool is_DegradationData_batteryStateExt_created{false};
 	bool is_DegradationData_OCV_created{false};
+	bool is_DegradationData_plating_created{false};
+	bool is_DegradationData_modes_created{false};
+	bool is_DegradationData_ICA_created{false};
+	bool is_DegradationData_ICA_OCV_created{false};
+	bool is_DegradationData_EIS_created{false};
+	bool is_DegradationData_sideReactions_created{false};
+	bool is_DegradationData_SOCwindow_created{false};
+	bool is_DegradationData_thermal_created{false};
+	bool is_DegradationData_usage_created{false};
+	bool is_DegradationData_GITT_created{false};
 };
 
 struct CyclerData
@@ -46,6 +59,55 @@ struct CyclerData
 	double AhDisout;   // cumulative discharged charge throughput since the start at every step [A]
 	double WhDisout;   // cumulative discharged energy throughput since the start at every step [Wh]
 	double timeResout; // cumulative time spent on rest since the start at every step [s]
+	double dLout;	   // change in cell thickness at every step [m]
+	double Pout;	   // stack pressure at every step [Pa]
+	double SOCout;	   // state of charge of the model at every step [-]
+	double SOHout;	   // capacity relative to the nominal capacity at every step [-]
+	double Eout;	   // available energy at every step [Wh]
+};
+
+// phases of the cycling data collection, see LogPolicy
+enum class LogPhase
+{
+	CC,		// constant current, power or resistance (including CCpl), except at zero current
+	CV,		// constant voltage
+	rest,	// zero current
+	profile // current or power profile (followI, followP), which is one phase for all its steps
+};
+
+// when cycling data is stored during a phase
+struct LogRule
+{
+	double dt{0};	  // time between two data points at the start of the phase [s], 0 for no time trigger
+	double growth{1}; // factor by which the time between two data points grows, > 1 gives logarithmic sampling from the start of the phase
+	double dV{0};	  // a point is stored if the voltage changed more than this since the last stored point [V], 0 for no voltage trigger
+	double dI{0};	  // a point is stored if the current changed more than this since the last stored point [A], 0 for no current trigger
+	double tmax{-1};  // no points are stored after this time in the phase [s], < 0 for no limit
+	bool edges{true}; // the first and last points of the phase are stored
+};
+
+// data collection per phase, which replaces the fixed CyclingDataTimeInterval if it is on
+// points are only stored at the end of time steps, so the policy never changes the time step of the simulation
+// e.g. 1 s data in profiles, 10 s in CC phases, logarithmic sampling in rests and CV phases and nothing after 2 h of float:
+// 		LogPolicy pol{true, {10}, {1, 1.2, 0, 0, 7200}, {1, 1.2}, {1}};
+struct LogPolicy
+{
+	bool on{false};
+	LogRule CC, CV, rest, profile;
+
+	const LogRule &rule(LogPhase ph) const { return (ph == LogPhase::CC) ? CC : ((ph == LogPhase::CV) ? CV : ((ph == LogPhase::rest) ? rest : profile)); }
+};
+
+// state of the data collection in the current phase
+struct LogState
+{
+	LogPhase phase{LogPhase::CC};
+	int profile{0};	   // 0 outside a profile, 1 in a profile before its first step, 2 in a profile
+	int steps{0};	   // number of time steps in the primitive, for the fixed time interval
+	double t{0};	   // time since the start of the phase [s]
+	double tNext{0};   // time in the phase of the next point of the time trigger [s]
+	double gap{0};	   // time between the last two points of the time trigger [s]
+	double V{0}, I{0}; // voltage and current of the last stored point [V], [A]
 };
 
 class BasicCycler
@@ -93,21 +155,43 @@ protected:
 	std::vector<double> AhDisout;	// cumulative discharged charge throughput since the start at every step [A]
 	std::vector<double> WhDisout;	// cumulative discharged energy throughput since the start at every step [Wh]
 	std::vector<double> timeResout; // cumulative time spent on rest since the start at every step [s]
+	std::vector<double> dLout;		// change in cell thickness at every step [m]
+	std::vector<double> Pout;		// stack pressure at every step [Pa]
+	std::vector<double> SOCout;		// state of charge of the model at every step [-]
+	std::vector<double> SOHout;		// capacity relative to the nominal capacity at every step [-]
+	std::vector<double> Eout;		// available energy at every step [Wh]
+
+	LogPolicy logPolicy;	   // data collection per phase, if logPolicy.on it replaces CyclingDataTimeInterval
+	LogState logState;		   // state of the data collection in the current phase
+	bool logSwelling{false};   // store the change in thickness and the stack pressure with every data point
+	bool logIndicators{false}; // store the SOC, SOH and available energy with every data point
 
 	FileStatus fileStatus;
 
 	std::vector<double> OCVni_vec, OCVpi_vec; // Created to use this vectors in getOCV for not creating every time.
 
 	void storeResults(double I, double v, double ocvp, double ocvn, double tem); // store the cycling data of a cell
+	bool logBegin(LogPhase ph);													 // a primitive starts a phase, returns true if its first point is stored
+	bool logDue(double I, double v, double dt);									 // a primitive has taken a time step, returns true if the point is stored
+	bool logEnd();																 // a primitive ends, returns true if its last point is stored
+	bool logProfile(bool start);												 // followI and followP start or end a profile, returns true if its last point is stored
 	int setCurrent(double I, double Vupp, double Vlow);							 // auxiliary function of CC_t_V to set the current
 	void findCVcurrent_recursive(double Imin, double Imax, int sign, double Vset, double dt, bool blockDegradation, double *Il, double *Vl);
 	// auxiliary function to solve the nonlinear equation to keep the voltage constant
+	bool findLoadCurrent(bool power, double X, double Iguess, double *I); // auxiliary function to solve the current which gives a certain power or load resistance
+	int load_t_V_E(bool power, double X, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei);
+	// auxiliary function to load the cell at constant power or constant resistance
+	bool findPlatingCurrent(double Iset, double margin, double Iguess, double *I); // auxiliary function to solve the charging current which keeps the anode potential above the plating reaction
 
 public:
 	BasicCycler(Cell &ci, std::string IDi, int verbose, int CyclingDataTimeIntervali);
 
 	Cell &getCell() { return c; }						   // returns (a reference to) the cell of the basicCycler
 	void setCyclingDataTimeResolution(int timeResolution); // change the time resolution of the data collection
+	void setLogPolicy(const LogPolicy &pol);			   // collect the data per phase instead of at a fixed time resolution
+	const LogPolicy &getLogPolicy() const { return logPolicy; }
+	void setLogSwelling(bool on);						   // add the change in thickness and the stack pressure to the cycling data
+	void setLogIndicators(bool on);						   // add the SOC, SOH and available energy to the cycling data
 
 	void clearData(); // Clear the recorded data.
 	void reset();
@@ -125,6 +209,13 @@ public:
 	int CC_V(double I, double dt, bool blockDegradation, double Vset, double *ahi, double *whi, double *timei);								// CC cycle until a given voltage is reached
 	void CC_halfCell_full(double I, double dt, bool pos, std::vector<double> &OCVi, double *ahi, bool isWritten);							// CC cycle only one electrode
 
+	// cycle battery at constant power or constant resistance
+	int CP_t_V_E(double P, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei); // CP cycle with a time, two voltage and an energy end-condition
+	int CP_t(double P, double dt, bool blockDegradation, double time, double *ahi, double *whi, double *timei);											   // CP cycle for a fixed amount of time
+	int CP_V(double P, double dt, bool blockDegradation, double Vset, double *ahi, double *whi, double *timei);											   // CP cycle until a given voltage is reached
+	int CR_t_V_E(double R, double dt, bool blockDegradation, double time, double Vupp, double Vlow, double Emax, double *ahi, double *whi, double *timei); // CR discharge with a time, two voltage and an energy end-condition
+	int CR_V(double R, double dt, bool blockDegradation, double Vset, double *ahi, double *whi, double *timei);											   // CR discharge until a given voltage is reached
+
 	// cycle battery at constant voltage
 	void findCVcurrent(double Vset, double dt, bool blockDegradation, double *Il, double *Vl);								   // find the current needed to keep the voltage constant at the specified value
 	int CV_t_I(double V, double dt, bool blockDegradation, double time, double Icut, double *ahi, double *whi, double *timei); // CV cycle with both a time and current limit
@@ -138,4 +229,14 @@ public:
 	// current profile
 	int followI(int nI, const std::string &nameI, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei);									  // follow a predefined current pattern (reads CSV)
 	int followI(int nI, const std::vector<double> &I, const std::vector<double> &T, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei); // follow a predefined current pattern (does not read CSV)
+
+	// power profile
+	int followP(int nP, const std::string &nameP, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei);									  // follow a predefined power pattern (reads CSV)
+	int followP(int nP, const std::vector<double> &P, const std::vector<double> &T, bool blockDegradation, int limit, double Vupp, double Vlow, double *ahi, double *whi, double *timei); // follow a predefined power pattern (does not read CSV)
+
+	// programmable protocols
+	int protocolStep(const slide::protocol::Instr &in, bool blockDegradation, double x[], double *ahi, double *whi, double *timei, // do one step of a protocol until its time or one of its limits is reached
+					 const slide::protocol::Condition *mark = nullptr, double *tmark = nullptr, double *Tmax = nullptr);
+	void runProtocol(slide::protocol::Protocol &p, bool blockDegradation, double Vupp, double Vlow, slide::protocol::Run &r, // execute a protocol
+					 const std::function<bool(int)> &checkUp = nullptr, const slide::protocol::Condition *mark = nullptr);
 };
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "util.hpp"
 #include "constants.hpp"
 #include "param/cell_param.hpp"
+#include "estimator.hpp"
 
 void Cell::getStates(slide::State &si, double *I)
 {
@@ -78,8 +79,15 @@ void Cell::getCSurf(double *cps, double *cns)
 	const double Dnt = s.get_Dn() * std::exp(Dn_T / Rg * (1 / T_ref - 1 / s.get_T())); // diffusion constant of the negative particle [m s-1]
 
 	// Calculate the molar flux on the surfaces
-	const double jp = -Icell / (s.get_ap() * elec_surf * s.get_thickp()) / (n * F); // molar flux on the positive particle [mol m-2 s-1]
-	const double jn = Icell / (s.get_an() * elec_surf * s.get_thickn()) / (n * F);	// molar flux on the negative particle [mol m-2 s-1]
+	double jp = -Icell / (s.get_ap() * elec_surf * s.get_thickp()) / (n * F); // molar flux on the positive particle [mol m-2 s-1]
+	double jn = Icell / (s.get_an() * elec_surf * s.get_thickn()) / (n * F);  // molar flux on the negative particle [mol m-2 s-1]
+	if (psd.n > 1)															  // with a particle-size distribution, the reference particle only carries its share of the flux
+	{
+		double jpk[settings::npsd], jnk[settings::npsd];
+		splitFlux(jp, jn, jpk, jnk);
+		jp = jpk[0];
+		jn = jnk[0];
+	}
 
 	// Calculate the surface concentration at the positive particle
 	// 	cp_surf = M.Cp[0][:] * zp[:] + M.Dp*jp/Dpt
@@ -137,8 +145,15 @@ void Cell::getC(double cp[], double cn[])
 	const double Dnt = s.get_Dn() * std::exp(Dn_T / Rg * (1 / T_ref - 1 / s.get_T())); // diffusion constant of the negative particle [m s-1]
 
 	// Calculate the molar flux on the surfaces
-	const double jp = -Icell / (s.get_ap() * elec_surf * s.get_thickp()) / (n * F); // molar flux on the positive particle [mol m-2 s-1]
-	const double jn = Icell / (s.get_an() * elec_surf * s.get_thickn()) / (n * F);	// molar flux on the negative particle [mol m-2 s-1]
+	double jp = -Icell / (s.get_ap() * elec_surf * s.get_thickp()) / (n * F); // molar flux on the positive particle [mol m-2 s-1]
+	double jn = Icell / (s.get_an() * elec_surf * s.get_thickn()) / (n * F);  // molar flux on the negative particle [mol m-2 s-1]
+	if (psd.n > 1)															  // with a particle-size distribution, these are the concentrations in the reference particle
+	{
+		double jpk[settings::npsd], jnk[settings::npsd];
+		splitFlux(jp, jn, jpk, jnk);
+		jp = jpk[0];
+		jn = jnk[0];
+	}
 
 	// Calculate concentration at the surface and inner nodes using the matrices from the spatial discretisation of the solid diffusion PDE
 	// 	cp = M.Cp[:][:] * zp[:] + M.Dp*jp/Dpt
@@ -236,8 +251,8 @@ bool Cell::getVoltage(bool print, double *V, double *OCVp, double *OCVn, double
 		try
 		{
 			dOCV = OCV_curves.linInt_dOCV_tot(zp_surf, print, bound); // Question: Why do we use zp_surf?
-			OCV_n = OCV_curves.linInt_OCV_neg(zn_surf, print, bound);
-			OCV_p = OCV_curves.linInt_OCV_pos(zp_surf, print, bound);
+			OCV_n = OCV_curves.linInt_OCV_neg_h(zn_surf, s.get_hn(), print, bound);
+			OCV_p = OCV_curves.linInt_OCV_pos_h(zp_surf, s.get_hp(), print, bound);
 		}
 		catch (int e)
 		{
@@ -256,8 +271,15 @@ bool Cell::getVoltage(bool print, double *V, double *OCVp, double *OCVn, double
 		const double i_app = Icell / elec_surf;											   // current density on the electrodes [I m-2]
 		const double i0p = kpt * n * F * sqrt(C_elec * cps * (Cmaxpos - cps));			   // exchange current density of the positive electrode
 		const double i0n = knt * n * F * sqrt(C_elec * cns * (Cmaxneg - cns));			   // exchange current density of the negative electrode
-		const double xp = -0.5 * i_app / (s.get_ap() * s.get_thickp()) / i0p;			   // x for the cathode
-		const double xn = 0.5 * i_app / (s.get_an() * s.get_thickn()) / i0n;			   // x for the anode
+		double xp = -0.5 * i_app / (s.get_ap() * s.get_thickp()) / i0p;				   // x for the cathode
+		double xn = 0.5 * i_app / (s.get_an() * s.get_thickn()) / i0n;				   // x for the anode
+		if (psd.n > 1)																   // with a particle-size distribution, use the flux on the reference particle
+		{																			   // all classes have the same electrode potential
+			double jpk[settings::npsd], jnk[settings::npsd];
+			splitFlux(-i_app / (s.get_ap() * s.get_thickp() * n * F), i_app / (s.get_an() * s.get_thickn() * n * F), jpk, jnk);
+			xp = 0.5 * n * F * jpk[0] / i0p;
+			xn = 0.5 * n * F * jnk[0] / i0n;
+		}
 		const double etapi = (2 * Rg * s.get_T()) / (n * F) * log(xp + sqrt(1 + xp * xp)); // cathode overpotential [V], < 0 on discharge
 		const double etani = (2 * Rg * s.get_T()) / (n * F) * log(xn + sqrt(1 + xn * xn)); // anode overpotential [V],  > 0 on discharge
 
@@ -283,6 +305,82 @@ bool Cell::getVoltage(bool print, double *V, double *OCVp, double *OCVn, double
 	}
 }
 
+double Cell::getVoltageAt(bool print, double I)
+{
+	/*
+	 * Function to calculate the voltage the cell would have if the current were changed instantaneously to the given value.
+	 * The states (and the cell current) are not changed, so this can be used to solve for the current which gives a certain power or load resistance.
+	 * The surface concentrations include the instantaneous effect of the current (see getCSurf), the diffusion inside the particles is not accounted for.
+	 *
+	 * IN
+	 * print 	boolean indicating if we want to print error messages or not
+	 * I 		current at which the voltage should be calculated [A], > 0 for discharge, < 0 for charge
+	 *
+	 * OUT
+	 * double 	cell voltage at the given current [V]
+	 *
+	 * THROWS
+	 * 101		invalid surface concentration at the given current
+	 */
+
+	double V, ocvp, ocvn, etap, etan, rdrop, tem;
+	const double Iold = Icell;
+	Icell = I;
+	try
+	{
+		getVoltage(print, &V, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+	}
+	catch (int e)
+	{
+		Icell = Iold;
+		throw e;
+	}
+	Icell = Iold;
+
+	return V;
+}
+
+double Cell::getPlatingPotentialAt(bool print, double I)
+{
+	/*
+	 * Function to calculate the potential of the anode relative to the plating reaction if the current were changed instantaneously to the given value.
+	 * This is the overpotential of the plating reaction in LiPlating: the anode potential at the cell's temperature plus the anode overpotential
+	 * and the voltage drop over the SEI layer, minus the OCV of the plating reaction.
+	 * Lithium is plated when it becomes negative, so charging protocols can limit the current to keep it above a margin.
+	 * The states (and the cell current) are not changed, and the reference particle is used if there is a particle-size distribution.
+	 *
+	 * IN
+	 * print 	boolean indicating if we want to print error messages or not
+	 * I 		current at which the potential should be calculated [A], > 0 for discharge, < 0 for charge
+	 *
+	 * OUT
+	 * double 	potential of the anode relative to the plating reaction [V]
+	 *
+	 * THROWS
+	 * 101		invalid surface concentration at the given current
+	 */
+
+	double V, ocvp, ocvn, etap, etan, rdrop, tem, cps, cns;
+	const double Iold = Icell;
+	Icell = I;
+	try
+	{
+		getVoltage(print, &V, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		getCSurf(&cps, &cns);
+	}
+	catch (int e)
+	{
+		Icell = Iold;
+		throw e;
+	}
+
+	const double OCVnt = ocvn + (s.get_T() - T_ref) * OCV_curves.linInt_dOCV_neg(cns / Cmaxneg, print, true); // anode potential at the cell's temperature [V]
+	const double etapl = OCVnt + etan - OCVpl + Rsei * s.get_delta() * Icell;
+	Icell = Iold;
+
+	return etapl;
+}
+
 void Cell::getDaiStress(double *sigma_p, double *sigma_n, sigma_type &sigma_r_p, sigma_type &sigma_r_n,
 						sigma_type &sigma_t_p, sigma_type &sigma_t_n, sigma_type &sigma_h_p, sigma_type &sigma_h_n) noexcept
 {
@@ -406,10 +504,12 @@ void Cell::getDaiStress(double *sigma_p, double *sigma_n, sigma_type &sigma_r_p,
 			stp[i] = sparam.omegap * sparam.Ep / (3 * (1 - sparam.nup)) * (2 / pow(Rp, 3.0) * ap + 1 / pow(rp, 3.0) * bp - cp[i]);
 			stn[i] = sparam.omegan * sparam.En / (3 * (1 - sparam.nun)) * (2 / pow(Rn, 3.0) * an + 1 / pow(rn, 3.0) * bn - cn[i]);
 		}
+	}
 
-		// Flip all arrays to get the opposite order (now it is [centre .. +surface] and we want [+surface .. centre]
-		// and store in the output arrays
-		// loop for the positive nodes
+	// Flip all arrays to get the opposite order (now it is [centre .. +surface] and we want [+surface .. centre]
+	// and store in the output arrays, only once all nodes are calculated
+	for (int i = 0; i < nch + 2; i++)
+	{ // loop for the positive nodes
 		sigma_r_p[i] = srp[nch + 2 - 1 - i];
 		sigma_r_n[i] = srn[nch + 2 - 1 - i];
 		sigma_t_p[i] = stp[nch + 2 - 1 - i];
@@ -751,27 +851,902 @@ void Cell::setC(double cp0, double cn0)
 	double znu = 0; // (twice) transformed negative uniform concentration
 	double zpu = 0; // (twice) transformed positive uniform concentration
 
-	for (int i = 0; i < settings::nch; i++)
-	{ // loop to calculate the row of V * u corresponding to the uniform concentration
-		znu += M.Vn[ind][i] * uneg[i];
-		zpu += M.Vp[ind][i] * upos[i];
+	for (int i = 0; i < settings::nch; i++)
+	{ // loop to calculate the row of V * u corresponding to the uniform concentration
+		znu += M.Vn[ind][i] * uneg[i];
+		zpu += M.Vp[ind][i] * upos[i];
+	}
+
+	// Make the full arrays for the (twice) transformed concentration
+	slide::z_type zp{}, zn{}; // set all values to 0
+	zp[ind] = zpu;			  // set the non-zero value
+	zn[ind] = znu;
+	s.setZ(zp, zn);
+
+	// the other particle classes have the same uniform li-fraction, and u scales with the radius and maximum concentration
+	for (int k = 1; k < psd.n; k++)
+	{
+		for (int i = 0; i < settings::nch; i++)
+		{
+			s.get_zp_psd(k, i) = psd.fp[k] * psd.cmp[k] * zp[i];
+			s.get_zn_psd(k, i) = psd.fn[k] * psd.cmn[k] * zn[i];
+		}
+	}
+
+	// Set the cell current to 0 to reflect the boundary condition for a fully uniform concentration
+	Icell = 0;
+
+	// the stress values stored in the class variables for stress are no longer valid because the state has changed
+	sparam.s_dai_update = false;
+	sparam.s_lares_update = false;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::setC terminating.\n";
+}
+
+void Cell::setPSD(int nclass, const double fp[], const double wp[], const double fn[], const double wn[])
+{
+	/*
+	 * Function to set the particle-size distribution of both electrodes.
+	 * Each electrode is represented by nclass particles with a different radius, which all see the same electrode potential.
+	 * Class 0 is the reference particle with radius Rp or Rn, whose concentration is stored in zp and zn.
+	 * The other classes have their own concentration states, which are set to the same li-fraction as the reference particle.
+	 * The effective surfaces ap and an are rescaled such that a = 3 e/R * sum(w/f).
+	 * All classes are made of the same material as the reference particle, use setMaterial afterwards for blended electrodes.
+	 * The distribution should be set before cycling the cell, directly after constructing it.
+	 * Note that the diffusion in a class with relative radius f is 1/f^2 times faster,
+	 * so the time step of the forward Euler time integration has to be reduced by f^2 for classes smaller than the reference particle.
+	 *
+	 * IN
+	 * nclass 	number of particle-size classes, 1 <= nclass <= settings::npsd
+	 * fp 		radius of each class of the cathode relative to Rp [-], array of length nclass with fp[0] = 1 and fp[k] > 0
+	 * wp 		fraction of the active material volume of the cathode in each class [-], array of length nclass, sums to 1
+	 * fn 		radius of each class of the anode relative to Rn [-], array of length nclass with fn[0] = 1 and fn[k] > 0
+	 * wn 		fraction of the active material volume of the anode in each class [-], array of length nclass, sums to 1
+	 *
+	 * THROWS
+	 * 112 		illegal particle-size distribution
+	 */
+	// #NOTHOTFUNCTION
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::setPSD starting.\n";
+
+	if (nclass < 1 || nclass > settings::npsd)
+	{
+		std::cerr << "ERROR in Cell::setPSD, illegal number of particle-size classes " << nclass
+				  << ". The value has to be between 1 and " << settings::npsd << " (settings::npsd in constants.hpp).\n";
+		throw 112;
+	}
+
+	double sum_p = 0, sum_n = 0;
+	bool illegal = std::abs(fp[0] - 1) > 1e-12 || std::abs(fn[0] - 1) > 1e-12;
+	for (int k = 0; k < nclass; k++)
+	{
+		illegal = illegal || fp[k] <= 0 || fn[k] <= 0 || wp[k] < 0 || wn[k] < 0;
+		sum_p += wp[k];
+		sum_n += wn[k];
+	}
+	if (illegal || std::abs(sum_p - 1) > 1e-6 || std::abs(sum_n - 1) > 1e-6)
+	{
+		std::cerr << "ERROR in Cell::setPSD, illegal particle-size distribution. The relative radii have to be positive with 1 for the first class, "
+					 "and the volume fractions have to be positive and sum to 1 (they sum to "
+				  << sum_p << " and " << sum_n << ").\n";
+		throw 112;
+	}
+
+	// derived values
+	const double sp_old = psd.sp, sn_old = psd.sn;
+	psd.n = nclass;
+	psd.sp = 0;
+	psd.sn = 0;
+	for (int k = 0; k < nclass; k++)
+	{
+		psd.fp[k] = fp[k];
+		psd.fn[k] = fn[k];
+		psd.wp[k] = wp[k];
+		psd.wn[k] = wn[k];
+		psd.cmp[k] = 1;
+		psd.cmn[k] = 1;
+		psd.dp[k] = 1;
+		psd.dn[k] = 1;
+		OCV_curves.has_OCV_posk[k] = false;
+		OCV_curves.has_OCV_negk[k] = false;
+		psd.sp += wp[k] / fp[k];
+		psd.sn += wn[k] / fn[k];
+	}
+	for (int k = 0; k < nclass; k++)
+	{
+		psd.alphap[k] = wp[k] / fp[k] / psd.sp;
+		psd.alphan[k] = wn[k] / fn[k] / psd.sn;
+	}
+
+	// the effective surface scales with the total surface of the classes
+	s.get_ap() *= psd.sp / sp_old;
+	s.get_an() *= psd.sn / sn_old;
+	s_ini.get_ap() *= psd.sp / sp_old;
+	s_ini.get_an() *= psd.sn / sn_old;
+
+	// the other classes start with the same (uniform) concentration as the reference particle, u scales with the radius
+	for (int k = 1; k < psd.n; k++)
+	{
+		for (int i = 0; i < settings::nch; i++)
+		{
+			s.get_zp_psd(k, i) = psd.fp[k] * s.get_zp(i);
+			s.get_zn_psd(k, i) = psd.fn[k] * s.get_zn(i);
+		}
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::setPSD terminating.\n";
+}
+
+void Cell::setMaterial(bool pos, int k, const std::string &nameOCV, double cmax, double D)
+{
+	/*
+	 * Function to set the material of particle class k of a blended electrode (e.g. graphite + SiOx).
+	 * The classes have to be defined first with setPSD, class 0 is the material with the parameters of the cell.
+	 * The class gets the same li-fraction as class 0.
+	 * All classes see the same electrode potential and the current is split between them in every time step (see splitFlux),
+	 * and SEI growth and lithium plating are calculated for each anode class with its own potential (see psdSideReactions).
+	 *
+	 * IN
+	 * pos 		if true, the class is in the cathode, else in the anode
+	 * k 		particle class, 1 <= k < number of classes set by setPSD
+	 * nameOCV 	name of the CSV file with the OCV curve of the material, same format as the other OCV curves
+	 * 			if empty, the OCV curve of class 0 is used
+	 * cmax 	maximum li-concentration of the material relative to the one of class 0 [-], > 0
+	 * D 		diffusion constant of the material relative to the one of class 0 [-], > 0
+	 *
+	 * THROWS
+	 * 2 		the OCV file could not be opened
+	 * 112 		illegal particle class, maximum concentration or diffusion constant
+	 */
+	// #NOTHOTFUNCTION
+	if (k < 1 || k >= psd.n || cmax <= 0 || D <= 0)
+	{
+		std::cerr << "ERROR in Cell::setMaterial, illegal particle class " << k << " (there are " << psd.n << " classes, set with setPSD)"
+				  << ", relative maximum concentration " << cmax << " or relative diffusion constant " << D << ".\n";
+		throw 112;
+	}
+
+	if (!nameOCV.empty())
+	{
+		try
+		{
+			OCV_curves.loadMaterial(pos, k, nameOCV);
+		}
+		catch (int e)
+		{
+			std::cerr << "ERROR in Cell::setMaterial when loading the OCV curve: " << e << ". Throwing it on.\n";
+			throw e;
+		}
+	}
+
+	(pos ? psd.cmp : psd.cmn)[k] = cmax;
+	(pos ? psd.dp : psd.dn)[k] = D;
+
+	// the class has the same (uniform) li-fraction as the reference particle
+	for (int i = 0; i < settings::nch; i++)
+	{
+		if (pos)
+			s.get_zp_psd(k, i) = psd.fp[k] * cmax * s.get_zp(i);
+		else
+			s.get_zn_psd(k, i) = psd.fn[k] * cmax * s.get_zn(i);
+	}
+}
+
+void Cell::getUtilisation(double up[], double un[])
+{
+	/*
+	 * Function to get the mean li-fraction of each particle class, i.e. the utilisation of each material of a blended electrode.
+	 * The mean concentration follows from the transformed concentration of the eigenvector with the 0 eigenvalue,
+	 * which is the only one which changes the amount of lithium in the particle.
+	 *
+	 * OUT
+	 * up 		mean li-fraction of each class of the cathode [-], array of length settings::npsd, unused classes are 0
+	 * un 		mean li-fraction of each class of the anode [-], array of length settings::npsd, unused classes are 0
+	 */
+
+	const int ind = M.Input[3];
+	double vp = 0, vn = 0; // transformed concentration per unit of uniform concentration of the reference particle
+	for (int i = 0; i < settings::nch; i++)
+	{
+		vp += M.Vp[ind][i] * M.xch[i] * Rp;
+		vn += M.Vn[ind][i] * M.xch[i] * Rn;
+	}
+
+	for (int k = 0; k < settings::npsd; k++)
+	{
+		up[k] = 0;
+		un[k] = 0;
+	}
+	up[0] = s.get_zp(ind) / (vp * Cmaxpos);
+	un[0] = s.get_zn(ind) / (vn * Cmaxneg);
+	for (int k = 1; k < psd.n; k++)
+	{
+		up[k] = s.get_zp_psd(k, ind) / (psd.fp[k] * vp * psd.cmp[k] * Cmaxpos);
+		un[k] = s.get_zn_psd(k, ind) / (psd.fn[k] * vn * psd.cmn[k] * Cmaxneg);
+	}
+}
+
+void Cell::getElectrodeBalance(double *Qp, double *Qn, double *nLi, double win[4])
+{
+	/*
+	 * Function to get the balance of the electrodes, which is used to calculate the degradation modes (LLI, LAM_PE and LAM_NE).
+	 * The capacities follow from the amount of active material, the cyclable lithium from the concentrations in the particles.
+	 * The stoichiometry windows are the li-fractions at which the equilibrium cell voltage (at reference temperature, without hysteresis)
+	 * is equal to the voltage limits for the present amount of cyclable lithium.
+	 * With multiple particle classes, the capacity and lithium of all classes are included but the windows use the OCV curves of class 0.
+	 *
+	 * OUT
+	 * Qp 		capacity of the cathode [Ah]
+	 * Qn 		capacity of the anode [Ah]
+	 * nLi 		cyclable lithium in both electrodes [Ah]
+	 * win 		stoichiometry windows [-]
+	 * 				win[0] 	li-fraction of the anode at 0% SOC (Vmin)
+	 * 				win[1] 	li-fraction of the anode at 100% SOC (Vmax)
+	 * 				win[2] 	li-fraction of the cathode at 0% SOC (Vmin)
+	 * 				win[3] 	li-fraction of the cathode at 100% SOC (Vmax)
+	 */
+
+	using namespace PhyConst;
+
+	// capacity of each electrode, including the relative capacity of the particle classes
+	double cp = 0, cn = 0;
+	for (int k = 0; k < psd.n; k++)
+	{
+		cp += psd.wp[k] * psd.cmp[k];
+		cn += psd.wn[k] * psd.cmn[k];
+	}
+	*Qp = s.get_thickp() * s.get_ep() * elec_surf * Cmaxpos * F / 3600 * cp;
+	*Qn = s.get_thickn() * s.get_en() * elec_surf * Cmaxneg * F / 3600 * cn;
+
+	// cyclable lithium
+	double up[settings::npsd], un[settings::npsd];
+	getUtilisation(up, un);
+	*nLi = 0;
+	for (int k = 0; k < psd.n; k++)
+		*nLi += up[k] * psd.wp[k] * psd.cmp[k] / cp * (*Qp) + un[k] * psd.wn[k] * psd.cmn[k] / cn * (*Qn);
+
+	// reuse the windows if the capacities, the cyclable lithium and the voltage limits have not changed, e.g. between two time steps without degradation
+	auto same = [](double a, double b) { return std::abs(a - b) <= 1e-9 * std::abs(b); };
+	if (same(*Qp, balance.Qp) && same(*Qn, balance.Qn) && same(*nLi, balance.nLi) && Vmax == balance.Vmax && Vmin == balance.Vmin)
+	{
+		std::copy(balance.win, balance.win + 4, win);
+		return;
+	}
+
+	// range of cathode li-fractions for which both electrodes stay within their OCV curves
+	const double ylo = std::max(OCV_curves.OCV_pos_x.front(), (*nLi - *Qn * OCV_curves.OCV_neg_x.back()) / (*Qp));
+	const double yhi = std::min(OCV_curves.OCV_pos_x.back(), (*nLi - *Qn * OCV_curves.OCV_neg_x.front()) / (*Qp));
+
+	// find the cathode li-fraction at which the equilibrium voltage is V using bisection, the voltage decreases with the cathode li-fraction
+	auto findWindow = [&](double V) {
+		double a = ylo, b = yhi;
+		for (int i = 0; i < 60; i++)
+		{
+			const double y = 0.5 * (a + b);
+			const double Vy = OCV_curves.linInt_OCV_pos(y) - OCV_curves.linInt_OCV_neg((*nLi - y * (*Qp)) / (*Qn));
+			if (Vy > V)
+				a = y;
+			else
+				b = y;
+		}
+		return 0.5 * (a + b);
+	};
+
+	win[3] = findWindow(Vmax);
+	win[2] = findWindow(Vmin);
+	win[1] = (*nLi - win[3] * (*Qp)) / (*Qn);
+	win[0] = (*nLi - win[2] * (*Qp)) / (*Qn);
+
+	balance.Qp = *Qp;
+	balance.Qn = *Qn;
+	balance.nLi = *nLi;
+	balance.Vmax = Vmax;
+	balance.Vmin = Vmin;
+	std::copy(win, win + 4, balance.win);
+}
+
+double Cell::getSOC()
+{
+	/*
+	 * Function to get the state of charge from the lithium in the anode and the stoichiometry window of the anode (see getIndicators).
+	 * The window is evaluated for the present amount of active material and cyclable lithium, so the SOC is relative to the present capacity.
+	 * The SOC is based on the average li-fraction, so it does not change when the cell relaxes after a current.
+	 *
+	 * OUT
+	 * double 	state of charge [-], 0 at the minimum and 1 at the maximum equilibrium voltage
+	 */
+
+	double SOC, cap, SOH;
+	getIndicators(&SOC, &cap, &SOH, nullptr);
+	return SOC;
+}
+
+void Cell::getIndicators(double *SOC, double *cap, double *SOH, double *Eav)
+{
+	/*
+	 * Function to get the state of the cell from its states without cycling it, e.g. to benchmark the estimators of a battery management system.
+	 * The capacity and SOC follow from the stoichiometry windows (see getElectrodeBalance),
+	 * the available energy is the integral of the equilibrium voltage (see getEquilibriumCurve) from the present state to Vmin.
+	 * They are equilibrium values, so they don't include the resistive losses of a discharge and they don't depend on the current.
+	 * The windows are only recalculated when the electrodes or the cyclable lithium change, so this function is cheap enough to call every time step.
+	 *
+	 * OUT
+	 * SOC 		state of charge [-], 0 at the minimum and 1 at the maximum equilibrium voltage
+	 * cap 		present capacity of the cell between its voltage limits [Ah]
+	 * SOH 		state of health, the present capacity relative to the nominal capacity [-]
+	 * Eav 		available energy, the energy of an equilibrium discharge from the present state to Vmin [Wh], not calculated if nullptr
+	 */
+
+	double Qp, Qn, nLi, win[4];
+	getElectrodeBalance(&Qp, &Qn, &nLi, win);
+
+	double up[settings::npsd], un[settings::npsd];
+	getUtilisation(up, un);
+	double zn = 0, cn = 0;
+	for (int k = 0; k < psd.n; k++)
+	{
+		zn += un[k] * psd.wn[k] * psd.cmn[k];
+		cn += psd.wn[k] * psd.cmn[k];
+	}
+	zn /= cn;
+
+	*SOC = (zn - win[0]) / (win[1] - win[0]);
+	*cap = (win[2] - win[3]) * Qp;
+	*SOH = *cap / nomCapacity;
+	if (Eav == nullptr)
+		return;
+
+	// integrate the equilibrium voltage over the cathode li-fraction with Simpson's rule, the cathode is lithiated during the discharge
+	constexpr int n = 16;												// number of intervals, must be even
+	const double y0 = std::clamp((nLi - zn * Qn) / Qp, win[3], win[2]);	// present cathode li-fraction, within the window
+	const double h = (win[2] - y0) / n;
+	double E = 0;
+	for (int i = 0; i <= n; i++)
+	{
+		const double y = y0 + i * h;
+		const double V = OCV_curves.linInt_OCV_pos(y) - OCV_curves.linInt_OCV_neg((nLi - y * Qp) / Qn);
+		E += ((i == 0 || i == n) ? 1 : ((i % 2) ? 4 : 2)) * V;
+	}
+	*Eav = std::max(E * h / 3 * Qp, 0.0);
+}
+
+void Cell::getEquilibriumCurve(int n, std::vector<double> &Q, std::vector<double> &V)
+{
+	/*
+	 * Function to get the equilibrium discharge curve of the cell from the electrode OCV curves,
+	 * e.g. to calculate the incremental capacity and differential voltage curves of the model.
+	 * The curve spans the stoichiometry windows from getElectrodeBalance, i.e. from Vmax to Vmin,
+	 * and is evaluated at reference temperature without hysteresis using the OCV curves of particle class 0.
+	 *
+	 * IN
+	 * n 		number of points on the curve, at least 2
+	 *
+	 * OUT
+	 * Q 		discharged charge, 0 at Vmax [Ah]
+	 * V 		equilibrium voltage of the cell at the discharged charge [V]
+	 */
+
+	double Qp, Qn, nLi, win[4];
+	getElectrodeBalance(&Qp, &Qn, &nLi, win);
+
+	Q.resize(n);
+	V.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		const double y = win[3] + (win[2] - win[3]) * i / (n - 1); // the cathode is lithiated during the discharge
+		Q[i] = (y - win[3]) * Qp;
+		V[i] = OCV_curves.linInt_OCV_pos(y) - OCV_curves.linInt_OCV_neg((nLi - y * Qp) / Qn);
+	}
+}
+
+void Cell::getImpedance(const std::vector<double> &freq, std::vector<std::complex<double>> &Z)
+{
+	/*
+	 * Function to calculate the impedance of the cell, linearised around the present battery state.
+	 * Each particle class is a series connection of the linearised Butler-Volmer kinetics and the diffusion impedance,
+	 * in parallel with the double-layer capacitance. The classes of an electrode are in parallel (weighted by their share of the surface)
+	 * and both electrodes are in series with the DC resistance (electrolyte, contacts and SEI layer, see getR).
+	 * The diffusion impedance follows from the state-space model of the particles, which is diagonal (A is stored by its eigenvalues),
+	 * so the linear systems (i*w*I - D*A) z = B j can be solved element by element:
+	 * 		c_surf = ( sum_j C_j B_j / (i*w - D A_j) + Dm / D ) * j
+	 * The hysteresis and the temperature are kept constant.
+	 *
+	 * IN
+	 * freq 	frequencies at which the impedance is needed [Hz], > 0
+	 *
+	 * OUT
+	 * Z 		impedance at each frequency [Ohm], the real part is positive and the imaginary part negative for capacitive behaviour
+	 *
+	 * THROWS
+	 * 101 		the surface concentration of one of the particle classes is out of bounds
+	 */
+
+	using namespace PhyConst;
+	using cplx = std::complex<double>;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::getImpedance starting\n";
+
+	// Arrhenius relation for temperature-dependent parameters
+	const double T = s.get_T();
+	const double Dpt = s.get_Dp() * std::exp(Dp_T / Rg * (1 / T_ref - 1 / T));
+	const double Dnt = s.get_Dn() * std::exp(Dn_T / Rg * (1 / T_ref - 1 / T));
+	const double kpt = kp * std::exp(kp_T / Rg * (1 / T_ref - 1 / T));
+	const double knt = kn * std::exp(kn_T / Rg * (1 / T_ref - 1 / T));
+
+	// molar flux on each particle class at the operating point
+	double jpk[settings::npsd], jnk[settings::npsd];
+	const double jp = -Icell / (s.get_ap() * elec_surf * s.get_thickp()) / (n * F);
+	const double jn = Icell / (s.get_an() * elec_surf * s.get_thickn()) / (n * F);
+	if (psd.n > 1)
+		splitFlux(jp, jn, jpk, jnk);
+	else
+	{
+		jpk[0] = jp;
+		jnk[0] = jn;
+	}
+
+	// linearisation of each particle class: dphi = Rct * dj + kappa * dc_surf
+	double Rctp[settings::npsd], Rctn[settings::npsd], kapp[settings::npsd], kapn[settings::npsd];
+	auto linearise = [&](bool pos, int k, double j, double *Rct, double *kappa) {
+		const double f = pos ? psd.fp[k] : psd.fn[k];
+		const double Dk = pos ? psd.dp[k] * Dpt : psd.dn[k] * Dnt;
+		const double Cmax = pos ? Cmaxpos * psd.cmp[k] : Cmaxneg * psd.cmn[k];
+		const double kt = pos ? kpt : knt;
+
+		double c = 0;
+		for (int i = 0; i < settings::nch; i++)
+		{
+			const double z = (k == 0) ? (pos ? s.get_zp(i) : s.get_zn(i)) : (pos ? s.get_zp_psd(k, i) : s.get_zn_psd(k, i));
+			c += (pos ? M.Cp[0][i] : M.Cn[0][i]) * z;
+		}
+		c = c / f + (pos ? M.Dp[0] : M.Dn[0]) * f * j / Dk;
+		if (c <= 0 || c >= Cmax)
+		{
+			if constexpr (settings::verbose >= printLevel::printNonCrit)
+				std::cerr << "ERROR in Cell::getImpedance: concentration out of bounds in particle class " << k << " of the "
+						  << (pos ? "cathode" : "anode") << ", the lithium fraction is " << c / Cmax << ".\n";
+			throw 101;
+		}
+
+		// kinetics, eta = 2RT/(nF) asinh(x) with x = nF j / (2 i0) and i0 ~ sqrt(c (Cmax - c))
+		const double i0 = kt * n * F * sqrt(C_elec * c * (Cmax - c));
+		const double x = 0.5 * n * F * j / i0;
+		const double sq = sqrt(1 + x * x);
+		*Rct = Rg * T / (i0 * sq);
+		const double detadc = -2 * Rg * T / (n * F) / sq * x * (Cmax - 2 * c) / (2 * c * (Cmax - c));
+
+		// slope of the OCV curve with a central difference, the curve is extended with its end values
+		const double dx = 1e-3, xs = c / Cmax, h = pos ? s.get_hp() : s.get_hn();
+		const double dU = pos ? OCV_curves.linInt_OCV_pos_k(k, xs + dx, h, false, false) - OCV_curves.linInt_OCV_pos_k(k, xs - dx, h, false, false)
+							  : OCV_curves.linInt_OCV_neg_k(k, xs + dx, h, false, false) - OCV_curves.linInt_OCV_neg_k(k, xs - dx, h, false, false);
+		*kappa = dU / (2 * dx * Cmax) + detadc;
+	};
+	for (int k = 0; k < psd.n; k++)
+	{
+		linearise(true, k, jpk[k], &Rctp[k], &kapp[k]);
+		linearise(false, k, jnk[k], &Rctn[k], &kapn[k]);
+	}
+
+	// admittance of an electrode at angular frequency w
+	auto admittance = [&](bool pos, double w) {
+		cplx Y = 0;
+		for (int k = 0; k < psd.n; k++)
+		{
+			const double f = pos ? psd.fp[k] : psd.fn[k];
+			const double Dk = pos ? psd.dp[k] * Dpt : psd.dn[k] * Dnt;
+
+			// surface concentration per unit flux, the matrices of a particle with radius f*R are A/f^2, C/f and D*f
+			cplx H = (pos ? M.Dp[0] : M.Dn[0]) * f / Dk;
+			for (int i = 0; i < settings::nch; i++)
+			{
+				const double CB = (pos ? M.Cp[0][i] * M.Bp[i] : M.Cn[0][i] * M.Bn[i]) / f;
+				H += CB / cplx(-Dk * (pos ? M.Ap[i] : M.An[i]) / (f * f), w);
+			}
+
+			// impedance of the Faradaic reaction per unit particle surface [Ohm m2], the current density is nF j
+			const cplx zF = (pos ? Rctp[k] + kapp[k] * H : Rctn[k] + kapn[k] * H) / (n * F);
+			Y += (pos ? psd.alphap[k] : psd.alphan[k]) * (1.0 / zF + cplx(0, w * Cdl));
+		}
+		return Y * (pos ? s.get_ap() * s.get_thickp() : s.get_an() * s.get_thickn()) * elec_surf;
+	};
+
+	Z.resize(freq.size());
+	for (size_t i = 0; i < freq.size(); i++)
+	{
+		const double w = 2 * pi * freq[i]; // angular frequency [rad s-1]
+		Z[i] = getR() + 1.0 / admittance(true, w) + 1.0 / admittance(false, w);
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::getImpedance terminating\n";
+}
+
+void Cell::getPlant(slide::estimation::Plant &p)
+{
+	/*
+	 * Function to get a frozen copy of the model for state estimation (see estimator.hpp).
+	 * The concentrations and the temperature are the states of the plant, all other states (degradation, diffusion constants,
+	 * resistance and hysteresis) are copied as constant parameters. The heat of the thermal management is not part of the plant.
+	 *
+	 * OUT
+	 * p 		plant with the present parameters and states of the cell
+	 *
+	 * THROWS
+	 * 1022 	the cell has a particle-size distribution, the plant only has one particle per electrode
+	 */
+
+	// #NOTHOTFUNCTION
+	using namespace PhyConst;
+	constexpr int nch = settings::nch;
+
+	if (psd.n > 1)
+	{
+		std::cerr << "ERROR in Cell::getPlant, the cell has " << psd.n << " particle classes but the plant only supports a single particle per electrode. Throwing an error.\n";
+		throw 1022;
+	}
+
+	for (int j = 0; j < nch; j++)
+	{
+		p.Ap[j] = M.Ap[j];
+		p.An[j] = M.An[j];
+		p.Bp[j] = M.Bp[j];
+		p.Bn[j] = M.Bn[j];
+		p.Csp[j] = M.Cp[0][j];
+		p.Csn[j] = M.Cn[0][j];
+		p.x0[j] = s.get_zp(j);
+		p.x0[nch + j] = s.get_zn(j);
+	}
+	p.x0[2 * nch] = s.get_T();
+	p.Dsp = M.Dp[0];
+	p.Dsn = M.Dn[0];
+
+	p.Dp = s.get_Dp();
+	p.Dn = s.get_Dn();
+	p.Dp_T = Dp_T;
+	p.Dn_T = Dn_T;
+	p.kp = kp;
+	p.kn = kn;
+	p.kp_T = kp_T;
+	p.kn_T = kn_T;
+	p.fp = -1 / (s.get_ap() * elec_surf * s.get_thickp() * n * F);
+	p.fn = 1 / (s.get_an() * elec_surf * s.get_thickn() * n * F);
+	p.Cmaxpos = Cmaxpos;
+	p.Cmaxneg = Cmaxneg;
+	p.C_elec = C_elec;
+	p.n = n;
+	p.T_ref = T_ref;
+	p.T_env = T_env;
+	p.R = getR();
+	p.hp = s.get_hp();
+	p.hn = s.get_hn();
+	p.L = L;
+	p.elec_surf = elec_surf;
+	p.SAV = SAV;
+	p.rhoCp = rho * Cp;
+	p.Qch = Qch;
+
+	// mean concentration and SOC, see getUtilisation and getSOC
+	p.ind = M.Input[3];
+	p.vp = p.vn = 0;
+	for (int i = 0; i < nch; i++)
+	{
+		p.vp += M.Vp[p.ind][i] * M.xch[i] * Rp;
+		p.vn += M.Vn[p.ind][i] * M.xch[i] * Rn;
+	}
+	double nLi, win[4];
+	getElectrodeBalance(&p.Qp, &p.Qn, &nLi, win);
+	p.Qnom = nomCapacity;
+	p.Vmax = Vmax;
+	p.Vmin = Vmin;
+
+	p.ocv = std::make_shared<OCVcurves>(OCV_curves);
+	p.rebalance(p.x0);
+}
+
+void Cell::getSwelling(double *dL, double *P)
+{
+	/*
+	 * Function to get the swelling of the cell and the stack pressure in the fixture.
+	 * The volume of the active material increases with the lithium it contains (with the partial molar volumes of the stress model),
+	 * and the SEI and plated lithium on the anode particles add their own volume.
+	 * Since the electrodes are constrained in-plane, the volume change is taken up by the electrode thickness:
+	 * 		dthick = thick * e * omega * c_avg 		(intercalation)
+	 * 		dthick = a * thick * delta 				(layers on the particle surface)
+	 * The pressure is linear in the change in thickness, P = P0 + K * dL, and the cell loses contact with the fixture at P = 0.
+	 *
+	 * OUT
+	 * dL 		change in thickness of the cell relative to the reference thickness set by setFixture [m]
+	 * P 		stack pressure [Pa]
+	 */
+
+	double up[settings::npsd], un[settings::npsd];
+	getUtilisation(up, un);
+	double cp = 0, cn = 0; // mean concentration in the active material of the electrodes [mol m-3]
+	for (int k = 0; k < psd.n; k++)
+	{
+		cp += psd.wp[k] * up[k] * psd.cmp[k] * Cmaxpos;
+		cn += psd.wn[k] * un[k] * psd.cmn[k] * Cmaxneg;
+	}
+
+	const double dp = s.get_thickp() * s.get_ep() * sparam.omegap * cp;
+	const double dn = s.get_thickn() * s.get_en() * sparam.omegan * cn;
+	const double dside = s.get_an() * s.get_thickn() * (swparam.fsei * s.get_delta() + swparam.fpl * s.get_delta_pl());
+
+	*dL = swparam.nlayer * (dp + dn + dside) - swparam.dref;
+	*P = std::max(0.0, swparam.P0 + swparam.K * (*dL));
+}
+
+void Cell::setHysteresis(bool pos, const std::string &namech, const std::string &namedis, double gamma, double h0)
+{
+	/*
+	 * Function to enable voltage hysteresis for one electrode (see OCVcurves).
+	 * The potential then interpolates between a charge and a discharge OCV curve using the hysteresis state of the electrode.
+	 *
+	 * IN
+	 * pos 		if true, hysteresis is enabled for the cathode, else for the anode
+	 * namech 	name of the CSV file with the OCV curve while the cell is charged, same format as the other OCV curves
+	 * namedis 	name of the CSV file with the OCV curve while the cell is discharged
+	 * gamma 	rate of the hysteresis per unit of change in li-fraction [-], > 0
+	 * h0 		initial hysteresis state, -1 <= h0 <= 1 (1 is the charge curve, -1 the discharge curve)
+	 *
+	 * THROWS
+	 * 2 		one of the files could not be opened
+	 * 113 		illegal value of gamma or h0
+	 */
+	// #NOTHOTFUNCTION
+	if (gamma <= 0 || h0 < -1 || h0 > 1)
+	{
+		std::cerr << "ERROR in Cell::setHysteresis, illegal hysteresis rate " << gamma << " or initial state " << h0
+				  << ". The rate has to be positive and the state between -1 and 1.\n";
+		throw 113;
+	}
+
+	try
+	{
+		OCV_curves.loadHysteresis(pos, namech, namedis, gamma);
+	}
+	catch (int e)
+	{
+		std::cerr << "ERROR in Cell::setHysteresis when loading the OCV curves: " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	(pos ? s.get_hp() : s.get_hn()) = h0;
+	(pos ? s_ini.get_hp() : s_ini.get_hn()) = h0;
+}
+
+void Cell::setFixture(double K, double P0, int nlayer)
+{
+	/*
+	 * Function to clamp the cell in a fixture.
+	 * The present thickness of the cell becomes the reference thickness, at which the stack pressure is P0.
+	 * The constructors call this function with K = 0, so by default the swelling is relative to the initial state and there is no pressure.
+	 *
+	 * IN
+	 * K 		stiffness of the fixture [Pa m-1], >= 0
+	 * P0 		stack pressure at the present thickness [Pa], >= 0
+	 * nlayer 	number of electrode pairs stacked in the thickness direction of the cell [-], >= 1
+	 *
+	 * THROWS
+	 * 114 		illegal parameters of the swelling model
+	 */
+	// #NOTHOTFUNCTION
+	if (K < 0 || P0 < 0 || nlayer < 1)
+	{
+		std::cerr << "ERROR in Cell::setFixture, illegal stiffness " << K << ", pressure " << P0 << " or number of layers " << nlayer
+				  << ". The stiffness and pressure can't be negative and there must be at least one layer.\n";
+		throw 114;
+	}
+
+	swparam.K = K;
+	swparam.P0 = P0;
+	swparam.nlayer = nlayer;
+	swparam.dref = 0;
+
+	double dL, P;
+	getSwelling(&dL, &P);
+	swparam.dref = dL;
+}
+
+void Cell::setPressureFeedback(double gsei, double glam, double gpl, double pref)
+{
+	/*
+	 * Function to set the effect of the stack pressure on the degradation rates.
+	 * The rates of SEI growth, LAM and lithium plating are multiplied by 1 + g * (P - P0) / pref (and limited to positive values).
+	 * All sensitivities are 0 by default, in which case the pressure is not calculated during the time integration.
+	 *
+	 * IN
+	 * gsei 	sensitivity of the SEI growth rate to the pressure [-]
+	 * glam 	sensitivity of the LAM rates to the pressure [-]
+	 * gpl 		sensitivity of the plating rate to the pressure [-]
+	 * pref 	reference pressure [Pa], > 0
+	 *
+	 * THROWS
+	 * 114 		illegal parameters of the swelling model
+	 */
+	// #NOTHOTFUNCTION
+	if (pref <= 0)
+	{
+		std::cerr << "ERROR in Cell::setPressureFeedback, illegal reference pressure " << pref << ", it has to be positive.\n";
+		throw 114;
+	}
+
+	swparam.gsei = gsei;
+	swparam.glam = glam;
+	swparam.gpl = gpl;
+	swparam.pref = pref;
+}
+
+void Cell::setHeater(double Pmax, double Theat)
+{
+	/*
+	 * Function to add a heater to the cell, which is driven by the controller set with setThermalController.
+	 *
+	 * IN
+	 * Pmax 	maximum power of the heater [W], >= 0, 0 removes the heater
+	 * Theat 	temperature below which the cell is heated [K], must be below the temperature above which it is cooled
+	 *
+	 * THROWS
+	 * 115 		illegal parameters of the thermal management
+	 */
+	// #NOTHOTFUNCTION
+	if (Pmax < 0 || (Pmax > 0 && tmparam.Hcool > 0 && Theat >= tmparam.Tcool))
+	{
+		std::cerr << "ERROR in Cell::setHeater, illegal power " << Pmax << " or temperature " << Theat
+				  << ". The power can't be negative and the cell must be heated below the temperature at which it is cooled (" << tmparam.Tcool << ").\n";
+		throw 115;
+	}
+
+	tmparam.Pheat = Pmax;
+	tmparam.Theat = Theat;
+	s.get_uheat() = 0;
+	s.get_Iheat() = 0;
+}
+
+void Cell::setCoolant(double H, double Tcoolant, double Tcool, double COP)
+{
+	/*
+	 * Function to add a coolant loop to the cell, which is driven by the controller set with setThermalController.
+	 * The controller sets the flow of the coolant, i.e. the fraction of the conductance H which is used.
+	 * The energy used by the loop is the heat it exchanges with the cell divided by the coefficient of performance of the chiller.
+	 *
+	 * IN
+	 * H 		maximum thermal conductance between the cell and the coolant [W K-1], >= 0, 0 removes the coolant loop
+	 * Tcoolant temperature of the coolant [K]
+	 * Tcool 	temperature above which the cell is cooled [K], must be above the temperature below which it is heated
+	 * COP 		coefficient of performance of the chiller [-], > 0
+	 *
+	 * THROWS
+	 * 115 		illegal parameters of the thermal management
+	 */
+	// #NOTHOTFUNCTION
+	if (H < 0 || COP <= 0 || (H > 0 && tmparam.Pheat > 0 && Tcool <= tmparam.Theat))
+	{
+		std::cerr << "ERROR in Cell::setCoolant, illegal conductance " << H << ", coefficient of performance " << COP << " or temperature " << Tcool
+				  << ". The conductance can't be negative, the coefficient must be positive and the cell must be cooled above the temperature at which it is heated ("
+				  << tmparam.Theat << ").\n";
+		throw 115;
+	}
+
+	tmparam.Hcool = H;
+	tmparam.Tcoolant = Tcoolant;
+	tmparam.Tcool = Tcool;
+	tmparam.COP = COP;
+	s.get_ucool() = 0;
+	s.get_Icool() = 0;
+}
+
+void Cell::setThermalController(int mode, double band, double Kp, double Ki)
+{
+	/*
+	 * Function to set the controller of the heater and the coolant loop.
+	 * The controller is updated at the start of every time step of ETI, so it acts during any procedure of the Cycler.
+	 *
+	 * IN
+	 * mode 	type of controller
+	 * 				0 	no thermal management, the actuators are switched off
+	 * 				1 	on/off with a hysteresis band
+	 * 				2 	PI
+	 * band 	hysteresis band of the on/off controller [K], >= 0
+	 * Kp 		proportional gain of the PI controller [K-1], >= 0
+	 * Ki 		integral gain of the PI controller [K-1 s-1], >= 0
+	 *
+	 * THROWS
+	 * 115 		illegal parameters of the thermal management
+	 */
+	// #NOTHOTFUNCTION
+	if (mode < 0 || mode > 2 || band < 0 || Kp < 0 || Ki < 0)
+	{
+		std::cerr << "ERROR in Cell::setThermalController, illegal controller " << mode << ", band " << band << " or gains " << Kp << " and " << Ki
+				  << ". The controller must be 0, 1 or 2 and the band and gains can't be negative.\n";
+		throw 115;
+	}
+
+	tmparam.mode = mode;
+	tmparam.band = band;
+	tmparam.Kp = Kp;
+	tmparam.Ki = Ki;
+	s.get_uheat() = s.get_ucool() = 0;
+	s.get_Iheat() = s.get_Icool() = 0;
+}
+
+void Cell::getThermalReport(double *Eheat, double *Ecool, double tregime[3])
+{
+	/*
+	 * Function to get the energy used by the thermal management and the time spent in each thermal regime since the last reset.
+	 *
+	 * OUT
+	 * Eheat 	energy used by the heater [Wh]
+	 * Ecool 	energy used by the coolant loop [Wh]
+	 * tregime 	time spent idle, heating and cooling [s]
+	 */
+	*Eheat = s.get_Eheat() / 3600;
+	*Ecool = s.get_Ecool() / 3600;
+	for (int i = 0; i < 3; i++)
+		tregime[i] = s.get_t_tm(i);
+}
+
+void Cell::resetThermalReport()
+{
+	s.get_Eheat() = s.get_Ecool() = 0;
+	for (int i = 0; i < 3; i++)
+		s.get_t_tm(i) = 0;
+}
+
+void Cell::controlTemperature(double dti)
+{
+	/*
+	 * Function to update the actuators of the thermal management at the start of a time step,
+	 * and to accumulate their energy use and the time spent in each thermal regime over the time step.
+	 * The heater heats when the temperature is below Theat, the coolant loop cools when it is above Tcool (see ThermalParam).
+	 * The controller and the accumulated values are states, so they are undone together with the time step (e.g. while searching the current of a CV phase).
+	 *
+	 * IN
+	 * dti 		time step [s]
+	 */
+
+	const auto &tm = tmparam;
+	double &uheat = s.get_uheat(), &ucool = s.get_ucool();
+	if (tm.mode == 0 || tm.paused)
+	{
+		uheat = ucool = 0;
+		return;
 	}
 
-	// Make the full arrays for the (twice) transformed concentration
-	slide::z_type zp{}, zn{}; // set all values to 0
-	zp[ind] = zpu;			  // set the non-zero value
-	zn[ind] = znu;
-	s.setZ(zp, zn);
-
-	// Set the cell current to 0 to reflect the boundary condition for a fully uniform concentration
-	Icell = 0;
+	// fraction of an actuator from the error e (the actuator should act if e > 0) and the integral of the error I
+	auto control = [&](double e, double &u, double &I) {
+		if (tm.mode == 1)
+		{
+			if (e > 0.5 * tm.band)
+				u = 1;
+			else if (e < -0.5 * tm.band)
+				u = 0; // inside the band, the actuator stays as it is
+		}
+		else
+		{
+			I += e * dti;
+			u = tm.Kp * e + tm.Ki * I;
+			if (u > 1 || u < 0) // anti-windup: don't integrate while the actuator is saturated
+			{
+				I -= e * dti;
+				u = std::clamp(u, 0.0, 1.0);
+			}
+		}
+	};
 
-	// the stress values stored in the class variables for stress are no longer valid because the state has changed
-	sparam.s_dai_update = false;
-	sparam.s_lares_update = false;
+	const double T = s.get_T();
+	if (tm.Pheat > 0)
+		control(tm.Theat - T, uheat, s.get_Iheat());
+	if (tm.Hcool > 0)
+		control(T - tm.Tcool, ucool, s.get_Icool());
 
-	if constexpr (settings::verbose >= printLevel::printCellFunctions)
-		std::cout << "Cell::setC terminating.\n";
+	s.get_Eheat() += uheat * tm.Pheat * dti;
+	s.get_Ecool() += ucool * tm.Hcool * std::abs(T - tm.Tcoolant) / tm.COP * dti;
+	s.get_t_tm((uheat > 0) ? 1 : (ucool > 0) ? 2 : 0) += dti;
 }
 
 void Cell::setI(bool print, bool check, double I)
@@ -1324,7 +2299,7 @@ void Cell::LAM(bool print, double zp_surf, double etap,
 			double OCVpt; // cathode potential
 			try
 			{
-				OCVpt = OCV_curves.linInt_OCV_pos(zp_surf, print);
+				OCVpt = OCV_curves.linInt_OCV_pos_h(zp_surf, s.get_hp(), print);
 				// get OCV of positive electrode, throw error if out of bounds
 				// this should be updated for the cell's temperature using the entropic coefficient of the cathode
 				// but I couldn't find any data on this, so I have ignored the effect
@@ -1386,7 +2361,7 @@ void Cell::LAM(bool print, double zp_surf, double etap,
 		std::cout << "Cell::LAM terminating\n";
 }
 
-void Cell::LiPlating(double OCVnt, double etan, double *ipl)
+void Cell::LiPlating(double OCVnt, double etan, double *ipl, double *istrip)
 {
 	/*
 	 * Function to simulate the effect of lithium plating
@@ -1396,7 +2371,9 @@ void Cell::LiPlating(double OCVnt, double etan, double *ipl)
 	 * etan 	the overpotential at the negative electrode [V]
 	 *
 	 * OUT
-	 * ipl 		current density for the plating side-reaction [A m-2]
+	 * ipl 		net current density for the plating side-reaction [A m-2], < 0 if more lithium is stripped than plated
+	 * istrip 	current density of the stripping reaction [A m-2], only model 2 strips lithium.
+	 * 			The gross plating current density is ipl + istrip.
 	 *
 	 * THROWS
 	 * 106 		illegal value in id
@@ -1409,13 +2386,31 @@ void Cell::LiPlating(double OCVnt, double etan, double *ipl)
 	// Arrhenius relation for temperature-dependent plating parameters
 	const double kplt = plparam.pl1k * std::exp(plparam.pl1k_T / Rg * (1 / T_ref - 1 / s.get_T())); // Rate constant
 
+	*istrip = 0;
 	if (deg_id.pl_id == 0) // no plating
 		*ipl = 0;
 	else if (deg_id.pl_id == 1) // Yang, Leng, Zhang, Ge, Wang, Journal of Power Sources 360, 2017
 		*ipl = npl * F * kplt * std::exp(-n * F / (Rg * s.get_T()) * alphapl * (OCVnt + etan - OCVpl + Rsei * s.get_delta() * Icell));
+	else if (deg_id.pl_id == 2) // O'Kane, Campbell, Marzook, Offer, Marinescu, Journal of the Electrochemical Society 167, 2020
+	{
+		// Butler-Volmer kinetics between the plating and stripping reaction.
+		// Stripping can only happen if there is reversibly plated lithium, the rate is proportional to its amount per unit of anode surface
+		const double arr = std::exp(plparam.pl2k_T / Rg * (1 / T_ref - 1 / s.get_T()));	  // Arrhenius relation for the rate constants
+		const double etapl = OCVnt + etan - OCVpl + Rsei * s.get_delta() * Icell;		  // overpotential of the plating reaction [V]
+		const double cpl = std::max(s.get_Li_pl(), 0.0) / (npl * F * getAnodeSurface()); // plated lithium per unit of anode surface [mol m-2]
+		const double ipli = npl * F * plparam.pl2k * arr * std::exp(-plparam.pl2alpha * npl * F / (Rg * s.get_T()) * etapl);
+		*istrip = npl * F * plparam.pl2ks * arr * cpl * std::exp((1 - plparam.pl2alpha) * npl * F / (Rg * s.get_T()) * etapl);
+
+		// the stripping rate grows exponentially with the anode potential, so after a charge the little plated lithium would be stripped
+		// faster than the time step of the (explicit) time integration, which makes the plated lithium negative.
+		// Therefore the plated lithium is not stripped faster than with a time constant tstrip, which is at least two time steps.
+		const double tstrip = std::max(10.0, 2 * dt_step); // minimum time constant of the stripping reaction [s]
+		*istrip = std::min(*istrip, npl * F * cpl / tstrip);
+		*ipl = ipli - *istrip;
+	}
 	else
 	{
-		std::cerr << "ERROR in Cell::LiPlating, illegal degradation model identifier " << deg_id.pl_id << ", only values 0 and 1 are allowed. Throwing an error.\n";
+		std::cerr << "ERROR in Cell::LiPlating, illegal degradation model identifier " << deg_id.pl_id << ", only values 0, 1 and 2 are allowed. Throwing an error.\n";
 		throw 106;
 	}
 
@@ -1423,6 +2418,285 @@ void Cell::LiPlating(double OCVnt, double etan, double *ipl)
 		std::cout << "Cell::LiPlating starting\n";
 }
 
+void Cell::CAT(bool print, double zp_surf, double etap, double *iox, double *ish)
+{
+	/*
+	 * Function to calculate the side reactions at the cathode, which cause self-discharge during storage at high SOC.
+	 * 		1 	electrolyte oxidation: electrons from the electrolyte reduce the cathode, so lithium is inserted into the cathode
+	 * 			without being removed from the anode. The products form a resistive film on the cathode.
+	 * 		2 	redox shuttle: a molecule is oxidised at the cathode and reduced again at the anode,
+	 * 			so the cell is discharged without losing lithium or capacity.
+	 * Both reactions follow Tafel kinetics in the cathode potential with an Arrhenius temperature dependence.
+	 *
+	 * IN
+	 * print 	boolean indicating if we want to print error messages or not
+	 * zp_surf 	li-fraction at the surface of the positive particle [-]
+	 * etap 	overpotential at the positive electrode [V]
+	 *
+	 * OUT
+	 * iox 		current density of the electrolyte oxidation on the cathode surface [A m-2]
+	 * ish 		current density of the redox shuttle on the cathode surface [A m-2]
+	 *
+	 * THROWS
+	 * 106 		illegal value in id
+	 */
+	using namespace PhyConst;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::CAT starting\n";
+
+	*iox = 0;
+	*ish = 0;
+	if (deg_id.CAT_n == 0)
+		return;
+
+	double OCVpt; // cathode potential, the entropic effect is ignored like in the LAM models
+	try
+	{
+		OCVpt = OCV_curves.linInt_OCV_pos_h(zp_surf, s.get_hp(), print);
+	}
+	catch (int e)
+	{
+		std::cout << "Error in Cell::CAT when calculating the cathode potential: " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	const double T = s.get_T();
+	for (int i = 0; i < deg_id.CAT_n; i++)
+	{
+		switch (deg_id.CAT_id[i])
+		{
+		case 0: // no side reactions
+			break;
+		case 1: // electrolyte oxidation
+			*iox += catparam.cat1k * std::exp(catparam.cat1k_T / Rg * (1 / T_ref - 1 / T)) * std::exp(catparam.cat1alpha * F / (Rg * T) * (OCVpt + etap - catparam.cat1U));
+			break;
+		case 2: // redox shuttle
+			*ish += catparam.cat2k * std::exp(catparam.cat2k_T / Rg * (1 / T_ref - 1 / T)) * std::exp(catparam.cat2alpha * F / (Rg * T) * (OCVpt + etap - catparam.cat2U));
+			break;
+		default:
+			std::cerr << "ERROR in Cell::CAT, illegal degradation model identifier " << deg_id.CAT_id[i] << ", only values 0, 1 and 2 are allowed. Throwing an error.\n";
+			throw 106;
+		}
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::CAT terminating\n";
+}
+
+void Cell::userDegradation(double zp_surf, double zn_surf, double OCVnt, double etap, double etan, slide::deg::Rates &r, double dxdeg[])
+{
+	/*
+	 * Function to calculate the effect of the user-defined degradation models selected in deg_id (see deg_registry.hpp)
+	 *
+	 * IN
+	 * zp_surf 	li-fraction at the surface of the positive particle [-]
+	 * zn_surf 	li-fraction at the surface of the negative particle [-]
+	 * OCVnt 	the OCV of the negative electrode at the battery temperature [V]
+	 * etap 	overpotential at the positive electrode [V]
+	 * etan 	overpotential at the negative electrode [V]
+	 *
+	 * OUT
+	 * r 		combined contributions of all user-defined models to the degradation rates
+	 * dxdeg 	time derivatives of the own states of the user-defined models, array of length settings::ns_deg
+	 *
+	 * THROWS
+	 * 108 		the stress values are not up to date
+	 */
+
+	using namespace slide::deg;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::userDegradation starting\n";
+
+	Inputs in;
+	in.T = s.get_T();
+	in.T_ref = T_ref;
+	in.I = Icell;
+	in.zp_surf = zp_surf;
+	in.zn_surf = zn_surf;
+	in.OCVnt = OCVnt;
+	in.etap = etap;
+	in.etan = etan;
+	in.delta = s.get_delta();
+	in.CS = s.get_CS();
+	in.LLI = s.get_LLI();
+	in.ASn = getAnodeSurface();
+	in.s_dai_p = sparam.s_dai_p;
+	in.s_dai_n = sparam.s_dai_n;
+	in.s_dai_p_prev = sparam.s_dai_p_prev;
+	in.s_dai_n_prev = sparam.s_dai_n_prev;
+	in.s_lares_n = sparam.s_lares_n;
+	in.s_lares_n_prev = sparam.s_lares_n_prev;
+
+	for (int i = 0; i < deg_id.user_n; i++)
+	{
+		const Model &m = registry()[deg_id.user_id[i]];
+
+		// ensure the stress values are up to date
+		if ((m.needs(in_stressDai) && !sparam.s_dai_update) || (m.needs(in_stressLares) && !sparam.s_lares_update))
+		{
+			std::cerr << "ERROR in Cell::userDegradation. The stress values needed by the degradation model " << m.name << " are not updated. Throwing an error.\n";
+			throw 108;
+		}
+
+		// the model only sees its own states
+		in.x = &s.get_xdeg(deg_id.user_x0[i]);
+		r.dx = dxdeg + deg_id.user_x0[i];
+		m.rate(in, m.param, r);
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::userDegradation terminating\n";
+}
+
+void Cell::splitFlux(double jp, double jn, double jpk[], double jnk[])
+{
+	/*
+	 * Function to split the molar flux over the particle-size classes.
+	 * All classes of an electrode see the same electrode potential but have a different surface concentration, so a different OCV and exchange current.
+	 * The Butler-Volmer relation is linearised around the OCV of each class, j_k = i0_k / (Rg T) * (phi - OCV_k),
+	 * and phi follows from the condition that the surface-weighted flux of all classes equals the electrode flux, sum(alpha_k * j_k) = j.
+	 * The surface concentration of each class is evaluated with the electrode flux j.
+	 * The matrices of a particle with radius f*R are C/f and D*f, and its (transformed) concentrations are stored in zp_psd and zn_psd.
+	 *
+	 * IN
+	 * jp 		molar flux on the positive electrode [mol m-2 s-1]
+	 * jn 		molar flux on the negative electrode [mol m-2 s-1]
+	 *
+	 * OUT
+	 * jpk 		molar flux on each class of the positive electrode [mol m-2 s-1], array of length psd.n
+	 * jnk 		molar flux on each class of the negative electrode [mol m-2 s-1], array of length psd.n
+	 *
+	 * THROWS
+	 * 101 		the surface concentration of one of the classes is out of bounds
+	 */
+
+	using namespace PhyConst;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::splitFlux starting\n";
+
+	// Arrhenius relation for temperature-dependent parameters
+	const double Dpt = s.get_Dp() * std::exp(Dp_T / Rg * (1 / T_ref - 1 / s.get_T()));
+	const double Dnt = s.get_Dn() * std::exp(Dn_T / Rg * (1 / T_ref - 1 / s.get_T()));
+	const double kpt = kp * std::exp(kp_T / Rg * (1 / T_ref - 1 / s.get_T()));
+	const double knt = kn * std::exp(kn_T / Rg * (1 / T_ref - 1 / s.get_T()));
+
+	// surface concentration of each class
+	double cpk[settings::npsd] = {}, cnk[settings::npsd] = {};
+	for (int j = 0; j < settings::nch; j++)
+	{
+		cpk[0] += M.Cp[0][j] * s.get_zp(j);
+		cnk[0] += M.Cn[0][j] * s.get_zn(j);
+		for (int k = 1; k < psd.n; k++)
+		{
+			cpk[k] += M.Cp[0][j] * s.get_zp_psd(k, j);
+			cnk[k] += M.Cn[0][j] * s.get_zn_psd(k, j);
+		}
+	}
+
+	// linearised conductance (G) and OCV (U) of each class
+	double Gp[settings::npsd], Gn[settings::npsd], Up[settings::npsd], Un[settings::npsd];
+	double sumGp = 0, sumGn = 0, sumGUp = 0, sumGUn = 0;
+	for (int k = 0; k < psd.n; k++)
+	{
+		const double Cmaxp = Cmaxpos * psd.cmp[k]; // maximum concentration of the material of this class [mol m-3]
+		const double Cmaxn = Cmaxneg * psd.cmn[k];
+		cpk[k] = cpk[k] / psd.fp[k] + M.Dp[0] * psd.fp[k] * jp / (psd.dp[k] * Dpt);
+		cnk[k] = cnk[k] / psd.fn[k] + M.Dn[0] * psd.fn[k] * jn / (psd.dn[k] * Dnt);
+		if (cpk[k] <= 0 || cnk[k] <= 0 || cpk[k] >= Cmaxp || cnk[k] >= Cmaxn)
+		{
+			if constexpr (settings::verbose >= printLevel::printNonCrit)
+				std::cerr << "ERROR in Cell::splitFlux: concentration out of bounds in particle class " << k << ". the positive lithium fraction is "
+						  << cpk[k] / Cmaxp << " and the negative lithium fraction is " << cnk[k] / Cmaxn << ", they should both be between 0 and 1.\n";
+			throw 101;
+		}
+
+		Up[k] = OCV_curves.linInt_OCV_pos_k(k, cpk[k] / Cmaxp, s.get_hp(), false, true);
+		Un[k] = OCV_curves.linInt_OCV_neg_k(k, cnk[k] / Cmaxn, s.get_hn(), false, true);
+		Gp[k] = kpt * n * F * sqrt(C_elec * cpk[k] * (Cmaxp - cpk[k])) / (Rg * s.get_T());
+		Gn[k] = knt * n * F * sqrt(C_elec * cnk[k] * (Cmaxn - cnk[k])) / (Rg * s.get_T());
+
+		sumGp += psd.alphap[k] * Gp[k];
+		sumGn += psd.alphan[k] * Gn[k];
+		sumGUp += psd.alphap[k] * Gp[k] * Up[k];
+		sumGUn += psd.alphan[k] * Gn[k] * Un[k];
+	}
+
+	// electrode potential and flux on each class
+	const double phip = (jp + sumGUp) / sumGp;
+	const double phin = (jn + sumGUn) / sumGn;
+	for (int k = 0; k < psd.n; k++)
+	{
+		jpk[k] = Gp[k] * (phip - Up[k]);
+		jnk[k] = Gn[k] * (phin - Un[k]);
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::splitFlux terminating\n";
+}
+
+void Cell::psdSideReactions(bool print, const double jnk[], double Dnt, double iseik[], double iplk[], double istripk[])
+{
+	/*
+	 * Function to calculate SEI growth and lithium plating on the particle-size classes 1 to psd.n-1 of the anode.
+	 * Each class has its own anode potential and overpotential, which are used in the same SEI and plating models as the reference particle.
+	 *
+	 * IN
+	 * print 	boolean indicating if we want to print error messages or not
+	 * jnk 		molar flux on each class of the negative electrode [mol m-2 s-1]
+	 * Dnt 		diffusion constant of the negative electrode at the cell temperature [m s-1]
+	 *
+	 * OUT
+	 * iseik 	current density of the SEI growth side reaction on each class [A m-2], index 0 is not set
+	 * iplk 	net current density of the plating side reaction on each class [A m-2], index 0 is not set
+	 * istripk 	current density of the stripping reaction on each class [A m-2], index 0 is not set
+	 *
+	 * THROWS
+	 * 101 		the surface concentration of one of the classes is out of bounds
+	 */
+
+	using namespace PhyConst;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::psdSideReactions starting\n";
+
+	const double knt = kn * std::exp(kn_T / Rg * (1 / T_ref - 1 / s.get_T()));
+
+	for (int k = 1; k < psd.n; k++)
+	{
+		// surface concentration of the class
+		double cns = 0;
+		for (int j = 0; j < settings::nch; j++)
+			cns += M.Cn[0][j] * s.get_zn_psd(k, j);
+		const double Cmaxn = Cmaxneg * psd.cmn[k]; // maximum concentration of the material of this class [mol m-3]
+		cns = cns / psd.fn[k] + M.Dn[0] * psd.fn[k] * jnk[k] / (psd.dn[k] * Dnt);
+		if (cns <= 0 || cns >= Cmaxn)
+		{
+			if (print)
+				std::cerr << "ERROR in Cell::psdSideReactions: concentration out of bounds in particle class " << k
+						  << ". the negative lithium fraction is " << cns / Cmaxn << ", it should be between 0 and 1.\n";
+			throw 101;
+		}
+
+		// anode potential and overpotential of the class
+		// the entropic coefficient of the reference material is used for all materials
+		const double zn_surf = cns / Cmaxn;
+		const double OCVnt = OCV_curves.linInt_OCV_neg_k(k, zn_surf, s.get_hn(), print, true) + (s.get_T() - T_ref) * OCV_curves.linInt_dOCV_neg(zn_surf, print, true);
+		const double i0n = knt * n * F * sqrt(C_elec * cns * (Cmaxn - cns));
+		const double xn = 0.5 * n * F * jnk[k] / i0n;
+		const double etan = (2 * Rg * s.get_T()) / (n * F) * log(xn + sqrt(1 + xn * xn));
+
+		double den_sei; // the decrease in volume fraction is only accounted for on the reference particle
+		SEI(OCVnt, etan, &iseik[k], &den_sei);
+		LiPlating(OCVnt, etan, &iplk[k], &istripk[k]);
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::psdSideReactions terminating\n";
+}
+
 // state space model
 slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 {
@@ -1461,6 +2735,7 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 	 * 		dDn			time derivative of the diffusion constant at reference temperature of the negative electrode [m s-1 s-1] (dDn/dt)
 	 * 		dR			time derivative of the electrode resistance [Ohm m2 s-1] (dR/dt)
 	 * 		ddelta_pl 	time derivative of the thickness of the plated lithium layer [m s-1] (ddelta_pl/dt)
+	 * 		dxdeg 		time derivatives of the own states of the user-defined degradation models
 	 *
 	 * THROWS
 	 * 100 	the array provided has the wrong length
@@ -1508,8 +2783,19 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 
 	// current density
 	const double i_app = Icell / elec_surf;												  // current density on the electrode surfaces [A m-2]
-	const double jp = (electr == 2) ? 0 : -i_app / (s.get_ap() * n * F * s.get_thickp()); // molar flux on the positive particle [mol m-2 s-1]
-	const double jn = (electr == 1) ? 0 : i_app / (s.get_an() * n * F * s.get_thickn());  // molar flux on the negative particle [mol m-2 s-1]
+	double jp = (electr == 2) ? 0 : -i_app / (s.get_ap() * n * F * s.get_thickp()); // molar flux on the positive particle [mol m-2 s-1]
+	double jn = (electr == 1) ? 0 : i_app / (s.get_an() * n * F * s.get_thickn());  // molar flux on the negative particle [mol m-2 s-1]
+
+	// with a particle-size distribution, split the flux over the size classes. Class 0 is the reference particle with the states zp and zn
+	// half-cell cycling is only done with the reference particle
+	const bool isPSD = psd.n > 1 && electr != 1 && electr != 2;
+	double jpk[settings::npsd], jnk[settings::npsd]; // molar flux on each particle-size class [mol m-2 s-1]
+	if (isPSD)
+	{
+		splitFlux(jp, jn, jpk, jnk);
+		jp = jpk[0];
+		jn = jnk[0];
+	}
 
 	// Arrhenius relation for temperature-dependent parameters
 	const double Dpt = (electr == 2) ? 0 : s.get_Dp() * std::exp(Dp_T / Rg * (1 / T_ref - 1 / s.get_T())); // Diffusion constant at the positive electrode at the cell's temperature [m s-1]
@@ -1527,13 +2813,29 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 		dzn[j] = (Dnt * cten + M.Bn[j] * jn);
 	}
 
+	// Same for the other particle-size classes, all classes are done together.
+	// The matrices are scaled with the radius of the class: A/f^2, while B does not depend on the radius.
+	// The diffusion constant is scaled with the one of the material of the class
+	const int npk = isPSD ? psd.n : 1;							 // number of classes, half-cell cycling only changes the reference particle
+	double dzpk[settings::npsd][nch], dznk[settings::npsd][nch]; // only the classes 1 to npk - 1 are set
+	for (int k = 1; k < npk; k++)
+	{
+		const double Dpk = psd.dp[k] * Dpt / (psd.fp[k] * psd.fp[k]);
+		const double Dnk = psd.dn[k] * Dnt / (psd.fn[k] * psd.fn[k]);
+		for (int j = 0; j < nch; j++)
+		{
+			dzpk[k][j] = Dpk * M.Ap[j] * s.get_zp_psd(k, j) + M.Bp[j] * jpk[k];
+			dznk[k][j] = Dnk * M.An[j] * s.get_zn_psd(k, j) + M.Bn[j] * jnk[k];
+		}
+	}
+
 	// Calculate the overpotential using the Bulter-Volmer equation
 	// if alpha is 0.5, the Bulter-Volmer relation can be inverted to eta = 2RT / (nF) asinh(x)
 	// and asinh(x) = ln(x + sqrt(1+x^2)
 	const double i0p = kpt * n * F * sqrt(C_elec * cps * (Cmaxpos - cps));								  // exchange current density of the positive electrode
 	const double i0n = knt * n * F * sqrt(C_elec * cns * (Cmaxneg - cns));								  // exchange current density of the negative electrode
-	const double xp = -0.5 * i_app / (s.get_ap() * s.get_thickp()) / i0p;								  // x for the cathode
-	const double xn = 0.5 * i_app / (s.get_an() * s.get_thickn()) / i0n;								  // x for the anode
+	const double xp = isPSD ? 0.5 * n * F * jp / i0p : -0.5 * i_app / (s.get_ap() * s.get_thickp()) / i0p; // x for the cathode
+	const double xn = isPSD ? 0.5 * n * F * jn / i0n : 0.5 * i_app / (s.get_an() * s.get_thickn()) / i0n;	 // x for the anode
 	const double etap = (electr == 2) ? 0 : (2 * Rg * s.get_T()) / (n * F) * log(xp + sqrt(1 + xp * xp)); // cathode overpotential [V], < 0 on discharge
 	const double etan = (electr == 1) ? 0 : (2 * Rg * s.get_T()) / (n * F) * log(xn + sqrt(1 + xn * xn)); // anode overpotential [V],  > 0 on discharge
 
@@ -1559,13 +2861,35 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 	const double Qohm = Icell * Icell * getR() / (L * elec_surf); // Ohmic heat due to electrode resistance [W m-3]
 	const double Qc = -Qch * SAV * (s.get_T() - T_env);			  // cooling with the environment [W m-3]
 
+	// heating and cooling by the thermal management [W m-3] (see controlTemperature)
+	const double Qtm = (s.get_uheat() * tmparam.Pheat - s.get_ucool() * tmparam.Hcool * (s.get_T() - tmparam.Tcoolant)) / (L * elec_surf);
+
+	// voltage hysteresis, h relaxes to 1 while charging and to -1 while discharging proportionally to the change in li-fraction
+	double dhp = 0, dhn = 0;
+	if (OCV_curves.hys_pos || OCV_curves.hys_neg)
+	{
+		const double hlim = (Icell < 0) ? 1 : -1;
+		if (OCV_curves.hys_pos && electr != 2)
+			dhp = OCV_curves.hys_gammap * std::abs(i_app) / (n * F * s.get_thickp() * s.get_ep() * Cmaxpos) * (hlim - s.get_hp());
+		if (OCV_curves.hys_neg && electr != 1)
+			dhn = OCV_curves.hys_gamman * std::abs(i_app) / (n * F * s.get_thickn() * s.get_en() * Cmaxneg) * (hlim - s.get_hn());
+	}
+
 	// If we ignore degradation in this time step, we have calculated everything we need
+	slide::states_type dstates{}; // Initialize as zero, one array for both returns such that it is not copied
 	if (blockDegradation)
 	{
-		slide::states_type dstates{};									   // Initialize as zero.
-		std::copy(dzp.begin(), dzp.end(), dstates.begin());				   // first nch dstates are d_zp,
-		std::copy(dzn.begin(), dzn.end(), dstates.begin() + nch);		   // first nch dstates are d_zn,
-		dstates[2 * nch + 0] = 1 / (rho * Cp) * (Qrev + Qrea + Qohm + Qc); // dT		cell temperature
+		std::copy(dzp.begin(), dzp.end(), dstates.begin());						 // first nch dstates are d_zp,
+		std::copy(dzn.begin(), dzn.end(), dstates.begin() + nch);				 // first nch dstates are d_zn,
+		dstates[2 * nch + 0] = 1 / (rho * Cp) * (Qrev + Qrea + Qohm + Qc + Qtm); // dT		cell temperature
+		for (int k = 1; k < npk; k++)											 // other particle-size classes
+			for (int j = 0; j < nch; j++)
+			{
+				dstates[slide::State::i_psd + 2 * nch * (k - 1) + j] = dzpk[k][j];
+				dstates[slide::State::i_psd + 2 * nch * (k - 1) + nch + j] = dznk[k][j];
+			}
+		dstates[slide::State::i_hys + 0] = dhp; // dhp 	hysteresis
+		dstates[slide::State::i_hys + 1] = dhn; // dhn
 
 		// Others are zero : ddelta	SEI thickness, dLLI	lost lithium, dthickp/dthickn 	electrode thickness,
 		// dep/den volume fraction of active material, dap/dan effective surface are, a = 3 e/R, dCS surface area of the cracks,
@@ -1582,7 +2906,7 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 	try
 	{
 		dOCVn = OCV_curves.linInt_dOCV_neg(zn_surf, print, bound); // entropic coefficient of the anode potential [V K-1]
-		OCV_n = OCV_curves.linInt_OCV_neg(zn_surf, print, bound);  // anode potential [V]
+		OCV_n = OCV_curves.linInt_OCV_neg_h(zn_surf, s.get_hn(), print, bound);  // anode potential [V]
 	}
 	catch (int e)
 	{
@@ -1593,6 +2917,35 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 	}
 	const double OCVnt = OCV_n + (s.get_T() - T_ref) * dOCVn; // anode potential at the cell's temperature [V]
 
+	// user-defined degradation models, their rates are added to the ones of the built-in models below
+	slide::deg::Rates ru;						  // combined contributions of the user-defined models
+	double dxdeg[settings::ns_deg] = {};		  // time derivatives of their own states
+	if (deg_id.user_n > 0)
+	{
+		try
+		{
+			userDegradation(zp_surf, zn_surf, OCVnt, etap, etan, ru, dxdeg);
+		}
+		catch (int e)
+		{
+			if (print)
+				std::cout << "Error in Cell::dState when calculating the user-defined degradation models: " << e << ". Throwing it on.\n";
+			throw e;
+		}
+	}
+
+	// effect of the stack pressure on the degradation rates
+	double fsei = 1, flam = 1, fpl = 1;
+	if (swparam.gsei != 0 || swparam.glam != 0 || swparam.gpl != 0)
+	{
+		double dL, P;
+		getSwelling(&dL, &P);
+		const double dP = (P - swparam.P0) / swparam.pref;
+		fsei = std::max(0.0, 1 + swparam.gsei * dP);
+		flam = std::max(0.0, 1 + swparam.glam * dP);
+		fpl = std::max(0.0, 1 + swparam.gpl * dP);
+	}
+
 	// SEI growth
 	double isei;		// current density of the SEI growth side reaction [A m-2]
 	double den_sei;		// decrease in volume fraction due to SEI growth [s-1]
@@ -1607,6 +2960,8 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 			std::cout << "Error in Cell::dState when calculating the effect of SEI growth: " << e << ". Throwing it on.\n";
 		throw e;
 	}
+	isei = (isei + ru.isei) * fsei;
+	den_sei *= fsei;
 
 	// Subtract Li from negative electrode (like an extra current density -> add it in the boundary conditions: dCn/dx =  jn + isei/nF)
 	for (int j = 0; j < nch; j++)
@@ -1627,6 +2982,9 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 			std::cout << "Error in Cell::dState when calculating the effect of crack growth: " << e << ". Throwing it on.\n";
 		throw e;
 	}
+	isei_multiplyer += ru.isei_multiplyer;
+	dCS += ru.dCS;
+	dDn += ru.dDn;
 
 	// crack surface leads to extra SEI growth because the exposed surface area increases.
 	// (like an extra current density -> add it in the boundary conditions: dCn/dx =  jn + isei/nF + isei_CS/nF)
@@ -1646,13 +3004,26 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 			std::cout << "Error in Cell::dState when calculating the LAM: " << e << ". Throwing it on.\n";
 		throw e;
 	}
+	dthickp += ru.dthickp;
+	dthickn += ru.dthickn;
+	dap += ru.dap;
+	dan += ru.dan;
+	dep += ru.dep;
+	den += ru.den;
+	dthickp *= flam;
+	dthickn *= flam;
+	dap *= flam;
+	dan *= flam;
+	dep *= flam;
+	den *= flam;
 
 	// lithium plating
-	double ipl;			// current density of the plating side reaction [A m-2]
+	double ipl;			// net current density of the plating side reaction [A m-2]
+	double istrip;		// current density of the stripping reaction [A m-2]
 	double dzn_pl[nch]; // additional diffusion in the anode due to ipl
 	try
 	{
-		LiPlating(OCVnt, etan, &ipl);
+		LiPlating(OCVnt, etan, &ipl, &istrip);
 	}
 	catch (int e)
 	{
@@ -1660,34 +3031,118 @@ slide::states_type Cell::dState(bool print, bool blockDegradation, int electr)
 			std::cout << "Error in Cell::dState when calculating the lithium plating: " << e << ". Throwing it on.\n";
 		throw e;
 	}
+	ipl = (ipl + ru.ipl + istrip) * fpl - istrip; // the pressure only affects the plating, not the stripping
 
 	// Subtract Li from negative electrode (like an extra current density -> add it in the boundary conditions: dCn/dx =  jn + ipl/nF)
 	for (int j = 0; j < nch; j++)
 		dzn_pl[j] = (M.Bn[j] * ipl / (npl * F));
 
+	// SEI growth and plating on the other particle-size classes.
+	// The side reactions of each class are driven by its own anode potential and overpotential,
+	// the contributions of the user-defined models are assumed to be the same on all classes.
+	// Crack growth and LAM are only calculated on the reference particle.
+	double isei_tot = isei; // SEI side reaction current density averaged over the surface of all classes [A m-2]
+	double ipl_tot = ipl;	// plating current density averaged over the surface of all classes [A m-2]
+	double istrip_tot = istrip; // stripping current density averaged over the surface of all classes [A m-2]
+	if (isPSD)
+	{
+		double iseik[settings::npsd], iplk[settings::npsd], istripk[settings::npsd];
+		try
+		{
+			psdSideReactions(print, jnk, Dnt, iseik, iplk, istripk);
+		}
+		catch (int e)
+		{
+			if (print)
+				std::cout << "Error in Cell::dState when calculating the side reactions on the particle-size classes: " << e << ". Throwing it on.\n";
+			throw e;
+		}
+
+		isei_tot = psd.alphan[0] * isei;
+		ipl_tot = psd.alphan[0] * ipl;
+		istrip_tot = psd.alphan[0] * istrip;
+		for (int k = 1; k < psd.n; k++)
+		{
+			iseik[k] = (iseik[k] + ru.isei) * fsei;
+			iplk[k] = (iplk[k] + ru.ipl + istripk[k]) * fpl - istripk[k];
+			isei_tot += psd.alphan[k] * iseik[k];
+			ipl_tot += psd.alphan[k] * iplk[k];
+			istrip_tot += psd.alphan[k] * istripk[k];
+			for (int j = 0; j < nch; j++)
+				dznk[k][j] += M.Bn[j] * (iseik[k] / (nsei * F) + iplk[k] / (npl * F));
+		}
+	}
+
+	// plated lithium inventory
+	// with the reversible plating model, part of the plated lithium can be stripped again and part of it becomes dead lithium
+	// with the other models, all plated lithium is immediately dead lithium
+	const double surfn = elec_surf * s.get_thickn() * s.get_an(); // active surface area of the anode [m2]
+	double dLi_pl = 0;											   // change in reversibly plated lithium [A]
+	double dLi_dead = ipl_tot * surfn;							   // change in dead lithium [A]
+	if (deg_id.pl_id == 2)
+	{
+		double gamma = plparam.pl2gamma; // rate at which plated lithium becomes dead lithium [s-1]
+		if (deg_id.pl_sei == 1)			 // the SEI passivates the plated lithium
+			gamma *= plparam.pl2delta0 / (plparam.pl2delta0 + s.get_delta());
+		dLi_dead = gamma * std::max(s.get_Li_pl(), 0.0);
+		dLi_pl = ipl_tot * surfn - dLi_dead;
+	}
+
+	// side reactions at the cathode
+	// they reduce the cathode (like an extra negative flux), and the shuttle also oxidises the anode with the same total current
+	double iox, ish; // current density of the electrolyte oxidation and the redox shuttle on the cathode surface [A m-2]
+	try
+	{
+		CAT(print, zp_surf, etap, &iox, &ish);
+	}
+	catch (int e)
+	{
+		if (print)
+			std::cout << "Error in Cell::dState when calculating the side reactions at the cathode: " << e << ". Throwing it on.\n";
+		throw e;
+	}
+	const double surfp = elec_surf * s.get_thickp() * s.get_ap(); // active surface area of the cathode [m2]
+	const double jp_cat = -(iox + ish) / (n * F);				   // extra molar flux on the cathode particles [mol m-2 s-1]
+	const double jn_cat = ish * surfp / surfn / (n * F);		   // extra molar flux on the anode particles [mol m-2 s-1]
+
 	// time derivatives
-	slide::states_type dstates{}; // Initialize as zero.
 	for (int j = 0; j < nch; j++)
 	{
-		dstates[j] = dzp[j];												// dzp 		diffusion
-		dstates[nch + j] = (dzn[j] + dznsei[j] + dznsei_CS[j] + dzn_pl[j]); // dzn		jtot = jn + isei/nF + isei_CS/nF + ipl/nF
+		dstates[j] = dzp[j] + M.Bp[j] * jp_cat;												   // dzp 		diffusion
+		dstates[nch + j] = (dzn[j] + dznsei[j] + dznsei_CS[j] + dzn_pl[j] + M.Bn[j] * jn_cat); // dzn		jtot = jn + isei/nF + isei_CS/nF + ipl/nF
 	}
-	dstates[2 * nch + 0] = 1 / (rho * Cp) * (Qrev + Qrea + Qohm + Qc);						 // dT 		cell temperature
-	dstates[2 * nch + 1] = isei / (nsei * F * rhosei);										 // ddelta	thickness of the SEI layer
-																							 // delta uses only isei (and not isei + isei_CS) since crack growth increases the area, not the thickness
-	dstates[2 * nch + 2] = (isei + isei_CS + ipl) * elec_surf * s.get_thickn() * s.get_an(); // dLLI 	loss of lithium
+	dstates[2 * nch + 0] = 1 / (rho * Cp) * (Qrev + Qrea + Qohm + Qc + Qtm);					 // dT 		cell temperature
+	dstates[2 * nch + 1] = isei_tot / (nsei * F * rhosei);										 // ddelta	thickness of the SEI layer
+																								 // delta uses only isei (and not isei + isei_CS) since crack growth increases the area, not the thickness
+	dstates[2 * nch + 2] = (isei_tot + isei_CS + ipl_tot) * elec_surf * s.get_thickn() * s.get_an(); // dLLI 	loss of lithium
 																							 // i_sei = density => * active surface area = * (surf*thick*specific_surf_neg)
 	dstates[2 * nch + 3] = dthickp;															 // dthickp 	electrode thickness
 	dstates[2 * nch + 4] = dthickn;															 // dthickn
 	dstates[2 * nch + 5] = dep;																 // dep		volume fraction of active material
 	dstates[2 * nch + 6] = den + den_sei;													 // den
-	dstates[2 * nch + 7] = dap + 3 / Rp * dep;												 // dap		effective surface area, a = 3 e/R -> da/dt = da/dt + 3/R de/dt
-	dstates[2 * nch + 8] = dan + 3 / Rn * (den + den_sei);									 // dan
+	dstates[2 * nch + 7] = dap + 3 / Rp * psd.sp * dep;										 // dap		effective surface area, a = 3 e/R -> da/dt = da/dt + 3/R de/dt
+	dstates[2 * nch + 8] = dan + 3 / Rn * psd.sn * (den + den_sei);							 // dan			(with a particle-size distribution, a = 3 e/R * sum(w/f))
 	dstates[2 * nch + 9] = dCS;																 // dCS 		surface area of the cracks
 	dstates[2 * nch + 10] = 0;																 // dDp 		diffusion constant
 	dstates[2 * nch + 11] = dDn;															 // dDn
-	dstates[2 * nch + 12] = 0;																 // dR 		specific electrode resistance
-	dstates[2 * nch + 13] = ipl / (npl * F * rhopl);										 // ddelta_pl thickness of the plated lithium
+	dstates[2 * nch + 12] = catparam.cat1r * iox;											 // dR 		specific electrode resistance
+	dstates[2 * nch + 13] = ipl_tot / (npl * F * rhopl);									 // ddelta_pl thickness of the plated lithium
+	for (int j = 0; j < settings::ns_deg; j++)
+		dstates[slide::State::i_xdeg + j] = dxdeg[j]; // own states of the user-defined degradation models
+	for (int k = 1; k < npk; k++)						  // other particle-size classes
+		for (int j = 0; j < nch; j++)
+		{
+			dstates[slide::State::i_psd + 2 * nch * (k - 1) + j] = dzpk[k][j] + M.Bp[j] * jp_cat;
+			dstates[slide::State::i_psd + 2 * nch * (k - 1) + nch + j] = dznk[k][j] + M.Bn[j] * jn_cat;
+		}
+	dstates[slide::State::i_pl + 0] = dLi_pl;						  // dLi_pl 	reversibly plated lithium
+	dstates[slide::State::i_pl + 1] = dLi_dead;					  // dLi_dead 	dead lithium
+	dstates[slide::State::i_pl + 2] = (ipl_tot + istrip_tot) * surfn; // dQ_pl 	cumulative plated lithium
+	dstates[slide::State::i_pl + 3] = istrip_tot * surfn;			  // dQ_strip 	cumulative stripped lithium
+	dstates[slide::State::i_hys + 0] = dhp;							  // dhp 		hysteresis
+	dstates[slide::State::i_hys + 1] = dhn;							  // dhn
+	dstates[slide::State::i_cat + 0] = iox * surfp;					  // dQ_ox 		electrolyte oxidation
+	dstates[slide::State::i_cat + 1] = ish * surfp;					  // dQ_sh 		redox shuttle
 
 	if constexpr (settings::verbose >= printLevel::printCellFunctions)
 		std::cout << "Cell::dState terminating with degradation.\n";
@@ -1951,6 +3406,38 @@ void validState(slide::State &s, slide::State &s_ini)
 	// throw an error if one of the states was invalid
 }
 
+void Cell::integrate(const slide::states_type &dstates, double dti, bool blockDegradation)
+{
+	/*
+	 * Forward Euler time integration s(t+dt) = s(t) + ds/dt * dt of the blocks of states which can change in a time step.
+	 * The blocks of the features which are off have a time derivative of 0 (see dState), so they are skipped,
+	 * and the states are changed in place rather than copied, such that the unused blocks cost nothing.
+	 *
+	 * IN
+	 * dstates 			time derivatives of the states
+	 * dti 				time step [s]
+	 * blockDegradation if true, the degradation states are skipped
+	 */
+
+	using slide::State;
+	using settings::nch;
+	s.step(dstates, dti, 0, 2 * nch + 1);					   // zp, zn, T
+	s.step(dstates, dti, State::i_psd, 2 * nch * (psd.n - 1)); // particle-size classes which are used
+	if (OCV_curves.hys_pos || OCV_curves.hys_neg)
+		s.step(dstates, dti, State::i_hys, settings::ns_hys);
+	if (blockDegradation)
+		return;
+
+	s.step(dstates, dti, 2 * nch + 1, State::i_xdeg - 2 * nch - 1); // built-in degradation states
+	if (deg_id.user_n > 0)
+		s.step(dstates, dti, State::i_xdeg, settings::ns_deg);
+	if (deg_id.pl_id != 0 || deg_id.user_n > 0) // the user-defined models can have a plating rate
+		s.step(dstates, dti, State::i_pl, settings::ns_pl);
+	if (deg_id.CAT_n > 0)
+		s.step(dstates, dti, State::i_cat, settings::ns_cat);
+	// the states of the thermal management are changed by controlTemperature, their time derivatives are 0
+}
+
 void Cell::ETI(bool print, double dti, bool blockDegradation)
 {
 	/*
@@ -1982,17 +3469,16 @@ void Cell::ETI(bool print, double dti, bool blockDegradation)
 	if (sparam.s_lares) // only a few degradation models need the stress according to Laresgoiti
 		updateLaresgoitiStress(print);
 
-	// Calculate the time derivatives
-	slide::states_type states = s.getStates_arr();
+	// Update the heater and coolant loop of the thermal management for this time step
+	controlTemperature(dti);
+	dt_step = dti;
 
 	// calculate time derivatives, electr = 0 to account for both electrodes (i.e. cycle the full cell)
-	const slide::states_type dstates = dState(print, blockDegradation, 0); // arrays with the state and dstate/dt
-
-	// forward Euler time integration: s(t+1) = s(t) + ds/dt * dt
-	for (int i = 0; i < settings::ns; i++) // loop for all states
-		states[i] += dti * dstates[i];
+	const slide::states_type dstates = dState(print, blockDegradation, 0); // array with dstate/dt
 
-	setStates(std::move(states)); // store new states, checks if they are illegal (throws an error in that case)
+	// forward Euler time integration: s(t+1) = s(t) + ds/dt * dt, checks if the states are illegal (throws an error in that case)
+	validState();
+	integrate(dstates, dti, blockDegradation);
 
 	// the stress values stored in the class variables for stress are no longer valid because the state has changed
 	sparam.s_dai_update = false;
@@ -2002,6 +3488,83 @@ void Cell::ETI(bool print, double dti, bool blockDegradation)
 		std::cout << "Cell::ETI terminating.\n";
 }
 
+void Cell::ETI_rest(bool print, double dti, bool blockDegradation)
+{
+	/*
+	 * Performs one time step of dti seconds while the cell is resting, which stays stable for time steps of minutes to hours.
+	 * The transformed concentrations are the coordinates along the eigenvectors of the diffusion matrices, so each of them follows
+	 * dz/dt = D * A * z + B * j with a constant A and, at rest, a slowly varying flux j (only the side reactions).
+	 * These are integrated exactly for a constant flux, z(t+dt) = z(t) + dz/dt * dt * (exp(D A dt) - 1) / (D A dt),
+	 * and the temperature is integrated in the same way with the rate of the heat exchange with the environment and the coolant loop.
+	 * The other (degradation) states change slowly at rest and are integrated with forward Euler, as in ETI.
+	 *
+	 * IN
+	 * print 			boolean indicating if we want to print error messages or not
+	 * dti 				time step [s]
+	 * blockDegradation if true, degradation is not accounted for in this time step
+	 *
+	 * THROWS
+	 * 109 				the cell current is not 0
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::ETI_rest starting.\n";
+
+	if (Icell != 0)
+	{
+		std::cerr << "ERROR in Cell::ETI_rest, the cell current is " << Icell << " but the cell must be resting. Throwing an error.\n";
+		throw 109;
+	}
+
+	// the stress in this and the previous time step, as in ETI
+	sparam.s_dai_p_prev = sparam.s_dai_p;
+	sparam.s_dai_n_prev = sparam.s_dai_n;
+	sparam.s_lares_n_prev = sparam.s_lares_n;
+	if (sparam.s_dai)
+		updateDaiStress();
+	if (sparam.s_lares)
+		updateLaresgoitiStress(print);
+
+	controlTemperature(dti);
+	dt_step = dti;
+
+	slide::states_type dstates = dState(print, blockDegradation, 0);
+
+	// (exp(x) - 1) / x, which is 1 for the uniform concentration (x = 0) and 1/|x| for modes which decay much faster than the time step
+	auto phi = [](double x) { return (std::abs(x) < 1e-10) ? 1.0 : std::expm1(x) / x; };
+
+	// the exact integration is a forward Euler step with the time derivatives scaled by phi
+	using PhyConst::Rg;
+	using settings::nch;
+	const double Dpt = s.get_Dp() * std::exp(Dp_T / Rg * (1 / T_ref - 1 / s.get_T())); // diffusion constants at the cell's temperature, as in dState
+	const double Dnt = s.get_Dn() * std::exp(Dn_T / Rg * (1 / T_ref - 1 / s.get_T()));
+	for (int j = 0; j < nch; j++)
+	{
+		dstates[j] *= phi(Dpt * M.Ap[j] * dti);
+		dstates[nch + j] *= phi(Dnt * M.An[j] * dti);
+		for (int k = 1; k < psd.n; k++)
+		{
+			const int ip = slide::State::i_psd + 2 * nch * (k - 1) + j;
+			dstates[ip] *= phi(psd.dp[k] * Dpt / (psd.fp[k] * psd.fp[k]) * M.Ap[j] * dti);
+			dstates[ip + nch] *= phi(psd.dn[k] * Dnt / (psd.fn[k] * psd.fn[k]) * M.An[j] * dti);
+		}
+	}
+
+	// the temperature relaxes to the environment (and coolant) with the rate kT
+	const double kT = (Qch * SAV + s.get_ucool() * tmparam.Hcool / (L * elec_surf)) / (rho * Cp);
+	dstates[2 * nch] *= phi(-kT * dti);
+
+	// the other states with forward Euler, checks if the states are illegal (throws an error in that case)
+	validState();
+	integrate(dstates, dti, blockDegradation);
+
+	sparam.s_dai_update = false;
+	sparam.s_lares_update = false;
+
+	if constexpr (settings::verbose >= printLevel::printCellFunctions)
+		std::cout << "Cell::ETI_rest terminating.\n";
+}
+
 void Cell::ETI_electr(bool print, double I, double dti, bool blockDegradation, bool pos)
 {
 	/*
@@ -2048,17 +3611,11 @@ void Cell::ETI_electr(bool print, double I, double dti, bool blockDegradation, b
 			   // so here 'cheat it' and directly set the current
 			   // this means you avoid the checks done in setI, so you don't know if the current is feasible or not
 
-	// Calculate the time derivatives
-	slide::states_type states = s.getStates_arr();
-
 	// calculate time derivatives of the positive or negative electrode
-	const slide::states_type dstates = pos ? dState(print, blockDegradation, 1) : dState(print, blockDegradation, 2); // arrays with the state and dstate/dt
+	const slide::states_type dstates = pos ? dState(print, blockDegradation, 1) : dState(print, blockDegradation, 2); // array with dstate/dt
 
 	// forward Euler time integration: s(t+1) = s(t) + ds/dt * dt
-	for (int i = 0; i < settings::ns; i++) // loop for all states
-		states[i] += dti * dstates[i];
-
-	s.setStates(std::move(states)); // store new states
+	integrate(dstates, dti, blockDegradation);
 
 	// the stress values stored in the class variables for stress are no longer valid because the state has changed
 	sparam.s_dai_update = false;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <vector>
+#include <complex>
 #include <array>
 #include <iostream>
 
@@ -30,6 +31,11 @@
 
 //#include <string>
 
+namespace slide::estimation
+{
+	class Plant;
+}
+
 using sigma_type = std::array<double, settings::nch + 2>;
 
 // Free functions:
@@ -72,6 +78,7 @@ protected: // protected such that child classes can access the class variables
 	double kp_T; // activation energy for the Arrhenius relation of kp
 	double kn;	 // rate constant of main reaction at negative electrode at reference temperature
 	double kn_T; // activation energy for the Arrhenius relation of kn
+	double Cdl;	 // double-layer capacitance per unit particle surface, only used for the impedance [F m-2]
 	// The diffusion constants at reference temperature are part of State because they can change over the battery's lifetime
 	double Dp_T; // activation energy for the Arrhenius relation of Dp
 	double Dn_T; // activation energy for the Arrhenius relation of Dn
@@ -98,7 +105,17 @@ protected: // protected such that child classes can access the class variables
 	double Rn;		  // radius of the negative sphere of the Single Particle model [m]
 	// other geometric parameters are part of State because they can change over the battery's lifetime
 
-	struct StressParam sparam; // Stress parameters.
+	struct StressParam sparam;	 // Stress parameters.
+	struct PSDparam psd;		 // particle-size distribution, by default a single particle per electrode
+	struct SwellParam swparam;	 // parameters of the swelling model and the fixture
+	struct ThermalParam tmparam; // thermal management (heater, coolant loop and their controller)
+	double dt_step{0};			 // time step of the ongoing time integration [s]
+
+	struct
+	{
+		double Qp{-1}, Qn{0}, nLi{0}, Vmax{0}, Vmin{0}; // electrode capacities, cyclable lithium [Ah] and voltage limits [V] of the stored windows
+		double win[4]{};								// stoichiometry windows [-]
+	} balance;											// last result of getElectrodeBalance, reused while the capacities, lithium and limits don't change
 
 	// Constants and parameters for the SEI growth model
 	double nsei;			  // number of electrons involved in the SEI reaction [-]
@@ -125,6 +142,9 @@ protected: // protected such that child classes can access the class variables
 	double rhopl;			// density of the plated lithium layer
 	struct PLparam plparam; // structure with the fitting parameters of the different plating models
 
+	// cathode side reaction parameters
+	struct CATparam catparam; // structure with the fitting parameters of the side reactions at the cathode
+
 	// Matrices for spatial discretisation of the solid diffusion model
 	struct slide::Model M;
 
@@ -150,10 +170,20 @@ protected: // protected such that child classes can access the class variables
 	void SEI(double OCVnt, double etan, double *isei, double *den);																				// calculate the effect of SEI growth
 	void CS(double OCVnt, double etan, double *isei_multiplyer, double *dCS, double *dDn);														// calculate the effect of surface crack growth
 	void LAM(bool critical, double zp_surf, double etap, double *dthickp, double *dthickn, double *dap, double *dan, double *dep, double *den); // calculate the effect of LAM
-	void LiPlating(double OCVnt, double etan, double *isei);																					// calculate the effect of lithium plating
+	void LiPlating(double OCVnt, double etan, double *ipl, double *istrip);																					// calculate the effect of lithium plating
+	void CAT(bool print, double zp_surf, double etap, double *iox, double *ish);																			// calculate the side reactions at the cathode
+	void userDegradation(double zp_surf, double zn_surf, double OCVnt, double etap, double etan, slide::deg::Rates &r, double dxdeg[]);		// calculate the effect of the user-defined degradation models
+
+	// particle-size distribution
+	void splitFlux(double jp, double jn, double jpk[], double jnk[]);								// split the molar flux over the particle-size classes
+	void psdSideReactions(bool print, const double jnk[], double Dnt, double iseik[], double iplk[], double istripk[]); // SEI growth and plating on the particle-size classes of the anode
+
+	// thermal management
+	void controlTemperature(double dti); // update the actuators of the thermal management and accumulate their energy use
 
 	// Calculate the time derivatives of the states at the actual cell current (state-space model)
 	slide::states_type dState(bool critical, bool blockDegradation, int electr);
+	void integrate(const slide::states_type &dstates, double dti, bool blockDegradation); // forward Euler step of the blocks of states which can change
 
 public:
 	// Constructor
@@ -189,6 +219,18 @@ public:
 		*Tref = T_ref;
 	}
 
+	void getRadius(double *R_p, double *R_n) noexcept // get the radius of the particles
+	{
+		/*
+	 	* Function to get the radius of the spheres of the Single Particle model
+	 	* OUT
+	 	* R_p 	radius of the positive particle [m]
+	 	* R_n 	radius of the negative particle [m]
+	 	*/
+		*R_p = Rp;
+		*R_n = Rn;
+	}
+
 	double getR() noexcept // get the total cell DC resistance
 	{
 		/*
@@ -208,8 +250,18 @@ public:
 	void getStates(slide::State &si, double *I);
 
 	void getCSurf(double *cps, double *cns);																					 // get the surface concentrations
+	void getUtilisation(double up[], double un[]);																				 // get the mean li-fraction of each particle class
+	void getElectrodeBalance(double *Qp, double *Qn, double *nLi, double win[4]);												 // get the electrode capacities, cyclable lithium and stoichiometry windows
+	double getSOC();																											 // get the state of charge from the lithium in the anode
+	void getIndicators(double *SOC, double *cap, double *SOH, double *Eav);														 // get the SOC, capacity, SOH and available energy from the states
+	void getEquilibriumCurve(int n, std::vector<double> &Q, std::vector<double> &V);											 // get the equilibrium discharge curve from the electrode OCV curves
+	void getImpedance(const std::vector<double> &freq, std::vector<std::complex<double>> &Z);									 // get the impedance linearised around the present state
+	void getPlant(slide::estimation::Plant &p);																					 // get a frozen copy of the model for state estimation
+	void getSwelling(double *dL, double *P);																					 // get the change in cell thickness and the stack pressure
 	void getC(double cp[], double cn[]);																						 // get the concentrations at all nodes
 	bool getVoltage(bool print, double *V, double *OCVp, double *OCVn, double *etap, double *etan, double *Rdrop, double *Temp); // get the cell's voltage
+	double getVoltageAt(bool print, double I);																					 // get the voltage at a different current without changing the states
+	double getPlatingPotentialAt(bool print, double I);																			 // get the anode potential relative to the plating reaction at a different current
 
 	void getDaiStress(double *sigma_p, double *sigma_n, sigma_type &sigma_r_p, sigma_type &sigma_r_n, sigma_type &sigma_t_p, sigma_type &sigma_t_n,
 					  sigma_type &sigma_h_p, sigma_type &sigma_h_n) noexcept; // get the stresses at all nodes according to Dai's stress model
@@ -224,6 +276,45 @@ public:
 	void setStates(const slide::State &si, double I); // set the cell's states to the states in the State object and the cell current to the given value
 	void setC(double cp0, double cn0);				  // set the concentrations to the given (uniform) concentration
 	void setI(bool critical, bool check, double I);	  // set the cell's current to the specified value
+	void setPSD(int nclass, const double fp[], const double wp[], const double fn[], const double wn[]); // set the particle-size distribution of both electrodes
+	void setMaterial(bool pos, int k, const std::string &nameOCV, double cmax, double D);							   // set the material of a particle class of a blended electrode
+	void setHysteresis(bool pos, const std::string &namech, const std::string &namedis, double gamma, double h0); // enable voltage hysteresis for one electrode
+	void setFixture(double K, double P0, int nlayer);																   // clamp the cell in a fixture at its present thickness
+	void setPressureFeedback(double gsei, double glam, double gpl, double pref);									   // set the effect of the stack pressure on the degradation rates
+	void setHeater(double Pmax, double Theat);																		   // add a heater which heats the cell below a temperature
+	void setCoolant(double H, double Tcoolant, double Tcool, double COP);											   // add a coolant loop which cools the cell above a temperature
+	void setThermalController(int mode, double band, double Kp, double Ki);											   // set the controller of the heater and coolant loop
+	bool isThermalControlled() const { return tmparam.mode != 0; }													   // true if the thermal management is active
+	void getThermalReport(double *Eheat, double *Ecool, double tregime[3]);											   // get the energy used by the thermal management and the time spent in each regime
+	void resetThermalReport();																						   // set the energy and time of the thermal management to 0
+	const PSDparam &getPSD() const { return psd; }																	   // get the particle-size distribution
+	const DEG_ID &getDegID() const { return deg_id; }																   // get the identification of the degradation models
+
+	void pauseThermalControl(bool pause)
+	{
+		// switch the thermal management off (or on again) without changing its settings
+		tmparam.paused = pause;
+		s.get_uheat() = 0;
+		s.get_ucool() = 0;
+	}
+
+	void getDegradationParam(SEIparam *sei, CSparam *cs, LAMparam *lam, PLparam *pl) const
+	{
+		// get the fitting parameters of the degradation models
+		*sei = seiparam;
+		*cs = csparam;
+		*lam = lamparam;
+		*pl = plparam;
+	}
+
+	void setDegradationParam(const SEIparam &sei, const CSparam &cs, const LAMparam &lam, const PLparam &pl)
+	{
+		// set the fitting parameters of the degradation models, e.g. to infer them from ageing data
+		seiparam = sei;
+		csparam = cs;
+		lamparam = lam;
+		plparam = pl;
+	}
 
 	// State related functions
 	void validState() { ::validState(s, s_ini); }
@@ -244,6 +335,7 @@ public:
 	// time integration
 	void ETI(bool print, double dti, bool blockDegradation);							// step forward in time using forward Eurler time integration
 	void ETI_electr(bool print, double I, double dti, bool blockDegradation, bool pos); // step forward with only one electrode using forward Euler time integration
+	void ETI_rest(bool print, double dti, bool blockDegradation);						// step forward while resting with a time step of minutes to hours
 
 	// Utility
 	void checkModelparam(); // check if the inputs to the Matlab code are the same as the ones here in the C++ code
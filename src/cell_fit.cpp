@@ -92,6 +92,7 @@ Cell_Fit::Cell_Fit(const slide::Model &MM, int verbosei)
 	kp_T = 58000;
 	kn = 1.7640e-11; // characterisation fitting parameter (at Tref)
 	kn_T = 20000;
+	Cdl = 0.2; // double-layer capacitance, typical value of 20 uF cm-2
 	// The diffusion coefficients at reference temperature are part of 'State'.
 	// The values are set in the block of code below ('Initialise state variables')
 	Dp_T = 29000;
@@ -195,6 +196,26 @@ Cell_Fit::Cell_Fit(const slide::Model &MM, int verbosei)
 	// fitting parameters
 	plparam.pl1k = 0;
 	plparam.pl1k_T = 0;
+	plparam.pl2k = 0;
+	plparam.pl2k_T = 0;
+	plparam.pl2ks = 0;
+	plparam.pl2alpha = 0.5;
+	plparam.pl2gamma = 0;
+	plparam.pl2delta0 = 1e-9;
+
+	// swelling, the cell is not clamped and the swelling is relative to the initial state
+	setFixture(0, 0, 1);
+
+	// side reactions at the cathode
+	catparam.cat1k = 1e-5;
+	catparam.cat1k_T = 5e4;
+	catparam.cat1U = 4.2;
+	catparam.cat1alpha = 0.5;
+	catparam.cat1r = 2e-5;
+	catparam.cat2k = 3e-5;
+	catparam.cat2k_T = 3e4;
+	catparam.cat2U = 4.1;
+	catparam.cat2alpha = 0.5;
 
 	// degradation identifiers: no degradation
 	deg_id.SEI_id[0] = 0;	 // no SEI growth
@@ -89,6 +89,7 @@ namespace slide
 		kp_T = 58000;
 		kn = 1.7640e-11; // characterisation fitting parameter (at Tref)
 		kn_T = 20000;
+		Cdl = 0.2; // double-layer capacitance, typical value of 20 uF cm-2
 		// The diffusion coefficients at reference temperature are part of 'State'.
 		// The values are set in the block of code below ('Initialise state variables')
 		Dp_T = 29000;
@@ -170,6 +171,26 @@ namespace slide
 		// fitting parameters
 		plparam.pl1k = 4.5e-10;
 		plparam.pl1k_T = -2.014008e5;
+		plparam.pl2k = 4.5e-10;
+		plparam.pl2k_T = -2.014008e5;
+		plparam.pl2ks = 2e-4;
+		plparam.pl2alpha = 0.5;
+		plparam.pl2gamma = 1e-4;
+		plparam.pl2delta0 = 1e-9;
+
+		// swelling, the cell is not clamped and the swelling is relative to the initial state
+		setFixture(0, 0, 1);
+
+		// side reactions at the cathode
+		catparam.cat1k = 1e-5;
+		catparam.cat1k_T = 5e4;
+		catparam.cat1U = 4.2;
+		catparam.cat1alpha = 0.5;
+		catparam.cat1r = 2e-5;
+		catparam.cat2k = 3e-5;
+		catparam.cat2k_T = 3e4;
+		catparam.cat2U = 4.1;
+		catparam.cat2alpha = 0.5;
 
 		// degradation identifiers: no degradation
 		deg_id.SEI_id[0] = 0;	 // no SEI growth
@@ -214,6 +235,10 @@ namespace slide
 		// check if we need to calculate the stress according to Laresgoiti's stress model
 		for (int i = 0; i < deg_id.CS_n; i++)
 			sparam.s_lares = sparam.s_lares || deg_id.CS_id[i] == 1;
+
+		// check if one of the user-defined degradation models needs one of the stress models
+		sparam.s_dai = sparam.s_dai || deg_id.userNeeds(slide::deg::in_stressDai);
+		sparam.s_lares = sparam.s_lares || deg_id.userNeeds(slide::deg::in_stressLares);
 	}
 
 } // namespace slide
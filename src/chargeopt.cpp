@@ -0,0 +1,487 @@
+/*
+ * chargeopt.cpp
+ *
+ * Implements the evaluation of charge protocols, the derivative-free optimisers and the Pareto front.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "chargeopt.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "basic_cycler.hpp"
+#include "cell_KokamNMC.hpp"
+#include "cell_LGChemNMC.hpp"
+#include "cell_user.hpp"
+#include "fastcharge.hpp"
+#include "util.hpp"
+
+namespace slide::chargeopt
+{
+	using protocol::above;
+	using protocol::below;
+	using protocol::Protocol;
+	using protocol::Var;
+
+	namespace
+	{
+		constexpr double Jfail = std::numeric_limits<double>::max(); // objective of a failed evaluation
+
+		void evaluateAll(const Cell &c, const Space &sp, const Objective &o, const std::vector<Par> &xs, std::vector<Evaluation> &out)
+		{
+			// evaluate the points in parallel
+			out.assign(xs.size(), Evaluation{});
+			auto task_indv = [&](int i)
+			{
+				out[i] = evaluate(c, sp.decode(xs[i]), o);
+				out[i].x = xs[i];
+			};
+			slide::run(task_indv, static_cast<int>(xs.size()));
+		}
+
+		std::vector<Par> latinHypercube(int n, int d, std::mt19937_64 &gen)
+		{
+			// n points in the unit hypercube, with one point in every one of n slices along every dimension
+			std::uniform_real_distribution<double> U(0, 1);
+			std::vector<Par> xs(n, Par(d));
+			std::vector<int> perm(n);
+			for (int j = 0; j < d; j++)
+			{
+				std::iota(perm.begin(), perm.end(), 0);
+				std::shuffle(perm.begin(), perm.end(), gen);
+				for (int i = 0; i < n; i++)
+					xs[i][j] = (perm[i] + U(gen)) / n;
+			}
+			return xs;
+		}
+
+		bool converged(const std::vector<Evaluation> &pts, double tol)
+		{
+			// the objectives of all points differ by less than tol relative to the best one
+			double Jmin = Jfail, Jmax = -Jfail;
+			for (const auto &e : pts)
+			{
+				if (!e.ok)
+					return false;
+				Jmin = std::min(Jmin, e.J);
+				Jmax = std::max(Jmax, e.J);
+			}
+			return Jmax - Jmin <= tol * std::abs(Jmin);
+		}
+	} // namespace
+
+	Design Space::decode(const Par &x) const
+	{
+		/*
+		 * Design of a point in the unit hypercube, every coordinate is scaled linearly between its bounds:
+		 * 		x[0 .. n-1] 	current of the stages
+		 * 		x[n .. 2n-2] 	SOCs at which the stages switch, they are sorted so the stages are in order
+		 * 		x[2n-1] 		voltage of the CV phase
+		 * 		x[2n] 			environmental temperature during the charge
+		 * Coordinates outside [0, 1] are clipped.
+		 *
+		 * THROWS
+		 * 1020 	x does not have the dimension of the space
+		 */
+
+		const int n = nStages;
+		if (n < 1 || static_cast<int>(x.size()) != dimension())
+		{
+			std::cerr << "ERROR in chargeopt::Space::decode, the point has " << x.size() << " coordinates but the space with "
+					  << n << " stages has dimension " << dimension() << ". Throwing an error.\n";
+			throw 1020;
+		}
+
+		auto u = [&](int j) { return std::clamp(x[j], 0.0, 1.0); };
+		Design d;
+		for (int k = 0; k < n; k++)
+			d.I.push_back(Imin + u(k) * (Imax - Imin));
+		for (int k = 0; k < n - 1; k++)
+			d.SOC.push_back(SOCmin + u(n + k) * (SOCmax - SOCmin));
+		std::sort(d.SOC.begin(), d.SOC.end());
+		d.Vcv = Vmin + u(2 * n - 1) * (Vmax - Vmin);
+		d.T = Tmin + u(2 * n) * (Tmax - Tmin);
+		return d;
+	}
+
+	Evaluation evaluate(const Cell &c, const Design &d, const Objective &o)
+	{
+		/*
+		 * Cycle a copy of the cell nCycles times with a charge protocol and evaluate the objective
+		 * 		J = wTime * tCharge + wSEI * lossSEI + wPl * lossPl + wT * max(Tmax - Tlimit, 0)
+		 * with the charge time in hours and the lithium losses in % of the nominal capacity per 100 cycles.
+		 * Every cycle is a CC discharge to the minimum voltage at Tamb, a rest at the set-point d.T and the charge.
+		 * No cycling data is written.
+		 *
+		 * IN
+		 * c 	cell, at any state
+		 * d 	charge protocol
+		 * o 	cycling and weights of the objective
+		 *
+		 * OUT
+		 * Evaluation 	charge time, losses and maximum temperature of the cycles, ok is false if they failed
+		 */
+
+		Evaluation e;
+		e.d = d;
+		e.J = Jfail;
+		if (o.nCycles < 1)
+			return e;
+
+		try
+		{
+			Cell c0 = c;
+			BasicCycler cy(c0, "ChargeOptimisation", 0, -1);
+			auto &ci = cy.getCell(); // the cycler works on a copy of the cell
+			const double Qnom = ci.getNominalCap();
+			const double Idis = (o.Idis > 0) ? o.Idis : Qnom;
+			const double Icut = (o.Icut > 0) ? o.Icut : Qnom / 20;
+
+			// the last stage ends at the voltage of the CV phase
+			std::vector<double> until(d.SOC);
+			until.push_back(2);
+			Protocol pc = fastcharge::stepped(d.I, until, Var::SOC, d.Vcv, Icut);
+			Protocol pd;
+			pd.Tenv(o.Tamb).CC(Idis, {below(Var::V, ci.getVmin())}).Tenv(d.T).rest(o.trest);
+
+			slide::State s;
+			double I, SOC, cap0, cap, SOH, Eav;
+			ci.getStates(s, &I);
+			const double LLI0 = s.get_LLI(), pl0 = s.get_Li_pl() + s.get_Li_dead();
+			ci.getIndicators(&SOC, &cap0, &SOH, &Eav);
+
+			double t = 0;
+			for (int k = 0; k < o.nCycles; k++)
+			{
+				protocol::Run r;
+				cy.runProtocol(pd, false, ci.getVmax(), ci.getVmin(), r);
+				const auto res = fastcharge::charge(cy, pc, false, o.SOCmark);
+				if (r.end <= 0 || res.end <= 0 || res.tmark < 0)
+					return e;
+				t += res.tmark;
+				e.Tmax = std::max({e.Tmax, r.Tmax, res.Tmax});
+			}
+
+			ci.getStates(s, &I);
+			ci.getIndicators(&SOC, &cap, &SOH, &Eav);
+			e.tCharge = t / o.nCycles;
+			e.lossPl = (s.get_Li_pl() + s.get_Li_dead() - pl0) / 3600;
+			e.lossSEI = (s.get_LLI() - LLI0) / 3600 - e.lossPl; // the lost lithium includes the plated lithium
+			e.fade = 1 - cap / cap0;
+			e.ok = true;
+
+			const double per100 = 100.0 / o.nCycles * 100 / Qnom; // from [Ah] over all cycles to [%] per 100 cycles
+			e.J = o.wTime * e.tCharge / 3600 + o.wSEI * e.lossSEI * per100 + o.wPl * e.lossPl * per100 + o.wT * std::max(e.Tmax - o.Tlimit, 0.0);
+		}
+		catch (int)
+		{
+			e.ok = false;
+			e.J = Jfail;
+		}
+		return e;
+	}
+
+	Result optimise(const Cell &c, const Space &sp, const Objective &o, const Settings &s)
+	{
+		/*
+		 * Search the design with the lowest objective with differential evolution or Nelder-Mead (see Settings::method).
+		 * The search stops after the given number of generations or evaluations, or once the objectives of the population
+		 * (or the vertices of the simplex) differ by less than tol relative to the best one.
+		 *
+		 * THROWS
+		 * 1020 	illegal settings or bounds
+		 */
+
+		// #NOTHOTFUNCTION
+		const int d = sp.dimension();
+		bool legal = sp.nStages >= 1 && sp.Imin > 0 && sp.Imin <= sp.Imax && sp.SOCmin > 0 && sp.SOCmin <= sp.SOCmax && sp.SOCmax < 1
+					 && sp.Vmin <= sp.Vmax && sp.Tmin <= sp.Tmax && o.nCycles >= 1 && s.tol >= 0;
+		if (s.method == Method::DE)
+			legal = legal && s.population >= 4 && s.generations >= 0 && s.F > 0 && s.CR >= 0 && s.CR <= 1;
+		else
+			legal = legal && s.population >= 0 && s.maxEvaluations > d && s.step > 0 && (s.x0.empty() || static_cast<int>(s.x0.size()) == d);
+		if (!legal)
+		{
+			std::cerr << "ERROR in chargeopt::optimise, illegal settings: the bounds of the designs must be increasing with currents above 0 "
+					  << "and SOCs in (0, 1), differential evolution needs at least 4 points, and Nelder-Mead needs more evaluations than "
+					  << d << " and a starting point of dimension " << d << ". Throwing an error.\n";
+			throw 1020;
+		}
+
+		Result res;
+		std::mt19937_64 gen(s.seed);
+		std::uniform_real_distribution<double> U(0, 1);
+		std::vector<Evaluation> ev;
+		auto evaluatePoints = [&](const std::vector<Par> &xs)
+		{
+			evaluateAll(c, sp, o, xs, ev);
+			res.all.insert(res.all.end(), ev.begin(), ev.end());
+			return ev;
+		};
+		auto better = [](const Evaluation &a, const Evaluation &b) { return a.J < b.J; };
+
+		if (s.method == Method::DE)
+		{
+			auto pop = evaluatePoints(latinHypercube(s.population, d, gen));
+			std::uniform_int_distribution<int> Ri(0, s.population - 1), Rj(0, d - 1);
+			for (int g = 0; g < s.generations && !converged(pop, s.tol); g++)
+			{
+				// rand/1/bin trial points, coordinates outside the hypercube bounce back between the parent and the bound
+				std::vector<Par> xs(s.population);
+				for (int i = 0; i < s.population; i++)
+				{
+					int r1, r2, r3;
+					do
+						r1 = Ri(gen);
+					while (r1 == i);
+					do
+						r2 = Ri(gen);
+					while (r2 == i || r2 == r1);
+					do
+						r3 = Ri(gen);
+					while (r3 == i || r3 == r1 || r3 == r2);
+
+					const auto &xi = pop[i].x;
+					const int jr = Rj(gen);
+					xs[i] = xi;
+					for (int j = 0; j < d; j++)
+						if (j == jr || U(gen) < s.CR)
+						{
+							double v = pop[r1].x[j] + s.F * (pop[r2].x[j] - pop[r3].x[j]);
+							if (v < 0)
+								v = U(gen) * xi[j];
+							else if (v > 1)
+								v = xi[j] + U(gen) * (1 - xi[j]);
+							xs[i][j] = v;
+						}
+				}
+
+				const auto trial = evaluatePoints(xs);
+				for (int i = 0; i < s.population; i++)
+					if (trial[i].J <= pop[i].J)
+						pop[i] = trial[i];
+			}
+		}
+		else
+		{
+			// start from the best point of a sample, or from x0
+			Par x0 = s.x0.empty() ? Par(d, 0.5) : s.x0;
+			if (s.population > 0)
+			{
+				const auto smp = evaluatePoints(latinHypercube(s.population, d, gen));
+				x0 = std::min_element(smp.begin(), smp.end(), better)->x;
+			}
+			std::vector<Par> xs(d + 1, x0);
+			for (int j = 0; j < d; j++)
+				xs[j + 1][j] += (x0[j] + s.step <= 1) ? s.step : -s.step;
+			auto spx = evaluatePoints(xs);
+
+			auto clip = [](Par &x)
+			{
+				for (auto &xj : x)
+					xj = std::clamp(xj, 0.0, 1.0);
+			};
+			while (static_cast<int>(res.all.size()) < s.maxEvaluations)
+			{
+				std::sort(spx.begin(), spx.end(), better);
+				if (converged(spx, s.tol))
+					break;
+
+				// centroid of all vertices but the worst one, and the candidates along the line through the worst one
+				Par cen(d, 0);
+				for (int i = 0; i < d; i++)
+					for (int j = 0; j < d; j++)
+						cen[j] += spx[i].x[j] / d;
+				std::vector<Par> cand(4, cen); // reflection, expansion, outside and inside contraction
+				const double coef[4] = {1, 2, 0.5, -0.5};
+				for (int k = 0; k < 4; k++)
+				{
+					for (int j = 0; j < d; j++)
+						cand[k][j] += coef[k] * (cen[j] - spx[d].x[j]);
+					clip(cand[k]);
+				}
+				const auto ce = evaluatePoints(cand);
+
+				bool shrink = false;
+				if (ce[0].J < spx[0].J)
+					spx[d] = (ce[1].J < ce[0].J) ? ce[1] : ce[0];
+				else if (ce[0].J < spx[d - 1].J)
+					spx[d] = ce[0];
+				else if (ce[0].J < spx[d].J)
+				{
+					if (ce[2].J <= ce[0].J)
+						spx[d] = ce[2];
+					else
+						shrink = true;
+				}
+				else if (ce[3].J < spx[d].J)
+					spx[d] = ce[3];
+				else
+					shrink = true;
+
+				if (shrink)
+				{
+					std::vector<Par> xsh(d);
+					for (int i = 1; i <= d; i++)
+					{
+						xsh[i - 1] = spx[0].x;
+						for (int j = 0; j < d; j++)
+							xsh[i - 1][j] += 0.5 * (spx[i].x[j] - spx[0].x[j]);
+					}
+					const auto sh = evaluatePoints(xsh);
+					std::copy(sh.begin(), sh.end(), spx.begin() + 1);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < res.all.size(); i++)
+			if (res.all[i].ok && (res.best < 0 || res.all[i].J < res.all[res.best].J))
+				res.best = static_cast<int>(i);
+		res.front = paretoFront(res.all, o.Tlimit);
+		return res;
+	}
+
+	std::vector<int> paretoFront(const std::vector<Evaluation> &all, double Tlimit)
+	{
+		/*
+		 * Designs for which no other design charges faster with at most the same capacity fade, or fades less with at most the same charge time.
+		 * Only designs which were evaluated successfully and stayed below Tlimit are included. The front is sorted by increasing charge time.
+		 */
+
+		std::vector<int> idx;
+		for (size_t i = 0; i < all.size(); i++)
+			if (all[i].ok && all[i].Tmax <= Tlimit)
+				idx.push_back(static_cast<int>(i));
+		std::sort(idx.begin(), idx.end(), [&](int a, int b)
+				  { return (all[a].tCharge < all[b].tCharge) || (all[a].tCharge == all[b].tCharge && all[a].fade < all[b].fade); });
+
+		std::vector<int> front;
+		for (auto i : idx)
+			if (front.empty() || all[i].fade < all[front.back()].fade)
+				front.push_back(i);
+		return front;
+	}
+
+	void write(const Result &r, const std::string &name)
+	{
+		/*
+		 * Write all evaluations to name_evaluations.csv and the Pareto front to name_pareto.csv in the results folder,
+		 * with one row per design:
+		 * 		evaluation number, ok, objective, charge time [s], lithium lost to the SEI and to plating [Ah], capacity fade [-], maximum temperature [K],
+		 * 		CV voltage [V], temperature set-point [K], currents of the stages [A], SOCs at which the stages switch [-]
+		 * The best design is the first row of the front file.
+		 *
+		 * THROWS
+		 * 1001 	a file could not be opened
+		 */
+
+		auto writeFile = [&](const std::string &suffix, const std::vector<int> &rows)
+		{
+			std::ofstream out(PathVar::results + (name + suffix), std::ios_base::out);
+			if (!out.is_open())
+			{
+				std::cerr << "ERROR in chargeopt::write. File " << name << suffix << " could not be opened. Throwing an error.\n";
+				throw 1001;
+			}
+			out << "evaluation,ok,objective,charge time,SEI loss,plating loss,fade,Tmax,Vcv,T";
+			const size_t n = r.all.empty() ? 0 : r.all[0].d.I.size();
+			for (size_t k = 0; k < n; k++)
+				out << ",I" << k + 1;
+			for (size_t k = 0; k + 1 < n; k++)
+				out << ",SOC" << k + 1;
+			out << '\n';
+			for (auto i : rows)
+			{
+				const auto &e = r.all[i];
+				out << i << ',' << e.ok << ',' << (e.ok ? e.J : 0) << ',' << e.tCharge << ',' << e.lossSEI << ',' << e.lossPl << ','
+					<< e.fade << ',' << e.Tmax << ',' << e.d.Vcv << ',' << e.d.T;
+				for (auto I : e.d.I)
+					out << ',' << I;
+				for (auto soc : e.d.SOC)
+					out << ',' << soc;
+				out << '\n';
+			}
+		};
+
+		std::vector<int> rows(r.all.size());
+		std::iota(rows.begin(), rows.end(), 0);
+		writeFile("_evaluations.csv", rows);
+
+		rows.clear();
+		if (r.best >= 0)
+			rows.push_back(r.best);
+		rows.insert(rows.end(), r.front.begin(), r.front.end());
+		writeFile("_pareto.csv", rows);
+	}
+} // namespace slide::chargeopt
+
+void ChargeOptimisation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to optimise a three-stage fast-charge protocol for a cell, and to find the Pareto front of charge time versus capacity fade.
+	 * The currents range from 0.5C to 4C, the stages switch between 10 and 70% SOC, the CV voltage is between 0.1 V below the maximum voltage
+	 * and the maximum voltage, and the temperature set-point during the charge is between 15 and 45 degrees.
+	 * Every design is evaluated with 10 cycles, and the designs are searched with differential evolution.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the names of the result files begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 *
+	 * OUT
+	 * The evaluations and the Pareto front are written in pref_degid_ChargeOptimisation_evaluations.csv and _pareto.csv (see chargeopt::write)
+	 */
+
+	using namespace slide::chargeopt;
+
+	Cell c = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																	   : (Cell)slide::Cell_user(M, degid, verbose);
+	const double Q = c.getNominalCap();
+
+	Space sp;
+	sp.nStages = 3;
+	sp.Imin = 0.5 * Q;
+	sp.Imax = 4 * Q;
+	sp.SOCmin = 0.1;
+	sp.SOCmax = 0.7;
+	sp.Vmax = c.getVmax();
+	sp.Vmin = sp.Vmax - 0.1;
+	sp.Tmin = 273.15 + 15;
+	sp.Tmax = 273.15 + 45;
+
+	Objective o;
+	o.nCycles = 10;
+
+	Settings s;
+	s.method = Method::DE;
+	s.population = 16;
+	s.generations = 20;
+
+	std::cout << "\t Optimisation of the charge protocol is started.\n";
+	const auto res = optimise(c, sp, o, s);
+	write(res, pref + "_" + degid.print() + "_ChargeOptimisation");
+
+	if (res.best >= 0)
+	{
+		const auto &e = res.all[res.best];
+		std::cout << "\t Best charge protocol: CV at " << e.d.Vcv << " V and " << e.d.T - 273.15 << " degrees, stage currents";
+		for (auto I : e.d.I)
+			std::cout << ' ' << I;
+		std::cout << " A, switching at SOC";
+		for (auto soc : e.d.SOC)
+			std::cout << ' ' << soc;
+		std::cout << ". Time to " << o.SOCmark * 100 << "% SOC " << e.tCharge / 60 << " min, capacity fade " << e.fade * 100 << "% in " << o.nCycles << " cycles.\n";
+	}
+	std::cout << "\t Optimisation of the charge protocol finished after " << res.all.size() << " evaluations, the Pareto front has " << res.front.size() << " designs.\n";
+}
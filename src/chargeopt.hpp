@@ -0,0 +1,119 @@
+/*
+ * chargeopt.hpp
+ *
+ * Optimisation of parameterised charge protocols for the trade-off between the charge time and the ageing of the cell.
+ *
+ * A Design is a multi-stage CC charge (see fastcharge::stepped) which switches to the next stage at given SOCs, followed by a CV phase,
+ * with the environmental temperature during the charge as set-point. A design is evaluated by cycling a copy of the cell for a few cycles:
+ * 		discharge at Idis at the ambient temperature
+ * 		rest at the set-point, e.g. a pre-conditioning of the cell
+ * 		charge with the design at the set-point
+ * The objective combines the time to charge to SOCmark, the lithium lost to the SEI and to plating, and a penalty if the cell gets warmer than Tlimit.
+ *
+ * The designs are coded as points in the unit hypercube (see Space::decode), which are searched with a derivative-free optimiser:
+ * 		DE 	differential evolution (rand/1/bin), every generation of trial points is evaluated in parallel
+ * 		NM 	Nelder-Mead simplex, the reflection, expansion and both contractions of an iteration are evaluated in parallel
+ * All evaluations are kept, and the designs which are not dominated in charge time and capacity fade form the Pareto front.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "cell.hpp"
+
+namespace slide::chargeopt
+{
+	using Par = std::vector<double>;
+
+	// a parameterised charge protocol
+	struct Design
+	{
+		std::vector<double> I;	 // current of every CC stage [A], > 0
+		std::vector<double> SOC; // SOC at which every stage but the last one switches to the next [-], increasing
+		double Vcv{4.2};		 // voltage of the CV phase [V]
+		double T{298.15};		 // environmental temperature during the charge [K]
+	};
+
+	// bounds of the designs
+	struct Space
+	{
+		int nStages{3};					   // number of CC stages
+		double Imin{1}, Imax{10};		   // current of the stages [A]
+		double SOCmin{0.1}, SOCmax{0.8};   // SOC at which the stages switch [-]
+		double Vmin{4.1}, Vmax{4.2};	   // voltage of the CV phase [V]
+		double Tmin{288.15}, Tmax{318.15}; // environmental temperature during the charge [K]
+
+		int dimension() const { return 2 * nStages + 1; }
+		Design decode(const Par &x) const; // design of a point in the unit hypercube
+	};
+
+	// cycling and objective of the evaluation of a design
+	struct Objective
+	{
+		int nCycles{10};	   // number of cycles to age the cell
+		double Idis{0};		   // discharge current [A], 0 for 1C
+		double Icut{0};		   // cutoff current of the CV phase of the charge [A], 0 for C/20
+		double Tamb{298.15};   // environmental temperature during the discharge [K]
+		double trest{1800};	   // rest at the set-point before every charge [s]
+		double SOCmark{0.8};   // the charge time is the time to reach this SOC [-]
+		double Tlimit{318.15}; // maximum temperature of the cell [K]
+		double wTime{1};	   // weight of the mean charge time [h-1]
+		double wSEI{1};		   // weight of the lithium lost to the SEI, in % of the nominal capacity per 100 cycles [-]
+		double wPl{5};		   // weight of the lithium lost to plating, in % of the nominal capacity per 100 cycles [-]
+		double wT{0.1};		   // weight of the temperature above Tlimit [K-1]
+	};
+
+	// result of the evaluation of a design
+	struct Evaluation
+	{
+		Par x;			   // point in the unit hypercube
+		Design d;		   // design
+		bool ok{false};	   // false if a charge or discharge failed or the charge did not reach SOCmark
+		double tCharge{0}; // mean time to charge to SOCmark [s]
+		double lossSEI{0}; // lithium lost to the SEI and other side reactions over all cycles [Ah]
+		double lossPl{0};  // lithium lost to plating over all cycles (dead and still plated lithium) [Ah]
+		double fade{0};	   // loss of capacity over all cycles relative to the initial capacity [-]
+		double Tmax{0};	   // maximum temperature of the cell [K]
+		double J{0};	   // objective, the largest double if the evaluation failed
+	};
+
+	enum class Method
+	{
+		DE, // differential evolution
+		NM	// Nelder-Mead
+	};
+
+	struct Settings
+	{
+		Method method{Method::DE};
+		int population{16};		 // number of points of differential evolution, or of the sample from which Nelder-Mead starts (0 to start from x0)
+		int generations{20};	 // number of generations of differential evolution
+		double F{0.7};			 // differential weight of differential evolution [-]
+		double CR{0.9};			 // crossover probability of differential evolution [-]
+		int maxEvaluations{400}; // number of evaluations after which Nelder-Mead stops
+		double step{0.2};		 // size of the initial simplex of Nelder-Mead, in the unit hypercube
+		Par x0;					 // starting point of Nelder-Mead in the unit hypercube, the centre if empty
+		double tol{1e-3};		 // stop once the objectives of the population or simplex differ by less than tol relative to the best one
+		unsigned seed{1};		 // seed of the random number generator
+	};
+
+	struct Result
+	{
+		std::vector<Evaluation> all; // all evaluations in the order in which they were done
+		int best{-1};				 // index of the best feasible design
+		std::vector<int> front;		 // indices of the Pareto front of charge time versus capacity fade, sorted by charge time
+	};
+
+	Evaluation evaluate(const Cell &c, const Design &d, const Objective &o);				// age a copy of the cell with a charge protocol
+	Result optimise(const Cell &c, const Space &sp, const Objective &o, const Settings &s);	// search the best design
+	std::vector<int> paretoFront(const std::vector<Evaluation> &all, double Tlimit);		// designs not dominated in charge time and capacity fade
+	void write(const Result &r, const std::string &name);									// write all evaluations and the Pareto front to csv files in the results folder
+} // namespace slide::chargeopt
+
+void ChargeOptimisation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose); // optimise a fast-charge protocol for a cell
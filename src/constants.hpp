@@ -44,6 +44,7 @@ namespace PhyConst
     constexpr double Kelvin = 273;
     constexpr double F = 96487;  // Faraday's constant
     constexpr double Rg = 8.314; // ideal gas constant
+    constexpr double pi = 3.14159265358979323846;
 }
 
 namespace slide
@@ -79,7 +80,14 @@ namespace settings
     // 		so nch is the number of Chebyshev points with 0 < x < 1
     // do NOT CHANGE this value, if you do change it, you have to recalculate the spatial discretisation with the supplied Matlab scripts.
     // See the word document '2 overview of the code', section 'Matlab setup before running the C++ code'
-    constexpr int ns{2 * nch + 14};
+    constexpr int ns_deg{4}; // number of states reserved for the own states of user-defined degradation models (see deg_registry.hpp)
+    constexpr int npsd{3};   // maximum number of particle-size classes per electrode (see PSDparam in cell_param.hpp)
+                             // each class beyond the first one has its own 2*nch transformed concentrations
+    constexpr int ns_pl{4};  // number of states for the plated lithium inventory (see State::get_Li_pl)
+    constexpr int ns_hys{2}; // number of states for the voltage hysteresis of the electrodes (see State::get_hp)
+    constexpr int ns_cat{2}; // number of states for the charge of the side reactions at the cathode (see State::get_Q_ox)
+    constexpr int ns_tm{9};  // number of states for the thermal management (see State::get_uheat)
+    constexpr int ns{2 * nch + 14 + ns_deg + 2 * nch * (npsd - 1) + ns_pl + ns_hys + ns_cat + ns_tm};
 
     constexpr double Tmin_C{0};  // the minimum temperature allowed in the simulation [oC]
     constexpr double Tmax_C{60}; // the maximum temperature allowed in the simulation [oC]
@@ -23,6 +23,7 @@
 #include <vector>
 #include <array>
 #include <numeric>
+#include <complex>
 
 double Cycler::getCapacity(bool blockDegradation)
 {
@@ -311,6 +312,16 @@ double Cycler::checkUp_batteryStates(bool blockDegradation, bool checkCap, int c
 	 * 		the thickness of the plated lithium layer [m]
 	 * 		the DC resistance of the cell [Ohm]
 	 * 		the active surface area of the anode [m2]
+	 * The states which were added later are written in a separate file (DegradationData_batteryStateExt.csv), such that the columns above don't move.
+	 * Every row of that file has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		all other states (see State: user-defined degradation models, particle-size classes, plated lithium, hysteresis,
+	 * 			side reactions at the cathode and thermal management, settings::ns - State::i_xdeg values)
+	 * 		the mean li-fraction of each particle class (material) of the cathode (settings::npsd values)
+	 * 		the mean li-fraction of each particle class (material) of the anode (settings::npsd values)
 	 *
 	 * IN
 	 * blockDegradation 	if true [RECOMMENDED], degradation is not accounted for during this check-up,
@@ -383,21 +394,307 @@ double Cycler::checkUp_batteryStates(bool blockDegradation, bool checkCap, int c
 	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh; // write the data points for where the cell is in it's life
 	output << ',' << cap;												  // write the cell capacity
 
-	for (const auto s : states)
-		output << ',' << s; // write the state variables of the cell
+	for (int i = 0; i < slide::State::i_xdeg; i++)
+		output << ',' << states[i]; // write the original state variables of the cell
 
 	output << ',' << c.getR();			  // write the total cell resistance (DC resistance [Ohm])
 	output << ',' << c.getAnodeSurface(); // write the active anode surface area an*thickn*elec_surf excluding cracks [m2]
 	output << '\n';						  // write an end-line (we have written everything we want)
 	output.close();
 
+	// the other states in their own file
+	const auto w_modeExt = !fileStatus.is_DegradationData_batteryStateExt_created ? std::ios_base::out : std::ios_base::app;
+	output.open(fol + "DegradationData_batteryStateExt.csv", w_modeExt);
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_batteryStates. File " << fol + "DegradationData_batteryStateExt.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+	fileStatus.is_DegradationData_batteryStateExt_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh;
+	for (int i = slide::State::i_xdeg; i < settings::ns; i++)
+		output << ',' << states[i];
+
+	double up[settings::npsd], un[settings::npsd]; // utilisation of each material of blended electrodes
+	c.getUtilisation(up, un);
+	for (const auto u : up)
+		output << ',' << u;
+	for (const auto u : un)
+		output << ',' << u;
+	output << '\n';
+	output.close();
+
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::checkUp_batteryStates terminating.\n";
 
 	return cap;
 }
 
-void Cycler::checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocvnini)
+void Cycler::checkUp_degradationModes(int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to calculate the degradation modes as part of a check-up.
+	 * They are calculated from the cell state, relative to the state at the first check-up:
+	 * 		LLI 	loss of lithium inventory, 1 - nLi / nLi_ref
+	 * 		LAM_PE 	loss of active material in the positive electrode, 1 - Qp / Qp_ref
+	 * 		LAM_NE 	loss of active material in the negative electrode, 1 - Qn / Qn_ref
+	 * It will add one row of data in the csv file with the results (DegradationData_modes.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		LLI, LAM_PE and LAM_NE [-]
+	 * 		li-fraction of the anode at 0% and 100% SOC [-]
+	 * 		li-fraction of the cathode at 0% and 100% SOC [-]
+	 * 		capacity of the cathode and anode [Ah]
+	 * 		cyclable lithium [Ah]
+	 *
+	 * IN
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_degradationModes is starting.\n";
+
+	double Qp, Qn, nLi, win[4];
+	c.getElectrodeBalance(&Qp, &Qn, &nLi, win);
+	if (nLi_ref == 0) // first check-up
+	{
+		Qp_ref = Qp;
+		Qn_ref = Qn;
+		nLi_ref = nLi;
+	}
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_modes_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_modes.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_degradationModes. File " << fol + "DegradationData_modes.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_modes_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh;
+	output << ',' << 1 - nLi / nLi_ref << ',' << 1 - Qp / Qp_ref << ',' << 1 - Qn / Qn_ref;
+	for (const auto w : win)
+		output << ',' << w;
+	output << ',' << Qp << ',' << Qn << ',' << nLi << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_degradationModes terminating.\n";
+}
+
+void Cycler::checkUp_sideReactions(int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to write the cumulative charge of the side reactions at the cathode as part of a check-up.
+	 * Both reactions discharge the cell without any current through the terminals, i.e. they cause self-discharge:
+	 * 		electrolyte oxidation 	lithiates the cathode without delithiating the anode, and increases the cathode resistance
+	 * 		redox shuttle 			lithiates the cathode and delithiates the anode, it is fully reversible
+	 * It will add one row of data in the csv file with the results (DegradationData_sideReactions.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		cumulative charge of the electrolyte oxidation [Ah]
+	 * 		cumulative charge of the redox shuttle [Ah]
+	 * 		lost lithium at the anode [Ah]
+	 * 		specific resistance of the electrodes [Ohm m2]
+	 *
+	 * IN
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_sideReactions is starting.\n";
+
+	slide::State si; // battery state
+	double Ii;		 // battery current [A]
+	c.getStates(si, &Ii);
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_sideReactions_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_sideReactions.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_sideReactions. File " << fol + "DegradationData_sideReactions.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_sideReactions_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh;
+	output << ',' << si.get_Q_ox() / 3600 << ',' << si.get_Q_sh() / 3600 << ',' << si.get_LLI() / 3600 << ',' << si.get_r() << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_sideReactions terminating.\n";
+}
+
+void Cycler::checkUp_thermal(int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to write the energy used by the thermal management (see Cell::setThermalController) as part of a check-up.
+	 * The energy and times are cumulative, i.e. since the thermal management was set or its report was reset (see Cell::resetThermalReport).
+	 * The thermal management is paused during the check-ups, so they are not included.
+	 * It will add one row of data in the csv file with the results (DegradationData_thermal.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		energy used by the heater [Wh]
+	 * 		energy used by the coolant loop [Wh]
+	 * 		time without heating or cooling [h]
+	 * 		time with heating [h]
+	 * 		time with cooling [h]
+	 *
+	 * IN
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_thermal is starting.\n";
+
+	double Eheat, Ecool, tregime[3];
+	c.getThermalReport(&Eheat, &Ecool, tregime);
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_thermal_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_thermal.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_thermal. File " << fol + "DegradationData_thermal.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_thermal_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << Eheat << ',' << Ecool;
+	output << ',' << tregime[0] / 3600 << ',' << tregime[1] / 3600 << ',' << tregime[2] / 3600 << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_thermal terminating.\n";
+}
+
+void Cycler::checkUp_ICA(bool measured, const std::vector<double> &Q, const std::vector<double> &V, int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to calculate the incremental capacity (dQ/dV) and differential voltage (dV/dQ) curves as part of a check-up
+	 * and to write the position and height of their peaks (see ica.hpp).
+	 * The peaks found at the first check-up are tracked over the later ones, so every row has the same columns.
+	 * It will add one row of data in the csv file with the results, DegradationData_ICA.csv for the curves of the model (from the electrode OCV curves)
+	 * or DegradationData_ICA_OCV.csv for the measured OCV curves, in the subfolder of this Cycler.
+	 * The row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		charge between the maximum and minimum voltage [Ah]
+	 * 		number of tracked IC peaks, followed by the voltage [V] and height [Ah V-1] of each of them (nan if it was not found)
+	 * 		number of tracked DV peaks, followed by the discharged charge [Ah] and height [V Ah-1] of each of them (nan if it was not found)
+	 *
+	 * IN
+	 * measured 	if true, the curve is the measured OCV curve, if false it is the equilibrium curve of the model
+	 * Q 			discharged charge, increasing [Ah]
+	 * V 			cell OCV at the discharged charges [V]
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_ICA is starting.\n";
+
+	slide::ica::Features f;
+	slide::ica::analyse(Q, V, f);
+
+	std::vector<double> icV, icH, dvQ, dvH;
+	auto &tracker = measured ? ica_OCV : ica_model;
+	tracker.track(f, icV, icH, dvQ, dvH);
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	const auto name = measured ? "DegradationData_ICA_OCV.csv" : "DegradationData_ICA.csv";
+	auto &created = measured ? fileStatus.is_DegradationData_ICA_OCV_created : fileStatus.is_DegradationData_ICA_created;
+
+	const auto w_mode = !created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	std::ofstream output(fol + name, w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_ICA. File " << fol + name << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << f.Q;
+	output << ',' << tracker.nIC();
+	for (int i = 0; i < tracker.nIC(); i++)
+		output << ',' << icV[i] << ',' << icH[i];
+	output << ',' << tracker.nDV();
+	for (int i = 0; i < tracker.nDV(); i++)
+		output << ',' << dvQ[i] << ',' << dvH[i];
+	output << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_ICA terminating.\n";
+}
+
+void Cycler::checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocvnini, std::vector<double> &Q, std::vector<double> &V)
 {
 	/*
 	 * Function to measure and write the half-cell OCV curves as part of a check-up.
@@ -417,6 +714,10 @@ void Cycler::checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocv
 	 * ocvpini				cathode potential at the operating point when the check-up is called [V]
 	 * ocvnini				anode potential at the operating point when the check-up is called [V]
 	 *
+	 * OUT
+	 * Q 					discharged charge of the points where the cell OCV is between the voltage limits [Ah]
+	 * V 					cell OCV at these points [V]
+	 *
 	 * THROWS
 	 * 1001 				the file in which to write the results couldn't be opened
 	 */
@@ -483,6 +784,19 @@ void Cycler::checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocv
 	output << '\n';
 	output.close();
 
+	// cell OCV within the voltage limits, for the IC and DV analysis
+	Q.clear();
+	V.clear();
+	for (int i = 0; i < ocvAh.size(); i++)
+	{
+		const double ocv = ocvp[i] - ocvn[i];
+		if (ocv <= c.getVmax() && ocv >= c.getVmin())
+		{
+			Q.push_back(ocvAh[i]);
+			V.push_back(ocv);
+		}
+	}
+
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::checkUp_OCVcurves terminating\n";
 }
@@ -537,6 +851,8 @@ void Cycler::checkUp_CCCV(bool blockDegradation, int nCycles, double Crates[], d
 	int feedb_old = CyclingDataTimeInterval;													 // the original data collection time interval
 	int dataTimeInterval = 2;																	 // time resolution at which we want to store the cycling data from the CCCV curves
 	CyclingDataTimeInterval = dataTimeInterval;													 // update the time resolution at which cycling data is stored for the CCCV cycles
+	const bool policy_old = logPolicy.on;														 // the data of the CCCV curves is not collected per phase
+	logPolicy.on = false;
 
 	// fully charge the cell
 	try
@@ -602,6 +918,7 @@ void Cycler::checkUp_CCCV(bool blockDegradation, int nCycles, double Crates[], d
 
 	// restore the old data-collection setting
 	CyclingDataTimeInterval = feedb_old;
+	logPolicy.on = policy_old;
 
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::checkUp_CCCV terminating.\n";
@@ -660,6 +977,8 @@ void Cycler::checkUp_pulse(bool blockDegradation, const std::vector<double> &I,
 	int feedb_old = CyclingDataTimeInterval;													  // the old data collection time interval
 	int dataTimeInterval = 2;																	  // time resolution at which we want to store the cycling data from the pulse discharge
 	CyclingDataTimeInterval = dataTimeInterval;													  // update the time resolution of the cycling data collection to the new value for the pulse discharge
+	const bool policy_old = logPolicy.on;														  // the data of the pulse discharge is not collected per phase
+	logPolicy.on = false;
 	double ahi, whi, timei;																		  // unneeded feedback variables
 	double Ccut = 0.05;																			  // C rate of the cutoff current for the CV phase
 
@@ -752,6 +1071,7 @@ void Cycler::checkUp_pulse(bool blockDegradation, const std::vector<double> &I,
 
 	// restore the old data-collection setting
 	CyclingDataTimeInterval = feedb_old;
+	logPolicy.on = policy_old;
 
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::checkUp_pulse terminating.\n";
@@ -819,6 +1139,230 @@ void Cycler::checkUp_pulse(bool blockDegradation, const std::string &profileName
 	checkUp_pulse(blockDegradation, I, T, profileLength, includeCycleData);
 }
 
+void Cycler::checkUp_EIS(const std::vector<double> &freq, int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to calculate the impedance spectrum as part of a check-up.
+	 * The cell model is linearised around the battery state at the start of the check-up (see Cell::getImpedance),
+	 * at rest, such that no time integration is needed and the battery state is not changed.
+	 * It will add one row of data in the csv file with the results (DegradationData_EIS.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		number of frequencies
+	 * 		for each frequency: the frequency [Hz] and the real and imaginary part of the impedance [Ohm]
+	 *
+	 * IN
+	 * freq 		frequencies at which to calculate the impedance [Hz], if empty 5 frequencies per decade from 10 kHz to 1 mHz are used
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_EIS is starting.\n";
+
+	std::vector<double> f = freq;
+	if (f.empty())
+		for (int i = 0; i <= 35; i++)
+			f.push_back(std::pow(10.0, 4 - i / 5.0));
+
+	// calculate the impedance at rest
+	slide::State sini;
+	double Iini;
+	std::vector<std::complex<double>> Z;
+	c.getStates(sini, &Iini);
+	c.setStates(sini, 0);
+	try
+	{
+		c.getImpedance(f, Z);
+	}
+	catch (int e)
+	{
+		c.setStates(sini, Iini);
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::checkUp_EIS when calculating the impedance: " << e << ". Throwing the error on.\n";
+		throw e;
+	}
+	c.setStates(sini, Iini);
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_EIS_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_EIS.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_EIS. File " << fol + "DegradationData_EIS.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_EIS_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << f.size();
+	for (size_t i = 0; i < f.size(); i++)
+		output << ',' << f[i] << ',' << Z[i].real() << ',' << Z[i].imag();
+	output << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_EIS terminating.\n";
+}
+
+void Cycler::checkUp_GITT(bool blockDegradation, double Crate, double tpulse, double trelax, int perDecade, int cumCycle, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to do a galvanostatic intermittent titration (GITT) as part of a check-up.
+	 * The cell is fully charged and relaxed, and then discharged with pulses of tpulse seconds, each followed by a relaxation of trelax seconds,
+	 * until the minimum voltage is reached. Because the states relax smoothly, the relaxations are done with time steps which grow with the time
+	 * since the end of the pulse (see Cell::ETI_rest), and the voltage is sampled on a logarithmic time grid: perDecade samples per decade from 1 second.
+	 *
+	 * The relaxation curves are written in a new csv file for every check-up, DegradationData_GITT_x.csv,
+	 * 		where 'x' is 1 (for the first check-up), 2 (for the second check-up), etc.
+	 * Each row has the following entries:
+	 * 		number of the pulse, 0 for the relaxation after the initial charge
+	 * 		time since the end of the pulse [s]
+	 * 		cell voltage [V]
+	 * 		cell temperature [K]
+	 *
+	 * For every pulse, one row is added to DegradationData_GITT.csv with the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		number of the pulse
+	 * 		charge discharged since the full charge [Ah]
+	 * 		relaxed voltage at the end of the relaxation after the pulse [V]
+	 * 		change of the relaxed voltage by the pulse, dEs [V]
+	 * 		change of the voltage during the pulse, without the instantaneous drop when the current is applied, dEt [V]
+	 * 		apparent diffusion constant of the positive and negative particles [m2 s-1]
+	 * The apparent diffusion constants follow from the approximation of Weppner and Huggins for a sphere of radius R,
+	 * 		D = 4 / (pi tpulse) * (R / 3)^2 * (dEs / dEt)^2
+	 * which assumes that the pulse is short compared to the diffusion time R^2 / D, and that only one electrode determines the voltage.
+	 * The apparent value of the other electrode is also given, but only one of them is meaningful for a full cell.
+	 *
+	 * IN
+	 * blockDegradation 	if true, degradation is not accounted for during the GITT
+	 * Crate 				C rate of the discharge pulses [-], > 0
+	 * tpulse 				duration of the pulses [s]
+	 * trelax 				duration of the relaxations [s]
+	 * perDecade 			number of samples of the relaxation per decade of time [-]
+	 * cumCycle				number of cycles up to now [-]
+	 * cumTime				time this cell has been cycled up to now [hour]
+	 * cumAh				cumulative Ah throughput up to now [Ah]
+	 * cumWh				cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 				one of the files in which to write the results couldn't be opened
+	 * 1004 				illegal settings of the GITT
+	 */
+
+	using slide::protocol::below;
+	using slide::protocol::Var;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_GITT starting.\n";
+
+	if (Crate <= 0 || tpulse <= 0 || trelax < 1 || perDecade < 1)
+	{
+		std::cerr << "ERROR in Cycler::checkUp_GITT, the C rate " << Crate << ", the duration of the pulses " << tpulse << " s and the relaxations " << trelax
+				  << " s, and the number of samples per decade " << perDecade << " are illegal. The relaxations must last at least 1 second. Throwing an error.\n";
+		throw 1004;
+	}
+
+	// variables
+	const auto fol = PathVar::results + ID; // we want to write the files in a subfolder, so append the name of the subfolder before the name of the csv file
+	const double I = Crate * c.getNominalCap(); // current of the pulses [A]
+	double Rp, Rn;								// radius of the particles [m]
+	double ahi, whi, timei;						// throughput and duration of a step
+	double Ah = 0;								// charge discharged since the full charge [Ah]
+	double v, ocvp, ocvn, etap, etan, rdrop, tem;
+	c.getRadius(&Rp, &Rn);
+
+	// logarithmic time grid of the relaxation [s]
+	std::vector<double> tgrid;
+	for (int k = 0; std::pow(10.0, static_cast<double>(k) / perDecade) < trelax; k++)
+		tgrid.push_back(std::pow(10.0, static_cast<double>(k) / perDecade));
+	tgrid.push_back(trelax);
+
+	const std::string nameCurves = "DegradationData_GITT_" + std::to_string(indexdegr) + ".csv"; // name of the csv file with the relaxation curves
+	std::ofstream curves(fol + nameCurves, std::ios_base::out);
+	const auto w_mode = !fileStatus.is_DegradationData_GITT_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	std::ofstream output(fol + "DegradationData_GITT.csv", w_mode);
+	if (!curves.is_open() || !output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::checkUp_GITT. File " << fol + "DegradationData_GITT.csv" << " or " << fol + nameCurves
+					  << " could not be opened. Throwing an error.\n";
+		throw 1001;
+	}
+	fileStatus.is_DegradationData_GITT_created = true;
+
+	// relax the cell and write the voltage on the logarithmic time grid, returns the relaxed voltage
+	auto relax = [&](int pulse) {
+		double t = 0;
+		c.setI(settings::verbose >= printLevel::printCrit, true, 0);
+		for (const auto tk : tgrid)
+		{
+			c.ETI_rest(settings::verbose >= printLevel::printCrit, tk - t, blockDegradation);
+			t = tk;
+			c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+			curves << pulse << ',' << t << ',' << v << ',' << tem << '\n';
+		}
+		return v;
+	};
+
+	// *********************************************************** 1 charge and relax the cell ***********************************************************************
+
+	if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+		std::cout << "Cycler::checkUp_GITT is charging the cell.\n";
+	CC_V_CV_I(1.0, c.getVmax(), 0.05, 2, blockDegradation, &ahi, &whi, &timei);
+	double Vrest = relax(0); // relaxed voltage before the pulse [V]
+
+	// *********************************************************** 2 pulses and relaxations ***********************************************************************
+
+	for (int pulse = 1;; pulse++)
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::checkUp_GITT is doing pulse " << pulse << ".\n";
+
+		const double V0 = c.getVoltageAt(settings::verbose >= printLevel::printCrit, I); // voltage as soon as the current is applied [V]
+		slide::protocol::Protocol p;
+		p.CC(I, {below(Var::V, c.getVmin())}, tpulse);
+		slide::protocol::Run r;
+		runProtocol(p, blockDegradation, c.getVmax(), c.getVmin(), r);
+		c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvp, &ocvn, &etap, &etan, &rdrop, &tem);
+		Ah += r.Ah;
+		const double dEt = V0 - v;								// change of the voltage during the pulse [V]
+		const bool empty = r.end <= 0 || r.time < tpulse - 1e-6; // the pulse stopped at the minimum voltage
+
+		const double Vrelax = relax(pulse);
+		const double dEs = Vrest - Vrelax; // change of the relaxed voltage [V]
+		Vrest = Vrelax;
+
+		// apparent diffusion constants, only if the full pulse was done
+		const double f = (empty || dEt <= 0) ? 0 : 4.0 / (PhyConst::pi * tpulse) * std::pow(dEs / dEt, 2);
+		output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << pulse << ',' << Ah << ',' << Vrelax << ',' << dEs << ',' << dEt << ','
+			   << f * std::pow(Rp / 3, 2) << ',' << f * std::pow(Rn / 3, 2) << '\n';
+
+		if (empty)
+			break;
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::checkUp_GITT terminating.\n";
+}
+
 double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTime, double cumAh, double cumWh)
 {
 	/*
@@ -828,12 +1372,14 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	 * 		a half-cell OCV measurement
 	 * 		some CC CV cycles (CC discharge, CV discharge, CC charge, CV charge) at 0.5, 1 and 2 C
 	 * 		a pulse discharge test
+	 * 		a galvanostatic intermittent titration (GITT)
 	 *
 	 * The results are written in csv files, in the subfolder of this Cycler.
 	 * 		DegradationData_batteryState.csv				one new row of data appended at the end of the existing csv file
 	 * 		DegradationData_OCV.csv							4 new rows of data appended at the end of the existing csv file
 	 * 		DegradationData_CheckupCycle_x.csv 				a new file for the data of this check-up, x is the index of the check-up (1 for the first check-up, 2 for the second, etc.)
 	 * 		DegradationData_CheckupPulse_x.csv				a new file for the data of this check-up, x is the index of the check-up (1 for the first check-up, 2 for the second, etc.)
+	 * 		DegradationData_GITT.csv, DegradationData_GITT_x.csv 	apparent diffusion constants of every pulse, and the relaxation curves of this check-up
 	 * See the individual functions (checkUp_yyy) for an exact description of what is in each file.
 	 *
 	 * IN
@@ -846,6 +1392,7 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -856,6 +1403,9 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
+	 * 		GITTCheck			boolean indicating if a galvanostatic intermittent titration should be done as part of the check-up procedure
+	 * 		GITTCrate, GITTtpulse, GITTtrelax, GITTperDecade 	C rate, duration of the pulses and relaxations and samples per decade of the GITT
 	 * cumCycle				number of cycles up to now [-]
 	 * cumTime				time this cell has been cycled up to now [hour]
 	 * cumAh				cumulative Ah throughput up to now [Ah]
@@ -883,6 +1433,8 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	c.getVoltage(settings::verbose >= printLevel::printCrit, &v, &ocvpini, &ocvnini, &etap, &etan, &rdrop, &tcellini); // initial cell voltage and temperature
 	c.getTemperatures(&Tenvini, &Trefi);																			   // initial environmental and reference temperature
 	int feedbackini = CyclingDataTimeInterval;																		   // initial data collection time interval
+	const bool policyini = logPolicy.on;																			   // initial data collection per phase
+	c.pauseThermalControl(true);																					   // the check-up is done without thermal management
 
 	// if we don't want to include the cycling data from the check-up in the cycling data from the cell
 	// push the cycling data and set the data collection to 0 to stop recording
@@ -894,6 +1446,7 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 				std::cout << "Cycler::checkUp is flushing the previously stored cycling data.\n";
 			writeCyclingData();			 // write the cycling data which was still stored
 			CyclingDataTimeInterval = 0; // don't record cycling data from the check-up
+			logPolicy.on = false;
 		}
 		catch (int e)
 		{
@@ -926,12 +1479,69 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	c.setT(Trefi);	  // set the cell temperature to the reference temperature
 
 	// *********************************************************** 2 do the different check-up tests ***********************************************************************
-	// Measure the capacity
-	if (proc.capCheck)
+	// Calculate the degradation modes, this is done in every check-up
+	try
 	{
-		try
-		{
-			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::checkUp is calculating the degradation modes.\n";
+		checkUp_degradationModes(cumCycle, cumTime, cumAh, cumWh);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::checkUp when calculating the degradation modes: " << e << ". Skip the degradation modes.\n";
+	}
+
+	// Write the charge of the side reactions at the cathode, this is done in every check-up
+	try
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::checkUp is writing the side reactions.\n";
+		checkUp_sideReactions(cumCycle, cumTime, cumAh, cumWh);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::checkUp when writing the side reactions: " << e << ". Skip the side reactions.\n";
+	}
+
+	// Write the energy use of the thermal management, this is done in every check-up if the cell is thermally managed
+	if (c.isThermalControlled())
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::checkUp is writing the thermal management.\n";
+			checkUp_thermal(cumCycle, cumTime, cumAh, cumWh);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in Cycler::checkUp when writing the thermal management: " << e << ". Skip the thermal management.\n";
+		}
+	}
+
+	// Calculate the IC and DV peaks of the equilibrium curve of the model, this is done in every check-up
+	try
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::checkUp is calculating the IC and DV curves.\n";
+		std::vector<double> Qeq, Veq;
+		c.getEquilibriumCurve(slide::ica::ngrid, Qeq, Veq);
+		checkUp_ICA(false, Qeq, Veq, cumCycle, cumTime, cumAh, cumWh);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::checkUp when calculating the IC and DV curves: " << e << ". Skip the IC and DV curves.\n";
+	}
+
+	// Measure the capacity
+	if (proc.capCheck)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
 				std::cout << "Cycler::checkUp is starting a capacity check.\n";
 			cap = checkUp_batteryStates(proc.blockDegradation, true, cumCycle, cumTime, cumAh, cumWh);
 		}
@@ -949,7 +1559,9 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 		{
 			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
 				std::cout << "Cycler::checkUp is starting an OCV check.\n";
-			checkUp_OCVcurves(proc.blockDegradation, ocvpini, ocvnini);
+			std::vector<double> Qocv, Vocv;
+			checkUp_OCVcurves(proc.blockDegradation, ocvpini, ocvnini, Qocv, Vocv);
+			checkUp_ICA(true, Qocv, Vocv, cumCycle, cumTime, cumAh, cumWh);
 		}
 		catch (int e)
 		{
@@ -991,6 +1603,38 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 		}
 	}
 
+	// calculate the impedance spectrum
+	if (proc.EISCheck)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::checkUp is calculating the impedance spectrum.\n";
+			checkUp_EIS(proc.EISfreq, cumCycle, cumTime, cumAh, cumWh);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in Cycler::checkUp when calculating the impedance spectrum: " << e << ". Skip the impedance spectrum.\n";
+		}
+	}
+
+	// do a galvanostatic intermittent titration
+	if (proc.GITTCheck)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::checkUp is starting a GITT.\n";
+			checkUp_GITT(proc.blockDegradation, proc.GITTCrate, proc.GITTtpulse, proc.GITTtrelax, proc.GITTperDecade, cumCycle, cumTime, cumAh, cumWh);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in Cycler::checkUp when doing the GITT: " << e << ". Skip the GITT.\n";
+		}
+	}
+
 	// increase the counter of the number of check-ups we have done
 	indexdegr++;
 
@@ -1001,6 +1645,7 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 
 	c.setTenv(Tenvini);					   // restore the environmental temperature
 	CyclingDataTimeInterval = feedbackini; // restore the initial data-collection setting
+	logPolicy.on = policyini;
 	if (proc.blockDegradation)
 		c.setStates(sini, Iini); // restore the exact initial battery state
 	else
@@ -1010,6 +1655,7 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 		CC_V_CV_I(1, ocvpini - ocvnini, Ccut, dt, proc.blockDegradation, &ahi, &whi, &timei); // bring the cell back to the original OCV (OCV_cell = OCV_p - OCV_n)
 		CC_t(0.0, dt, proc.blockDegradation, Trest, &ahi, &whi, &timei);					  // rest such that the cell temperatures goes back to the environmental temperature
 	}
+	c.pauseThermalControl(false); // switch the thermal management on again
 
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::checkUp terminating with capacity " << cap << "Ah.\n";
@@ -1018,6 +1664,194 @@ double Cycler::checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTi
 	return cap;
 }
 
+void Cycler::writePlating(int cumCycle, double *Qpl, double *Qstrip, double *Qdead)
+{
+	/*
+	 * Function to write the lithium plating of the last cycle.
+	 * It will add one row of data in the csv file with the results (DegradationData_plating.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		lithium plated during the last cycle [Ah]
+	 * 		lithium stripped during the last cycle [Ah]
+	 * 		lithium which became dead (irreversibly lost) during the last cycle [Ah]
+	 * 		reversibly plated lithium at the end of the cycle [Ah]
+	 * 		total dead lithium at the end of the cycle [Ah]
+	 * Nothing is written if the cell does not model lithium plating (pl_id == 0).
+	 *
+	 * IN
+	 * cumCycle		number of cycles up to now [-]
+	 *
+	 * IN/OUT
+	 * Qpl 			cumulative plated lithium at the end of the previous cycle [As], updated to the value at the end of this cycle
+	 * Qstrip 		cumulative stripped lithium at the end of the previous cycle [As], updated to the value at the end of this cycle
+	 * Qdead 		dead lithium at the end of the previous cycle [As], updated to the value at the end of this cycle
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writePlating is starting.\n";
+
+	if (c.getDegID().pl_id == 0) // no plating, so there is nothing to write
+		return;
+
+	slide::State si;
+	double Ii;
+	c.getStates(si, &Ii);
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_plating_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_plating.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::writePlating. File " << fol + "DegradationData_plating.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_plating_created = true;
+
+	output << cumCycle << ',' << (si.get_Q_pl() - *Qpl) / 3600 << ',' << (si.get_Q_strip() - *Qstrip) / 3600 << ',' << (si.get_Li_dead() - *Qdead) / 3600;
+	output << ',' << si.get_Li_pl() / 3600 << ',' << si.get_Li_dead() / 3600 << '\n';
+	output.close();
+
+	*Qpl = si.get_Q_pl();
+	*Qstrip = si.get_Q_strip();
+	*Qdead = si.get_Li_dead();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writePlating terminating.\n";
+}
+
+void Cycler::writeSOCwindow(int cumCycle, double cumTime, double cumAh, double cumWh, double dAh, bool anchored)
+{
+	/*
+	 * Function to write the position of the SOC window after a block of cycles of socWindowAgeing.
+	 * It will add one row of data in the csv file with the results (DegradationData_SOCwindow.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of cycles until now
+	 * 		time the cell has been cycled until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		charge between the bottom and the top of the window [Ah], 0 if the window is defined by the SOC of the model
+	 * 		SOC of the model at the top of the window [-], which drifts if the window is counted in Ah
+	 * 		1 if the window was re-anchored after this block, 0 if not
+	 *
+	 * IN
+	 * cumCycle		number of cycles up to now [-]
+	 * cumTime		time this cell has been cycled up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 * dAh 			charge between the bottom and the top of the window [Ah]
+	 * anchored 	true if the window is re-anchored after this block
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writeSOCwindow is starting.\n";
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_SOCwindow_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_SOCwindow.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::writeSOCwindow. File " << fol + "DegradationData_SOCwindow.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_SOCwindow_created = true;
+
+	output << cumCycle << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << dAh << ',' << c.getSOC() << ',' << anchored << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writeSOCwindow terminating.\n";
+}
+
+void Cycler::writeUsage(int day, const slide::usage::Schedule &s, const slide::protocol::Run &r, double cumTime, double cumAh, double cumWh)
+{
+	/*
+	 * Function to write the usage of one day of usageAgeing.
+	 * It will add one row of data in the csv file with the results (DegradationData_usage.csv in the subfolder of this Cycler)
+	 * the row has the following entries:
+	 * 		number of the day
+	 * 		time the cell has been used until now [h]
+	 * 		cumulative Ah throughput up to now [Ah]
+	 * 		cumulative Wh throughput up to now [Wh]
+	 * 		number of trips of the day
+	 * 		number of repetitions of the drive profiles of the day
+	 * 		number of charges of the day (a charge is skipped if the SOC is above its threshold)
+	 * 		Ah throughput of the day [Ah]
+	 * 		Wh throughput of the day [Wh]
+	 * 		time between midnight and the end of the last event of the day [h]
+	 * 		SOC of the model at the end of the day [-]
+	 *
+	 * IN
+	 * day 			number of the day, starting at 1
+	 * s 			schedule of the day
+	 * r 			totals of the day
+	 * cumTime		time this cell has been used up to now [hour]
+	 * cumAh		cumulative Ah throughput up to now [Ah]
+	 * cumWh		cumulative Wh throughput up to now [Wh]
+	 *
+	 * THROWS
+	 * 1001 		the file in which to write the results couldn't be opened
+	 */
+
+	using slide::usage::Kind;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writeUsage is starting.\n";
+
+	const auto fol = PathVar::results + ID; // we want to write the file in a subfolder, so append the name of the subfolder before the name of the csv file
+	std::ofstream output;
+
+	const auto w_mode = !fileStatus.is_DegradationData_usage_created ? std::ios_base::out : std::ios_base::app; // Check if created earlier, if not then create, if created then append.
+	output.open(fol + "DegradationData_usage.csv", w_mode);
+
+	if (!output.is_open())
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cerr << "ERROR in Cycler::writeUsage. File " << fol + "DegradationData_usage.csv"
+					  << " could not be opened. Throwing an error.\n";
+
+		throw 1001;
+	}
+
+	fileStatus.is_DegradationData_usage_created = true;
+
+	int ntrip = 0, nrep = 0, ncharge = 0;
+	for (const auto &e : s)
+		if (e.kind == Kind::trip)
+		{
+			ntrip++;
+			nrep += e.repeats;
+		}
+		else if (e.kind == Kind::charge)
+			ncharge++;
+
+	output << day << ',' << cumTime << ',' << cumAh << ',' << cumWh << ',' << ntrip << ',' << nrep << ',' << ncharge << ','
+		   << r.Ah << ',' << r.Wh << ',' << r.time / 3600 << ',' << c.getSOC() << '\n';
+	output.close();
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::writeUsage terminating.\n";
+}
+
 void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CVcha, double Ccutcha,
 						 double Cdis, bool CVdis, double Ccutdis, double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc)
 {
@@ -1026,6 +1860,7 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 	 * The parameters of the cycling regime are set by the inputs.
 	 * After a set number of cycles, a check-up is done where the cell capacity, OCV curves, etc. are measured.
 	 * These results are written to csv files.
+	 * The plated, stripped and dead lithium of every cycle are written to DegradationData_plating.csv (see writePlating).
 	 *
 	 * IN
 	 * dt 		the time step to be used in the cycling, small enough to ensure stability and accuracy (1-5 seconds) [s]
@@ -1054,6 +1889,7 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -1063,16 +1899,48 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 	 * 								the second column contains the time in [sec] the current should be maintained for
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 *
 	 *
 	 * throws
 	 * 1014		the input parameters describing the cycling regime are invalid
 	 */
 
+	cycleAgeing_load(false, dt, Vma, Vmi, Ccha, CVcha, Ccutcha, Cdis, CVdis, Ccutdis, Ti, nrCycles, nrCap, proc);
+}
+
+void Cycler::powerCycleAgeing(double dt, double Vma, double Vmi, double Pcha, bool CVcha, double Ccutcha,
+							  double Pdis, bool CVdis, double Ccutdis, double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc)
+{
+	/*
+	 * Function to simulate a cycle degradation experiment where a cell is continuously cycled at constant power and/or constant voltage.
+	 * This is the same as cycleAgeing, but the CC phases are replaced by CP phases (see BasicCycler::CP_V),
+	 * such that the current increases as the voltage decreases and as the cell ages, like in applications which are specified in power.
+	 *
+	 * IN
+	 * Pcha 	power at which the battery should be charged during the CP phase [W], > 0
+	 * Pdis 	power at which the battery should be discharged during the CP phase [W], > 0
+	 * the other inputs are the same as for cycleAgeing
+	 *
+	 * throws
+	 * 1014		the input parameters describing the cycling regime are invalid
+	 */
+
+	cycleAgeing_load(true, dt, Vma, Vmi, Pcha, CVcha, Ccutcha, Pdis, CVdis, Ccutdis, Ti, nrCycles, nrCap, proc);
+}
+
+void Cycler::cycleAgeing_load(bool power, double dt, double Vma, double Vmi, double Xcha, bool CVcha, double Ccutcha,
+							  double Xdis, bool CVdis, double Ccutdis, double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc)
+{
+	/*
+	 * Implementation of cycleAgeing (power == false, Xcha and Xdis are C-rates)
+	 * and powerCycleAgeing (power == true, Xcha and Xdis are powers [W]).
+	 */
+
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::cycleAgeing starting.\n";
 
-	slide::util::error::checkInputParam_CycAge(c, Vma, Vmi, Ccha, Ccutcha, Cdis, Ccutdis, Ti, nrCycles, nrCap); // Check the input parameters
+	slide::util::error::checkInputParam_CycAge(c, Vma, Vmi, Xcha, Ccutcha, Xdis, Ccutdis, Ti, nrCycles, nrCap); // Check the input parameters
 
 	// *********************************************************** 1 variables & settings ***********************************************************************
 
@@ -1088,6 +1956,31 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 	bool final = true;				   // boolean to indicate if a check-up at the end of the cycling regime is needed
 	double capnom = c.getNominalCap(); // nominal cell capacity [Ah] to convert Crate to Amperes
 
+	// charge to Vma and discharge to Vmi with a CC or CP phase, optionally followed by a CV phase
+	auto load = [&](bool cha) {
+		const double X = cha ? Xcha : Xdis;			 // C-rate or power [-] or [W]
+		const double Vset = cha ? Vma : Vmi;		 // voltage to which the cell is (dis)charged [V]
+		const double Ccut = cha ? Ccutcha : Ccutdis; // C-rate of the cutoff current of the CV phase [-]
+		const bool CV = cha ? CVcha : CVdis;		 // do a CV phase after the CC or CP phase
+		const int sign = cha ? -1 : 1;				 // charge (-1) or discharge (1)
+		if (!power && CV)
+			CC_V_CV_I(X, Vset, Ccut, dt, blockDegradation, &ahi, &whi, &ti); // CC and CV (dis)charge
+		else if (!power)
+			CC_V(sign * X * capnom, dt, blockDegradation, Vset, &ahi, &whi, &ti); // CC (dis)charge (must have current as input, not C rate)
+		else
+		{
+			CP_V(sign * X, dt, blockDegradation, Vset, &ahi, &whi, &ti); // CP (dis)charge
+			if (CV)
+			{
+				double ahcv, whcv, tcv;
+				CV_I(Vset, dt, blockDegradation, Ccut * capnom, &ahcv, &whcv, &tcv); // CV phase at the voltage limit
+				ahi += ahcv;
+				whi += whcv;
+				ti += tcv;
+			}
+		}
+	};
+
 	// *********************************************************** 2 cell initialisation ***********************************************************************
 
 	if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
@@ -1100,10 +1993,7 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 	// Get the battery to Vma so the cycling can start with a discharge
 	try
 	{
-		if (CVcha)
-			CC_V_CV_I(Ccha, Vma, Ccutcha, dt, blockDegradation, &ahi, &whi, &ti); // CC and CV charge
-		else
-			CC_V(-Ccha * capnom, dt, blockDegradation, Vma, &ahi, &whi, &ti); // CC charge (must have current as input, not C rate)
+		load(true); // CC or CP charge, optionally followed by a CV charge
 	}
 	catch (int e)
 	{
@@ -1126,6 +2016,14 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 		throw e;
 	}
 
+	// lithium plating at the start of the cycling regime, to report the plating of every cycle
+	slide::State si; // battery state
+	double Ii;		 // battery current [A]
+	c.getStates(si, &Ii);
+	double Qpl = si.get_Q_pl();		  // cumulative plated lithium at the end of the previous cycle [As]
+	double Qstrip = si.get_Q_strip(); // cumulative stripped lithium at the end of the previous cycle [As]
+	double Qdead = si.get_Li_dead();  // dead lithium at the end of the previous cycle [As]
+
 	// *********************************************************** 3 cycle age the cell ***********************************************************************
 
 	for (int i = 0; i < nrCycles; i++)
@@ -1136,24 +2034,20 @@ void Cycler::cycleAgeing(double dt, double Vma, double Vmi, double Ccha, bool CV
 			// discharge
 			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
 				std::cout << "Cycler::cycleAgeing is discharging the cell in cycle number " << i << ".\n";
-			if (CVdis)
-				CC_V_CV_I(Cdis, Vmi, Ccutdis, dt, blockDegradation, &ahi, &whi, &ti); // CC and CV discharge
-			else
-				CC_V(Cdis * capnom, dt, blockDegradation, Vmi, &ahi, &whi, &ti); // CC discharge (must have current as input, not C rate)
-			Ahtot += abs(ahi);													 // increase the charge throughput with the throughput of this discharge
-			Whtot += abs(whi);													 // increase the energy throughput with the throughput of this discharge
-			timetot += (ti / 3600);												 // increase the total time the time of this discharge
+			load(false);			// CC or CP discharge, optionally followed by a CV discharge
+			Ahtot += abs(ahi);		// increase the charge throughput with the throughput of this discharge
+			Whtot += abs(whi);		// increase the energy throughput with the throughput of this discharge
+			timetot += (ti / 3600); // increase the total time the time of this discharge
 
 			// charge
 			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
 				std::cout << "Cycler::cycleAgeing is charging the cell in cycle number " << i << ".\n";
-			if (CVcha)
-				CC_V_CV_I(Ccha, Vma, Ccutcha, dt, blockDegradation, &ahi, &whi, &ti); // CC and CV charge
-			else
-				CC_V(-Ccha * capnom, dt, blockDegradation, Vma, &ahi, &whi, &ti); // CC charge (must have current as input, not C rate)
-			Ahtot += abs(ahi);													  // increase the charge throughput with the throughput of this charge
-			Whtot += abs(whi);													  // increase the energy throughput with the throughput of this charge
-			timetot += (ti / 3600);												  // increase the total time the time of this charge
+			load(true);				// CC or CP charge, optionally followed by a CV charge
+			Ahtot += abs(ahi);		// increase the charge throughput with the throughput of this charge
+			Whtot += abs(whi);		// increase the energy throughput with the throughput of this charge
+			timetot += (ti / 3600); // increase the total time the time of this charge
+
+			writePlating(i + 1, &Qpl, &Qstrip, &Qdead); // write the plating of this cycle
 
 			// do a check-up every nrCap cycles
 			// 	i is the cycle number, so when it is a multiple of nrCap we need to do a check-up
@@ -1249,6 +2143,7 @@ void Cycler::calendarAgeing(double dt, double V, double Ti, int Time, int timeCh
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -1258,6 +2153,7 @@ void Cycler::calendarAgeing(double dt, double V, double Ti, int Time, int timeCh
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 *
 	 * throws
 	 * 1014		the input parameters describing the calendar regime are invalid
@@ -1430,6 +2326,7 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -1439,6 +2336,7 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 * 
 	 * length = 1000 in default. 
 	 *
@@ -1451,6 +2349,37 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	 * 				reduce the absolute value of the currents in the current profile (or reduce the durations) to produce a valid current profile
 	 */
 
+	profileAgeing_load(false, nameI, limit, Vma, Vmi, Ti, nrProfiles, nrCap, proc, length);
+}
+
+void Cycler::powerProfileAgeing(const std::string &nameP, int limit, double Vma, double Vmi, double Ti, int nrProfiles, int nrCap, struct checkUpProcedure &proc, size_t length)
+{
+	/*
+	 * Function to simulate degradation by continuously cycling a cell with a certain power profile.
+	 * This is the same as profileAgeing, but every step of the profile is a constant power (see BasicCycler::followP),
+	 * such that the current follows the cell voltage as it (dis)charges and ages.
+	 *
+	 * IN
+	 * nameP 	name of the CSV-file with the power profile
+	 * 				the first column contains the power in [W], positive for discharge, negative for charge
+	 * 				the second column contains the time in [sec] the power should be maintained
+	 * the other inputs are the same as for profileAgeing
+	 *
+	 * throws
+	 * 1014 		the input parameters are invalid
+	 * 1015 		the profile is invalid or the voltage limits are too small (see profileAgeing)
+	 */
+
+	profileAgeing_load(true, nameP, limit, Vma, Vmi, Ti, nrProfiles, nrCap, proc, length);
+}
+
+void Cycler::profileAgeing_load(bool power, const std::string &nameI, int limit, double Vma, double Vmi, double Ti, int nrProfiles, int nrCap, struct checkUpProcedure &proc, size_t length)
+{
+	/*
+	 * Implementation of profileAgeing (power == false, the profile is a current profile)
+	 * and powerProfileAgeing (power == true, the profile is a power profile).
+	 */
+
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::profileAgeing starting.\n";
 
@@ -1500,7 +2429,7 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
 		std::cout << "Cycler::profileAgeing is reading the current profile.\n";
 
-	static thread_local std::vector<double> I(length), T(length); // arrays to store the current profile as doubles
+	static thread_local std::vector<double> I(length), T(length); // arrays to store the current (or power) profile as doubles
 	try
 	{
 		loadCSV_2col(PathVar::data + nameI, I, T); // read the file
@@ -1513,7 +2442,7 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	}
 
 	// Determine if the profile is a net charge or a net discharge
-	const double aht = std::inner_product(I.begin(), I.end(), T.begin(), 0.0); // charge throughput of the profile
+	const double aht = std::inner_product(I.begin(), I.end(), T.begin(), 0.0); // charge (or energy) throughput of the profile
 	const int sign = (aht > 0) ? -1 : 1;									   // the profile is a net discharge (-1) or net charge (1)
 
 	// *********************************************************** 2 cell initialisation ***********************************************************************
@@ -1576,7 +2505,10 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 			{ // loop to keep applying the profile until you hit a voltage limit
 
 				// follow the profile
-				vlim = followI(length, I, T, blockDegradation, limit, Vma, Vmi, &ahi, &whi, &timei);
+				if (power)
+					vlim = followP(length, I, T, blockDegradation, limit, Vma, Vmi, &ahi, &whi, &timei);
+				else
+					vlim = followI(length, I, T, blockDegradation, limit, Vma, Vmi, &ahi, &whi, &timei);
 
 				// update the throughput
 				Ahtot += abs(ahi);
@@ -1715,3 +2647,624 @@ void Cycler::profileAgeing(const std::string &nameI, int limit, double Vma, doub
 	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
 		std::cout << "Cycler::profileAgeing terminating.\n";
 }
+
+void Cycler::followProtocol(slide::protocol::Protocol &p, double Vma, double Vmi, struct checkUpProcedure &proc)
+{
+	/*
+	 * Function to age the cell with a programmed protocol (see protocol.hpp and BasicCycler::runProtocol).
+	 * A check-up is done at the start and at the end of the protocol, and at every check-up instruction whose interval is a multiple of the iteration number of its loop.
+	 * The cycle number written in the check-ups is the total number of iterations done by the innermost loop around the check-up.
+	 *
+	 * IN
+	 * p 		protocol, it is compiled if this was not done yet
+	 * Vma 		maximum voltage of the profile steps [V]
+	 * Vmi 		minimum voltage of the profile steps [V]
+	 * proc 	structure with the parameters of the check-up procedure
+	 *
+	 * THROWS
+	 * 1020 	the protocol can't be compiled (see Protocol::compile)
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::followProtocol starting.\n";
+
+	p.compile();
+
+	// *********************************************************** 1 variables & settings ***********************************************************************
+
+	slide::protocol::Run r;			   // throughput, time and cycle number of the protocol until now
+	double cap;						   // capacity of the cell at this point in time [Ah]
+	bool blockDegradation = false;	   // account for degradation while we cycle
+	bool final = true;				   // boolean to indicate if a check-up at the end of the protocol is needed
+	double capnom = c.getNominalCap(); // nominal cell capacity [Ah]
+
+	// do an initial check up
+	try
+	{
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::followProtocol is doing an initial check-up.\n";
+		cap = checkUp(proc, 0, 0, 0, 0);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in the initial check-up Cycler::followProtocol " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	// check-up at the check-up instructions, which stops the protocol if the cell capacity has decreased too much
+	auto check = [&](int cycle) {
+		if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+			std::cout << "Cycler::followProtocol is doing a check-up in cycle number " << cycle << ".\n";
+		cap = checkUp(proc, cycle, r.time / 3600, r.Ah, r.Wh);
+		if (cap < capnom / 2.0)
+		{
+			std::cout << "Cycler::followProtocol has finished protocol " << ID << " early because the cell has already lost 50% of its capacity.";
+			std::cout << " We have done " << cycle << " cycles and the remaining capacity now is " << cap << " [Ah].\n";
+			final = false; // skip the final check-up because we just did one
+		}
+		return final;
+	};
+
+	// *********************************************************** 2 execute the protocol ***********************************************************************
+
+	try
+	{
+		runProtocol(p, blockDegradation, Vma, Vmi, r, check);
+		if (r.end <= 0)
+		{
+			// the cell went outside its voltage range or an error occurred in a step
+			std::cout << "Cycler::followProtocol has finished protocol " << ID << " early because a step ended with code " << r.end << ".\n";
+			checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+			final = false;
+		}
+	}
+
+	// Catch an error which occurred while cycling the cell (or during the check-up procedure)
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+		{
+			std::cout << "Error in Cycler::followProtocol while following protocol " << ID << ". Error encountered is " << e << ". Stop cycling now.";
+			std::cout << " We have done " << r.nrCycles << " cycles and the capacity last measured is " << cap << " [Ah].\n";
+		}
+
+		// we probably cannot do a full check-up procedure because the cell is in an illegal state.
+		// Therefore, only write the BatteryStates with a capacity of 0 to indicate something went wrong
+		checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+		final = false;
+	}
+
+	// *********************************************************** 3 final check-up ***********************************************************************
+
+	if (final)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::followProtocol is doing a final check-up.\n";
+			checkUp(proc, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in a in the final check-up of Cycler::followProtocol " << e << ". Throwing it on.\n";
+			throw e;
+		}
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::followProtocol terminating\n";
+}
+
+void Cycler::socWindowAgeing(double dt, double SOCmin, double SOCmax, double Ccha, double Cdis, bool modelSOC, int anchor,
+							 double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc)
+{
+	/*
+	 * Function to age the cell by cycling it in a SOC window, e.g. between 20% and 80%, with CC charges and discharges.
+	 * The window is defined in one of two ways:
+	 * 		counted 	the discharges and charges last for (SOCmax - SOCmin) times the capacity measured at the latest check-up,
+	 * 					and the window starts at SOCmax below a full CC CV charge (the anchor).
+	 * 					As in a real test, the position of the window drifts because of the coulombic inefficiency of the cell,
+	 * 					so it can be re-anchored by a full charge after some of the check-ups.
+	 * 		model SOC 	the discharges end when the SOC of the model drops below SOCmin and the charges when it reaches SOCmax (see Cell::getSOC).
+	 * 					This SOC is relative to the present capacity, so the window does not drift and does not need to be re-anchored.
+	 * The voltage limits of the cell are respected, such that a window which no longer fits in the capacity of the cell is cut off at the voltage limits.
+	 * After every block of nrCap cycles (and at the end), a check-up is done and the position of the window is written (see writeSOCwindow).
+	 *
+	 * IN
+	 * dt 		time step to use for the cycling [s]
+	 * SOCmin 	bottom of the window [-], 0 <= SOCmin < SOCmax
+	 * SOCmax 	top of the window [-], SOCmin < SOCmax <= 1
+	 * Ccha 	C rate of the charges [-], > 0
+	 * Cdis 	C rate of the discharges [-], > 0
+	 * modelSOC if true, the window is defined by the SOC of the model, else it is counted in Ah
+	 * anchor 	the window is re-anchored after every anchor check-ups, 0 to only anchor it at the start (only used if the window is counted)
+	 * Ti 		environmental temperature [K]
+	 * nrCycles number of cycles to be simulated in total [-]
+	 * nrCap 	number of cycles between consecutive check-ups [-]
+	 * proc 	structure with the parameters of the check-up procedure
+	 *
+	 * THROWS
+	 * 1014 	illegal input parameters
+	 */
+
+	using slide::protocol::above;
+	using slide::protocol::below;
+	using slide::protocol::Var;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::socWindowAgeing starting.\n";
+
+	const double Ccut = 0.05; // C rate of the cutoff current of the CV charges which anchor the window
+	slide::util::error::checkInputParam_CycAge(c, c.getVmax(), c.getVmin(), Ccha, Ccut, Cdis, Ccut, Ti, nrCycles, nrCap); // Check the input parameters
+	slide::util::error::checkInputParam_SOCwindow(SOCmin, SOCmax);
+
+	// *********************************************************** 1 variables & settings ***********************************************************************
+
+	slide::protocol::Run r;			   // throughput, time and cycle number until now
+	double ahi, whi, ti;			   // throughput and time of a charge or discharge
+	double cap;						   // capacity of the cell at this point in time [Ah]
+	bool blockDegradation = false;	   // account for degradation while we cycle
+	double capnom = c.getNominalCap(); // nominal cell capacity [Ah]
+	int ncheck = 0;					   // number of check-ups done since the start
+
+	// capacity which defines the window, the nominal capacity if the capacity is not measured in the check-ups
+	auto capw = [&]() { return (cap > 0) ? cap : capnom; };
+
+	// bring the cell to the top of the window: full CC CV charge and a discharge of 1 - SOCmax times the capacity
+	auto anchorWindow = [&]() {
+		CC_V_CV_I(Ccha, c.getVmax(), Ccut, dt, blockDegradation, &ahi, &whi, &ti);
+		r.Ah += std::abs(ahi);
+		r.Wh += std::abs(whi);
+		r.time += ti;
+		if (SOCmax < 1)
+		{
+			slide::protocol::Protocol p;
+			p.CC(Cdis * capnom, {above(Var::Ah, (1 - SOCmax) * capw()), below(Var::V, c.getVmin())}, slide::protocol::tmax, dt);
+			runProtocol(p, blockDegradation, c.getVmax(), c.getVmin(), r);
+		}
+	};
+
+	// block of nrCap cycles (discharge and charge) in the window, the last block can be shorter
+	auto block = [&]() {
+		const int n = std::min(nrCap, nrCycles - r.nrCycles);
+		slide::protocol::Protocol p;
+		if (modelSOC)
+			p.loop(n)
+				.CC(Cdis * capnom, {below(Var::SOC, SOCmin), below(Var::V, c.getVmin())}, slide::protocol::tmax, dt)
+				.CC(-Ccha * capnom, {above(Var::SOC, SOCmax), above(Var::V, c.getVmax())}, slide::protocol::tmax, dt)
+				.endLoop();
+		else
+			p.loop(n)
+				.CC(Cdis * capnom, {above(Var::Ah, (SOCmax - SOCmin) * capw()), below(Var::V, c.getVmin())}, slide::protocol::tmax, dt)
+				.CC(-Ccha * capnom, {above(Var::Ah, (SOCmax - SOCmin) * capw()), above(Var::V, c.getVmax())}, slide::protocol::tmax, dt)
+				.endLoop();
+		const int n0 = r.nrCycles;
+		r.nrCycles = 0;
+		runProtocol(p, blockDegradation, c.getVmax(), c.getVmin(), r);
+		r.nrCycles += n0;
+	};
+
+	// *********************************************************** 2 cell initialisation ***********************************************************************
+
+	c.setT(Ti);	   // set the cell temperature
+	c.setTenv(Ti); // set the environmental temperature
+
+	try
+	{
+		CC_V_CV_I(Ccha, c.getVmax(), Ccut, dt, blockDegradation, &ahi, &whi, &ti); // start from a full cell
+		cap = checkUp(proc, 0, 0, 0, 0);
+		if (!modelSOC)
+			anchorWindow();
+		else if (SOCmax < 1)
+		{
+			slide::protocol::Protocol p;
+			p.CC(Cdis * capnom, {below(Var::SOC, SOCmax), below(Var::V, c.getVmin())}, slide::protocol::tmax, dt);
+			runProtocol(p, blockDegradation, c.getVmax(), c.getVmin(), r);
+		}
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::socWindowAgeing when bringing the cell to the top of the window or in the initial check-up, error " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	// *********************************************************** 3 cycle age the cell ***********************************************************************
+
+	while (r.nrCycles < nrCycles)
+	{
+		try
+		{
+			block();
+			if (r.end <= 0)
+			{
+				std::cout << "Cycler::socWindowAgeing has finished cycling regime " << ID << " early because a (dis)charge ended with code " << r.end << ".\n";
+				checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+				break;
+			}
+
+			ncheck++;
+			const bool reanchor = !modelSOC && anchor > 0 && ncheck % anchor == 0;
+			writeSOCwindow(r.nrCycles, r.time / 3600, r.Ah, r.Wh, modelSOC ? 0 : (SOCmax - SOCmin) * capw(), reanchor);
+
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::socWindowAgeing is doing a check-up in cycle number " << r.nrCycles << ".\n";
+			cap = checkUp(proc, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+
+			// End the experiment if the cell capacity has decreased too much
+			if (cap < capnom / 2.0)
+			{
+				std::cout << "Cycler::socWindowAgeing has finished cycling regime " << ID << " early because the cell has already lost 50% of its capacity.";
+				std::cout << " We have done " << r.nrCycles << " cycles instead of " << nrCycles << " and the remaining capacity now is " << cap << " [Ah].\n";
+				break;
+			}
+
+			if (reanchor)
+				anchorWindow();
+		}
+
+		// Catch an error which occurred while cycling the cell (or during the check-up procedure)
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+			{
+				std::cout << "Error in Cycler::socWindowAgeing while cycling the cell according to cycling regime " << ID << ". Error encountered is " << e << ". Stop cycling now.";
+				std::cout << " We have done " << r.nrCycles << " cycles instead of " << nrCycles << " and the capacity last measured is " << cap << " [Ah].\n";
+			}
+			checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+			break;
+		}
+	} // the check-up after the last block is the final check-up
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::socWindowAgeing terminating\n";
+}
+
+void Cycler::usageAgeing(const slide::usage::Stats &st, unsigned seed, double Vma, double Vmi, double Ti, int nrDays, int daysCheck, struct checkUpProcedure &proc)
+{
+	/*
+	 * Function to age the cell with realistic usage, e.g. of an electric vehicle.
+	 * Every day, a schedule of trips, charges and rests is drawn from the statistics of the usage (see usage.hpp),
+	 * and the rest of the day after the last event is added such that every day lasts 24 hours.
+	 * The rests are done with a growing time step (see Cell::ETI_rest), so a year of usage with many hours of rest per day is simulated quickly.
+	 * The same seed gives the same schedules, so different cells or temperatures can be compared under the same usage.
+	 * The usage of every day is written to a file (see writeUsage), and a check-up is done every daysCheck days and at the end.
+	 * The cell starts fully charged.
+	 *
+	 * IN
+	 * st 		statistics of the usage
+	 * seed 	seed of the random number generator which draws the schedules
+	 * Vma 		maximum voltage of the drive profiles and charges [V]
+	 * Vmi 		minimum voltage of the drive profiles [V]
+	 * Ti 		environmental temperature [K]
+	 * nrDays 	number of days to be simulated [-]
+	 * daysCheck number of days between consecutive check-ups [-]
+	 * proc 	structure with the parameters of the check-up procedure
+	 *
+	 * THROWS
+	 * 1014 	illegal input parameters
+	 * 1021 	illegal statistics (see usage::Generator)
+	 */
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::usageAgeing starting.\n";
+
+	slide::util::error::checkInputParam_Usage(c, Vma, Vmi, Ti, nrDays, daysCheck); // Check the input parameters
+	slide::usage::Generator gen(st, seed);
+
+	// *********************************************************** 1 variables & settings ***********************************************************************
+
+	constexpr double tday = 24 * 3600;	   // duration of a day [s]
+	double ahi, whi, ti;				   // throughput and time of the initial charge
+	double cap;							   // capacity of the cell at this point in time [Ah]
+	bool blockDegradation = false;		   // account for degradation while we cycle
+	double capnom = c.getNominalCap();	   // nominal cell capacity [Ah], used to convert the C rates of the charges to currents
+	double Ahtot = 0, Whtot = 0, ttot = 0; // cumulative throughput and time [Ah], [Wh], [s]
+	int day = 0;						   // number of days done
+	bool final = true;					   // boolean to indicate if a check-up at the end is needed
+
+	// *********************************************************** 2 cell initialisation ***********************************************************************
+
+	c.setT(Ti);	   // set the cell temperature
+	c.setTenv(Ti); // set the environmental temperature
+
+	try
+	{
+		CC_V_CV_I(st.Ccha, Vma, st.Ccut, 2, blockDegradation, &ahi, &whi, &ti); // start from a full cell
+		cap = checkUp(proc, 0, 0, 0, 0);
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::usageAgeing when charging the cell or in the initial check-up, error " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	// *********************************************************** 3 use the cell day by day ***********************************************************************
+
+	while (day < nrDays)
+	{
+		try
+		{
+			const auto sched = gen.day();
+			slide::protocol::Protocol p;
+			slide::usage::build(sched, gen.stats(), capnom, Vma, p);
+			slide::protocol::Run r; // totals of this day
+			runProtocol(p, blockDegradation, Vma, Vmi, r);
+			const double tend = r.time; // end of the last event of the day
+
+			// rest for the remainder of the day
+			if (r.end > 0 && r.time < tday)
+			{
+				slide::protocol::Protocol pr;
+				pr.restFast(tday - r.time);
+				runProtocol(pr, blockDegradation, Vma, Vmi, r);
+			}
+			day++;
+			Ahtot += r.Ah;
+			Whtot += r.Wh;
+			ttot += r.time;
+
+			if (r.end <= 0)
+			{
+				std::cout << "Cycler::usageAgeing has finished usage " << ID << " early because a step ended with code " << r.end << " on day " << day << ".\n";
+				checkUp_batteryStates(proc.blockDegradation, false, day, ttot / 3600, Ahtot, Whtot);
+				final = false;
+				break;
+			}
+
+			r.time = tend;
+			writeUsage(day, sched, r, ttot / 3600, Ahtot, Whtot);
+
+			if (day % daysCheck == 0)
+			{
+				if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+					std::cout << "Cycler::usageAgeing is doing a check-up on day " << day << ".\n";
+				cap = checkUp(proc, day, ttot / 3600, Ahtot, Whtot);
+				final = day != nrDays; // the check-up on the last day is the final check-up
+
+				// End the experiment if the cell capacity has decreased too much
+				if (cap < capnom / 2.0)
+				{
+					std::cout << "Cycler::usageAgeing has finished usage " << ID << " early because the cell has already lost 50% of its capacity.";
+					std::cout << " We have done " << day << " days instead of " << nrDays << " and the remaining capacity now is " << cap << " [Ah].\n";
+					final = false;
+					break;
+				}
+			}
+		}
+
+		// Catch an error which occurred while using the cell (or during the check-up procedure)
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+			{
+				std::cout << "Error in Cycler::usageAgeing while using the cell according to usage " << ID << ". Error encountered is " << e << ". Stop cycling now.";
+				std::cout << " We have done " << day << " days instead of " << nrDays << " and the capacity last measured is " << cap << " [Ah].\n";
+			}
+			checkUp_batteryStates(proc.blockDegradation, false, day, ttot / 3600, Ahtot, Whtot);
+			final = false;
+			break;
+		}
+	}
+
+	// *********************************************************** 4 final check-up ***********************************************************************
+
+	if (final)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::usageAgeing is doing a final check-up.\n";
+			checkUp(proc, day, ttot / 3600, Ahtot, Whtot);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in the final check-up of Cycler::usageAgeing " << e << ". Throwing it on.\n";
+			throw e;
+		}
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::usageAgeing terminating\n";
+}
+
+void Cycler::mixedAgeing(const std::vector<AgeingEvent> &events, int period, double Vma, double Vmi, int nrDays, int daysCheck, struct checkUpProcedure &proc)
+{
+	/*
+	 * Function to simulate a combined calendar and cycle ageing experiment, e.g. one cycle per day with a rest at 90% SOC in between.
+	 * The experiment repeats a period of one or more days (e.g. 1 for a daily or 7 for a weekly structure).
+	 * Every event starts at a given time of the period, does a number of full cycles from its resting SOC,
+	 * and brings the cell to its resting SOC, where it rests at its resting temperature until the next event.
+	 * The SOC is the one of the model (see Cell::getSOC), so the resting SOC is relative to the present capacity of the cell.
+	 * If an event takes longer than the time until the next event, the next event starts immediately after it.
+	 * The rests are done with a growing time step (see Cell::ETI_rest), so long experiments are simulated quickly.
+	 * The check-ups are done at a fixed interval of the wall-clock time (every daysCheck days), also if this is in the middle of a rest,
+	 * and the time of the check-ups is not counted in the wall-clock time.
+	 * The cell starts at the resting SOC and temperature of the last event, as if the period had already been repeated.
+	 *
+	 * IN
+	 * events 	cycling events, in increasing order of their start
+	 * period 	duration of the period which is repeated [days]
+	 * Vma 		maximum voltage of the cycles [V]
+	 * Vmi 		minimum voltage of the cycles [V]
+	 * nrDays 	duration of the experiment [days]
+	 * daysCheck number of days between consecutive check-ups [days]
+	 * proc 	structure with the parameters of the check-up procedure
+	 *
+	 * THROWS
+	 * 1014 	illegal input parameters
+	 */
+
+	using slide::protocol::above;
+	using slide::protocol::below;
+	using slide::protocol::Protocol;
+	using slide::protocol::Var;
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::mixedAgeing starting.\n";
+
+	slide::util::error::checkInputParam_MixedAge(c, events, period, Vma, Vmi, nrDays, daysCheck); // Check the input parameters
+
+	// *********************************************************** 1 variables & settings ***********************************************************************
+
+	constexpr double tday = 24 * 3600;	   // duration of a day [s]
+	constexpr double ttol = 1;			   // tolerance on the times of the events and check-ups [s]
+	slide::protocol::Run r;				   // throughput and cycle number until now, r.time is the wall-clock time since the start [s]
+	double ahi, whi, ti;				   // throughput and time of the initial charge
+	double cap;							   // capacity of the cell at this point in time [Ah]
+	bool blockDegradation = false;		   // account for degradation while we cycle
+	double capnom = c.getNominalCap();	   // nominal cell capacity [Ah]
+	const double tend = nrDays * tday;	   // end of the experiment [s]
+	double tcheck = daysCheck * tday;	   // time of the next check-up [s]
+	double tnext = events[0].start * 3600; // start of the next event [s]
+	size_t k = 0;						   // index of the next event
+	int np = 0;							   // number of the period of the next event
+	bool final = true;					   // boolean to indicate if a check-up at the end is needed
+
+	// bring the cell to the resting SOC and temperature of an event
+	auto toRest = [&](const AgeingEvent &e, Protocol &p) {
+		p.Tenv(e.Trest);
+		if (e.SOCrest < 1)
+			p.jumpIf(below(Var::SOC, e.SOCrest), "up")
+				.CC(e.Cdis * capnom, {below(Var::SOC, e.SOCrest), below(Var::V, Vmi)})
+				.jump("rest")
+				.label("up")
+				.CC(-e.Ccha * capnom, {above(Var::SOC, e.SOCrest), above(Var::V, Vma)})
+				.label("rest");
+		else if (e.nrCycles == 0)
+		{
+			p.CC(-e.Ccha * capnom, {above(Var::V, Vma)});
+			if (e.CVcha)
+				p.CV(Vma, {below(Var::I, e.Ccut * capnom)});
+		}
+	};
+
+	// *********************************************************** 2 cell initialisation ***********************************************************************
+
+	c.setT(events.back().Trest);	// set the cell temperature
+	c.setTenv(events.back().Trest); // set the environmental temperature
+
+	try
+	{
+		CC_V_CV_I(events.back().Ccha, Vma, events.back().Ccut, 2, blockDegradation, &ahi, &whi, &ti); // start from a full cell
+		cap = checkUp(proc, 0, 0, 0, 0);
+		Protocol p;
+		toRest(events.back(), p);
+		runProtocol(p, blockDegradation, Vma, Vmi, r);
+		r = slide::protocol::Run{}; // the experiment starts at the resting SOC
+	}
+	catch (int e)
+	{
+		if constexpr (settings::verbose >= printLevel::printCrit)
+			std::cout << "Error in Cycler::mixedAgeing when bringing the cell to its resting SOC or in the initial check-up, error " << e << ". Throwing it on.\n";
+		throw e;
+	}
+
+	// *********************************************************** 3 age the cell ***********************************************************************
+
+	while (r.time < tend - ttol)
+	{
+		try
+		{
+			// rest until the next event, check-up or the end of the experiment
+			const double trest = std::min({tnext, tcheck, tend}) - r.time;
+			if (trest > ttol)
+			{
+				Protocol p;
+				p.restFast(trest);
+				runProtocol(p, blockDegradation, Vma, Vmi, r);
+			}
+
+			if (r.end > 0 && r.time >= tcheck - ttol)
+			{
+				if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+					std::cout << "Cycler::mixedAgeing is doing a check-up after " << r.time / tday << " days.\n";
+				cap = checkUp(proc, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+				tcheck += daysCheck * tday;
+				final = r.time < tend - ttol; // the check-up at the end is the final check-up
+
+				// End the experiment if the cell capacity has decreased too much
+				if (cap < capnom / 2.0)
+				{
+					std::cout << "Cycler::mixedAgeing has finished regime " << ID << " early because the cell has already lost 50% of its capacity.";
+					std::cout << " We have done " << r.time / tday << " days instead of " << nrDays << " and the remaining capacity now is " << cap << " [Ah].\n";
+					final = false;
+					break;
+				}
+			}
+			else if (r.end > 0 && r.time >= tnext - ttol && r.time < tend - ttol)
+			{
+				// the cycles of the event and the move to its resting SOC
+				const auto &e = events[k];
+				Protocol p;
+				p.Tenv(e.Tcycle);
+				if (e.nrCycles > 0)
+				{
+					p.loop(e.nrCycles)
+						.CC(e.Cdis * capnom, {below(Var::V, Vmi)})
+						.CC(-e.Ccha * capnom, {above(Var::V, Vma)});
+					if (e.CVcha)
+						p.CV(Vma, {below(Var::I, e.Ccut * capnom)});
+					p.endLoop();
+				}
+				toRest(e, p);
+
+				const int n0 = r.nrCycles;
+				r.nrCycles = 0;
+				runProtocol(p, blockDegradation, Vma, Vmi, r);
+				r.nrCycles += n0;
+
+				// start of the next event
+				k = (k + 1) % events.size();
+				np += (k == 0);
+				tnext = np * period * tday + events[k].start * 3600;
+			}
+
+			if (r.end <= 0)
+			{
+				std::cout << "Cycler::mixedAgeing has finished regime " << ID << " early because a step ended with code " << r.end << ".\n";
+				checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+				final = false;
+				break;
+			}
+		}
+
+		// Catch an error which occurred while cycling the cell (or during the check-up procedure)
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+			{
+				std::cout << "Error in Cycler::mixedAgeing while ageing the cell according to regime " << ID << ". Error encountered is " << e << ". Stop now.";
+				std::cout << " We have done " << r.time / tday << " days instead of " << nrDays << " and the capacity last measured is " << cap << " [Ah].\n";
+			}
+			checkUp_batteryStates(proc.blockDegradation, false, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+			final = false;
+			break;
+		}
+	}
+
+	// *********************************************************** 4 final check-up ***********************************************************************
+
+	if (final)
+	{
+		try
+		{
+			if constexpr (settings::verbose >= printLevel::printCyclerHighLevel)
+				std::cout << "Cycler::mixedAgeing is doing a final check-up.\n";
+			checkUp(proc, r.nrCycles, r.time / 3600, r.Ah, r.Wh);
+		}
+		catch (int e)
+		{
+			if constexpr (settings::verbose >= printLevel::printCrit)
+				std::cout << "Error in the final check-up of Cycler::mixedAgeing " << e << ". Throwing it on.\n";
+			throw e;
+		}
+	}
+
+	if constexpr (settings::verbose >= printLevel::printCyclerFunctions)
+		std::cout << "Cycler::mixedAgeing terminating\n";
+}
@@ -25,6 +25,8 @@
 #include "interpolation.h"
 #include "util.hpp"
 #include "slide_aux.hpp"
+#include "ica.hpp"
+#include "usage.hpp"
 
 // Define a structure which outlines the check-up procedure.
 // A check-up can consist of 4 things:
@@ -39,6 +41,7 @@ struct checkUpProcedure
 	bool OCVCheck;			 // boolean indicating if the half-cell OCV curves should be checked
 	bool CCCVCheck;			 // boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	bool pulseCheck;		 // boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	bool EISCheck{false};	 // boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	bool includeCycleData;	 // boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	int nCycles;			 // number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	double Crates[100];		 // array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -49,6 +52,12 @@ struct checkUpProcedure
 							 //	the second column contains the time in [sec] the current should be maintained
 							 //	the profile must be a net discharge, i.e. sum (I*dt) > 0
 	int profileLength;		 // length of the current profiles for the pulse test (number of rows in the csv file)
+	std::vector<double> EISfreq; // frequencies for the impedance spectrum [Hz], if empty 5 frequencies per decade from 10 kHz to 1 mHz are used
+	bool GITTCheck{false};	 // boolean indicating if a galvanostatic intermittent titration (GITT) should be done as part of the check-up procedure
+	double GITTCrate{0.5};	 // C rate of the GITT discharge pulses [-], must be positive
+	double GITTtpulse{120};	 // duration of the GITT pulses [s], should be short compared to the diffusion time of the particles
+	double GITTtrelax{3600}; // duration of the relaxation after every GITT pulse [s]
+	int GITTperDecade{10};	 // number of samples of the relaxation voltage per decade of time since the end of the pulse [-]
 
 	std::vector<double> I, T; // profile data;
 
@@ -72,22 +81,55 @@ struct checkUpProcedure
 	}
 };
 
+// Cycling event of a combined calendar and cycle ageing experiment (see Cycler::mixedAgeing).
+// The event starts at a time of day (or of the week), does a number of full cycles from its resting SOC,
+// and leaves the cell at the resting SOC and temperature until the next event.
+struct AgeingEvent
+{
+	double start{0};	   // start of the event in the period [h], e.g. 7.5 for half past seven, or 24 + 7.5 for the second day of a weekly period
+	int nrCycles{1};	   // number of cycles (a discharge to the minimum voltage and a charge to the maximum voltage) [-], 0 to only change the resting SOC
+	double Ccha{1};		   // C rate of the charges [-], > 0
+	double Cdis{1};		   // C rate of the discharges [-], > 0
+	bool CVcha{true};	   // boolean indicating if the charges end with a CV phase
+	double Ccut{0.05};	   // C rate of the cutoff current of the CV phases [-], > 0
+	double Tcycle{298.15}; // environmental temperature during the cycles [K]
+	double SOCrest{0.9};   // SOC at which the cell rests after the event [-], 1 to rest after a full charge
+	double Trest{298.15};  // environmental temperature during the rest after the event [K]
+};
+
 class Cycler : public BasicCycler
 {
 private:
 	int indexdegr; // index number of the check-up (how many check-ups have we done so far)
 
+	double Qp_ref{0}, Qn_ref{0}, nLi_ref{0}; // electrode capacities and cyclable lithium at the first check-up [Ah], the degradation modes are relative to these
+	slide::ica::Tracker ica_model, ica_OCV;	 // peaks of the IC and DV curves of the model and of the measured OCV curves which are followed over the check-ups
+
 	// functions for a check-up
 	double getCapacity(bool blockDegradation);																										 // measure the remaining cell capacity
 	void getOCV(slide::fixed_data<double> &Ah, std::vector<double> &OCVp, std::vector<double> &OCVn);												 // measure the half-cell OCV curves
 	double checkUp_batteryStates(bool blockDegradation, bool checkCap, int cumCycle, double cumTime, double cumAh, double cumWh);					 // measure the capacity and battery state & write to a file
-	void checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocvnini);																	 // measure the half-cell OCV curves & write them to a file
+	void checkUp_degradationModes(int cumCycle, double cumTime, double cumAh, double cumWh);														 // calculate the degradation modes & write them to a file
+	void checkUp_sideReactions(int cumCycle, double cumTime, double cumAh, double cumWh);															 // write the charge of the side reactions at the cathode to a file
+	void checkUp_thermal(int cumCycle, double cumTime, double cumAh, double cumWh);																	 // write the energy use and thermal regimes of the thermal management to a file
+	void checkUp_OCVcurves(bool blockDegradation, double ocvpini, double ocvnini, std::vector<double> &Q, std::vector<double> &V);					 // measure the half-cell OCV curves & write them to a file
+	void checkUp_ICA(bool measured, const std::vector<double> &Q, const std::vector<double> &V, int cumCycle, double cumTime, double cumAh, double cumWh); // calculate the IC and DV peaks & write them to a file
 	void checkUp_CCCV(bool blockDegradation, int nCycles, double Crates[], double Ccut_cha, double Ccut_dis, bool includeCycleData);				 // measure the voltage and temperature during some CCCV cycles & write to a file
 	void checkUp_pulse(bool blockDegradation, const std::string &profileName, int profileLength, bool includeCycleData);							 // measure the voltage and temperature during a pulse discharge & write to a file
 	void checkUp_pulse(bool blockDegradation, const std::vector<double> &I, const std::vector<double> &T, int profileLength, bool includeCycleData); // measure the voltage and temperature during a pulse discharge & write to a file
+	void checkUp_EIS(const std::vector<double> &freq, int cumCycle, double cumTime, double cumAh, double cumWh);									 // calculate the impedance spectrum & write it to a file
+	void checkUp_GITT(bool blockDegradation, double Crate, double tpulse, double trelax, int perDecade, int cumCycle, double cumTime, double cumAh, double cumWh); // do a GITT, write the relaxation curves and apparent diffusion constants to files
 
 	double checkUp(struct checkUpProcedure &proc, int cumCycle, double cumTime, double cumAh, double cumWh); // function to do a check-up of a cell
 
+	void writePlating(int cumCycle, double *Qpl, double *Qstrip, double *Qdead); // write the plated, stripped and dead lithium of the last cycle to a file
+	void writeSOCwindow(int cumCycle, double cumTime, double cumAh, double cumWh, double dAh, bool anchored); // write the position of the SOC window to a file
+	void writeUsage(int day, const slide::usage::Schedule &s, const slide::protocol::Run &r, double cumTime, double cumAh, double cumWh); // write the usage of one day to a file
+	void cycleAgeing_load(bool power, double dt, double Vma, double Vmi, double Xcha, bool CVcha, double Ccutcha, // implementation of cycleAgeing and powerCycleAgeing
+						  double Xdis, bool CVdis, double Ccutdis, double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc);
+	void profileAgeing_load(bool power, const std::string &nameI, int limit, // implementation of profileAgeing and powerProfileAgeing
+							double Vma, double Vmi, double Ti, int nrProfiles, int nrCap, struct checkUpProcedure &proc, size_t length);
+
 public:
 	Cycler(Cell &ci, std::string IDi, int verbosei, int feedbacki) : BasicCycler(ci, IDi, verbosei, feedbacki), indexdegr(0) {} // constructor
 
@@ -98,4 +140,15 @@ public:
 						int timeCheck, int mode, struct checkUpProcedure &proc);
 	void profileAgeing(const std::string &nameI, int limit, // profile ageing by repeating the same current profile
 					   double Vma, double Vmi, double Ti, int nrProfiles, int nrCap, struct checkUpProcedure &proc, size_t length = 1000);
+	void powerCycleAgeing(double dt, double Vma, double Vmi, double Pcha, bool CVcha, double Icutcha, // cycle ageing with constant power (dis)charges
+						  double Pdis, bool CVdis, double Icutdis, double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc);
+	void powerProfileAgeing(const std::string &nameP, int limit, // profile ageing by repeating the same power profile
+							double Vma, double Vmi, double Ti, int nrProfiles, int nrCap, struct checkUpProcedure &proc, size_t length = 1000);
+	void followProtocol(slide::protocol::Protocol &p, double Vma, double Vmi, struct checkUpProcedure &proc); // age the cell with a programmed protocol of steps, loops, jumps and check-ups
+	void socWindowAgeing(double dt, double SOCmin, double SOCmax, double Ccha, double Cdis, bool modelSOC, int anchor, // cycle ageing in a SOC window counted in Ah or defined by the SOC of the model
+						 double Ti, int nrCycles, int nrCap, struct checkUpProcedure &proc);
+	void usageAgeing(const slide::usage::Stats &st, unsigned seed, double Vma, double Vmi, double Ti, // age the cell with daily schedules of trips, charges and rests drawn from usage statistics
+					 int nrDays, int daysCheck, struct checkUpProcedure &proc);
+	void mixedAgeing(const std::vector<AgeingEvent> &events, int period, double Vma, double Vmi, // combined calendar and cycle ageing with cycling events at given times of the day or week
+					 int nrDays, int daysCheck, struct checkUpProcedure &proc);
 };
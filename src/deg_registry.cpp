@@ -0,0 +1,100 @@
+/*
+ * deg_registry.cpp
+ *
+ * Implements the registry of degradation models.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "deg_registry.hpp"
+
+#include <iostream>
+
+namespace slide::deg
+{
+	Registry::Registry()
+	{
+		/*
+		 * Register the built-in models with the identifiers used in DEG_ID.
+		 * They have no rate function since they are evaluated by the switch-statements in Cell::SEI, Cell::CS, Cell::LAM, Cell::LiPlating and Cell::CAT.
+		 */
+
+		models = {
+			{"SEI_none", Mechanism::SEI, 0, 0, 0},
+			{"SEI_kinetic", Mechanism::SEI, in_eta | in_T, 0, 1},			  // Ning & Popov, 2004
+			{"SEI_PinsonBazant", Mechanism::SEI, in_eta | in_T, 0, 2},		  // Pinson & Bazant, 2013
+			{"SEI_ChristensenNewman", Mechanism::SEI, in_eta | in_T, 0, 3},	  // Christensen & Newman, 2005
+			{"CS_none", Mechanism::CS, 0, 0, 0},							  //
+			{"CS_Laresgoiti", Mechanism::CS, in_stressLares, 0, 1},			  // Laresgoiti et al., 2015
+			{"CS_Dai", Mechanism::CS, in_stressDai, 0, 2},					  // Dai's stress with Laresgoiti's crack growth
+			{"CS_DeshpandeBernardi", Mechanism::CS, in_conc, 0, 3},			  // Deshpande & Bernardi, 2017
+			{"CS_Barai", Mechanism::CS, 0, 0, 4},							  // Barai et al., 2015
+			{"CS_Ekstrom", Mechanism::CS, in_conc | in_eta | in_T, 0, 5},	  // Ekstrom & Lindbergh, 2015
+			{"LAM_none", Mechanism::LAM, 0, 0, 0},							  //
+			{"LAM_Dai", Mechanism::LAM, in_stressDai, 0, 1},				  // Dai's stress with Laresgoiti's correlation
+			{"LAM_Delacourt", Mechanism::LAM, in_T, 0, 2},					  // Delacourt & Safari, 2012
+			{"LAM_Kindermann", Mechanism::LAM, in_conc | in_eta | in_T, 0, 3}, // Kindermann et al., 2017
+			{"LAM_Narayanrao", Mechanism::LAM, 0, 0, 4},					  // Narayanrao et al., 2012
+			{"PL_none", Mechanism::PL, 0, 0, 0},							  //
+			{"PL_Yang", Mechanism::PL, in_eta | in_T, 0, 1},					  // Yang et al., 2017
+			{"PL_OKane", Mechanism::PL, in_eta | in_T, 0, 2},				  // O'Kane et al., 2020
+			{"CAT_none", Mechanism::CAT, 0, 0, 0},							  //
+			{"CAT_oxidation", Mechanism::CAT, in_conc | in_eta | in_T, 0, 1}, // electrolyte oxidation
+			{"CAT_shuttle", Mechanism::CAT, in_conc | in_eta | in_T, 0, 2}	  // redox shuttle
+		};
+	}
+
+	Registry &Registry::get()
+	{
+		static Registry reg;
+		return reg;
+	}
+
+	int Registry::add(const Model &m)
+	{
+		/*
+		 * Register a user-defined degradation model
+		 *
+		 * IN
+		 * m 		the model, it must have a unique name and a rate function
+		 *
+		 * OUT
+		 * int 		index of the model in the registry
+		 *
+		 * THROWS
+		 * 106 		the name is already used or the model has no rate function
+		 * 107 		the model has more states than there are available
+		 */
+
+		if (find(m.name) != -1)
+		{
+			std::cerr << "ERROR in deg::Registry::add, there is already a degradation model with the name " << m.name << ". Throwing an error.\n";
+			throw 106;
+		}
+		if (m.rate == nullptr || m.builtin_id != -1)
+		{
+			std::cerr << "ERROR in deg::Registry::add, the degradation model " << m.name << " has no rate function. Throwing an error.\n";
+			throw 106;
+		}
+		if (m.nstates < 0 || m.nstates > settings::ns_deg)
+		{
+			std::cerr << "ERROR in deg::Registry::add, the degradation model " << m.name << " has " << m.nstates
+					  << " states but only " << settings::ns_deg << " are available. Throwing an error.\n";
+			throw 107;
+		}
+
+		models.push_back(m);
+		return size() - 1;
+	}
+
+	int Registry::find(const std::string &name) const
+	{
+		for (int i = 0; i < size(); i++)
+			if (models[i].name == name)
+				return i;
+
+		return -1;
+	}
+} // namespace slide::deg
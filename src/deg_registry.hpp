@@ -0,0 +1,110 @@
+/*
+ * deg_registry.hpp
+ *
+ * Registry of degradation models which can be selected by name.
+ *
+ * The built-in models (SEI growth, surface cracking, LAM, lithium plating and cathode side reactions) are registered with their integer identifier,
+ * such that selecting them by name fills in the same identifiers in DEG_ID and they are evaluated by the switch-statements in the Cell.
+ * User-defined models are declared as a Model with the inputs they need, the number of own states and a rate function.
+ * They are evaluated in Cell::dState after the built-in models and their rates are added to the ones of the built-in models.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+
+namespace slide::deg
+{
+	// degradation mechanism to which a model contributes
+	enum class Mechanism
+	{
+		SEI, // SEI growth
+		CS,	 // surface cracking
+		LAM, // loss of active material
+		PL,	 // lithium plating
+		CAT	 // side reactions at the cathode
+	};
+
+	// flags for the inputs a model needs.
+	// the concentrations, overpotentials and temperature are always available (they are computed anyway in Cell::dState),
+	// but the stresses are only calculated if at least one of the selected models needs them because that is expensive.
+	enum Input : unsigned
+	{
+		in_conc = 1 << 0,		 // surface li-fractions
+		in_eta = 1 << 1,		 // overpotentials and anode potential
+		in_T = 1 << 2,			 // cell temperature
+		in_stressDai = 1 << 3,	 // hydrostatic stress according to Dai's stress model
+		in_stressLares = 1 << 4	 // stress according to Laresgoiti's stress model
+	};
+
+	// values available to the rate function of a model
+	struct Inputs
+	{
+		double T, T_ref;		  // cell temperature and reference temperature [K]
+		double I;				  // cell current [A], > 0 for discharge
+		double zp_surf, zn_surf;  // li-fraction at the surface of the positive and negative particle [-]
+		double OCVnt;			  // anode potential at the cell temperature [V]
+		double etap, etan;		  // overpotential at the positive and negative electrode [V]
+		double delta, CS, LLI;	  // SEI thickness [m], crack surface [m2], lost lithium [As]
+		double ASn;				  // active surface area of the anode [m2]
+		double s_dai_p, s_dai_n;  // Dai's stress in this and the previous time step (only valid with in_stressDai)
+		double s_dai_p_prev, s_dai_n_prev;
+		double s_lares_n, s_lares_n_prev; // Laresgoiti's stress in this and the previous time step (only valid with in_stressLares)
+		const double *x;				  // the own states of the model
+	};
+
+	// contributions of a model to the time derivatives, they are added to the ones of the built-in models
+	// the rates of all user-defined models are accumulated in the same struct, so a rate function must add (+=) its contributions
+	struct Rates
+	{
+		double isei{0};			   // SEI side reaction current density [A m-2]
+		double isei_multiplyer{0}; // extra SEI growth on the crack surface as fraction of isei [-]
+		double dCS{0};			   // increase in crack surface [m2 s-1]
+		double dDn{0};			   // change in the negative diffusion constant [m s-1 s-1]
+		double dthickp{0}, dthickn{0}; // change in electrode thickness [m s-1]
+		double dap{0}, dan{0};		   // change in effective surface [m2 m-3 s-1]
+		double dep{0}, den{0};		   // change in volume fraction of active material [s-1]
+		double ipl{0};				   // plating side reaction current density [A m-2]
+		double *dx;					   // time derivatives of the own states of the model
+	};
+
+	using RateFunction = void (*)(const Inputs &in, const std::vector<double> &param, Rates &out);
+
+	struct Model
+	{
+		std::string name;		  // name by which the model is selected
+		Mechanism mech;			  // mechanism to which the model contributes
+		unsigned inputs{0};		  // combination of the Input flags with the inputs needed by the model
+		int nstates{0};			  // number of own states of the model, at most settings::ns_deg over all selected models
+		int builtin_id{-1};		  // identifier of a built-in model in DEG_ID, -1 for a user-defined model
+		RateFunction rate{nullptr}; // rate function of a user-defined model
+		std::vector<double> param{}; // fitting parameters passed to the rate function
+
+		bool needs(unsigned flag) const { return (inputs & flag) != 0; }
+	};
+
+	class Registry
+	{
+	public:
+		static Registry &get(); // the registry, built-in models are registered on the first call
+								// register user-defined models before starting (parallel) simulations, the registry is not locked
+
+		int add(const Model &m);				  // register a new model, returns its index
+		int find(const std::string &name) const;  // index of the model with this name, -1 if it is unknown
+		const Model &operator[](int i) const { return models[i]; }
+		int size() const { return static_cast<int>(models.size()); }
+
+	private:
+		Registry();
+		std::vector<Model> models;
+	};
+
+	inline Registry &registry() { return Registry::get(); }
+} // namespace slide::deg
@@ -16,6 +16,7 @@
 #include "cycler.hpp"
 #include "cell_user.hpp"
 #include "util.hpp"
+#include "inference.hpp"
 
 void Cycle_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, // simulate one cycle ageing experiment
 			   const struct CycleAgeingConfig &cycAgConfig, bool CVcha, double Icutcha, bool CVdis, double Icutdis, int timeCycleData, int nrCycles, int nrCap, struct checkUpProcedure &proc, const std::string &pref)
@@ -73,6 +74,7 @@ void Calendar_one(const struct slide::Model &M, const struct DEG_ID &degid, int
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -82,6 +84,7 @@ void Calendar_one(const struct slide::Model &M, const struct DEG_ID &degid, int
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 * name 		the name of the subfolder in which all the data for this simulation is written, must obey the naming convention for folders
 	 * 				avoid special characters or spaces
 	 */
@@ -179,6 +182,7 @@ void Cycle_one(const struct slide::Model &M, const struct DEG_ID &degid, int cel
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -188,6 +192,7 @@ void Cycle_one(const struct slide::Model &M, const struct DEG_ID &degid, int cel
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 * name 		the name of the subfolder in which all the data for this simulation is written, must obey the naming convention for folders
 	 * 				avoid special characters or spaces
 	 */
@@ -278,6 +283,7 @@ void Profile_one(const struct slide::Model &M, const struct DEG_ID &degid, int c
 	 * 		OCVCheck			boolean indicating if the half-cell OCV curves should be checked
 	 * 		CCCVCheck			boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	 * 		pulseCheck			boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	 * 		EISCheck			boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	 * 		includeCycleData	boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	 * 		nCycles				number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 	 * 		Crates				array with the Crates of the different cycles to be checked for the CCCV check-up, must be all positive
@@ -287,6 +293,7 @@ void Profile_one(const struct slide::Model &M, const struct DEG_ID &degid, int c
 	 * 								the second column contains the time in [sec] the current should be maintained
 	 * 								the profile must be a net discharge, i.e. sum (I*dt) > 0
 	 * 		profileLength		length of the current profiles for the pulse test (number of rows in the csv file)
+	 * 		EISfreq				frequencies for the impedance spectrum [Hz]
 	 * name 		the name of the subfolder in which all the data for this simulation is written, must obey the naming convention for folders
 	 * 				avoid special characters or spaces
 	 */
@@ -333,6 +340,137 @@ void Profile_one(const struct slide::Model &M, const struct DEG_ID &degid, int c
 	}
 }
 
+void SOCWindow_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const struct SOCWindowAgeingConfig &winConfig,
+				   bool modelSOC, int anchor, int timeCycleData, int nrCycles, int nrCap, struct checkUpProcedure &proc, const std::string &pref)
+{
+	/*
+	 * Calls the socWindowAgeing() function of a Cycler
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see Profile_one)
+	 * verbose 		integer indicating how verbose the simulation has to be (see Profile_one)
+	 * winConfig 	SOC window, temperature and C rates of the cycles
+	 * modelSOC 	if true, the window is defined by the SOC of the model, else it is counted in Ah from a full charge
+	 * anchor 		number of check-ups after which the window is anchored again with a full charge (only if modelSOC is false)
+	 * timeCycleData the time interval at which cycling data (e.g. the voltage of the cell) should be stored [s]
+	 * 				if 0, no cycle data is stored
+	 * nrCycles 	number of cycles to be simulated in total [-]
+	 * nrCap 		number of cycles between consecutive check-ups [-]
+	 * proc 		structure with the parameters of the check-up procedure (see Profile_one)
+	 * pref 		prefix of the name of the subfolder in which all the data for this simulation is written
+	 */
+
+	Cell c1 = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																		  : (Cell)slide::Cell_user(M, degid, verbose);
+	const auto name = winConfig.get_name(pref);
+	Cycler cycler(c1, name, verbose, timeCycleData);
+
+	try
+	{
+		cycler.socWindowAgeing(2.0, winConfig.SOCmi() / 100, winConfig.SOCma() / 100, winConfig.Ccha, winConfig.Cdis, modelSOC, anchor,
+							   winConfig.Ti(), nrCycles, nrCap, proc);
+	}
+	catch (int err)
+	{
+		std::cout << "SOCWindow_one experienced error " << err << " during execution of " << name << ", abort this test.\n";
+		if (err == 15)
+			std::cout << "Error 15 means that the cell had degraded too much to continue simulating (see Cycle_one).\n"
+						 "The results which have been written are all valid.\n";
+	}
+}
+
+void Usage_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const std::string &statsName, double SOCplug,
+			   unsigned seed, double Ti, int timeCycleData, int nrDays, int daysCheck, struct checkUpProcedure &proc, const std::string &name)
+{
+	/*
+	 * Calls the usageAgeing() function of a Cycler
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see Profile_one)
+	 * verbose 		integer indicating how verbose the simulation has to be (see Profile_one)
+	 * statsName 	name of the csv file in the data folder with the statistics of the usage (see usage::loadStats)
+	 * SOCplug 		the night charge is only done below this SOC [-], this overrides the value in the statistics
+	 * seed 		seed of the random number generator which draws the daily schedules
+	 * Ti 			environmental temperature [K]
+	 * timeCycleData the time interval at which cycling data (e.g. the voltage of the cell) should be stored [s]
+	 * 				if 0, no cycle data is stored
+	 * nrDays 		number of days to be simulated [-]
+	 * daysCheck 	number of days between consecutive check-ups [-]
+	 * proc 		structure with the parameters of the check-up procedure (see Profile_one)
+	 * name 		name of the subfolder in which all the data for this simulation is written
+	 */
+
+	Cell c1 = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																		  : (Cell)slide::Cell_user(M, degid, verbose);
+	Cycler cycler(c1, name, verbose, timeCycleData);
+
+	try
+	{
+		auto st = slide::usage::loadStats(statsName);
+		st.SOCplug = SOCplug;
+		cycler.usageAgeing(st, seed, c1.getVmax(), c1.getVmin(), Ti, nrDays, daysCheck, proc);
+	}
+	catch (int err)
+	{
+		std::cout << "Usage_one experienced error " << err << " during execution of " << name << ", abort this test.\n";
+		if (err == 15)
+			std::cout << "Error 15 means that the cell had degraded too much to continue simulating (see Cycle_one).\n"
+						 "The results which have been written are all valid.\n";
+	}
+}
+
+void Mixed_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const struct MixedAgeingConfig &mixConfig,
+			   double start, int timeCycleData, int nrDays, int daysCheck, struct checkUpProcedure &proc, const std::string &pref)
+{
+	/*
+	 * Calls the mixedAgeing() function of a Cycler with one event per day
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see Profile_one)
+	 * verbose 		integer indicating how verbose the simulation has to be (see Profile_one)
+	 * mixConfig 	resting SOC, temperature, number of cycles per day and C rate of the cycles
+	 * start 		time of the day at which the cycles start [h]
+	 * timeCycleData the time interval at which cycling data (e.g. the voltage of the cell) should be stored [s]
+	 * 				if 0, no cycle data is stored
+	 * nrDays 		number of days to be simulated [-]
+	 * daysCheck 	number of days between consecutive check-ups [-]
+	 * proc 		structure with the parameters of the check-up procedure (see Profile_one)
+	 * pref 		prefix of the name of the subfolder in which all the data for this simulation is written
+	 */
+
+	Cell c1 = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																		  : (Cell)slide::Cell_user(M, degid, verbose);
+	const auto name = mixConfig.get_name(pref);
+	Cycler cycler(c1, name, verbose, timeCycleData);
+
+	AgeingEvent e;
+	e.start = start;
+	e.nrCycles = mixConfig.nrCycles;
+	e.Ccha = mixConfig.Crate;
+	e.Cdis = mixConfig.Crate;
+	e.Tcycle = mixConfig.Ti();
+	e.SOCrest = mixConfig.SOCrest / 100;
+	e.Trest = mixConfig.Ti();
+
+	try
+	{
+		cycler.mixedAgeing({e}, 1, c1.getVmax(), c1.getVmin(), nrDays, daysCheck, proc);
+	}
+	catch (int err)
+	{
+		std::cout << "Mixed_one experienced error " << err << " during execution of " << name << ", abort this test.\n";
+		if (err == 15)
+			std::cout << "Error 15 means that the cell had degraded too much to continue simulating (see Cycle_one).\n"
+						 "The results which have been written are all valid.\n";
+	}
+}
+
 void CycleAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
 {
 	/*
@@ -416,6 +554,7 @@ void CycleAgeing(const struct slide::Model &M, std::string pref, const struct DE
 	proc.OCVCheck = true;							 // boolean indicating if the half-cell OCV curves should be checked
 	proc.CCCVCheck = true;							 // boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	proc.pulseCheck = true;							 // boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;							 // boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	proc.includeCycleData = true;					 // boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	proc.nCycles = 3;								 // number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates)
 													 // If you change this variable, also change it in the MATLAB script which reads the results from the check-up (the variable Crates in readAgeing_CCCV.m)
@@ -574,6 +713,7 @@ void CalendarAgeing(const struct slide::Model &M, std::string pref, const struct
 	proc.OCVCheck = true;							 // boolean indicating if the half-cell OCV curves should be checked
 	proc.CCCVCheck = true;							 // boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	proc.pulseCheck = true;							 // boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;							 // boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	proc.includeCycleData = true;					 // boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	proc.nCycles = 3;								 // number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates), maximum 100
 													 // If you change this variable, also change it in the MATLAB script which reads the results from the check-up (the variable Crates in readAgeing_CCCV.m)
@@ -728,6 +868,7 @@ void ProfileAgeing(const struct slide::Model &M, std::string pref, const struct
 	proc.OCVCheck = true;							 // boolean indicating if the half-cell OCV curves should be checked
 	proc.CCCVCheck = true;							 // boolean indicating if some CCCV cycles should be done as part of the check-up procedure
 	proc.pulseCheck = true;							 // boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;							 // boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
 	proc.includeCycleData = true;					 // boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
 	proc.nCycles = 3;								 // number of different cycles to be simulated for the CCCV check-up (i.e. the length of the array crates).
 													 // If you change this variable, also change it in the MATLAB script which reads the results from the check-up (the variable Crates in readAgeing_CCCV.m)
@@ -797,4 +938,253 @@ void ProfileAgeing(const struct slide::Model &M, std::string pref, const struct
 	// Print a message that we are starting the simulations
 	std::cout << "\t Profile ageing experiments are started.\n";
 	slide::run(task_indv, profAgConfigVec.size());
-}
\ No newline at end of file
+}
+
+void SOCWindowAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to simulate a selection of cycle ageing experiments in partial SOC windows.
+	 * The cells are cycled between two SOC levels which are counted in Ah from a full charge (see Cycler::socWindowAgeing),
+	 * such that windows with the same depth of discharge but different centres (or the other way round) can be compared
+	 * without having to convert the SOC levels to voltages for every cell.
+	 * The results are written in one subfolder per simulation, as for CycleAgeing.
+	 * On top of the files written by CycleAgeing, the throughput and SOC at every check-up are written in DegradationData_SOCwindow.csv.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the name of the subfolder in which the results should be written, will begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 */
+
+	// *********************************************************** 1 variables ***********************************************************************
+
+	// append the ageing identifiers to the prefix
+	pref += +"_" + degid.print() + "_";
+
+	bool modelSOC = false;	// the window is counted in Ah from a full charge (if true, the SOC of the model defines the window)
+	int anchor = 2;			// number of check-ups after which the window is anchored again with a full charge
+	int nrCycles = 3000;	// the number of cycles which has to be simulated
+	int nrCap = 500;		// the number of cycles between check-ups
+	int timeCycleData = 0;	// time interval at which cycling data (voltage and temperature) has to be recorded [s], 0 means no data is recorded
+
+	// *********************************************************** 2 check-up procedure ******************************************************************
+
+	struct checkUpProcedure proc;
+	proc.blockDegradation = true;	 // boolean indicating if degradation is accounted for during the check-up, [RECOMMENDED: TRUE]
+	proc.capCheck = true;			 // boolean indicating if the capacity should be checked, needed to count the window in Ah
+	proc.OCVCheck = true;			 // boolean indicating if the half-cell OCV curves should be checked
+	proc.CCCVCheck = false;			 // boolean indicating if some CCCV cycles should be done as part of the check-up procedure
+	proc.pulseCheck = false;		 // boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;			 // boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
+	proc.includeCycleData = false;	 // boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
+
+	// *********************************************************** 3 simulations ******************************************************************
+
+	// Windows with depths of discharge of 10, 40 and 80% around centres of 30, 50 and 70% SOC, skipping the ones which do not fit in 0-100%
+	std::vector<SOCWindowAgeingConfig> winConfigVec;
+	for (double SOCc : {30, 50, 70})
+		for (double DOD : {10, 40, 80})
+			if (SOCc - DOD / 2 >= 0 && SOCc + DOD / 2 <= 100)
+				winConfigVec.emplace_back(SOCc, DOD, 45, 1, 1);
+
+	auto task_indv = [&](int i_begin)
+	{
+		// simulate one SOC-window ageing experiment
+		SOCWindow_one(M, degid, cellType, verbose, winConfigVec[i_begin], modelSOC, anchor, timeCycleData, nrCycles, nrCap, proc, pref);
+	};
+
+	// Print a message that we are starting the simulations
+	std::cout << "\t SOC-window ageing experiments are started.\n";
+	slide::run(task_indv, winConfigVec.size()); // Runs individual simulation in parallel or sequential depending on settings.
+}
+
+void UsageAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to simulate a selection of ageing experiments with realistic usage, e.g. of an electric vehicle.
+	 * Every day, the cells drive a number of trips with drive cycles, are charged and rest, according to the statistics in a csv file (see usage.hpp).
+	 * All cells use the same seed, so they follow the same daily schedules, and only the temperature and the charging habit differ:
+	 * the cells are either charged every night they are plugged in, or only when their SOC has dropped below 30%.
+	 * The results are written in one subfolder per simulation, as for CycleAgeing.
+	 * On top of the files written by CycleAgeing, the usage of every day is written in DegradationData_usage.csv.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the name of the subfolder in which the results should be written, will begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 */
+
+	// *********************************************************** 1 variables ***********************************************************************
+
+	// append the ageing identifiers to the prefix
+	pref += +"_" + degid.print() + "_";
+
+	const std::string statsName = "Usage statistics commuter.csv"; // statistics of the usage
+	unsigned seed = 1;											   // seed of the daily schedules
+	int nrDays = 730;											   // the number of days which has to be simulated
+	int daysCheck = 30;											   // the number of days between check-ups
+	int timeCycleData = 0;										   // time interval at which cycling data (voltage and temperature) has to be recorded [s], 0 means no data is recorded
+
+	// *********************************************************** 2 check-up procedure ******************************************************************
+
+	struct checkUpProcedure proc;
+	proc.blockDegradation = true;	// boolean indicating if degradation is accounted for during the check-up, [RECOMMENDED: TRUE]
+	proc.capCheck = true;			// boolean indicating if the capacity should be checked
+	proc.OCVCheck = true;			// boolean indicating if the half-cell OCV curves should be checked
+	proc.CCCVCheck = false;			// boolean indicating if some CCCV cycles should be done as part of the check-up procedure
+	proc.pulseCheck = false;		// boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;			// boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
+	proc.includeCycleData = false;	// boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
+
+	// *********************************************************** 3 simulations ******************************************************************
+
+	// environmental temperatures of 10, 25 and 40 degrees, charged every night (SOCplug = 1) or only below 30% SOC
+	std::vector<std::pair<double, double>> useVec; // temperature [oC] and SOCplug [-]
+	for (double Tc : {10, 25, 40})
+		for (double SOCplug : {1.0, 0.3})
+			useVec.emplace_back(Tc, SOCplug);
+
+	auto task_indv = [&](int i_begin)
+	{
+		// simulate one usage ageing experiment
+		const auto [Tc, SOCplug] = useVec[i_begin];
+		const auto name = pref + "Use-T" + std::to_string((int)Tc) + "_plug" + std::to_string((int)(100 * SOCplug));
+		Usage_one(M, degid, cellType, verbose, statsName, SOCplug, seed, Tc + PhyConst::Kelvin, timeCycleData, nrDays, daysCheck, proc, name);
+	};
+
+	// Print a message that we are starting the simulations
+	std::cout << "\t Usage ageing experiments are started.\n";
+	slide::run(task_indv, useVec.size()); // Runs individual simulation in parallel or sequential depending on settings.
+}
+
+void MixedAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to simulate a selection of combined calendar and cycle ageing experiments.
+	 * Every day, the cells do one full cycle in the evening and then rest at a given SOC until the next evening (see Cycler::mixedAgeing),
+	 * such that the effect of the resting SOC and the temperature on cells which are also cycled can be studied.
+	 * The results are written in one subfolder per simulation, as for CycleAgeing.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the name of the subfolder in which the results should be written, will begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 */
+
+	// *********************************************************** 1 variables ***********************************************************************
+
+	// append the ageing identifiers to the prefix
+	pref += +"_" + degid.print() + "_";
+
+	double start = 18;	   // time of the day at which the cycles start [h]
+	int nrDays = 365;	   // the number of days which has to be simulated
+	int daysCheck = 30;	   // the number of days between check-ups
+	int timeCycleData = 0; // time interval at which cycling data (voltage and temperature) has to be recorded [s], 0 means no data is recorded
+
+	// *********************************************************** 2 check-up procedure ******************************************************************
+
+	struct checkUpProcedure proc;
+	proc.blockDegradation = true;	// boolean indicating if degradation is accounted for during the check-up, [RECOMMENDED: TRUE]
+	proc.capCheck = true;			// boolean indicating if the capacity should be checked
+	proc.OCVCheck = true;			// boolean indicating if the half-cell OCV curves should be checked
+	proc.CCCVCheck = false;			// boolean indicating if some CCCV cycles should be done as part of the check-up procedure
+	proc.pulseCheck = false;		// boolean indicating if a pulse discharge test should be done as part of the check-up procedure
+	proc.EISCheck = false;			// boolean indicating if the impedance spectrum should be calculated as part of the check-up procedure
+	proc.includeCycleData = false;	// boolean indicating if the cycling data from the check-up should be included in the cycling data of the cell or not
+
+	// *********************************************************** 3 simulations ******************************************************************
+
+	// One 1C cycle per day, resting at 30, 60 or 90% SOC at 25, 35 or 45 degrees
+	std::vector<MixedAgeingConfig> mixConfigVec;
+	for (double Tc : {25, 35, 45})
+		for (double SOCrest : {30, 60, 90})
+			mixConfigVec.emplace_back(SOCrest, Tc, 1, 1);
+
+	auto task_indv = [&](int i_begin)
+	{
+		// simulate one combined calendar and cycle ageing experiment
+		Mixed_one(M, degid, cellType, verbose, mixConfigVec[i_begin], start, timeCycleData, nrDays, daysCheck, proc, pref);
+	};
+
+	// Print a message that we are starting the simulations
+	std::cout << "\t Combined calendar and cycle ageing experiments are started.\n";
+	slide::run(task_indv, mixConfigVec.size()); // Runs individual simulation in parallel or sequential depending on settings.
+}
+
+void UncertaintyAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to propagate the uncertainty of degradation parameters to a cycle ageing experiment (see inference::propagate).
+	 * Copies of the cell do 1C CC CV cycles at 45 degrees with parameters drawn from posterior samples of an earlier Sampler run,
+	 * or from a log-uniform prior within a factor of two of the parameters of the cell.
+	 * The runs are repeated until the quantiles of the capacity and resistance at the check-ups converge.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the names of the result files begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 *
+	 * OUT
+	 * The bands are written in pref_degid_UncertaintyAgeing_bands.csv (see inference::write)
+	 */
+
+	using namespace slide::protocol;
+
+	// *********************************************************** 1 variables ***********************************************************************
+
+	std::vector<std::string> names{"sei2k", "sei2D"}; // degradation parameters with an uncertainty (see inference::degradationParam)
+													  // the rate and diffusion constant of the SEI growth of Pinson & Bazant, change them for other degradation models
+	std::string samples = "";						  // name of a Sampler whose posterior samples of these parameters are used (see inference::loadSamples), empty to use the prior
+	int burnIn = 1000;								  // number of iterations of the burn-in of the Sampler
+	int nrCycles = 500;								  // the number of cycles which has to be simulated
+	int nrCap = 100;								  // the number of cycles between check-ups
+
+	// Make a cell, the type of the cell depending on the value of 'cellType'
+	Cell c = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																	   : (Cell)slide::Cell_user(M, degid, verbose);
+
+	// *********************************************************** 2 the parameters ******************************************************************
+
+	slide::inference::Draw draw;
+	if (samples.empty())
+	{
+		SEIparam sei;
+		CSparam cs;
+		LAMparam lam;
+		PLparam pl;
+		c.getDegradationParam(&sei, &cs, &lam, &pl);
+		std::vector<slide::inference::Parameter> par;
+		for (const auto &name : names)
+		{
+			const double x = *slide::inference::degradationParam(name, sei, cs, lam, pl);
+			par.push_back({name, x / 2, x * 2, true, x});
+		}
+		draw = slide::inference::prior(par);
+	}
+	else
+		draw = slide::inference::resample(slide::inference::loadSamples(samples, burnIn));
+
+	// *********************************************************** 3 simulations ******************************************************************
+
+	const double Q = c.getNominalCap();
+	Protocol p;
+	p.Tenv(PhyConst::Kelvin + 45).loop(nrCycles);
+	p.CC(-Q, {above(Var::V, c.getVmax())}).CV(c.getVmax(), {below(Var::I, Q / 20)});
+	p.CC(Q, {below(Var::V, c.getVmin())}).checkUp(nrCap).endLoop();
+
+	slide::inference::Propagation s; // convergence settings, see inference.hpp
+
+	std::cout << "\t Propagation of the parameter uncertainty through cycle ageing is started.\n";
+	const auto b = slide::inference::propagate(c, names, draw, p, s);
+	slide::inference::write(b, pref + "_" + degid.print() + "_UncertaintyAgeing");
+	std::cout << "\t Propagation of the parameter uncertainty finished after " << b.par.size() + b.failed << " runs, "
+			  << (b.converged ? "the bands converged.\n" : "the bands did not converge.\n");
+}
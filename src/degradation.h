@@ -85,6 +85,48 @@ struct ProfileAgeingConfig
 	}
 };
 
+struct SOCWindowAgeingConfig
+{
+	double SOCc{50};  // centre of the SOC window [%]
+	double DOD{20};	  // width of the SOC window [%]
+	double Tc{45};
+	double Ccha{1};
+	double Cdis{1};
+
+	SOCWindowAgeingConfig(double SOCc, double DOD, double Tc, double Ccha, double Cdis)
+		: SOCc(SOCc), DOD(DOD), Tc(Tc), Ccha(Ccha), Cdis(Cdis) {}
+
+	double Ti() const { return Tc + PhyConst::Kelvin; }
+	double SOCmi() const { return SOCc - DOD / 2; }
+	double SOCma() const { return SOCc + DOD / 2; }
+	std::string get_name(const std::string &pref) const
+	{
+		// Example output: pref + "Win-T45_1C1D_SoC40-60";
+		return pref + "Win-T" + std::to_string((int)Tc) + "_" +
+			   std::to_string((int)Ccha) + "C" + std::to_string((int)Cdis) + "D" + "_" +
+			   "SoC" + std::to_string((int)SOCmi()) + "-" + std::to_string((int)SOCma());
+	}
+};
+
+struct MixedAgeingConfig
+{
+	double SOCrest{90}; // SOC at which the cell rests between the cycles [%]
+	double Tc{35};
+	int nrCycles{1};	// number of cycles per day
+	double Crate{1};
+
+	MixedAgeingConfig(double SOCrest, double Tc, int nrCycles, double Crate)
+		: SOCrest(SOCrest), Tc(Tc), nrCycles(nrCycles), Crate(Crate) {}
+
+	double Ti() const { return Tc + PhyConst::Kelvin; }
+	std::string get_name(const std::string &pref) const
+	{
+		// Example output: pref + "Mix-T35_1CpD_1C_SoC90";
+		return pref + "Mix-T" + std::to_string((int)Tc) + "_" + std::to_string(nrCycles) + "CpD_" +
+			   std::to_string((int)Crate) + "C_SoC" + std::to_string((int)SOCrest);
+	}
+};
+
 // Auxiliary functions for multi-threaded simulations
 void Calendar_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, // simulate one calendar ageing experiment
 				  double V, double Ti, int Time, int mode, int timeCycleData, int timeCheck, struct checkUpProcedure &proc, std::string name);
@@ -92,11 +134,21 @@ void Cycle_one(const struct slide::Model &M, const struct DEG_ID &degid, int cel
 			   double Ccha, bool CVcha, double Icutcha, double Cdis, bool CVdis, double Icutdis, double Ti, int timeCycleData, int nrCycles, int nrCap, struct checkUpProcedure &proc, std::string name);
 void Profile_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, std::string profName, int n, int limit, // simulate one drive cycle ageing experiment
 				 double Vma, double Vmi, double Ti, int timeCycleData, int nrProfiles, int nrCap, struct checkUpProcedure &proc, std::string name);
+void SOCWindow_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const struct SOCWindowAgeingConfig &winConfig, // simulate one SOC-window ageing experiment
+				   bool modelSOC, int anchor, int timeCycleData, int nrCycles, int nrCap, struct checkUpProcedure &proc, const std::string &pref);
+void Usage_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const std::string &statsName, double SOCplug, // simulate one usage ageing experiment
+			   unsigned seed, double Ti, int timeCycleData, int nrDays, int daysCheck, struct checkUpProcedure &proc, const std::string &name);
+void Mixed_one(const struct slide::Model &M, const struct DEG_ID &degid, int cellType, int verbose, const struct MixedAgeingConfig &mixConfig, // simulate one combined calendar and cycle ageing experiment
+			   double start, int timeCycleData, int nrDays, int daysCheck, struct checkUpProcedure &proc, const std::string &pref);
 
 // Degradation experiments
 void CycleAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose);	// simulate a range of cycle ageing experiments (different temperatures, SoC windows, currents)
 void CalendarAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose); // simulate a range of calendar ageing experiments (different temperatures, SoC levels)
 void ProfileAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose);	// simulate a range of drive cycle experiments (different cycles, different temperatures, etc.)
+void SOCWindowAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose);// simulate a range of cycle ageing experiments in SOC windows (different centres and depths of discharge)
+void UsageAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose);	// simulate a range of realistic usage experiments (different temperatures and charging habits)
+void MixedAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose);	// simulate a range of combined calendar and cycle ageing experiments (different resting SOCs and temperatures)
+void UncertaintyAgeing(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose); // propagate the uncertainty of degradation parameters to the capacity and resistance of a cycle ageing experiment
 
 // Configuration struct for above-given functions.
 
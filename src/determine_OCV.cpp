@@ -462,7 +462,7 @@ void readOCVinput(const std::string &namepos, const std::string &nameneg, const
 	}
 }
 
-double calculateError(bool bound, slide::vec_XYdata &OCVcell, slide::vec_XYdata &OCVsim)
+double calculateError(bool bound, const slide::vec_XYdata &OCVcell, const slide::vec_XYdata &OCVsim)
 {
 	/*
 	 * Function to calculate the root mean square error between the OCV curve of the cell supplied by the user and the simulated OCV curve
@@ -893,4 +893,32 @@ void writeOCVParam(int h, const std::array<double, 4> &par)
 	output << "start pos" << ',' << par[2] << '\n';
 	output << "start neg" << ',' << par[3] << '\n';
 	output.close();
-}
\ No newline at end of file
+}
+
+slide::inference::LogLikelihood OCVlikelihood(const std::string &namepos, const std::string &nameneg, const std::string &namecell,
+											  double cmaxp, double cmaxn, const slide::inference::Noise &nz)
+{
+	/*
+	 * Likelihood of the OCV parameters for the measured OCV curve of the cell, to sample their posterior with slide::inference::Sampler.
+	 * It uses the squared error of the simulated OCV curve (see cost_OCV) with the given noise model (see slide::inference::gaussian).
+	 * The parameters are in the same order as in hierarchicalOCVfit: AMp, AMn, sp, sn
+	 *
+	 * IN
+	 * namepos 		name of the CSV file with the cathode OCV curve
+	 * nameneg 		name of the CSV file with the anode OCV curve
+	 * namecell		name of the CSV file with the cell's OCV curve
+	 * cmaxp 		maximum lithium concentration in the cathode [mol m-3]
+	 * cmaxn		maximum lithium concentration in the anode [mol m-3]
+	 * nz 			noise of the measured OCV [V]
+	 */
+
+	slide::vec_XYdata OCVp(100), OCVn(100), OCVcell(100);
+	readOCVinput(namepos, nameneg, namecell, OCVp, OCVn, OCVcell);
+
+	return [OCVp, OCVn, OCVcell, cmaxp, cmaxn, nz](const slide::inference::Par &p, double *logL)
+	{
+		const double sse = cost_OCV(OCVp, OCVn, p[0], p[1], p[2], p[3], cmaxp, cmaxn, OCVcell);
+		*logL = slide::inference::gaussian(nz, sse, OCVcell.size());
+		return true;
+	};
+}
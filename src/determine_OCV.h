@@ -14,6 +14,7 @@
 #include <array>
 
 #include "slide_aux.hpp"
+#include "inference.hpp"
 
 bool validOCV(bool checkRange, slide::vec_XYdata &data);
 
@@ -28,10 +29,13 @@ auto discharge_noexcept(const slide::vec_XYdata &OCVp, const slide::vec_XYdata &
 						const double cmaxp, const double cmaxn, double sp, double sn, double Vend, slide::vec_XYdata &OCV,
 						slide::vec_XYdata &OCVanode, slide::vec_XYdata &OCVcathode, double fp[], double fn[]);
 
-double calculateError(bool bound, slide::vec_XYdata &OCVcell, slide::vec_XYdata &OCVsim);
+double calculateError(bool bound, const slide::vec_XYdata &OCVcell, const slide::vec_XYdata &OCVsim);
 
 void estimateOCVparameters();
 
+slide::inference::LogLikelihood OCVlikelihood(const std::string &namepos, const std::string &nameneg, const std::string &namecell,
+											  double cmaxp, double cmaxn, const slide::inference::Noise &nz);
+
 void writeOCVParam(int h, const std::array<double, 4> &par);
 
 void fitAMnAndStartingPoints(int hierarchy, int ap, slide::fixed_data<double> AMn_space, slide::fixed_data<double> sp_space,
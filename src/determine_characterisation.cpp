@@ -22,6 +22,7 @@
 #include <array>
 #include <thread>
 #include <algorithm>
+#include <memory>
 
 #include "cell_fit.hpp"
 #include "cycler.hpp"
@@ -788,3 +789,157 @@ void writeCharacterisationParam(int h, const std::array<double, 5> &par, double
 		   << "total RMSE" << ',' << err << '\n';
 	output.close();
 }
+
+slide::inference::LogLikelihood characterisationLikelihood(const std::vector<slide::vec_XYdata> &Vdata_all, const std::vector<double> &weights,
+														   const std::vector<double> &Crates, const std::vector<double> &Ccuts, double Tref,
+														   const struct OCVparam &ocvfit, const slide::inference::Noise &nz)
+{
+	/*
+	 * Likelihood of the characterisation parameters for the measured CCCV cycles, to sample their posterior with slide::inference::Sampler.
+	 * The parameters are in the same order as in hierarchicalCharacterisationFit: Rdc, Dp, Dn, kp, kn
+	 *
+	 * Every cycle is simulated as in fitDiffusionAndRate, and its RMSE (see calculateError) gives the sum of squared errors of its points.
+	 * These are weighted with weights[i] * nCCCV / sum(weights), such that with equal weights every measured point counts once.
+	 * Parameters for which a cycle can't be simulated have a zero likelihood.
+	 *
+	 * IN
+	 * Vdata_all 	measured voltage curves of the CCCV cycles
+	 * weights 		weight of every CCCV cycle
+	 * Crates 		C rates of the CC phases of each experiment, >0 for discharge, <0 for charge
+	 * Ccuts 		C rates of the current threshold for the CV phase of each experiment, >0
+	 * Tref 		temperature at which the characterisation is done [K]
+	 * ocvfit 		structure with the values of the OCV parameters determined by determineOCV::estimateOCVparam
+	 * nz 			noise of the measured voltage [V]
+	 */
+
+	auto M = std::make_shared<slide::Model>();
+	auto cell = std::make_shared<Cell_Fit>(*M, 0);
+	cell->setOCVcurve(ocvfit.namepos, ocvfit.nameneg);
+	cell->setInitialConcentration(ocvfit.cmaxp, ocvfit.cmaxn, ocvfit.lifracpini, ocvfit.lifracnini);
+	cell->setGeometricParameters(ocvfit.cap, ocvfit.elec_surf, ocvfit.ep, ocvfit.en, ocvfit.thickp, ocvfit.thickn);
+	cell->setVlimits(ocvfit.Vmax, ocvfit.Vmin);
+	cell->setT(Tref);
+	cell->setTenv(Tref);
+
+	double wsum = 0;
+	for (auto w : weights)
+		wsum += w;
+	std::vector<double> wt;
+	for (auto w : weights)
+		wt.push_back(w * weights.size() / wsum);
+
+	return [Vdata_all, wt, Crates, Ccuts, Tref, ocvfit, nz, M, cell](const slide::inference::Par &p, double *logL)
+	{
+		const auto [Rdc, Dp, Dn, kp, kn] = std::array<double, 5>{p[0], p[1], p[2], p[3], p[4]};
+		slide::vec_XYdata Vsim, Tsim;
+		double sse = 0, n = 0;
+		for (size_t i = 0; i < Vdata_all.size(); i++)
+		{
+			Vsim.clear(), Tsim.clear();
+			if (!CCCV_fit(*cell, Crates[i], Ccuts[i], Tref, Dp, Dn, kp, kn, Rdc, ocvfit, *M, Vsim, Tsim))
+				return false;
+
+			const double rmse = calculateError(false, Vdata_all[i], Vsim);
+			sse += wt[i] * Vdata_all[i].size() * rmse * rmse;
+			n += wt[i] * Vdata_all[i].size();
+		}
+		*logL = slide::inference::gaussian(nz, sse, n);
+		return true;
+	};
+}
+
+void estimateCharacterisationPosterior()
+{
+	/*
+	 * Function which samples the posterior of the diffusion constants, rate constants and DC resistance
+	 * for the measured CCCV cycles of the user, with the same data and OCV parameters as estimateCharacterisation.
+	 *
+	 * The prior of every parameter is uniform over the first level of the search space of estimateCharacterisation (log-uniform for D and k),
+	 * and the chains start around the point estimate of the hierarchical fit (copy it from characterisationFit_parameters.csv).
+	 * The voltage noise is unknown and integrated out, set its standard deviation in nz if it is known.
+	 *
+	 * The samples of every chain are written to characterisationPosterior_chain<i>.csv, and the posterior means,
+	 * credible intervals and convergence diagnostics to characterisationPosterior_summary.csv.
+	 * If the function is stopped, it continues from the checkpoints of the chains when it is called again.
+	 */
+
+	// *********************************************************** 1 USER INPUT ***********************************************************************
+
+	double Tref = PhyConst::Kelvin + 25; // Temperature at which the characterisation should be done [K]
+
+	std::string names[] = {"Characterisation_0.2C_CC_discharge.csv",
+						   "Characterisation_0.5C_CC_discharge.csv",
+						   "Characterisation_1C_CC_discharge.csv",
+						   "Characterisation_2C_CC_discharge.csv",
+						   "Characterisation_3C_CC_discharge.csv"}; // Name of the files with the voltage curve from the cell
+
+	std::vector<double> Crates{0.2, 0.5, 1, 2, 3};		  // C rates of the CC phases for each voltage curve, <0 for charge, >0 for discharge
+	std::vector<double> Ccuts{100, 100, 100, 100, 100};	  // C rates of the current threshold for the CV phases [A], > 0
+	std::vector<double> weights{0.2, 0.2, 0.2, 0.2, 0.2}; // weight of each individual CCCV curve in the likelihood
+
+	// OCV parameters (calculated by determineOCV::estimateOCVparameters)
+	OCVparam ocvfit;
+	ocvfit.elec_surf = 0.0982;	// electrode surface
+	ocvfit.ep = 0.5;			// volume fraction of active material in the cathode
+	ocvfit.en = 0.5;			// volume fraction of active material in the anode
+	ocvfit.thickp = 70e-6;		// thickness of the cathode
+	ocvfit.thickn = 73.5e-6;	// thickness of the anode
+	ocvfit.lifracpini = 0.6862; // lithium fraction in the cathode at 50% soC
+	ocvfit.lifracnini = 0.4843; // lithium fraction in the anode at 50% SoC
+	ocvfit.cmaxp = 51385;		// maximum lithium concentration in the cathode [mol m-3]
+	ocvfit.cmaxn = 30555;		// maximum lithium concentration in the anode [mol m-3]
+	ocvfit.cap = 2.7;			// the capacity of the cell [Ah]
+	ocvfit.Vmax = 4.2;			// maximum voltage of the cell [V]
+	ocvfit.Vmin = 2.7;			// minimum voltage of the cell [V]
+
+	ocvfit.namepos = "OCVfit_cathode.csv"; // name of the CSV file with the cathode OCV curve
+	ocvfit.nameneg = "OCVfit_anode.csv";   // name of the CSV file with the anode OCV curve
+	ocvfit.np = 49;						   // number of points in the cathode OCV curve
+	ocvfit.nn = 63;						   // number of points in the anode OCV curve
+
+	// point estimate of the hierarchical fit, where the chains start
+	std::array<double, 5> par0{0.0102, 8e-14, 7e-14, 5e-11, 1.764e-11}; // [R Dp Dn kp kn]
+
+	// search spaces of estimateCharacterisation, which are the priors
+	auto Dp_space = slide::logstep_fix(1e-18, 13, 10); // lowest value/step size/Nsteps in the search space for Dp [m s-1]
+	auto Dn_space = slide::logstep_fix(1e-18, 13, 10); // lowest value/step size/Nsteps in the search space for Dn [m s-1]
+	auto kp_space = slide::logstep_fix(1e-18, 13, 10); // lowest value/step size/Nsteps in the search space for kp [m s-1]
+	auto kn_space = slide::logstep_fix(1e-18, 13, 10); // lowest value/step size/Nsteps in the search space for kn [m s-1]
+	auto r_space = slide::linstep_fix(1e-6, 5e-3, 9);  // lowest value/step size/Nsteps in the search space for Rdc [Ohm]
+
+	slide::inference::Noise nz;							  // noise of the measured voltage, unknown
+	slide::inference::Settings st;						  // settings of the sampler, see inference.hpp
+	st.nChains = 4;										  // number of chains, they run in parallel
+	st.nSamples = 5000;									  // length of every chain
+	st.burnIn = 1000;									  // iterations of every chain which are not used
+	const std::string name = "characterisationPosterior"; // prefix of the output files
+
+	// ***************************************************** 2 sample the posterior ***********************************************************************
+
+	std::vector<slide::vec_XYdata> Vdata_all(std::size(names));
+	for (size_t i = 0; i < std::size(names); i++)
+	{
+		loadCSV_2col(PathVar::data + names[i], Vdata_all[i].x, Vdata_all[i].y);
+		if (!validOCV(false, Vdata_all[i]))
+		{
+			std::cerr << "ERROR in determineCharacterisation::estimateCharacterisationPosterior. Input file " << names[i] << " has the wrong format. throwing an error.\n";
+			throw 10000;
+		}
+	}
+
+	// the steps of the chains are 1% of the decades of the prior for D and k, and 5% of the range of the resistance
+	std::vector<slide::inference::Parameter> par{
+		{"Rdc", r_space.front(), r_space.back(), false, par0[0], 0},
+		{"Dp", Dp_space.front(), Dp_space.back(), true, par0[1], 0.01 * std::log10(Dp_space.back() / Dp_space.front())},
+		{"Dn", Dn_space.front(), Dn_space.back(), true, par0[2], 0.01 * std::log10(Dn_space.back() / Dn_space.front())},
+		{"kp", kp_space.front(), kp_space.back(), true, par0[3], 0.01 * std::log10(kp_space.back() / kp_space.front())},
+		{"kn", kn_space.front(), kn_space.back(), true, par0[4], 0.01 * std::log10(kn_space.back() / kn_space.front())}};
+
+	slide::inference::Sampler sampler(par, characterisationLikelihood(Vdata_all, weights, Crates, Ccuts, Tref, ocvfit, nz), st, name);
+	sampler.run();
+	sampler.write();
+
+	for (const auto &iv : sampler.summary())
+		std::cout << iv.name << ": mean " << iv.mean << ", " << 100 * st.level << "% credible interval from " << iv.lower
+				  << " to " << iv.upper << ", Rhat " << iv.Rhat << ".\n";
+}
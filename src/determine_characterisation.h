@@ -17,6 +17,7 @@
 #include "slide_aux.hpp"
 #include "model.h"
 #include "cycler.hpp"
+#include "inference.hpp"
 
 bool CCCV_fit(Cell_Fit c1, double Crate, double Ccut, double Tref, double Dp, double Dn, double kp, double kn, double R, const struct OCVparam &ocvfit, const struct slide::Model &M,
 			  slide::vec_XYdata &Vsim, slide::vec_XYdata &Tsim);
@@ -40,6 +41,12 @@ void writeCharacterisationParam(int h, const std::array<double, 5> &par, double
 
 void estimateCharacterisation();
 
+slide::inference::LogLikelihood characterisationLikelihood(const std::vector<slide::vec_XYdata> &Vdata_all, const std::vector<double> &weights,
+														   const std::vector<double> &Crates, const std::vector<double> &Ccuts, double Tref,
+														   const struct OCVparam &ocvfit, const slide::inference::Noise &nz);
+
+void estimateCharacterisationPosterior();
+
 // Define a struct with the parameters of the OCV curve
 // These parameters are calculated by the functions in determineOCV.cpp
 struct OCVparam
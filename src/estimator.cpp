@@ -0,0 +1,1191 @@
+/*
+ * estimator.cpp
+ *
+ * Implements the reduced plant model and the Kalman filters for state estimation.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "cell_KokamNMC.hpp"
+#include "cell_LGChemNMC.hpp"
+#include "cell_user.hpp"
+#include "read_CSVfiles.h"
+
+namespace slide::estimation
+{
+	void Plant::arrhenius(double T)
+	{
+		/*
+		 * Diffusion and rate constants at the given temperature.
+		 * They are reused while the temperature changes less than 1 mK, which changes them by less than 1e-4 relative,
+		 * since the filters evaluate almost the same temperature many times per sample.
+		 */
+
+		using PhyConst::Rg;
+		if (std::abs(T - Tk) < 1e-3)
+			return;
+		Tk = T;
+		Dpt = Dp * std::exp(Dp_T / Rg * (1 / T_ref - 1 / T));
+		Dnt = Dn * std::exp(Dn_T / Rg * (1 / T_ref - 1 / T));
+		kpt = kp * std::exp(kp_T / Rg * (1 / T_ref - 1 / T));
+		knt = kn * std::exp(kn_T / Rg * (1 / T_ref - 1 / T));
+	}
+
+	void Plant::discretise(double T, double dt)
+	{
+		/*
+		 * Exact discretisation of the particle dynamics over a time step at constant flux and temperature.
+		 * A is diagonal, so every mode is a scalar linear ODE dz/dt = D*A*z + B*j with solution
+		 * 		z(t+dt) = exp(D*A*dt) * z(t) + (exp(D*A*dt) - 1) / (D*A) * B * j
+		 * The mode with the 0 eigenvalue integrates the flux, z(t+dt) = z(t) + dt * B * j.
+		 */
+
+		arrhenius(T);
+		if (Tk == Td && dt == dtd)
+			return;
+		Td = Tk;
+		dtd = dt;
+		for (int j = 0; j < nch; j++)
+		{
+			const double ap = Dpt * Ap[j] * dt, an = Dnt * An[j] * dt;
+			const double mp = std::expm1(ap), mn = std::expm1(an);
+			ep[j] = 1 + mp;
+			en[j] = 1 + mn;
+			gp[j] = (ap == 0 ? dt : mp / ap * dt) * Bp[j];
+			gn[j] = (an == 0 ? dt : mn / an * dt) * Bn[j];
+		}
+	}
+
+	Plant::Out Plant::evaluate(const Vec &x, double I)
+	{
+		/*
+		 * Surface concentrations and the cell voltage, see Cell::getCSurf and Cell::getVoltage.
+		 * The li-fractions are clamped inside (0, 1) and the OCV curves are not bounded,
+		 * such that states which a filter temporarily moves out of the physical range still give a finite voltage.
+		 *
+		 * This repeats the equations of Cell::getVoltage rather than calling it, because the filters need what a Cell can't give:
+		 * 		the voltage at states which are not those of a cell, e.g. sigma points, without writing them into a State first
+		 * 		no error if a state is out of range, where Cell::getVoltage throws 101 and the bounded OCV curves throw as well
+		 * 		the intermediate values (li-fractions, exchange currents, arguments of asinh) for the analytical gradient in voltage
+		 * 		the degradation states frozen as parameters, such that one plant is evaluated many times per sample at little cost
+		 * The equations must be kept the same as in Cell::getVoltage (for a single particle, without particle-size distribution).
+		 */
+
+		using namespace PhyConst;
+		constexpr double ylim = 1e-6; // smallest distance of the li-fractions to 0 and 1
+
+		Out o;
+		o.T = x[2 * nch];
+		arrhenius(o.T);
+		o.cps = Dsp * fp * I / Dpt;
+		o.cns = Dsn * fn * I / Dnt;
+		for (int j = 0; j < nch; j++)
+		{
+			o.cps += Csp[j] * x[j];
+			o.cns += Csn[j] * x[nch + j];
+		}
+
+		o.yp = std::clamp(o.cps / Cmaxpos, ylim, 1 - ylim);
+		o.yn = std::clamp(o.cns / Cmaxneg, ylim, 1 - ylim);
+		o.dOCV = ocv->linInt_dOCV_tot(o.yp, false, false);
+		o.OCVp = ocv->linInt_OCV_pos_h(o.yp, hp, false, false);
+		o.OCVn = ocv->linInt_OCV_neg_h(o.yn, hn, false, false);
+
+		o.i0p = kpt * n * F * std::sqrt(C_elec * o.yp * (1 - o.yp)) * Cmaxpos;
+		o.i0n = knt * n * F * std::sqrt(C_elec * o.yn * (1 - o.yn)) * Cmaxneg;
+		o.xp = 0.5 * n * F * fp * I / o.i0p;
+		o.xn = 0.5 * n * F * fn * I / o.i0n;
+		o.etap = (2 * Rg * o.T) / (n * F) * std::asinh(o.xp);
+		o.etan = (2 * Rg * o.T) / (n * F) * std::asinh(o.xn);
+
+		o.V = o.OCVp - o.OCVn + (o.T - T_ref) * o.dOCV + o.etap - o.etan - R * I;
+		return o;
+	}
+
+	void Plant::step(Vec &x, double I, double dt)
+	{
+		/*
+		 * Advance the states over a time step at constant current.
+		 * The concentrations are integrated exactly at the temperature at the start of the step (see discretise),
+		 * the temperature with forward Euler and the heat generation at the start of the step (see Cell::dState).
+		 * The heat of the thermal management is not included.
+		 *
+		 * IN
+		 * I 		cell current during the time step [A], > 0 for discharge
+		 * dt 		time step [s]
+		 *
+		 * IN/OUT
+		 * x 		states
+		 */
+
+		const double T = x[2 * nch];
+		const auto o = evaluate(x, I);
+		discretise(T, dt);
+
+		const double i_app = I / elec_surf;
+		const double Qrev = -i_app / L * T * o.dOCV;
+		const double Qrea = i_app / L * (o.etan - o.etap);
+		const double Qohm = I * I * R / (L * elec_surf);
+		const double Qc = -Qch * SAV * (T - T_env);
+
+		const double jp = fp * I, jn = fn * I;
+		for (int j = 0; j < nch; j++)
+		{
+			x[j] = ep[j] * x[j] + gp[j] * jp;
+			x[nch + j] = en[j] * x[nch + j] + gn[j] * jn;
+		}
+		x[2 * nch] = T + dt * (Qrev + Qrea + Qohm + Qc) / rhoCp;
+	}
+
+	void Plant::step(Vec &x, double I, double dt, Vec &F)
+	{
+		/*
+		 * Advance the states and get the Jacobian of the transition.
+		 * Only the diagonal is kept: the concentration modes are uncoupled, and the effect of the concentrations on the heat generation
+		 * and of the temperature on the diffusion during one step are negligible for the covariance.
+		 */
+
+		step(x, I, dt);
+		for (int j = 0; j < nch; j++)
+		{
+			F[j] = ep[j];
+			F[nch + j] = en[j];
+		}
+		F[2 * nch] = 1 - dt * Qch * SAV / rhoCp;
+	}
+
+	void Plant::gain(Vec &g) const
+	{
+		// sensitivity of the states after the last time step to the current during the step, the temperature is not affected
+		for (int j = 0; j < nch; j++)
+		{
+			g[j] = gp[j] * fp;
+			g[nch + j] = gn[j] * fn;
+		}
+		g[2 * nch] = 0;
+	}
+
+	double Plant::voltage(const Vec &x, double I)
+	{
+		return evaluate(x, I).V;
+	}
+
+	double Plant::voltage(const Vec &x, double I, Vec &H, double dVdp[3])
+	{
+		/*
+		 * Cell voltage and its gradient to the states and parameters.
+		 * The voltage depends on the concentrations through the surface li-fractions, which are linear in the states.
+		 * The derivatives of the kinetics and the Arrhenius relations are analytical, the slopes of the OCV curves are finite differences.
+		 *
+		 * OUT
+		 * H 		dV/dx
+		 * dVdp 	derivatives to fp, fn and R, not calculated if nullptr
+		 * double 	voltage [V]
+		 */
+
+		using namespace PhyConst;
+		constexpr double dy = 1e-6; // step in li-fraction for the slopes of the OCV curves
+
+		const auto o = evaluate(x, I);
+		const double c = (2 * Rg * o.T) / (n * F); // d(eta) / d(asinh(x))
+		const double sp = c / std::sqrt(1 + o.xp * o.xp), sn = c / std::sqrt(1 + o.xn * o.xn);
+
+		// derivatives to the surface li-fractions, i0 is proportional to sqrt(y*(1-y))
+		const double dOCVp = (ocv->linInt_OCV_pos_h(o.yp + dy, hp, false, false) - o.OCVp) / dy;
+		const double ddOCV = (ocv->linInt_dOCV_tot(o.yp + dy, false, false) - o.dOCV) / dy;
+		const double dOCVn = (ocv->linInt_OCV_neg_h(o.yn + dy, hn, false, false) - o.OCVn) / dy;
+		const double dVdyp = dOCVp + (o.T - T_ref) * ddOCV - sp * o.xp * (1 - 2 * o.yp) / (2 * o.yp * (1 - o.yp));
+		const double dVdyn = -dOCVn + sn * o.xn * (1 - 2 * o.yn) / (2 * o.yn * (1 - o.yn));
+		for (int j = 0; j < nch; j++)
+		{
+			H[j] = dVdyp / Cmaxpos * Csp[j];
+			H[nch + j] = dVdyn / Cmaxneg * Csn[j];
+		}
+
+		// temperature: entropic term, prefactor of the overpotentials, rate constants and the diffusion constants in the feedthrough
+		const double r = 1 / (Rg * o.T * o.T); // d(1/T_ref - 1/T) / Rg
+		H[2 * nch] = o.dOCV + (o.etap - o.etan) / o.T - sp * o.xp * kp_T * r + sn * o.xn * kn_T * r
+					 - dVdyp / Cmaxpos * Dsp * fp * I / Dpt * Dp_T * r - dVdyn / Cmaxneg * Dsn * fn * I / Dnt * Dn_T * r;
+
+		// the fluxes change the surface concentrations through the feedthrough, and the overpotentials are proportional to them
+		if (dVdp != nullptr)
+		{
+			dVdp[0] = dVdyp / Cmaxpos * Dsp * I / Dpt + sp * 0.5 * n * F * I / o.i0p;
+			dVdp[1] = dVdyn / Cmaxneg * Dsn * I / Dnt - sn * 0.5 * n * F * I / o.i0n;
+			dVdp[2] = -I;
+		}
+		return o.V;
+	}
+
+	void Plant::surface(const Vec &x, double I, double *yp, double *yn)
+	{
+		const auto o = evaluate(x, I);
+		*yp = o.cps / Cmaxpos;
+		*yn = o.cns / Cmaxneg;
+	}
+
+	double Plant::SOC(const Vec &x) const
+	{
+		return (x[nch + ind] / (vn * Cmaxneg) - win0) / (win1 - win0);
+	}
+
+	double Plant::lithium(const Vec &x) const
+	{
+		// cyclable lithium from the mean li-fractions, see Cell::getElectrodeBalance
+		return Qp * x[ind] / (vp * Cmaxpos) + Qn * x[nch + ind] / (vn * Cmaxneg);
+	}
+
+	void Plant::windows(double Qpi, double Qni, double nLi, double win[4])
+	{
+		/*
+		 * Stoichiometry windows for given capacities and cyclable lithium, with the same bisection as Cell::getElectrodeBalance.
+		 *
+		 * IN
+		 * Qpi 		capacity of the cathode [Ah]
+		 * Qni 		capacity of the anode [Ah]
+		 * nLi 		cyclable lithium [Ah]
+		 *
+		 * OUT
+		 * win 		li-fraction of the anode at 0 and 100% SOC and of the cathode at 0 and 100% SOC [-]
+		 */
+
+		const double ylo = std::max(ocv->OCV_pos_x.front(), (nLi - Qni * ocv->OCV_neg_x.back()) / Qpi);
+		const double yhi = std::min(ocv->OCV_pos_x.back(), (nLi - Qni * ocv->OCV_neg_x.front()) / Qpi);
+		auto findWindow = [&](double V) {
+			double a = ylo, b = yhi;
+			for (int i = 0; i < 60; i++)
+			{
+				const double y = 0.5 * (a + b);
+				if (ocv->linInt_OCV_pos(y) - ocv->linInt_OCV_neg((nLi - y * Qpi) / Qni) > V)
+					a = y;
+				else
+					b = y;
+			}
+			return 0.5 * (a + b);
+		};
+
+		win[3] = findWindow(Vmax);
+		win[2] = findWindow(Vmin);
+		win[1] = (nLi - win[3] * Qpi) / Qni;
+		win[0] = (nLi - win[2] * Qpi) / Qni;
+	}
+
+	void Plant::rebalance(const Vec &x)
+	{
+		/*
+		 * Update the SOC window for the present capacities and the lithium in the given states,
+		 * and the direction dSOC in which the states change with the SOC: at constant cyclable lithium,
+		 * the cathode loses what the anode gains, dyp * Qp = -dxn * Qn.
+		 */
+
+		double win[4];
+		windows(Qp, Qn, lithium(x), win);
+		win0 = win[0];
+		win1 = win[1];
+		dSOC.fill(0);
+		dSOC[nch + ind] = (win1 - win0) * vn * Cmaxneg;
+		dSOC[ind] = -(win1 - win0) * Qn / Qp * vp * Cmaxpos;
+	}
+
+	Log loadLog(const std::string &name, int ct, int cI, int cV, int cT)
+	{
+		/*
+		 * Read a log from a csv file in the data folder.
+		 * Lines which don't have a number in all the columns which are read (e.g. a header) are skipped.
+		 *
+		 * IN
+		 * name 	name of the csv file
+		 * ct 		column with the time [s]
+		 * cI 		column with the current [A], > 0 for a discharge
+		 * cV 		column with the voltage [V]
+		 * cT 		column with the temperature [K], < 0 if the temperature is not measured
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 * 1022 	the file has no samples
+		 */
+
+		std::ifstream in(PathVar::data + name, std::ios_base::in);
+		if (!in.good())
+		{
+			std::cerr << "ERROR in estimation::loadLog. File " << name << " could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+
+		Log log;
+		std::string line;
+		std::vector<double> f;
+		while (std::getline(in, line))
+		{
+			f.clear();
+			std::stringstream ss(line);
+			try
+			{
+				for (std::string x; std::getline(ss, x, ',');)
+					f.push_back(std::stod(x));
+			}
+			catch (...)
+			{
+			}
+			const int nc = static_cast<int>(f.size());
+			if (ct >= nc || cI >= nc || cV >= nc || cT >= nc)
+				continue;
+
+			log.t.push_back(f[ct]);
+			log.I.push_back(f[cI]);
+			log.V.push_back(f[cV]);
+			if (cT >= 0)
+				log.T.push_back(f[cT]);
+		}
+
+		if (log.t.empty())
+		{
+			std::cerr << "ERROR in estimation::loadLog. File " << name << " has no samples in columns " << ct << ", " << cI << " and " << cV << ". Throwing an error.\n";
+			throw 1022;
+		}
+		return log;
+	}
+
+	void write(const Estimate &e, const std::string &name)
+	{
+		/*
+		 * Write an estimate to a csv file in the results folder, with one row per sample:
+		 * 		time [s], SOC [-], standard deviation of the SOC [-], temperature [K], its standard deviation [K],
+		 * 		surface li-fraction of the cathode and anode [-], predicted voltage [V]
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 */
+
+		std::ofstream out(PathVar::results + name, std::ios_base::out);
+		if (!out.is_open())
+		{
+			std::cerr << "ERROR in estimation::write. File " << name << " could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+		for (size_t k = 0; k < e.t.size(); k++)
+			out << e.t[k] << ',' << e.SOC[k] << ',' << e.sdSOC[k] << ',' << e.T[k] << ',' << e.sdT[k] << ','
+				<< e.yp[k] << ',' << e.yn[k] << ',' << e.Vpred[k] << '\n';
+	}
+
+	void write(const Health &h, const std::string &name)
+	{
+		/*
+		 * Write an SOH trajectory to a csv file in the results folder, with one row per update of the parameters:
+		 * 		time [s], SOH [-], its standard deviation [-], capacity of the cathode and anode [Ah], cyclable lithium [Ah],
+		 * 		resistance [Ohm] and its standard deviation [Ohm]
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 */
+
+		std::ofstream out(PathVar::results + name, std::ios_base::out);
+		if (!out.is_open())
+		{
+			std::cerr << "ERROR in estimation::write. File " << name << " could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+		for (size_t k = 0; k < h.t.size(); k++)
+			out << h.t[k] << ',' << h.SOH[k] << ',' << h.sdSOH[k] << ',' << h.Qp[k] << ',' << h.Qn[k] << ','
+				<< h.nLi[k] << ',' << h.R[k] << ',' << h.sdR[k] << '\n';
+	}
+
+	Filter::Filter(const Plant &p, const Noise &nzi) : pl(p), nz(nzi)
+	{
+		// #NOTHOTFUNCTION
+		if (!pl.ocv || nz.sigmaV <= 0 || nz.sigmaT <= 0 || nz.sigmaI < 0 || nz.qSOC < 0 || nz.qc < 0 || nz.qT < 0
+			|| nz.sigmaSOC0 < 0 || nz.sigmac0 <= 0 || nz.sigmaT0 <= 0)
+		{
+			std::cerr << "ERROR in estimation::Filter, the plant has no OCV curves (see Cell::getPlant) or the noise is illegal: "
+					  << "the standard deviations of the measurements and the initial concentrations and temperature must be positive, "
+					  << "the others can't be negative. Throwing an error.\n";
+			throw 1022;
+		}
+		init(pl.x0);
+	}
+
+	void Filter::init(const Vec &x0)
+	{
+		/*
+		 * Restart the filter from the given states.
+		 * The initial covariance has the uncertainty of the SOC along dSOC, so the cyclable lithium is known,
+		 * and a small independent uncertainty of every mode to keep the covariance positive definite.
+		 */
+
+		x = x0;
+		for (int i = 0; i < nx; i++)
+			for (int j = 0; j < nx; j++)
+				P[i][j] = nz.sigmaSOC0 * nz.sigmaSOC0 * pl.dSOC[i] * pl.dSOC[j];
+
+		const double sp = nz.sigmac0 * pl.Cmaxpos * pl.vp, sn = nz.sigmac0 * pl.Cmaxneg * pl.vn;
+		for (int j = 0; j < nch; j++)
+		{
+			P[j][j] += sp * sp;
+			P[nch + j][nch + j] += sn * sn;
+		}
+		P[2 * nch][2 * nch] += nz.sigmaT0 * nz.sigmaT0;
+	}
+
+	void Filter::propagate(const Vec &F, double dt)
+	{
+		/*
+		 * Propagate the covariance over a time step, P = F*P*F' + Q with a diagonal F, with the process noise:
+		 * 		the error of the current changes the lithium in both electrodes in the same way as the current itself (see Plant::gain)
+		 * 		the model error of the lithium changes the SOC at constant cyclable lithium
+		 * 		every mode and the temperature have an independent error
+		 */
+
+		Vec g;
+		pl.gain(g);
+		const Vec &d = pl.dSOC;
+		const double vI = nz.sigmaI * nz.sigmaI, vS = nz.qSOC * nz.qSOC * dt;
+		for (int i = 0; i < nx; i++)
+		{
+			const double Fi = F[i], gi = vI * g[i], di = vS * d[i];
+			auto &Pi = P[i];
+			for (int j = 0; j < nx; j++)
+				Pi[j] = Fi * F[j] * Pi[j] + gi * g[j] + di * d[j];
+		}
+
+		const double sp = nz.qc * pl.Cmaxpos * pl.vp, sn = nz.qc * pl.Cmaxneg * pl.vn;
+		for (int j = 0; j < nch; j++)
+		{
+			P[j][j] += sp * sp * dt;
+			P[nch + j][nch + j] += sn * sn * dt;
+		}
+		P[2 * nch][2 * nch] += nz.qT * nz.qT * dt;
+	}
+
+	void Filter::update(const Vec &K, double S, double e)
+	{
+		// Kalman update for a scalar measurement with gain K, innovation covariance S and innovation e
+		for (int i = 0; i < nx; i++)
+		{
+			x[i] += K[i] * e;
+			const double KS = K[i] * S;
+			auto &Pi = P[i];
+			for (int j = 0; j < nx; j++)
+				Pi[j] -= KS * K[j];
+		}
+	}
+
+	void Filter::correctT(double T)
+	{
+		// the temperature is a state, so H is a unit vector
+		const double S = P[2 * nch][2 * nch] + nz.sigmaT * nz.sigmaT;
+		Vec K;
+		for (int i = 0; i < nx; i++)
+			K[i] = P[i][2 * nch] / S;
+		update(K, S, T - x[2 * nch]);
+	}
+
+	void Filter::step(double I, double dt, double V)
+	{
+		/*
+		 * Process one sample: the current flowed during dt before the sample, the voltage is measured at its end with the same current.
+		 * dt can be 0 for the first sample of a log, then only the correction is done.
+		 */
+
+		if (dt > 0)
+			predict(I, dt);
+		correct(I, V);
+	}
+
+	void Filter::step(double I, double dt, double V, double T)
+	{
+		step(I, dt, V);
+		correctT(T);
+	}
+
+	void Filter::run(const Log &log, Estimate &e)
+	{
+		/*
+		 * Process all samples of a log, starting from the present states and covariance.
+		 *
+		 * IN
+		 * log 		measurements, see loadLog
+		 *
+		 * OUT
+		 * e 		estimate after each sample
+		 *
+		 * THROWS
+		 * 1022 	the columns of the log have a different length or the time is not increasing
+		 */
+
+		const size_t N = log.t.size();
+		if (log.I.size() != N || log.V.size() != N || (!log.T.empty() && log.T.size() != N))
+		{
+			std::cerr << "ERROR in estimation::Filter::run, the log has " << N << " times, " << log.I.size() << " currents, " << log.V.size()
+					  << " voltages and " << log.T.size() << " temperatures, which must all be the same (or 0 temperatures). Throwing an error.\n";
+			throw 1022;
+		}
+
+		e = Estimate{};
+		for (auto v : {&e.t, &e.SOC, &e.sdSOC, &e.T, &e.sdT, &e.yp, &e.yn, &e.Vpred})
+			v->reserve(N);
+
+		for (size_t k = 0; k < N; k++)
+		{
+			const double dt = k > 0 ? log.t[k] - log.t[k - 1] : 0;
+			if (dt < 0)
+			{
+				std::cerr << "ERROR in estimation::Filter::run, the time decreases at sample " << k << ". Throwing an error.\n";
+				throw 1022;
+			}
+
+			if (dt > 0)
+				predict(log.I[k], dt);
+			e.Vpred.push_back(correct(log.I[k], log.V[k]));
+			if (!log.T.empty())
+				correctT(log.T[k]);
+
+			double yp, yn;
+			pl.surface(x, log.I[k], &yp, &yn);
+			e.t.push_back(log.t[k]);
+			e.SOC.push_back(SOC());
+			e.sdSOC.push_back(sdSOC());
+			e.T.push_back(T());
+			e.sdT.push_back(sdT());
+			e.yp.push_back(yp);
+			e.yn.push_back(yn);
+		}
+	}
+
+	double Filter::sdSOC() const
+	{
+		const double s = pl.vn * pl.Cmaxneg * (pl.win1 - pl.win0);
+		return std::sqrt(std::max(P[nch + pl.ind][nch + pl.ind], 0.0)) / std::abs(s);
+	}
+
+	double Filter::sdT() const
+	{
+		return std::sqrt(std::max(P[2 * nch][2 * nch], 0.0));
+	}
+
+	void EKF::predict(double I, double dt)
+	{
+		pl.step(x, I, dt, F);
+		propagate(F, dt);
+	}
+
+	double EKF::correct(double I, double V)
+	{
+		// the gradients, gain and innovation are kept for DualEKF
+		const double Vp = pl.voltage(x, I, H, dVdp);
+		S = nz.sigmaV * nz.sigmaV;
+		for (int i = 0; i < nx; i++)
+		{
+			double PH = 0;
+			for (int j = 0; j < nx; j++)
+				PH += P[i][j] * H[j];
+			K[i] = PH;
+			S += H[i] * PH;
+		}
+		for (int i = 0; i < nx; i++)
+			K[i] /= S;
+		e = V - Vp;
+		update(K, S, e);
+		return Vp;
+	}
+
+	DualEKF::DualEKF(const Plant &p, const Noise &nz, const Ageing &agi) : EKF(p, nz), base(p), ag(agi)
+	{
+		/*
+		 * Dual extended Kalman filter: the EKF of the states runs at every sample, a second EKF tracks the parameters at a slower rate.
+		 * The parameters are relative to their value in the plant, so they all start at 1:
+		 * 		th[0] 	active material of the cathode, which scales its capacity and inversely the flux on the particles
+		 * 		th[1] 	active material of the anode
+		 * 		th[2] 	resistance
+		 * The cyclable lithium is not a parameter since it follows from the mean concentrations, which are states
+		 * with an independent random walk (see Noise::qc), so loss of lithium is tracked by the state filter.
+		 *
+		 * THROWS
+		 * 1022 	illegal settings
+		 */
+
+		// #NOTHOTFUNCTION
+		if (ag.tUpdate <= 0 || ag.sigmaAM0 <= 0 || ag.sigmaR0 <= 0 || ag.qAM < 0 || ag.qR < 0)
+		{
+			std::cerr << "ERROR in estimation::DualEKF, the time between updates and the initial standard deviations must be positive "
+					  << "and the random walks can't be negative. Throwing an error.\n";
+			throw 1022;
+		}
+
+		Pth[0][0] = Pth[1][1] = ag.sigmaAM0 * ag.sigmaAM0;
+		Pth[2][2] = ag.sigmaR0 * ag.sigmaR0;
+	}
+
+	void DualEKF::predict(double I, double dt)
+	{
+		/*
+		 * Predict the states and their sensitivity to the parameters.
+		 * The sensitivity follows the same diagonal dynamics as the states, driven by the change in flux,
+		 * which is inversely proportional to the active material. The effect of the resistance on the temperature is neglected.
+		 */
+
+		EKF::predict(I, dt);
+		Vec g;
+		pl.gain(g);
+		for (int i = 0; i < nx; i++)
+			for (int k = 0; k < np; k++)
+				Sx[i][k] *= F[i];
+		for (int j = 0; j < nch; j++)
+		{
+			Sx[j][0] -= g[j] * I / th[0];
+			Sx[nch + j][1] -= g[nch + j] * I / th[1];
+		}
+		t += dt;
+		tw += dt;
+	}
+
+	double DualEKF::correct(double I, double V)
+	{
+		/*
+		 * Correct the states and add the information of the sample to the present window of the parameter filter.
+		 * The voltage depends on the parameters directly and through the states, dV/dth = dV/dp * dp/dth + H * Sx.
+		 * The weight of the sample is the innovation covariance of the state filter.
+		 */
+
+		const double Vp = EKF::correct(I, V);
+
+		Par Hp{dVdp[0] * -pl.fp / th[0], dVdp[1] * -pl.fn / th[1], dVdp[2] * base.R};
+		for (int i = 0; i < nx; i++)
+			for (int k = 0; k < np; k++)
+				Hp[k] += H[i] * Sx[i][k];
+
+		for (int k = 0; k < np; k++)
+		{
+			b[k] += Hp[k] * e / S;
+			for (int l = 0; l < np; l++)
+				J[k][l] += Hp[k] * Hp[l] / S;
+		}
+
+		// the correction of the states depends on the parameters through the innovation
+		for (int i = 0; i < nx; i++)
+			for (int k = 0; k < np; k++)
+				Sx[i][k] -= K[i] * Hp[k];
+
+		if (tw >= ag.tUpdate)
+			updateParameters();
+		return Vp;
+	}
+
+	void DualEKF::updateParameters()
+	{
+		/*
+		 * Update the parameters with the information of all samples since the previous update,
+		 * in information form since the window has many scalar measurements and only np parameters:
+		 * 		Pth = (Pth^-1 + J)^-1 		with J = sum(Hp' * Hp / S)
+		 * 		th 	= th + Pth * b 			with b = sum(Hp' * e / S)
+		 * The parameters do a random walk over the window before the update.
+		 *
+		 * THROWS
+		 * 1022 	the covariance of the parameters is singular
+		 */
+
+		Pth[0][0] += ag.qAM * ag.qAM * tw;
+		Pth[1][1] += ag.qAM * ag.qAM * tw;
+		Pth[2][2] += ag.qR * ag.qR * tw;
+
+		auto A = Pth;
+		invert(A);
+		for (int k = 0; k < np; k++)
+			for (int l = 0; l < np; l++)
+				A[k][l] += J[k][l];
+		invert(A);
+		Pth = A;
+
+		for (int k = 0; k < np; k++)
+		{
+			for (int l = 0; l < np; l++)
+				th[k] += Pth[k][l] * b[l];
+			th[k] = std::max(th[k], 0.05); // the parameters must stay positive
+		}
+
+		pl.fp = base.fp / th[0];
+		pl.fn = base.fn / th[1];
+		pl.Qp = base.Qp * th[0];
+		pl.Qn = base.Qn * th[1];
+		pl.R = base.R * th[2];
+		pl.rebalance(x);
+
+		for (auto &r : J)
+			r.fill(0);
+		b.fill(0);
+		tw = 0;
+
+		double soh, sdsoh;
+		health(&soh, &sdsoh);
+		hist.t.push_back(t);
+		hist.SOH.push_back(soh);
+		hist.sdSOH.push_back(sdsoh);
+		hist.Qp.push_back(pl.Qp);
+		hist.Qn.push_back(pl.Qn);
+		hist.nLi.push_back(pl.lithium(x));
+		hist.R.push_back(pl.R);
+		hist.sdR.push_back(base.R * std::sqrt(Pth[2][2]));
+	}
+
+	void DualEKF::invert(std::array<Par, np> &A)
+	{
+		// Gauss-Jordan elimination with partial pivoting, in place
+		std::array<Par, np> B{};
+		for (int k = 0; k < np; k++)
+			B[k][k] = 1;
+		for (int c = 0; c < np; c++)
+		{
+			int piv = c;
+			for (int r = c + 1; r < np; r++)
+				if (std::abs(A[r][c]) > std::abs(A[piv][c]))
+					piv = r;
+			if (A[piv][c] == 0)
+			{
+				std::cerr << "ERROR in estimation::DualEKF, the covariance of the parameters is singular. Throwing an error.\n";
+				throw 1022;
+			}
+			std::swap(A[c], A[piv]);
+			std::swap(B[c], B[piv]);
+			const double d = A[c][c];
+			for (int l = 0; l < np; l++)
+			{
+				A[c][l] /= d;
+				B[c][l] /= d;
+			}
+			for (int r = 0; r < np; r++)
+				if (r != c)
+				{
+					const double f = A[r][c];
+					for (int l = 0; l < np; l++)
+					{
+						A[r][l] -= f * A[c][l];
+						B[r][l] -= f * B[c][l];
+					}
+				}
+		}
+		A = B;
+	}
+
+	void DualEKF::health(double *SOH, double *sdSOH)
+	{
+		/*
+		 * State of health from the present capacities and cyclable lithium, see Cell::getIndicators.
+		 * Its variance follows from finite differences to the active material of both electrodes and the cyclable lithium,
+		 * the correlation between the states and parameters is neglected as in the dual filter.
+		 *
+		 * OUT
+		 * SOH 		present capacity relative to the nominal capacity [-]
+		 * sdSOH 	standard deviation of the SOH [-]
+		 */
+
+		const double nLi = pl.lithium(x);
+		auto capacity = [&](double Qpi, double Qni, double nLii) {
+			double win[4];
+			pl.windows(Qpi, Qni, nLii, win);
+			return (win[2] - win[3]) * Qpi;
+		};
+
+		constexpr double h = 1e-4; // relative step of the finite differences
+		const double c0 = capacity(pl.Qp, pl.Qn, nLi);
+		const double dcp = (capacity(base.Qp * (th[0] + h), pl.Qn, nLi) - c0) / h;
+		const double dcn = (capacity(pl.Qp, base.Qn * (th[1] + h), nLi) - c0) / h;
+		const double dcl = (capacity(pl.Qp, pl.Qn, nLi * (1 + h)) - c0) / (h * nLi);
+
+		// variance of the cyclable lithium from the covariance of the mean concentrations
+		const int ip = pl.ind, in = nch + pl.ind;
+		const double a = pl.Qp / (pl.vp * pl.Cmaxpos), bn = pl.Qn / (pl.vn * pl.Cmaxneg);
+		const double vLi = a * a * P[ip][ip] + 2 * a * bn * P[ip][in] + bn * bn * P[in][in];
+
+		const double v = dcp * dcp * Pth[0][0] + 2 * dcp * dcn * Pth[0][1] + dcn * dcn * Pth[1][1] + dcl * dcl * vLi;
+		*SOH = c0 / pl.Qnom;
+		*sdSOH = std::sqrt(std::max(v, 0.0)) / pl.Qnom;
+	}
+
+	void DualEKF::run(const Log &log, Estimate &e, Health &h)
+	{
+		/*
+		 * Process all samples of a log (see Filter::run) and get the SOH trajectory, with one point per update of the parameters.
+		 * The time of the trajectory continues from the first sample of the log.
+		 */
+
+		hist = Health{};
+		if (!log.t.empty())
+			t = log.t.front();
+		Filter::run(log, e);
+		h = std::move(hist);
+		hist = Health{};
+	}
+
+	UKF::UKF(const Plant &p, const Noise &nz, double alpha, double beta, double kappa) : Filter(p, nz)
+	{
+		/*
+		 * Unscented Kalman filter with the scaled sigma points of Julier (2002) for the ny outputs on which the voltage depends.
+		 * The default alpha = 1 and kappa = 0 put the sigma points at sqrt(ny) standard deviations with a 0 weight for the mean,
+		 * smaller alpha can give a negative weight which makes the covariance indefinite for a nonlinear voltage.
+		 *
+		 * IN
+		 * alpha 	spread of the sigma points, 0 < alpha <= 1
+		 * beta 	prior knowledge of the distribution, 2 is optimal for a Gaussian
+		 * kappa 	secondary scaling parameter, ny + kappa > 0
+		 *
+		 * THROWS
+		 * 1022 	illegal scaling parameters
+		 */
+
+		// #NOTHOTFUNCTION
+		lambda = alpha * alpha * (ny + kappa) - ny;
+		if (alpha <= 0 || alpha > 1 || ny + lambda <= 0)
+		{
+			std::cerr << "ERROR in estimation::UKF, illegal parameters alpha = " << alpha << " and kappa = " << kappa
+					  << ", alpha must be in (0, 1] and " << ny << " + kappa must be positive. Throwing an error.\n";
+			throw 1022;
+		}
+
+		Wm.fill(0.5 / (ny + lambda));
+		Wc.fill(0.5 / (ny + lambda));
+		Wm[0] = lambda / (ny + lambda);
+		Wc[0] = Wm[0] + 1 - alpha * alpha + beta;
+	}
+
+	void UKF::sigmaPoints()
+	{
+		/*
+		 * Sigma points for the outputs y = C*x on which the voltage depends: the linear combinations of the modes
+		 * which give the surface concentrations (Csp and Csn, see Plant::evaluate) and the temperature.
+		 * Every sigma point of y is made into states by adding the change of the mean of x given y,
+		 * 		x + G * Py^-1 * (y - C*x) 		with G = P*C' and Py = C*P*C'
+		 * With the Cholesky factor Py = L*L', the sigma points y = C*x +- sqrt(ny + lambda) * L*e_j give the states
+		 * 		x +- sqrt(ny + lambda) * M*e_j 	with M = G * L'^-1
+		 * so the cross covariance of the states and the voltage follows from the sigma points as for a full set of 2*nx+1.
+		 *
+		 * THROWS
+		 * 1022 	the covariance of the outputs is not positive definite
+		 */
+
+		std::array<Vec, ny> G{}; // G[k][i] = (P*C')[i][k]
+		for (int i = 0; i < nx; i++)
+		{
+			for (int j = 0; j < nch; j++)
+			{
+				G[0][i] += P[i][j] * pl.Csp[j];
+				G[1][i] += P[i][nch + j] * pl.Csn[j];
+			}
+			G[2][i] = P[i][2 * nch];
+		}
+
+		std::array<std::array<double, ny>, ny> Lc{}; // Cholesky factor of Py = C*G
+		for (int j = 0; j < ny; j++)
+		{
+			for (int i = j; i < ny; i++)
+			{
+				double s = 0;
+				if (i == 2)
+					s = G[j][2 * nch];
+				else
+					for (int k = 0; k < nch; k++)
+						s += (i == 0 ? pl.Csp[k] * G[j][k] : pl.Csn[k] * G[j][nch + k]);
+				for (int k = 0; k < j; k++)
+					s -= Lc[i][k] * Lc[j][k];
+				if (i == j)
+				{
+					if (s <= 0)
+					{
+						std::cerr << "ERROR in estimation::UKF, the covariance is not positive definite. Throwing an error.\n";
+						throw 1022;
+					}
+					Lc[j][j] = std::sqrt(s);
+				}
+				else
+					Lc[i][j] = s / Lc[j][j];
+			}
+		}
+
+		// M' = L^-1 * G' by forward substitution, scaled to the spread of the sigma points
+		const double sc = std::sqrt(ny + lambda);
+		chi[0] = x;
+		for (int i = 0; i < nx; i++)
+		{
+			double m[ny];
+			for (int j = 0; j < ny; j++)
+			{
+				m[j] = G[j][i];
+				for (int k = 0; k < j; k++)
+					m[j] -= Lc[j][k] * m[k];
+				m[j] /= Lc[j][j];
+				chi[1 + j][i] = x[i] + sc * m[j];
+				chi[1 + ny + j][i] = x[i] - sc * m[j];
+			}
+		}
+	}
+
+	void UKF::predict(double I, double dt)
+	{
+		// the concentrations are linear in the states (see Plant::discretise), so one step propagates their mean and covariance as in the EKF
+		Vec F;
+		pl.step(x, I, dt, F);
+		propagate(F, dt);
+	}
+
+	double UKF::correct(double I, double V)
+	{
+		sigmaPoints();
+		std::array<double, 2 * ny + 1> Y;
+		double Vp = 0;
+		for (int s = 0; s < 2 * ny + 1; s++)
+		{
+			Y[s] = pl.voltage(chi[s], I);
+			Vp += Wm[s] * Y[s];
+		}
+
+		double S = nz.sigmaV * nz.sigmaV;
+		Vec K{};
+		for (int s = 0; s < 2 * ny + 1; s++)
+		{
+			S += Wc[s] * (Y[s] - Vp) * (Y[s] - Vp);
+			for (int i = 0; i < nx; i++)
+				K[i] += Wc[s] * (chi[s][i] - x[i]) * (Y[s] - Vp);
+		}
+		for (int i = 0; i < nx; i++)
+			K[i] /= S;
+		update(K, S, V - Vp);
+		return Vp;
+	}
+} // namespace slide::estimation
+
+namespace
+{
+	bool follow(Cell &c, double I, int time, int dtlog, const slide::estimation::Noise &nz, std::mt19937 &gen, double *t, slide::estimation::Log &log)
+	{
+		/*
+		 * Let a cell follow a constant current with time steps of 1 second, and add a sample to a log every dtlog seconds.
+		 * Gaussian noise with the standard deviations of the measurements of the filters is added to the voltage and temperature.
+		 * Degradation is not accounted for.
+		 *
+		 * IN
+		 * I 		current [A], > 0 for a discharge
+		 * time 	duration [s]
+		 * dtlog 	time between two samples [s]
+		 * nz 		noise of the measurements
+		 *
+		 * IN/OUT
+		 * c 		cell
+		 * gen 		random number generator of the noise
+		 * t 		time of the log [s]
+		 * log 		log to which the samples are added
+		 *
+		 * OUT
+		 * bool 	false if the current could not be followed for the whole duration because the voltage would go outside the limits of the cell
+		 */
+
+		std::normal_distribution<double> nV(0, nz.sigmaV), nT(0, nz.sigmaT);
+		slide::State s;
+		double Iprev, V, ocvp, ocvn, etap, etan, rdrop, T;
+
+		try
+		{
+			c.setI(false, true, I);
+		}
+		catch (int)
+		{
+			return false;
+		}
+
+		for (int k = 1; k <= time; k++)
+		{
+			c.getStates(s, &Iprev);
+			try
+			{
+				c.ETI(false, 1, true);
+				c.getVoltage(false, &V, &ocvp, &ocvn, &etap, &etan, &rdrop, &T);
+			}
+			catch (int)
+			{
+				V = 0; // the current can't be sustained
+			}
+			if (V > c.getVmax() || V < c.getVmin())
+			{
+				c.setStates(s, Iprev); // undo the last time step such that the cell stays within its limits
+				return false;
+			}
+
+			*t += 1;
+			if (k % dtlog == 0)
+			{
+				log.t.push_back(*t);
+				log.I.push_back(I);
+				log.V.push_back(V + nV(gen));
+				log.T.push_back(T + nT(gen));
+			}
+		}
+		return true;
+	}
+} // namespace
+
+void StateEstimation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to estimate the SOC and temperature of a cell from a log of its current, voltage and temperature,
+	 * with the extended and the unscented Kalman filter (see estimator.hpp).
+	 * The log is either read from a csv file in the data folder (e.g. measured on a cell), or simulated:
+	 * the cell follows a drive cycle until it is empty and then rests for half an hour, with noise on the voltage and temperature.
+	 * The filters use the model of the cell in its initial state. A simulated log starts from this state,
+	 * but the filters start from an SOC which is 20% too low to show how fast they converge to the right one.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the names of the result files begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 *
+	 * OUT
+	 * The estimates of both filters are written in pref_degid_StateEstimation_EKF.csv and _UKF.csv (see estimation::write)
+	 */
+
+	using namespace slide::estimation;
+
+	// *********************************************************** 1 the log ***********************************************************************
+
+	std::string logName = "";									  // name of the csv file in the data folder with the log, empty to simulate one
+																  // the columns are the time [s], current [A] (> 0 for a discharge), voltage [V] and temperature [K]
+	std::string profile = "Current Profile drive cycle UDDS.csv"; // name of the csv file with the current profile of the simulated log (see FollowCurrent)
+	int length = 1370;											  // length of the profile (number of rows in the csv file) to read
+
+	Cell c = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																	   : (Cell)slide::Cell_user(M, degid, verbose);
+	Noise nz;
+	Log log;
+	double SOCerr = 0; // error of the initial SOC of the filters [-]
+	if (logName.empty())
+	{
+		std::vector<double> Iprof, tprof;
+		loadCSV_2col(PathVar::data + profile, Iprof, tprof, length);
+
+		Cell cs = c; // copy of the cell which makes the log
+		std::mt19937 gen(1);
+		double t = 0;
+		bool ok = true;
+		while (ok)
+			for (int k = 0; k < length && ok; k++)
+				ok = follow(cs, Iprof[k], static_cast<int>(tprof[k]), 1, nz, gen, &t, log);
+		follow(cs, 0, 1800, 1, nz, gen, &t, log);
+		SOCerr = -0.2;
+		std::cout << "\t The simulated log has " << log.t.size() << " samples and ends at " << cs.getSOC() * 100 << "% SOC.\n";
+	}
+	else
+		log = loadLog(logName, 0, 1, 2, 3);
+
+	// *********************************************************** 2 the filters ***********************************************************************
+
+	Plant pl;
+	c.getPlant(pl);
+	Vec x0 = pl.x0;
+	for (int i = 0; i < nx; i++)
+		x0[i] += SOCerr * pl.dSOC[i];
+
+	const std::string name = pref + "_" + degid.print() + "_StateEstimation";
+	Estimate e;
+
+	EKF ekf(pl, nz);
+	ekf.init(x0);
+	ekf.run(log, e);
+	write(e, name + "_EKF.csv");
+	std::cout << "\t The extended Kalman filter ends at " << ekf.SOC() * 100 << " +- " << ekf.sdSOC() * 100 << "% SOC.\n";
+
+	UKF ukf(pl, nz);
+	ukf.init(x0);
+	ukf.run(log, e);
+	write(e, name + "_UKF.csv");
+	std::cout << "\t The unscented Kalman filter ends at " << ukf.SOC() * 100 << " +- " << ukf.sdSOC() * 100 << "% SOC.\n";
+}
+
+void HealthEstimation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose)
+{
+	/*
+	 * Function to estimate the state of health of a cell from a cycling log with the dual extended Kalman filter (see estimator.hpp).
+	 * The log is either read from a csv file in the data folder (e.g. measured on a cell), or simulated with an aged copy of the cell:
+	 * the cathode is 7% and the anode 12% thinner, and the specific resistance is 40% higher, which lowers the SOH to around 89%.
+	 * The aged cell does a few cycles of a 1C CC discharge, a rest of half an hour, a 1C CC charge and another rest,
+	 * with noise on the voltage and temperature and a sample every 10 seconds.
+	 * The filter starts from the model of the cell in its initial (fresh) state, and finds the active material and resistance of the cell of the log.
+	 *
+	 * IN
+	 * M 			matrices of the spatial discretisation for the solid diffusion PDE
+	 * pref 		string with which the names of the result files begin
+	 * degid	 	struct with degradation settings (which degradation models to be used)
+	 * cellType 	integer deciding which cell to use for the simulation (see CycleAgeing)
+	 * verbose 		integer indicating how verbose the simulation has to be (see CycleAgeing)
+	 *
+	 * OUT
+	 * The SOH trajectory is written in pref_degid_HealthEstimation.csv and the estimated states in pref_degid_HealthEstimation_states.csv (see estimation::write)
+	 */
+
+	using namespace slide::estimation;
+
+	// *********************************************************** 1 the log ***********************************************************************
+
+	std::string logName = ""; // name of the csv file in the data folder with the log, empty to simulate one
+							  // the columns are the time [s], current [A] (> 0 for a discharge), voltage [V] and temperature [K]
+	int nCycles = 5;		  // number of cycles of the simulated log
+
+	Cell c = (cellType == 0) ? (Cell)Cell_KokamNMC(M, degid, verbose) : (cellType == 1) ? (Cell)Cell_LGChemNMC(M, degid, verbose)
+																	   : (Cell)slide::Cell_user(M, degid, verbose);
+	Noise nz;
+	Log log;
+	if (logName.empty())
+	{
+		Cell cs = c; // aged copy of the cell which makes the log
+		slide::State s;
+		double I;
+		cs.getStates(s, &I);
+		cs.overwriteGeometricStates(0.93 * s.get_thickp(), 0.88 * s.get_thickn(), s.get_ep(), s.get_en(), s.get_ap(), s.get_an());
+		cs.overwriteCharacterisationStates(s.get_Dp(), s.get_Dn(), 1.4 * s.get_r());
+
+		std::mt19937 gen(1);
+		double t = 0;
+		const double Icyc = cs.getNominalCap(); // 1C
+		for (int i = 0; i < nCycles; i++)
+		{
+			follow(cs, Icyc, 36000, 10, nz, gen, &t, log);
+			follow(cs, 0, 1800, 10, nz, gen, &t, log);
+			follow(cs, -Icyc, 36000, 10, nz, gen, &t, log);
+			follow(cs, 0, 1800, 10, nz, gen, &t, log);
+		}
+
+		double SOC, cap, SOH, Eav;
+		cs.getIndicators(&SOC, &cap, &SOH, &Eav);
+		std::cout << "\t The simulated log has " << log.t.size() << " samples, the SOH of the cell which made it is " << SOH * 100 << "%.\n";
+	}
+	else
+		log = loadLog(logName, 0, 1, 2, 3);
+
+	// *********************************************************** 2 the filter ***********************************************************************
+
+	Plant pl;
+	c.getPlant(pl);
+	Ageing ag;
+
+	const std::string name = pref + "_" + degid.print() + "_HealthEstimation";
+	Estimate e;
+	Health h;
+
+	DualEKF f(pl, nz, ag);
+	f.run(log, e, h);
+	write(h, name + ".csv");
+	write(e, name + "_states.csv");
+
+	double SOH, sdSOH;
+	f.health(&SOH, &sdSOH);
+	std::cout << "\t The dual extended Kalman filter ends at an SOH of " << SOH * 100 << " +- " << sdSOH * 100 << "% and a resistance of "
+			  << f.parameters()[2] * pl.R * 1000 << " mOhm (" << f.parameters()[2] * 100 << "% of the fresh cell).\n";
+}
@@ -0,0 +1,252 @@
+/*
+ * estimator.hpp
+ *
+ * Model-based state estimation with the single particle model, e.g. to test the algorithms of a battery management system
+ * on simulated data or to process measured logs.
+ *
+ * A Plant is a frozen copy of the model of a Cell (see Cell::getPlant). Its states are the transformed concentrations
+ * of both electrodes and the temperature, everything which changes over the lifetime of the cell (degradation states,
+ * diffusion constants, resistance, hysteresis) is a constant parameter. The concentration dynamics are linear with a
+ * diagonal state matrix, so a time step is discretised exactly and the filters only need 2*nch+1 states.
+ *
+ * The filters estimate the states from the measured current and voltage, and optionally the temperature:
+ * 		EKF 	extended Kalman filter, the voltage is linearised with its analytical gradient to the states (only the slopes of the OCV curves are finite differences)
+ * 		UKF 	unscented Kalman filter, the voltage follows from 2*3+1 sigma points of the surface concentrations and the temperature,
+ * 				the prediction is linear in the concentrations and the same as for the EKF
+ * The EKF is about twice as fast, the UKF is more accurate for a strongly nonlinear voltage, e.g. near the ends of the OCV curves.
+ * Both derive from Filter, which has the common interface and processes recorded logs in one go (see run).
+ * DualEKF adds a second, slower filter for the ageing parameters (active material of both electrodes and resistance),
+ * which gives SOH trajectories with their uncertainty for field logs.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "interpolation.h"
+#include "model.h"
+#include "param/cell_param.hpp"
+
+namespace slide::estimation
+{
+	constexpr int nch = settings::nch;
+	constexpr int nx = 2 * nch + 1; // number of states: transformed concentrations of the cathode and anode, and the temperature
+
+	using Vec = std::array<double, nx>;
+	using Mat = std::array<Vec, nx>; // covariance matrix, symmetric
+
+	// reduced model of a cell, the states are ordered as in State: zp, zn, T
+	class Plant
+	{
+	public:
+		// parameters, see Cell and Model
+		std::array<double, nch> Ap{}, An{}, Bp{}, Bn{};	// diagonal state-space model of the particles
+		std::array<double, nch> Csp{}, Csn{};			// row of the output matrix for the surface node
+		double Dsp{0}, Dsn{0};							// feedthrough of the flux to the surface concentration
+		double Dp{0}, Dn{0}, Dp_T{0}, Dn_T{0};			// diffusion constants at reference temperature [m s-1] and their activation energies
+		double kp{0}, kn{0}, kp_T{0}, kn_T{0};			// rate constants at reference temperature and their activation energies
+		double fp{0}, fn{0};							// molar flux on the particles per unit of cell current [mol m-2 s-1 A-1]
+		double Cmaxpos{0}, Cmaxneg{0}, C_elec{0}, n{1};	// maximum concentrations and electrolyte concentration [mol m-3], electrons of the reaction [-]
+		double T_ref{0}, T_env{0};						// reference and environment temperature [K]
+		double R{0};									// total DC resistance [Ohm]
+		double hp{0}, hn{0};							// hysteresis states [-]
+		double L{0}, elec_surf{0}, SAV{0};				// cell thickness [m], electrode surface [m2], surface to volume ratio [m-1]
+		double rhoCp{1}, Qch{0};						// volumetric heat capacity [J K-1 m-3] and heat transfer coefficient [W K-1 m-3]
+		int ind{0};										// index of the mode with the 0 eigenvalue, the mean concentration
+		double vp{0}, vn{0};							// transformed concentration of that mode per unit of uniform concentration
+		double Qp{0}, Qn{0}, Qnom{1};					// capacity of the electrodes and nominal capacity of the cell [Ah]
+		double Vmax{0}, Vmin{0};						// voltage limits at 100 and 0% SOC [V]
+		double win0{0}, win1{1};						// anode li-fraction at 0 and 100% SOC, see rebalance
+		Vec dSOC{};										// change of the states per unit of SOC at constant cyclable lithium, see rebalance
+		Vec x0{};										// states of the cell when the plant was made
+		std::shared_ptr<OCVcurves> ocv;					// copy of the OCV curves of the cell
+
+		void step(Vec &x, double I, double dt);									  // advance the states over a time step
+		void step(Vec &x, double I, double dt, Vec &F);							  // advance the states and get the diagonal of the Jacobian
+		void gain(Vec &g) const;												  // sensitivity of the states after the last step to its current
+		double voltage(const Vec &x, double I);									  // cell voltage [V]
+		double voltage(const Vec &x, double I, Vec &H, double dVdp[3] = nullptr); // cell voltage and its gradient to the states and parameters
+		void surface(const Vec &x, double I, double *yp, double *yn);			  // surface li-fractions [-]
+		double SOC(const Vec &x) const;											  // state of charge [-], see Cell::getSOC
+		double lithium(const Vec &x) const;										  // cyclable lithium [Ah]
+		void windows(double Qpi, double Qni, double nLi, double win[4]);		  // stoichiometry windows, see Cell::getElectrodeBalance
+		void rebalance(const Vec &x);											  // update the SOC window and dSOC for the capacities and the lithium in x
+
+	private:
+		struct Out
+		{
+			double T, cps, cns, yp, yn; // temperature, surface concentrations and li-fractions (clamped inside (0, 1))
+			double OCVp, OCVn, dOCV;	// electrode potentials and entropic coefficient
+			double i0p, i0n, xp, xn;	// exchange current densities and argument of asinh in the Butler-Volmer relation
+			double etap, etan;			// overpotentials
+			double V;					// cell voltage
+		};
+		double Tk{-1};									// temperature of the stored diffusion and rate constants
+		double Dpt{0}, Dnt{0}, kpt{0}, knt{0};			// diffusion and rate constants at Tk
+		double Td{-1}, dtd{-1};							// temperature and time step of the stored discretisation
+		std::array<double, nch> ep{}, en{}, gp{}, gn{};	// z(t+dt) = e*z(t) + g*j
+
+		void arrhenius(double T);
+		void discretise(double T, double dt);
+		Out evaluate(const Vec &x, double I);
+	};
+
+	// standard deviations of the noise
+	struct Noise
+	{
+		double sigmaV{5e-3};   // voltage measurement [V]
+		double sigmaT{0.5};	   // temperature measurement [K]
+		double sigmaI{0.01};   // current measurement [A], enters as process noise on the concentrations
+		double qSOC{1e-5};	   // process noise of the SOC (model error of the lithium in the electrodes) [s^-0.5]
+		double qc{1e-5};	   // process noise of every concentration mode, relative to a uniform maximum concentration [s^-0.5]
+		double qT{1e-3};	   // process noise of the temperature [K s^-0.5]
+		double sigmaSOC0{0.1}; // initial SOC [-]
+		double sigmac0{1e-3};  // initial concentration modes, relative to a uniform maximum concentration [-]
+		double sigmaT0{2};	   // initial temperature [K]
+	};
+
+	// recorded measurements
+	struct Log
+	{
+		std::vector<double> t, I, V; // time [s], current [A] (> 0 for a discharge) and voltage [V] of each sample
+		std::vector<double> T;		 // temperature of each sample [K], empty if it is not measured
+	};
+
+	// output of a filter at each sample of a log
+	struct Estimate
+	{
+		std::vector<double> t, SOC, sdSOC, T, sdT; // time [s], SOC [-] and temperature [K] with their standard deviations
+		std::vector<double> yp, yn;				   // surface li-fractions [-]
+		std::vector<double> Vpred;				   // voltage predicted before the correction [V], the innovation is V - Vpred
+	};
+
+	Log loadLog(const std::string &name, int ct = 0, int cI = 1, int cV = 2, int cT = -1); // read a log from a csv file in the data folder
+	void write(const Estimate &e, const std::string &name);									 // write an estimate to a csv file in the results folder
+
+	class Filter
+	{
+	public:
+		Filter(const Plant &p, const Noise &nz);
+		virtual ~Filter() = default;
+
+		void init(const Vec &x0);							// restart from the given states with the initial covariance
+		void step(double I, double dt, double V);			// predict over a time step and correct with the measured voltage
+		void step(double I, double dt, double V, double T); // idem, and correct with the measured temperature
+		void run(const Log &log, Estimate &e);				// process all samples of a log
+
+		double SOC() const { return pl.SOC(x); }
+		double sdSOC() const;
+		double T() const { return x[2 * nch]; }
+		double sdT() const;
+		const Vec &states() const { return x; }
+		const Mat &covariance() const { return P; }
+		Plant &plant() { return pl; }
+
+	protected:
+		Plant pl;
+		Noise nz;
+		Vec x{};
+		Mat P{};
+
+		virtual void predict(double I, double dt) = 0;	// propagate the states and covariance over a time step
+		virtual double correct(double I, double V) = 0;	// correct with a measured voltage, returns the predicted voltage
+		void correctT(double T);						// correct with a measured temperature (linear, so the same for both filters)
+		void propagate(const Vec &F, double dt);		// propagate the covariance over a time step and add the process noise
+		void update(const Vec &K, double S, double e);	// x += K*e, P -= K*K'*S
+	};
+
+	class EKF : public Filter
+	{
+	public:
+		using Filter::Filter;
+
+	protected:
+		Vec F{};		   // diagonal of the Jacobian of the last prediction
+		Vec H{}, K{};	   // gradient of the voltage and Kalman gain of the last correction
+		double S{1}, e{0}; // innovation covariance and innovation of the last correction
+		double dVdp[3]{};  // derivative of the voltage to the parameters of the plant, see Plant::voltage
+
+		void predict(double I, double dt) override;
+		double correct(double I, double V) override;
+	};
+
+	// settings of the parameter filter of DualEKF
+	struct Ageing
+	{
+		double tUpdate{600};   // time between two updates of the parameters [s]
+		double sigmaAM0{0.05}; // initial standard deviation of the relative active material of each electrode [-]
+		double sigmaR0{0.2};   // initial standard deviation of the relative resistance [-]
+		double qAM{1e-5};	   // random walk of the relative active material [s^-0.5]
+		double qR{1e-4};	   // random walk of the relative resistance [s^-0.5]
+	};
+
+	// output of DualEKF at each update of the parameters
+	struct Health
+	{
+		std::vector<double> t, SOH, sdSOH; // time [s], state of health [-] and its standard deviation
+		std::vector<double> Qp, Qn, nLi;   // capacity of the electrodes and cyclable lithium [Ah]
+		std::vector<double> R, sdR;		   // resistance and its standard deviation [Ohm]
+	};
+
+	void write(const Health &h, const std::string &name); // write an SOH trajectory to a csv file in the results folder
+
+	// joint estimation of the states and the slowly changing ageing parameters
+	class DualEKF : public EKF
+	{
+	public:
+		static constexpr int np = 3; // number of parameters: relative active material of the cathode and anode, and relative resistance
+		using Par = std::array<double, np>;
+
+		DualEKF(const Plant &p, const Noise &nz, const Ageing &ag);
+
+		using Filter::run;
+		void run(const Log &log, Estimate &e, Health &h); // process all samples of a log and get the SOH trajectory
+		void health(double *SOH, double *sdSOH);		  // present SOH and its standard deviation
+		const Par &parameters() const { return th; }
+		const std::array<Par, np> &parameterCovariance() const { return Pth; }
+
+	protected:
+		Plant base; // plant with the parameters at their initial value
+		Ageing ag;
+		Par th{1, 1, 1};							// parameters relative to the base plant
+		std::array<Par, np> Pth{};					// covariance of the parameters
+		std::array<Par, np> J{};					// information of the samples since the last update
+		Par b{};									// weighted innovations of the samples since the last update
+		std::array<Par, nx> Sx{};					// sensitivity of the states to the parameters
+		double t{0}, tw{0};							// time [s] and time since the last update [s]
+		Health hist;								// SOH trajectory of the present log
+
+		void predict(double I, double dt) override;
+		double correct(double I, double V) override;
+		void updateParameters();					// update the parameters with the information of the window
+		static void invert(std::array<Par, np> &A);	// invert a small matrix
+	};
+
+	class UKF : public Filter
+	{
+	public:
+		UKF(const Plant &p, const Noise &nz, double alpha = 1, double beta = 2, double kappa = 0);
+
+	protected:
+		static constexpr int ny = 3; // outputs on which the voltage depends: surface concentration of the cathode and anode, and the temperature
+
+		double lambda;
+		std::array<double, 2 * ny + 1> Wm, Wc; // weights of the sigma points for the mean and covariance
+		std::array<Vec, 2 * ny + 1> chi;	   // states of the sigma points
+
+		void sigmaPoints(); // make the sigma points from the mean and covariance
+		void predict(double I, double dt) override;
+		double correct(double I, double V) override;
+	};
+} // namespace slide::estimation
+
+void StateEstimation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose); // estimate the SOC and temperature of a log with the EKF and UKF
+void HealthEstimation(const struct slide::Model &M, std::string pref, const struct DEG_ID &degid, int cellType, int verbose); // estimate the SOH of a cycling log with the dual EKF
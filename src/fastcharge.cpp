@@ -0,0 +1,156 @@
+/*
+ * fastcharge.cpp
+ *
+ * Implements the library of fast-charge protocols.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "fastcharge.hpp"
+
+#include <iostream>
+
+namespace slide::fastcharge
+{
+	using protocol::above;
+	using protocol::below;
+	using protocol::Protocol;
+	using protocol::Var;
+
+	Protocol stepped(const std::vector<double> &I, const std::vector<double> &until, Var var, double Vmax, double Icut, double dt)
+	{
+		/*
+		 * Multi-stage CC charge followed by a CV phase.
+		 * Stage k charges at current I[k] until var is above until[k] (or for until[k] seconds if var is the time) or the voltage reaches Vmax.
+		 * Stepping by voltage gives a decreasing current as the cell fills up, stepping by SOC gives the same current profile as the cell ages.
+		 *
+		 * IN
+		 * I 		charging current of every stage [A], > 0
+		 * until 	end of every stage, SOC [-], voltage [V] or time [s]
+		 * var 		quantity which ends the stages, Var::SOC, Var::V or Var::t
+		 * Vmax 	voltage of the CV phase [V]
+		 * Icut 	cutoff current of the CV phase [A], > 0
+		 *
+		 * THROWS
+		 * 1020 	I and until have a different length or are empty
+		 */
+
+		if (I.empty() || I.size() != until.size())
+		{
+			std::cerr << "ERROR in fastcharge::stepped, there are " << I.size() << " currents and " << until.size()
+					  << " stage limits, there must be at least one and the same number of both. Throwing an error.\n";
+			throw 1020;
+		}
+
+		Protocol p;
+		for (size_t k = 0; k < I.size(); k++)
+		{
+			if (var == Var::t)
+				p.CC(-I[k], {above(Var::V, Vmax)}, until[k], dt);
+			else
+				p.CC(-I[k], {above(var, until[k]), above(Var::V, Vmax)}, protocol::tmax, dt);
+		}
+		p.CV(Vmax, {below(Var::I, Icut)}, protocol::tmax, dt);
+		return p;
+	}
+
+	Protocol boost(double Iboost, double tboost, double I, double Vmax, double Icut, double dt)
+	{
+		/*
+		 * Boost charge: a high current for tboost seconds while the cell is empty, followed by a CC CV charge at I.
+		 */
+
+		Protocol p;
+		p.CC(-Iboost, {above(Var::V, Vmax)}, tboost, dt)
+			.CC(-I, {above(Var::V, Vmax)}, protocol::tmax, dt)
+			.CV(Vmax, {below(Var::I, Icut)}, protocol::tmax, dt);
+		return p;
+	}
+
+	Protocol platingLimited(double Imax, double margin, double Vmax, double Icut, double dt)
+	{
+		/*
+		 * Charge at Imax, the current is reduced when needed to keep the potential of the anode at least margin above the plating reaction
+		 * (see BasicCycler::findPlatingCurrent). This phase ends when the voltage reaches Vmax or the current drops below Icut,
+		 * and it is followed by a CV phase at Vmax.
+		 */
+
+		Protocol p;
+		p.CCpl(-Imax, margin, {above(Var::V, Vmax), below(Var::I, Icut)}, protocol::tmax, dt)
+			.CV(Vmax, {below(Var::I, Icut)}, protocol::tmax, dt);
+		return p;
+	}
+
+	Protocol pulse(double I, double ton, double toff, double SOCend, double Vmax, double Icut, double dt)
+	{
+		/*
+		 * Pulse charge: pulses of ton seconds at current I separated by rests of toff seconds, until the SOC reaches SOCend.
+		 * Once a pulse is cut short because the voltage reaches Vmax, the charge is finished with a CV phase at Vmax
+		 * until the SOC reaches SOCend or the current drops below Icut.
+		 */
+
+		Protocol p;
+		p.label("pulse")
+			.CC(-I, {above(Var::V, Vmax), above(Var::SOC, SOCend)}, ton, dt)
+			.jumpIf(above(Var::SOC, SOCend), "done")
+			.jumpIf(below(Var::t, ton - 0.5 * dt), "CV")
+			.rest(toff, {}, dt)
+			.jump("pulse")
+			.label("CV")
+			.CV(Vmax, {above(Var::SOC, SOCend), below(Var::I, Icut)}, protocol::tmax, dt)
+			.label("done");
+		return p;
+	}
+
+	Result charge(BasicCycler &cy, Protocol &p, bool blockDegradation, double SOCmark)
+	{
+		/*
+		 * Run a charge protocol on the cell of a cycler.
+		 *
+		 * IN
+		 * cy 		cycler whose cell is charged
+		 * p 		protocol
+		 * blockDegradation if true, degradation is not accounted for during the charge (the plated, stripped and dead lithium of the result are then 0)
+		 * SOCmark 	state of charge whose time is reported in Result::tmark [-]
+		 *
+		 * OUT
+		 * Result 	time, charge, final SOC, plated lithium and maximum temperature of the charge
+		 */
+
+		auto &c = cy.getCell();
+		slide::State s;
+		double I;
+		c.getStates(s, &I);
+		const double Qpl0 = s.get_Q_pl(), Lipl0 = s.get_Li_pl(), Qdead0 = s.get_Li_dead();
+
+		const auto mark = above(Var::SOC, SOCmark);
+		protocol::Run r;
+		cy.runProtocol(p, blockDegradation, c.getVmax(), c.getVmin(), r, nullptr, &mark);
+
+		c.getStates(s, &I);
+		Result res;
+		res.tmark = r.tmark;
+		res.time = r.time;
+		res.Ah = r.Ah;
+		res.SOC = c.getSOC();
+		res.Qpl = (s.get_Q_pl() - Qpl0) / 3600;
+		res.Lipl = (s.get_Li_pl() - Lipl0) / 3600;
+		res.Qdead = (s.get_Li_dead() - Qdead0) / 3600;
+		res.Tmax = r.Tmax;
+		res.end = r.end;
+		return res;
+	}
+
+	Result charge(Cell &c, Protocol &p, bool blockDegradation, double SOCmark)
+	{
+		/*
+		 * Run a charge protocol on a copy of a cell, such that several protocols can be compared from the same initial state.
+		 * No cycling data is stored.
+		 */
+
+		BasicCycler cy(c, "fastcharge", 0, -1);
+		return charge(cy, p, blockDegradation, SOCmark);
+	}
+} // namespace slide::fastcharge
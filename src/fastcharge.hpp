@@ -0,0 +1,48 @@
+/*
+ * fastcharge.hpp
+ *
+ * Library of parameterised fast-charge protocols, built as programmable protocols (see protocol.hpp):
+ * 		stepped 		multi-stage CC charge, each stage ends at a SOC, voltage or time, followed by a CV phase
+ * 		boost 			high current for a given time, followed by a standard CC CV charge
+ * 		platingLimited 	CC charge whose current is reduced to keep the anode potential above the plating reaction, followed by a CV phase
+ * 		pulse 			charge pulses separated by rests until a SOC is reached, followed by a CV phase if the voltage limit is reached first
+ * All currents are the magnitude of the charging current [A].
+ *
+ * charge runs a protocol and reports the time to 80% SOC, the plated lithium and the maximum temperature, so variants of a protocol can be compared.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "basic_cycler.hpp"
+#include "protocol.hpp"
+
+namespace slide::fastcharge
+{
+	// result of a charge
+	struct Result
+	{
+		double tmark{-1}; // time to reach the marked SOC (by default 80%) [s], -1 if it was not reached
+		double time{0};	  // duration of the charge [s]
+		double Ah{0};	  // charged capacity [Ah]
+		double SOC{0};	  // state of charge at the end of the charge [-]
+		double Qpl{0};	  // lithium plated during the charge (the gross plating, some of it can be stripped again) [Ah]
+		double Lipl{0};	  // change in the reversibly plated lithium during the charge [Ah]
+		double Qdead{0};  // dead lithium formed during the charge [Ah]
+		double Tmax{0};	  // maximum temperature during the charge [K]
+		int end{1};		  // end code of the last step (see BasicCycler::protocolStep), <= 0 if the cell went outside its voltage range
+	};
+
+	protocol::Protocol stepped(const std::vector<double> &I, const std::vector<double> &until, protocol::Var var, double Vmax, double Icut, double dt = 2);
+	protocol::Protocol boost(double Iboost, double tboost, double I, double Vmax, double Icut, double dt = 2);
+	protocol::Protocol platingLimited(double Imax, double margin, double Vmax, double Icut, double dt = 2);
+	protocol::Protocol pulse(double I, double ton, double toff, double SOCend, double Vmax, double Icut, double dt = 2);
+
+	Result charge(BasicCycler &cy, protocol::Protocol &p, bool blockDegradation, double SOCmark = 0.8); // charge the cell of a cycler
+	Result charge(Cell &c, protocol::Protocol &p, bool blockDegradation, double SOCmark = 0.8);		   // charge a copy of a cell
+} // namespace slide::fastcharge
@@ -0,0 +1,204 @@
+/*
+ * ica.cpp
+ *
+ * Implements the incremental capacity and differential voltage analysis.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "ica.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace slide::ica
+{
+	namespace
+	{
+		void derivative(const std::vector<double> &y, double dx, std::vector<double> &dy)
+		{
+			// central differences on a uniform grid, one-sided at the ends
+			const auto n = y.size();
+			dy.resize(n);
+			for (size_t i = 0; i < n; i++)
+			{
+				const auto a = (i == 0) ? i : i - 1;
+				const auto b = (i == n - 1) ? i : i + 1;
+				dy[i] = (y[b] - y[a]) / ((b - a) * dx);
+			}
+		}
+
+		void smooth(std::vector<double> &y)
+		{
+			// Gaussian filter truncated at 3 standard deviations, the kernel is renormalised near the ends
+			const int n = static_cast<int>(y.size());
+			const int w = static_cast<int>(3 * sigma);
+			std::vector<double> ys(n);
+			for (int i = 0; i < n; i++)
+			{
+				double num = 0, den = 0;
+				for (int k = std::max(0, i - w); k <= std::min(n - 1, i + w); k++)
+				{
+					const double g = std::exp(-0.5 * (k - i) * (k - i) / (sigma * sigma));
+					num += g * y[k];
+					den += g;
+				}
+				ys[i] = num / den;
+			}
+			y = ys;
+		}
+
+		void findPeaks(const std::vector<double> &x, const std::vector<double> &y, int ilo, int ihi, std::vector<double> &px, std::vector<double> &ph)
+		{
+			// local maxima in [ilo, ihi] whose prominence is large enough, the highest npeak peaks are returned
+			const int n = static_cast<int>(y.size());
+			const double ymax = *std::max_element(y.begin() + ilo, y.begin() + ihi + 1);
+			std::vector<int> ind;
+			for (int i = std::max(ilo, 1); i <= std::min(ihi, n - 2); i++)
+			{
+				if (!(y[i] > y[i - 1] && y[i] >= y[i + 1]))
+					continue;
+
+				// the prominence is the height above the highest of the minima between the peak and a higher point on either side
+				double left = y[i], right = y[i];
+				for (int k = i - 1; k >= 0 && y[k] <= y[i]; k--)
+					left = std::min(left, y[k]);
+				for (int k = i + 1; k < n && y[k] <= y[i]; k++)
+					right = std::min(right, y[k]);
+
+				if (y[i] - std::max(left, right) >= prominence * ymax)
+					ind.push_back(i);
+			}
+
+			std::sort(ind.begin(), ind.end(), [&](int a, int b) { return y[a] > y[b]; });
+			if (static_cast<int>(ind.size()) > npeak)
+				ind.resize(npeak);
+
+			px.clear();
+			ph.clear();
+			for (const auto i : ind)
+			{
+				px.push_back(x[i]);
+				ph.push_back(y[i]);
+			}
+		}
+	} // namespace
+
+	void analyse(const std::vector<double> &Q, const std::vector<double> &V, Features &f)
+	{
+		/*
+		 * Get the peaks of the smoothed IC and DV curves of a (pseudo-)equilibrium discharge curve.
+		 * Points where the voltage does not decrease are skipped, such that the constant potentials after one electrode
+		 * has reached the end of its OCV curve (see Cycler::getOCV) do not produce spurious peaks.
+		 *
+		 * IN
+		 * Q 		discharged charge, increasing [Ah]
+		 * V 		cell voltage at the discharged charges [V]
+		 *
+		 * OUT
+		 * f 		peaks of the IC and DV curves, there are no peaks if the curve has fewer than 3 valid points
+		 */
+
+		f = Features{};
+
+		// keep the points with a decreasing voltage and increasing charge
+		std::vector<double> q, v;
+		for (size_t i = 0; i < std::min(Q.size(), V.size()); i++)
+			if (v.empty() || (V[i] < v.back() && Q[i] > q.back()))
+			{
+				q.push_back(Q[i]);
+				v.push_back(V[i]);
+			}
+
+		if (q.size() < 3)
+			return;
+
+		f.Q = q.back() - q.front();
+
+		// IC curve: charge on a uniform voltage grid from the highest to the lowest voltage
+		const double dV = (v.front() - v.back()) / (ngrid - 1);
+		std::vector<double> vg(ngrid), qg(ngrid), ic;
+		size_t j = 0;
+		for (int i = 0; i < ngrid; i++)
+		{
+			vg[i] = v.front() - i * dV;
+			while (j < v.size() - 2 && v[j + 1] > vg[i])
+				j++;
+			qg[i] = q[j] + (q[j + 1] - q[j]) * (vg[i] - v[j]) / (v[j + 1] - v[j]);
+		}
+		derivative(qg, dV, ic); // -dQ/dV since the grid has decreasing voltages
+		smooth(ic);
+		findPeaks(vg, ic, 0, ngrid - 1, f.icV, f.icH);
+
+		// DV curve: voltage on a uniform charge grid, the charge is relative to the highest voltage
+		const double dQ = f.Q / (ngrid - 1);
+		std::vector<double> qg2(ngrid), vg2(ngrid), dv;
+		j = 0;
+		for (int i = 0; i < ngrid; i++)
+		{
+			qg2[i] = i * dQ;
+			while (j < q.size() - 2 && q[j + 1] - q.front() < qg2[i])
+				j++;
+			vg2[i] = v[j] + (v[j + 1] - v[j]) * (qg2[i] + q.front() - q[j]) / (q[j + 1] - q[j]);
+		}
+		derivative(vg2, dQ, dv);
+		for (auto &d : dv)
+			d = -d; // the voltage decreases during the discharge
+		smooth(dv);
+		const int iedge = static_cast<int>(dv_edge * ngrid);
+		findPeaks(qg2, dv, iedge, ngrid - 1 - iedge, f.dvQ, f.dvH);
+	}
+
+	void Tracker::track(const Features &f, std::vector<double> &icV, std::vector<double> &icH, std::vector<double> &dvQ, std::vector<double> &dvH)
+	{
+		/*
+		 * Follow the peaks found in the first analysis.
+		 * Each tracked peak is matched to the closest peak of the new analysis which has not been matched to another tracked peak yet,
+		 * if it lies within 0.05 V (IC) or 10% of the charge range (DV) from the position where it was last found.
+		 * Peaks which appear after the first analysis are not tracked.
+		 *
+		 * IN
+		 * f 		peaks of the new analysis
+		 *
+		 * OUT
+		 * icV, icH	voltage and height of the tracked IC peaks, NaN if a peak was not found
+		 * dvQ, dvH	charge and height of the tracked DV peaks, NaN if a peak was not found
+		 */
+
+		if (!init)
+		{
+			icRef = f.icV;
+			dvRef = f.dvQ;
+			init = true;
+		}
+
+		auto match = [](std::vector<double> &ref, const std::vector<double> &px, const std::vector<double> &ph, double tol,
+						std::vector<double> &x, std::vector<double> &h) {
+			constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+			std::vector<bool> used(px.size(), false);
+			x.assign(ref.size(), nan);
+			h.assign(ref.size(), nan);
+			for (size_t r = 0; r < ref.size(); r++)
+			{
+				int best = -1;
+				for (size_t i = 0; i < px.size(); i++)
+					if (!used[i] && std::abs(px[i] - ref[r]) <= tol && (best < 0 || std::abs(px[i] - ref[r]) < std::abs(px[best] - ref[r])))
+						best = static_cast<int>(i);
+
+				if (best >= 0)
+				{
+					used[best] = true;
+					ref[r] = px[best];
+					x[r] = px[best];
+					h[r] = ph[best];
+				}
+			}
+		};
+
+		match(icRef, f.icV, f.icH, 0.05, icV, icH);
+		match(dvRef, f.dvQ, f.dvH, 0.1 * f.Q, dvQ, dvH);
+	}
+} // namespace slide::ica
@@ -0,0 +1,50 @@
+/*
+ * ica.hpp
+ *
+ * Incremental capacity (dQ/dV) and differential voltage (dV/dQ) analysis of equilibrium voltage curves.
+ *
+ * The curves are resampled on a uniform grid, differentiated and smoothed with a Gaussian kernel.
+ * The peaks of the smoothed curves are features of the electrode phase transitions, and their shifts track the degradation modes:
+ * 		IC peaks are located by their voltage, DV peaks by the discharged charge at which they occur.
+ * A Tracker follows the peaks found at the first analysis over the later ones such that they can be written as a compact table.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace slide::ica
+{
+	constexpr int ngrid = 250;			// number of points on the uniform voltage and charge grids
+	constexpr double sigma = 3;			// standard deviation of the Gaussian smoothing kernel [grid points]
+	constexpr double prominence = 0.05; // minimum prominence of a peak as fraction of the highest value of the curve [-]
+	constexpr double dv_edge = 0.05;	// fraction of the charge range at either end where DV peaks are ignored, the DV curve diverges there [-]
+	constexpr int npeak = 6;			// maximum number of peaks which are tracked for each curve
+
+	// peaks of the smoothed IC and DV curves
+	struct Features
+	{
+		double Q{0};					// charge between the highest and lowest voltage [Ah]
+		std::vector<double> icV, icH;	// voltage [V] and height [Ah V-1] of the IC peaks, in decreasing order of height
+		std::vector<double> dvQ, dvH;	// discharged charge [Ah] and height [V Ah-1] of the DV peaks, in decreasing order of height
+	};
+
+	void analyse(const std::vector<double> &Q, const std::vector<double> &V, Features &f); // get the IC and DV peaks of a discharge curve
+
+	// follows the peaks of the first analysis over the later ones
+	class Tracker
+	{
+	public:
+		void track(const Features &f, std::vector<double> &icV, std::vector<double> &icH, std::vector<double> &dvQ, std::vector<double> &dvH);
+		int nIC() const { return static_cast<int>(icRef.size()); }
+		int nDV() const { return static_cast<int>(dvRef.size()); }
+
+	private:
+		bool init{false};
+		std::vector<double> icRef, dvRef; // position of the tracked peaks at the last analysis in which they were found
+	};
+} // namespace slide::ica
@@ -0,0 +1,971 @@
+/*
+ * inference.cpp
+ *
+ * Implements the adaptive Metropolis sampler, the likelihood of degradation parameters for calendar ageing data,
+ * and the propagation of parameter uncertainty through ageing protocols.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "inference.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include "cycler.hpp"
+#include "util.hpp"
+
+namespace slide::inference
+{
+	namespace
+	{
+		double quantile(const std::vector<double> &x, double q)
+		{
+			// quantile of sorted values, with linear interpolation between them
+			const double pos = q * (x.size() - 1);
+			const size_t k = std::min(static_cast<size_t>(pos), x.size() - 1);
+			const size_t k1 = std::min(k + 1, x.size() - 1);
+			return x[k] + (pos - k) * (x[k1] - x[k]);
+		}
+	} // namespace
+
+	double gaussian(const Noise &nz, double sse, double n)
+	{
+		/*
+		 * Log-likelihood of n independent normally distributed errors with a sum of squares sse, without the constant terms.
+		 * If the standard deviation of the noise is unknown (sigma = 0), it is integrated out with the prior p(sigma) ~ 1/sigma,
+		 * which gives -n/2 * log(sse). This weighs the data in the same way as the RMSE of the hierarchical fits.
+		 */
+
+		if (nz.sigma > 0)
+			return -0.5 * sse / (nz.sigma * nz.sigma) - n * std::log(nz.sigma);
+		return -0.5 * n * std::log(std::max(sse, 1e-300));
+	}
+
+	Sampler::Sampler(const std::vector<Parameter> &pari, const LogLikelihood &fi, const Settings &s, const std::string &namei)
+		: par(pari), f(fi), st(s), name(namei)
+	{
+		/*
+		 * THROWS
+		 * 1023 	illegal parameters or settings
+		 */
+
+		// #NOTHOTFUNCTION
+		bool legal = !par.empty() && f && st.nChains > 0 && st.nSamples > 0 && st.burnIn >= 0 && st.burnIn < st.nSamples
+					 && st.adaptStart > 0 && st.thin > 0 && st.checkpoint > 0 && st.scatter >= 0 && st.level > 0 && st.level < 1;
+		for (auto &p : par)
+		{
+			legal = legal && p.lower < p.upper && (!p.log || p.lower > 0) && p.x0 >= p.lower && p.x0 <= p.upper && p.step >= 0;
+			if (p.step == 0 && p.lower < p.upper && (!p.log || p.lower > 0))
+				p.step = p.log ? 0.05 * std::log10(p.upper / p.lower) : 0.05 * (p.upper - p.lower);
+		}
+		if (!legal)
+		{
+			std::cerr << "ERROR in inference::Sampler, illegal settings: there must be at least one parameter and a likelihood, "
+					  << "every parameter must have lower < x0 < upper (lower > 0 for a logarithmic one), "
+					  << "and the burn-in must be shorter than the chains. Throwing an error.\n";
+			throw 1023;
+		}
+	}
+
+	Par Sampler::physical(const Par &u) const
+	{
+		Par x(u);
+		for (size_t j = 0; j < par.size(); j++)
+			if (par[j].log)
+				x[j] = std::pow(10.0, u[j]);
+		return x;
+	}
+
+	bool Sampler::likelihood(const Par &u, double *logL) const
+	{
+		/*
+		 * The prior is uniform in the coordinates of the chains, so the posterior is the likelihood inside the bounds.
+		 * Errors thrown by the simulations (e.g. when the parameters make a cell violate its limits) reject the point.
+		 */
+
+		for (size_t j = 0; j < par.size(); j++)
+		{
+			const double lb = par[j].log ? std::log10(par[j].lower) : par[j].lower;
+			const double ub = par[j].log ? std::log10(par[j].upper) : par[j].upper;
+			if (u[j] < lb || u[j] > ub)
+				return false;
+		}
+		try
+		{
+			return f(physical(u), logL);
+		}
+		catch (int)
+		{
+			return false;
+		}
+	}
+
+	std::string Sampler::file(int i, const std::string &suffix) const
+	{
+		return name + "_chain" + std::to_string(i) + suffix;
+	}
+
+	void Sampler::start(int i)
+	{
+		/*
+		 * Start chain i at a random point around x0, which is drawn again if the likelihood can't be evaluated there.
+		 * The samples of an earlier run with the same name are overwritten.
+		 *
+		 * THROWS
+		 * 1023 	the likelihood can't be evaluated around x0
+		 */
+
+		const size_t d = par.size();
+		Chain &c = ch[i];
+		c = Chain{};
+		c.gen.seed(st.seed + i);
+
+		Par u0(d);
+		for (size_t j = 0; j < d; j++)
+			u0[j] = par[j].log ? std::log10(par[j].x0) : par[j].x0;
+
+		std::normal_distribution<double> N(0, 1);
+		bool found = false;
+		for (int k = 0; k < 100 && !found; k++)
+		{
+			c.u = u0;
+			for (size_t j = 0; j < d; j++)
+				c.u[j] += st.scatter * par[j].step * N(c.gen);
+			found = likelihood(c.u, &c.lu);
+		}
+		if (!found)
+		{
+			c.u = u0;
+			found = likelihood(c.u, &c.lu);
+		}
+		if (!found)
+		{
+			std::cerr << "ERROR in inference::Sampler::start, the likelihood can't be evaluated at the starting point of chain " << i
+					  << " nor at 100 random points around it. Throwing an error.\n";
+			throw 1023;
+		}
+
+		c.mean = c.u;
+		c.cov.assign(d, Par(d, 0));
+
+		std::ofstream out(PathVar::results + file(i, ".csv"), std::ios_base::out);
+		out << "iteration,logL";
+		for (const auto &p : par)
+			out << ',' << p.name;
+		out << '\n';
+	}
+
+	void Sampler::iterate(int i)
+	{
+		/*
+		 * One iteration of the adaptive Metropolis algorithm for chain i.
+		 * From adaptStart on, the proposal has the covariance 2.38^2/d times the covariance of the chain during the burn-in,
+		 * with a small diagonal term to keep it positive definite. If the Cholesky factorisation fails, the initial steps are used.
+		 */
+
+		const size_t d = par.size();
+		Chain &c = ch[i];
+		std::normal_distribution<double> N(0, 1);
+		std::uniform_real_distribution<double> U(0, 1);
+
+		Par z(d), v(c.u);
+		for (auto &zj : z)
+			zj = N(c.gen);
+
+		bool adapted = c.n >= st.adaptStart;
+		if (adapted)
+		{
+			// Cholesky factorisation of the proposal covariance, L L' = sd * (cov + eps)
+			const double sd = 2.38 * 2.38 / d;
+			std::vector<Par> L(d, Par(d, 0));
+			for (size_t j = 0; j < d && adapted; j++)
+				for (size_t k = 0; k <= j && adapted; k++)
+				{
+					double sum = sd * (c.cov[j][k] + (j == k ? 1e-6 * par[j].step * par[j].step : 0));
+					for (size_t l = 0; l < k; l++)
+						sum -= L[j][l] * L[k][l];
+					if (j == k)
+					{
+						adapted = sum > 0;
+						L[j][j] = adapted ? std::sqrt(sum) : 0;
+					}
+					else
+						L[j][k] = sum / L[k][k];
+				}
+			for (size_t j = 0; j < d && adapted; j++)
+				for (size_t k = 0; k <= j; k++)
+					v[j] += L[j][k] * z[k];
+		}
+		if (!adapted)
+		{
+			v = c.u;
+			for (size_t j = 0; j < d; j++)
+				v[j] += par[j].step * z[j];
+		}
+
+		// Metropolis acceptance, the proposal is symmetric
+		double lv;
+		if (likelihood(v, &lv) && std::log(1 - U(c.gen)) < lv - c.lu)
+		{
+			c.u = v;
+			c.lu = lv;
+			c.accepted++;
+		}
+		c.n++;
+
+		// update the mean and covariance of the points during the burn-in, these are the points 0 to n of the chain
+		if (c.n <= st.burnIn)
+		{
+			const double k = c.n + 1;
+			Par du(d);
+			for (size_t j = 0; j < d; j++)
+				du[j] = c.u[j] - c.mean[j];
+			for (size_t j = 0; j < d; j++)
+			{
+				c.mean[j] += du[j] / k;
+				for (size_t l = 0; l < d; l++)
+					c.cov[j][l] = (k - 2) / (k - 1) * c.cov[j][l] + du[j] * du[l] / k;
+			}
+		}
+
+		if (c.n % st.thin == 0)
+		{
+			c.it.push_back(c.n);
+			c.logL.push_back(c.lu);
+			c.samples.push_back(physical(c.u));
+		}
+	}
+
+	void Sampler::save(int i, size_t from)
+	{
+		/*
+		 * Append the samples of chain i from index from to its csv file, and write its checkpoint.
+		 * The checkpoint is written to a temporary file which then replaces the old one,
+		 * so an interruption while writing leaves the previous checkpoint intact.
+		 * It stores the number of samples in the csv file, so samples written after the last checkpoint are dropped when resuming.
+		 */
+
+		const Chain &c = ch[i];
+		std::ofstream out(PathVar::results + file(i, ".csv"), std::ios_base::app);
+		out << std::setprecision(12);
+		for (size_t k = from; k < c.samples.size(); k++)
+		{
+			out << c.it[k] << ',' << c.logL[k];
+			for (auto x : c.samples[k])
+				out << ',' << x;
+			out << '\n';
+		}
+		out.close();
+
+		const auto na = PathVar::results + file(i, "_checkpoint.csv");
+		const auto tmp = PathVar::results + file(i, "_checkpoint.tmp");
+		std::ofstream cp(tmp, std::ios_base::out);
+		cp << std::setprecision(17);
+		cp << "parameters," << par.size() << '\n'
+		   << "iterations," << c.n << ',' << c.accepted << ',' << c.samples.size() << '\n'
+		   << "point," << c.lu;
+		for (auto x : c.u)
+			cp << ',' << x;
+		cp << "\nmean";
+		for (auto x : c.mean)
+			cp << ',' << x;
+		for (const auto &row : c.cov)
+		{
+			cp << "\ncovariance";
+			for (auto x : row)
+				cp << ',' << x;
+		}
+		cp << "\ngenerator," << c.gen << '\n';
+		cp.close();
+		std::filesystem::rename(tmp, na);
+	}
+
+	bool Sampler::load(int i)
+	{
+		/*
+		 * Resume chain i from its checkpoint and read its samples up to the checkpoint.
+		 *
+		 * THROWS
+		 * 1023 	the checkpoint is for a different number of parameters or its samples are missing
+		 */
+
+		std::ifstream in(PathVar::results + file(i, "_checkpoint.csv"), std::ios_base::in);
+		if (!in.good())
+			return false;
+
+		// every line has a key and comma-separated values
+		std::vector<std::pair<std::string, std::string>> rows;
+		for (std::string line; std::getline(in, line);)
+		{
+			const auto k = line.find(',');
+			rows.emplace_back(line.substr(0, k), k == std::string::npos ? "" : line.substr(k + 1));
+		}
+		auto values = [&](size_t r)
+		{
+			std::vector<double> v;
+			std::stringstream ss(rows[r].second);
+			for (std::string x; std::getline(ss, x, ',');)
+				v.push_back(std::stod(x));
+			return v;
+		};
+
+		const size_t d = par.size();
+		Chain &c = ch[i];
+		c = Chain{};
+		size_t stored = 0;
+		bool ok = rows.size() == d + 5 && rows[0].first == "parameters" && values(0).size() == 1 && values(0)[0] == d;
+		if (ok)
+		{
+			const auto it = values(1), pt = values(2);
+			c.mean = values(3);
+			ok = it.size() == 3 && pt.size() == d + 1 && c.mean.size() == d;
+			for (size_t j = 0; j < d && ok; j++)
+			{
+				c.cov.push_back(values(4 + j));
+				ok = c.cov.back().size() == d;
+			}
+			if (ok)
+			{
+				c.n = static_cast<int>(it[0]), c.accepted = static_cast<int>(it[1]), stored = static_cast<size_t>(it[2]);
+				c.lu = pt[0], c.u.assign(pt.begin() + 1, pt.end());
+				std::stringstream ss(rows[d + 4].second);
+				ss >> c.gen;
+				ok = rows[d + 4].first == "generator" && !ss.fail();
+			}
+		}
+
+		// read the samples up to the checkpoint
+		std::ifstream ins(PathVar::results + file(i, ".csv"), std::ios_base::in);
+		std::string line, header;
+		std::getline(ins, header);
+		while (ok && c.samples.size() < stored && std::getline(ins, line))
+		{
+			std::stringstream ss(line);
+			std::vector<double> x;
+			for (std::string s; std::getline(ss, s, ',');)
+				x.push_back(std::stod(s));
+			ok = x.size() == d + 2;
+			if (ok)
+			{
+				c.it.push_back(static_cast<int>(x[0]));
+				c.logL.push_back(x[1]);
+				c.samples.emplace_back(x.begin() + 2, x.end());
+			}
+		}
+		ins.close();
+		if (!ok || c.samples.size() < stored)
+		{
+			std::cerr << "ERROR in inference::Sampler::load, the checkpoint of chain " << i << " of " << name
+					  << " does not match the parameters or its samples are missing. Throwing an error.\n";
+			throw 1023;
+		}
+
+		// rewrite the samples without the ones after the checkpoint
+		std::ofstream out(PathVar::results + file(i, ".csv"), std::ios_base::out);
+		out << header << '\n';
+		out.close();
+		save(i, 0);
+		return true;
+	}
+
+	void Sampler::run()
+	{
+		/*
+		 * Run all chains in parallel until they have nSamples iterations, starting from their checkpoints if resume is true.
+		 *
+		 * THROWS
+		 * 1023 	a chain could not be started or resumed
+		 */
+
+		ch.assign(st.nChains, Chain{});
+		std::vector<int> err(st.nChains, 0);
+
+		auto task_indv = [&](int i)
+		{
+			try
+			{
+				if (!(st.resume && load(i)))
+					start(i);
+				size_t saved = ch[i].samples.size(); // samples which are already in the csv file
+				while (ch[i].n < st.nSamples)
+				{
+					iterate(i);
+					if (ch[i].n % st.checkpoint == 0 || ch[i].n == st.nSamples)
+					{
+						save(i, saved);
+						saved = ch[i].samples.size();
+					}
+				}
+			}
+			catch (int e)
+			{
+				err[i] = e;
+			}
+		};
+
+		slide::run(task_indv, st.nChains, st.nChains);
+
+		for (auto e : err)
+			if (e != 0)
+				throw e;
+	}
+
+	std::vector<Interval> Sampler::summary() const
+	{
+		/*
+		 * Posterior mean, standard deviation and equal-tailed credible interval of every parameter, from the samples after the burn-in of all chains.
+		 * Rhat compares the variance within and between the chains (Gelman and Rubin, 1992), in the coordinates of the chains.
+		 * It is only computed with at least 2 chains, and is 0 otherwise.
+		 *
+		 * THROWS
+		 * 1023 	there are no samples after the burn-in
+		 */
+
+		const size_t d = par.size();
+		std::vector<std::vector<Par>> post(ch.size()); // samples after the burn-in of every chain
+		size_t nmin = 0, ntot = 0;
+		for (size_t i = 0; i < ch.size(); i++)
+		{
+			for (size_t k = 0; k < ch[i].samples.size(); k++)
+				if (ch[i].it[k] > st.burnIn)
+					post[i].push_back(ch[i].samples[k]);
+			nmin = (i == 0) ? post[i].size() : std::min(nmin, post[i].size());
+			ntot += post[i].size();
+		}
+		if (ntot == 0)
+		{
+			std::cerr << "ERROR in inference::Sampler::summary, there are no samples after the burn-in, run the sampler first. Throwing an error.\n";
+			throw 1023;
+		}
+
+		std::vector<Interval> out;
+		std::vector<double> x;
+		for (size_t j = 0; j < d; j++)
+		{
+			Interval iv;
+			iv.name = par[j].name;
+
+			x.clear();
+			for (const auto &pc : post)
+				for (const auto &p : pc)
+					x.push_back(p[j]);
+			std::sort(x.begin(), x.end());
+
+			double m = 0, s = 0;
+			for (auto xi : x)
+				m += xi;
+			m /= x.size();
+			for (auto xi : x)
+				s += (xi - m) * (xi - m);
+			iv.mean = m;
+			iv.sd = x.size() > 1 ? std::sqrt(s / (x.size() - 1)) : 0;
+
+			iv.lower = quantile(x, (1 - st.level) / 2);
+			iv.median = quantile(x, 0.5);
+			iv.upper = quantile(x, (1 + st.level) / 2);
+
+			// Gelman-Rubin statistic on the last nmin samples of every chain
+			iv.Rhat = 0;
+			const double nc = ch.size(), n = nmin;
+			if (nc > 1 && n > 1)
+			{
+				double W = 0, mall = 0;
+				std::vector<double> mc(ch.size(), 0);
+				for (size_t i = 0; i < ch.size(); i++)
+				{
+					for (size_t k = post[i].size() - nmin; k < post[i].size(); k++)
+						mc[i] += par[j].log ? std::log10(post[i][k][j]) : post[i][k][j];
+					mc[i] /= n;
+					mall += mc[i] / nc;
+					for (size_t k = post[i].size() - nmin; k < post[i].size(); k++)
+					{
+						const double dx = (par[j].log ? std::log10(post[i][k][j]) : post[i][k][j]) - mc[i];
+						W += dx * dx / (n - 1) / nc;
+					}
+				}
+				double B = 0;
+				for (auto mi : mc)
+					B += (mi - mall) * (mi - mall) * n / (nc - 1);
+				if (W > 0)
+					iv.Rhat = std::sqrt(((n - 1) / n * W + B / n) / W);
+			}
+			out.push_back(iv);
+		}
+		return out;
+	}
+
+	void Sampler::write() const
+	{
+		/*
+		 * Write the summary of the posterior to a csv file in the results folder, with one row per parameter:
+		 * 		name, mean, standard deviation, lower bound, median and upper bound of the credible interval, Rhat
+		 * followed by the acceptance rate of every chain.
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 */
+
+		const auto s = summary();
+		std::ofstream out(PathVar::results + (name + "_summary.csv"), std::ios_base::out);
+		if (!out.is_open())
+		{
+			std::cerr << "ERROR in inference::Sampler::write. File " << name << "_summary.csv could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+		out << "parameter,mean,sd,lower " << st.level << ",median,upper " << st.level << ",Rhat\n";
+		for (const auto &iv : s)
+			out << iv.name << ',' << iv.mean << ',' << iv.sd << ',' << iv.lower << ',' << iv.median << ',' << iv.upper << ',' << iv.Rhat << '\n';
+		out << "\nchain,iterations,acceptance rate\n";
+		for (size_t i = 0; i < ch.size(); i++)
+			out << i << ',' << ch[i].n << ',' << (ch[i].n > 0 ? static_cast<double>(ch[i].accepted) / ch[i].n : 0) << '\n';
+	}
+
+	std::vector<Par> Sampler::posterior() const
+	{
+		/*
+		 * Samples after the burn-in of all chains, e.g. to propagate the uncertainty of the parameters (see resample).
+		 */
+
+		std::vector<Par> post;
+		for (const auto &c : ch)
+			for (size_t k = 0; k < c.samples.size(); k++)
+				if (c.it[k] > st.burnIn)
+					post.push_back(c.samples[k]);
+		return post;
+	}
+
+	double *degradationParam(const std::string &name, SEIparam &sei, CSparam &cs, LAMparam &lam, PLparam &pl)
+	{
+		/*
+		 * Field of the degradation parameter with the given name, e.g. "sei2k" for SEIparam::sei2k.
+		 */
+
+		static const std::pair<const char *, double SEIparam::*> seip[] = {
+			{"sei1k", &SEIparam::sei1k}, {"sei1k_T", &SEIparam::sei1k_T}, {"sei2k", &SEIparam::sei2k}, {"sei2k_T", &SEIparam::sei2k_T},
+			{"sei2D", &SEIparam::sei2D}, {"sei2D_T", &SEIparam::sei2D_T}, {"sei3k", &SEIparam::sei3k}, {"sei3k_T", &SEIparam::sei3k_T},
+			{"sei3D", &SEIparam::sei3D}, {"sei3D_T", &SEIparam::sei3D_T}, {"sei_porosity", &SEIparam::sei_porosity}};
+		static const std::pair<const char *, double CSparam::*> csp[] = {
+			{"CS1alpha", &CSparam::CS1alpha}, {"CS2alpha", &CSparam::CS2alpha}, {"CS3alpha", &CSparam::CS3alpha}, {"CS4Amax", &CSparam::CS4Amax},
+			{"CS4alpha", &CSparam::CS4alpha}, {"CS5k", &CSparam::CS5k}, {"CS5k_T", &CSparam::CS5k_T}, {"CS_diffusion", &CSparam::CS_diffusion}};
+		static const std::pair<const char *, double LAMparam::*> lamp[] = {
+			{"lam1p", &LAMparam::lam1p}, {"lam1n", &LAMparam::lam1n}, {"lam2ap", &LAMparam::lam2ap}, {"lam2bp", &LAMparam::lam2bp},
+			{"lam2an", &LAMparam::lam2an}, {"lam2bn", &LAMparam::lam2bn}, {"lam2t", &LAMparam::lam2t}, {"lam3k", &LAMparam::lam3k},
+			{"lam3k_T", &LAMparam::lam3k_T}, {"lam4p", &LAMparam::lam4p}, {"lam4n", &LAMparam::lam4n}};
+		static const std::pair<const char *, double PLparam::*> plp[] = {
+			{"pl1k", &PLparam::pl1k}, {"pl1k_T", &PLparam::pl1k_T}, {"pl2k", &PLparam::pl2k}, {"pl2k_T", &PLparam::pl2k_T},
+			{"pl2ks", &PLparam::pl2ks}, {"pl2alpha", &PLparam::pl2alpha}, {"pl2gamma", &PLparam::pl2gamma}, {"pl2delta0", &PLparam::pl2delta0}};
+
+		for (const auto &[na, m] : seip)
+			if (name == na)
+				return &(sei.*m);
+		for (const auto &[na, m] : csp)
+			if (name == na)
+				return &(cs.*m);
+		for (const auto &[na, m] : lamp)
+			if (name == na)
+				return &(lam.*m);
+		for (const auto &[na, m] : plp)
+			if (name == na)
+				return &(pl.*m);
+		return nullptr;
+	}
+
+	void checkDegradationParam(const Cell &c, const std::vector<std::string> &names)
+	{
+		/*
+		 * THROWS
+		 * 1023 	one of the names is not a degradation parameter
+		 */
+
+		SEIparam sei;
+		CSparam cs;
+		LAMparam lam;
+		PLparam pl;
+		c.getDegradationParam(&sei, &cs, &lam, &pl);
+		for (const auto &na : names)
+			if (degradationParam(na, sei, cs, lam, pl) == nullptr)
+			{
+				std::cerr << "ERROR in inference, " << na << " is not a degradation parameter. Throwing an error.\n";
+				throw 1023;
+			}
+	}
+
+	void setDegradationParam(Cell &c, const std::vector<std::string> &names, const Par &p)
+	{
+		/*
+		 * Set the degradation parameters with the given names (see degradationParam) to the values in p, in the same order.
+		 * The names must have been checked with checkDegradationParam.
+		 */
+
+		SEIparam sei;
+		CSparam cs;
+		LAMparam lam;
+		PLparam pl;
+		c.getDegradationParam(&sei, &cs, &lam, &pl);
+		for (size_t j = 0; j < names.size(); j++)
+			*degradationParam(names[j], sei, cs, lam, pl) = p[j];
+		c.setDegradationParam(sei, cs, lam, pl);
+	}
+
+	bool calendarFade(Cell &c, const Calendar &d, std::vector<double> &Q)
+	{
+		/*
+		 * Simulate a calendar ageing test: bring the cell to the storage voltage at the storage temperature with a CC CV (dis)charge at 1C,
+		 * and let it rest with a time step which grows by 20% up to an hour (see Cell::ETI_rest).
+		 * The capacity at every check-up follows from the electrode balance (see Cell::getIndicators), so the check-ups don't age the cell.
+		 *
+		 * IN
+		 * c 	cell with the parameters to be used
+		 * d 	storage conditions and times of the check-ups
+		 *
+		 * OUT
+		 * Q 	capacity at the check-ups relative to the capacity at the start [-]
+		 * 		returns false if the simulation fails
+		 */
+
+		Q.clear();
+		try
+		{
+			c.setT(d.T);
+			c.setTenv(d.T);
+			Cycler cyc(c, "CalendarFit", 0, -1);
+			double ahi, whi, timei;
+			cyc.CC_V_CV_I(1, d.V, 0.05, 2, true, &ahi, &whi, &timei);
+			c = cyc.getCell(); // the cycler works on a copy of the cell
+			c.setI(false, false, 0);
+
+			double SOC, cap0, cap, SOH, Eav;
+			c.getIndicators(&SOC, &cap0, &SOH, &Eav);
+
+			constexpr double dtmax = 3600;
+			double t = 0, dt = 60;
+			for (auto tk : d.t)
+			{
+				tk *= 24 * 3600;
+				while (t < tk)
+				{
+					const double dti = std::min(dt, tk - t);
+					c.ETI_rest(false, dti, false);
+					t += dti;
+					dt = std::min(1.2 * dt, dtmax);
+				}
+				c.getIndicators(&SOC, &cap, &SOH, &Eav);
+				Q.push_back(cap / cap0);
+			}
+		}
+		catch (int)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	Draw resample(const std::vector<Par> &samples)
+	{
+		/*
+		 * Draw parameter sets uniformly from samples, e.g. of the posterior.
+		 * Correlations between the parameters are kept since every draw is a complete sample.
+		 *
+		 * THROWS
+		 * 1023 	there are no samples, or they don't all have the same number of parameters
+		 */
+
+		if (samples.empty())
+		{
+			std::cerr << "ERROR in inference::resample, there are no samples. Throwing an error.\n";
+			throw 1023;
+		}
+		for (const auto &x : samples)
+			if (x.empty() || x.size() != samples[0].size())
+			{
+				std::cerr << "ERROR in inference::resample, a sample has " << x.size() << " parameters and the first one has " << samples[0].size()
+						  << ", they must all have the same number of parameters. Throwing an error.\n";
+				throw 1023;
+			}
+		return [samples](std::mt19937_64 &gen) {
+			std::uniform_int_distribution<size_t> k(0, samples.size() - 1);
+			return samples[k(gen)];
+		};
+	}
+
+	Draw prior(const std::vector<Parameter> &par)
+	{
+		/*
+		 * Draw independent parameters from the uniform distribution between their bounds,
+		 * or the log-uniform one for logarithmic parameters (the prior of the Sampler).
+		 *
+		 * THROWS
+		 * 1023 	illegal bounds
+		 */
+
+		for (const auto &p : par)
+			if (!(p.lower < p.upper) || (p.log && p.lower <= 0))
+			{
+				std::cerr << "ERROR in inference::prior, parameter " << p.name << " has illegal bounds " << p.lower << " and " << p.upper << ". Throwing an error.\n";
+				throw 1023;
+			}
+		return [par](std::mt19937_64 &gen) {
+			std::uniform_real_distribution<double> U(0, 1);
+			Par x(par.size());
+			for (size_t j = 0; j < par.size(); j++)
+			{
+				const double u = U(gen);
+				x[j] = par[j].log ? par[j].lower * std::pow(par[j].upper / par[j].lower, u) : par[j].lower + u * (par[j].upper - par[j].lower);
+			}
+			return x;
+		};
+	}
+
+	std::vector<Par> loadSamples(const std::string &name, int burnIn)
+	{
+		/*
+		 * Read the samples of all chains of a Sampler with the given name (name_chain0.csv, name_chain1.csv, ...) from the results folder,
+		 * and keep the ones after the burn-in. This gives the posterior of an earlier run without running the sampler again.
+		 *
+		 * THROWS
+		 * 1001 	there is no file of the first chain
+		 */
+
+		// #NOTHOTFUNCTION
+		std::vector<Par> post;
+		for (int i = 0;; i++)
+		{
+			std::ifstream in(PathVar::results + (name + "_chain" + std::to_string(i) + ".csv"));
+			if (!in.is_open())
+			{
+				if (i > 0)
+					break;
+				std::cerr << "ERROR in inference::loadSamples. File " << name << "_chain0.csv could not be opened. Throwing an error.\n";
+				throw 1001;
+			}
+
+			std::string line, cell;
+			std::getline(in, line); // header
+			while (std::getline(in, line))
+			{
+				std::stringstream ss(line);
+				std::getline(ss, cell, ',');
+				if (cell.empty() || std::stoi(cell) <= burnIn)
+					continue;
+				std::getline(ss, cell, ','); // log-likelihood
+				Par p;
+				while (std::getline(ss, cell, ','))
+					p.push_back(std::stod(cell));
+				post.push_back(std::move(p));
+			}
+		}
+		return post;
+	}
+
+	void write(const Bands &b, const std::string &name)
+	{
+		/*
+		 * Write the bands to a csv file in the results folder, with one row per check-up:
+		 * 		cycle number, the quantiles of the capacity, the quantiles of the resistance
+		 * followed by the number of successful and failed runs.
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 */
+
+		std::ofstream out(PathVar::results + (name + "_bands.csv"), std::ios_base::out);
+		if (!out.is_open())
+		{
+			std::cerr << "ERROR in inference::write. File " << name << "_bands.csv could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+		out << "cycle";
+		for (auto q : b.q)
+			out << ",capacity " << q;
+		for (auto q : b.q)
+			out << ",resistance " << q;
+		out << '\n';
+		for (size_t k = 0; k < b.cycle.size(); k++)
+		{
+			out << b.cycle[k];
+			for (auto x : b.cap[k])
+				out << ',' << x;
+			for (auto x : b.R[k])
+				out << ',' << x;
+			out << '\n';
+		}
+		out << "\nruns," << b.par.size() << "\nfailed," << b.failed << "\nconverged," << b.converged << '\n';
+	}
+
+	bool age(Cell &c, protocol::Protocol p, std::vector<int> &cycle, std::vector<double> &cap, std::vector<double> &R)
+	{
+		/*
+		 * Follow an ageing protocol without writing any cycling data,
+		 * and record the capacity (from the electrode balance, see Cell::getIndicators) and the resistance at the start and at every check-up.
+		 *
+		 * IN
+		 * c 	cell with the parameters to be used
+		 * p 	ageing protocol with check-up instructions (see protocol::Protocol::checkUp)
+		 *
+		 * OUT
+		 * c 		the cell at the end of the protocol
+		 * cycle 	cycle number of every check-up, 0 at the start
+		 * cap 		capacity at every check-up [Ah]
+		 * R 		resistance at every check-up [Ohm]
+		 * 			returns false if the simulation fails or the cell goes outside its voltage range
+		 */
+
+		cycle.clear();
+		cap.clear();
+		R.clear();
+		double SOC, capi, SOH, Eav;
+		auto record = [&](Cell &ci, int n) {
+			ci.getIndicators(&SOC, &capi, &SOH, &Eav);
+			cycle.push_back(n);
+			cap.push_back(capi);
+			R.push_back(ci.getR());
+			return true;
+		};
+
+		try
+		{
+			record(c, 0);
+			Cycler cyc(c, "Propagation", 0, -1);
+			auto &ci = cyc.getCell(); // the cycler works on a copy of the cell
+			protocol::Run r;
+			cyc.runProtocol(p, false, ci.getVmax(), ci.getVmin(), r, [&](int n) { return record(ci, n); });
+			c = ci;
+			return r.end > 0;
+		}
+		catch (int)
+		{
+			return false;
+		}
+	}
+
+	Bands propagate(const Ageing &f, const Draw &draw, const Propagation &s)
+	{
+		/*
+		 * Propagate the uncertainty of parameters through ageing simulations.
+		 * Run k uses a parameter set drawn with a generator seeded with seed + k, so the result does not depend on the number of threads.
+		 * The runs are done in parallel batches, after every batch the quantiles of the capacity and resistance at every check-up are updated.
+		 * The propagation stops once there are at least minRuns successful runs and no quantile changed by more than tol relative to its change since the start,
+		 * or after maxRuns runs. Runs which fail or end early (e.g. the cell reaches its voltage limit) are not used for the quantiles.
+		 *
+		 * THROWS
+		 * 1023 	illegal settings, or none of the runs succeeded
+		 */
+
+		// #NOTHOTFUNCTION
+		bool legal = f && draw && !s.q.empty() && s.batch > 0 && s.minRuns > 0 && s.maxRuns >= s.minRuns && s.tol > 0;
+		for (auto q : s.q)
+			legal = legal && q >= 0 && q <= 1;
+		if (!legal)
+		{
+			std::cerr << "ERROR in inference::propagate, illegal settings: there must be a draw, an ageing function and quantiles in [0, 1], "
+					  << "and the batches and runs must be positive with maxRuns >= minRuns. Throwing an error.\n";
+			throw 1023;
+		}
+
+		Bands b;
+		b.q = s.q;
+		std::vector<Par> par;
+		std::vector<std::vector<int>> cycle;
+		std::vector<std::vector<double>> cap, R;
+		std::vector<char> ok;
+		std::vector<double> x;
+		int k = 0; // number of runs done
+		while (k < s.maxRuns)
+		{
+			const int n = std::min(s.batch, s.maxRuns - k);
+			par.resize(n);
+			cycle.assign(n, {});
+			cap.assign(n, {});
+			R.assign(n, {});
+			ok.assign(n, 0);
+			for (int i = 0; i < n; i++)
+			{
+				std::mt19937_64 gen(s.seed + k + i);
+				par[i] = draw(gen);
+			}
+
+			auto task_indv = [&](int i) {
+				try
+				{
+					ok[i] = f(par[i], cycle[i], cap[i], R[i]);
+				}
+				catch (int)
+				{
+					ok[i] = 0;
+				}
+			};
+			slide::run(task_indv, n);
+			k += n;
+
+			for (int i = 0; i < n; i++)
+			{
+				if (ok[i] && b.cycle.empty())
+					b.cycle = cycle[i];
+				if (!ok[i] || cycle[i] != b.cycle) // all runs must have the same check-ups
+				{
+					b.failed++;
+					continue;
+				}
+				b.par.push_back(par[i]);
+				b.capRun.push_back(cap[i]);
+				b.RRun.push_back(R[i]);
+			}
+			if (b.par.empty())
+				continue;
+
+			// quantiles at every check-up
+			const auto cap0 = b.cap, R0 = b.R;
+			const size_t nc = b.cycle.size();
+			b.cap.assign(nc, std::vector<double>(s.q.size()));
+			b.R.assign(nc, std::vector<double>(s.q.size()));
+			for (size_t j = 0; j < nc; j++)
+			{
+				x.clear();
+				for (const auto &ci : b.capRun)
+					x.push_back(ci[j]);
+				std::sort(x.begin(), x.end());
+				for (size_t l = 0; l < s.q.size(); l++)
+					b.cap[j][l] = quantile(x, s.q[l]);
+
+				x.clear();
+				for (const auto &ri : b.RRun)
+					x.push_back(ri[j]);
+				std::sort(x.begin(), x.end());
+				for (size_t l = 0; l < s.q.size(); l++)
+					b.R[j][l] = quantile(x, s.q[l]);
+			}
+
+			if (static_cast<int>(b.par.size()) < s.minRuns || cap0.size() != nc)
+				continue;
+			// the changes are compared to the fade of the capacity and the growth of the resistance, which are small relative to their values
+			auto same = [&](const std::vector<std::vector<double>> &y, const std::vector<std::vector<double>> &y0, size_t j, size_t l) {
+				const double scale = std::max(std::abs(y[j][l] - y[0][l]), 1e-9 * std::abs(y[j][l]));
+				return std::abs(y[j][l] - y0[j][l]) <= s.tol * scale;
+			};
+			bool conv = true;
+			for (size_t j = 0; j < nc && conv; j++)
+				for (size_t l = 0; l < s.q.size(); l++)
+					conv = conv && same(b.cap, cap0, j, l) && same(b.R, R0, j, l);
+			if (conv)
+			{
+				b.converged = true;
+				break;
+			}
+		}
+
+		if (b.par.empty())
+		{
+			std::cerr << "ERROR in inference::propagate, all " << k << " runs failed. Throwing an error.\n";
+			throw 1023;
+		}
+		return b;
+	}
+} // namespace slide::inference
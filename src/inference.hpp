@@ -0,0 +1,259 @@
+/*
+ * inference.hpp
+ *
+ * Bayesian inference of model parameters with Markov chain Monte Carlo, to get the uncertainty of the parameters
+ * on top of the point estimate of the hierarchical fits in determine_OCV.cpp and determine_characterisation.cpp.
+ *
+ * The posterior is sampled with the adaptive Metropolis algorithm (Haario et al., 2001):
+ * 		every chain proposes a step from a normal distribution around its present point
+ * 		the covariance of the proposal is diagonal during the first iterations, and then follows the covariance of the chain itself
+ * 		the proposal is frozen at the end of the burn-in, so the samples after it come from a Markov chain with a fixed proposal
+ * The parameters have a uniform prior between their bounds, or a log-uniform one for parameters which span many decades (e.g. diffusion constants).
+ * The likelihood is given as a function of the parameters, e.g. the existing cost functions with a Gaussian noise model (see gaussian).
+ *
+ * The chains run in parallel (see slide::run), so the likelihood must be safe to call from several threads at the same time.
+ * Every chain writes its samples and a checkpoint with its full state to the results folder at regular intervals,
+ * and an interrupted run continues from the checkpoints when it is started again with the same name.
+ *
+ * The uncertainty of the parameters is propagated to ageing predictions by propagate:
+ * 		parameter sets are drawn from posterior samples (see resample) or from a distribution (see prior)
+ * 		a copy of the cell follows an ageing protocol for every set, the capacity and resistance are recorded at its check-up instructions
+ * 		the runs are done in parallel batches until the quantiles of the capacity and resistance at every check-up converge
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cell.hpp"
+#include "protocol.hpp"
+
+namespace slide::inference
+{
+	using Par = std::vector<double>;
+
+	// log-likelihood of the parameters (in the order of the Parameters of the Sampler)
+	// returns false if the parameters are infeasible (e.g. the simulation fails), then they are rejected
+	using LogLikelihood = std::function<bool(const Par &p, double *logL)>;
+
+	// a parameter to be inferred with its prior
+	struct Parameter
+	{
+		std::string name;
+		double lower{0}, upper{1}; // bounds of the uniform prior, > 0 for a logarithmic parameter
+		bool log{false};		   // if true, the prior is uniform in log10 of the parameter and the chains step in log10
+		double x0{0.5};			   // starting point of the chains, e.g. the point estimate of a hierarchical fit
+		double step{0};			   // initial standard deviation of the proposal (in log10 for a logarithmic parameter), 0 for 5% of the range
+	};
+
+	// noise model of the measurements
+	struct Noise
+	{
+		double sigma{0}; // standard deviation of the measurement noise (e.g. [V] for voltage curves)
+						 // 0 if it is unknown, then it is integrated out with a Jeffreys prior
+	};
+
+	double gaussian(const Noise &nz, double sse, double n); // log-likelihood of n independent Gaussian errors with a sum of squares sse
+
+	struct Settings
+	{
+		int nChains{4};		 // number of chains, they run in parallel
+		int nSamples{10000}; // number of iterations of every chain, including the burn-in
+		int burnIn{2000};	 // iterations at the start of every chain which are not used for the posterior
+		int adaptStart{200}; // iteration from which the proposal follows the covariance of the chain
+		int thin{1};		 // every so many iterations are stored
+		int checkpoint{100}; // every so many iterations the samples and state of a chain are written
+		unsigned seed{1};	 // seed of the random number generators, chain i uses seed + i
+		bool resume{true};	 // continue from the checkpoints of an earlier run with the same name if there are any
+		double scatter{1};	 // spread of the starting points of the chains around x0, in units of the initial step
+		double level{0.95};	 // probability of the credible intervals [-]
+	};
+
+	// state of a chain
+	struct Chain
+	{
+		std::vector<int> it;	  // iteration of each stored sample
+		std::vector<double> logL; // log-likelihood of each stored sample
+		std::vector<Par> samples; // stored samples
+		int n{0}, accepted{0};	  // number of iterations done and number of accepted proposals
+		Par u;					  // present point, in the coordinates of the chain (log10 for logarithmic parameters)
+		double lu{0};			  // log-likelihood of the present point
+		Par mean;				  // mean of the points during the burn-in, for the adaptation
+		std::vector<Par> cov;	  // covariance of the points during the burn-in
+		std::mt19937_64 gen;	  // random number generator
+	};
+
+	// summary of the posterior of a parameter
+	struct Interval
+	{
+		std::string name;
+		double mean, sd;			 // posterior mean and standard deviation
+		double lower, median, upper; // credible interval, see Settings::level
+		double Rhat;				 // potential scale reduction factor, close to 1 if the chains have converged
+	};
+
+	class Sampler
+	{
+	public:
+		Sampler(const std::vector<Parameter> &par, const LogLikelihood &f, const Settings &s, const std::string &name);
+
+		void run();							   // run all chains until they have nSamples iterations
+		std::vector<Interval> summary() const; // posterior mean, credible interval and convergence of every parameter
+		void write() const;					   // write the summary to a csv file in the results folder
+		std::vector<Par> posterior() const;	   // samples after the burn-in of all chains
+		const std::vector<Chain> &chains() const { return ch; }
+
+	private:
+		std::vector<Parameter> par;
+		LogLikelihood f;
+		Settings st;
+		std::string name; // prefix of the output files
+		std::vector<Chain> ch;
+
+		void start(int i);										  // start chain i at a random point around x0
+		bool load(int i);										  // resume chain i from its checkpoint, false if there is none
+		void save(int i, size_t from);							  // append the samples from index from and write the checkpoint of chain i
+		void iterate(int i);									  // do one iteration of chain i
+		bool likelihood(const Par &u, double *logL) const;		  // log-likelihood in the coordinates of the chains, false outside the prior
+		Par physical(const Par &u) const;						  // transform a point of a chain to the physical parameters
+		std::string file(int i, const std::string &suffix) const; // name of an output file of chain i
+	};
+
+	// measured capacity during a calendar ageing test
+	struct Calendar
+	{
+		double V{4.2};		   // voltage at which the cell is stored [V]
+		double T{298};		   // storage temperature [K]
+		std::vector<double> t; // time of the check-ups [day]
+		std::vector<double> Q; // capacity at the check-ups relative to the capacity at the start [-]
+	};
+
+	double *degradationParam(const std::string &name, SEIparam &sei, CSparam &cs, LAMparam &lam, PLparam &pl); // field of the degradation parameter with this name, nullptr if it is unknown
+	void checkDegradationParam(const Cell &c, const std::vector<std::string> &names);						   // check that all names are degradation parameters
+	void setDegradationParam(Cell &c, const std::vector<std::string> &names, const Par &p);					   // set the degradation parameters with these names
+	bool calendarFade(Cell &c, const Calendar &d, std::vector<double> &Q);									   // simulate a calendar ageing test, false if the simulation fails
+
+	template <typename Tcell>
+	LogLikelihood calendar(const Tcell &c, const std::vector<std::string> &names, const std::vector<Calendar> &data, const Noise &nz)
+	{
+		/*
+		 * Likelihood of degradation parameters (the fields of SEIparam, CSparam, LAMparam and PLparam with the given names)
+		 * for the relative capacity measured during calendar ageing tests at different voltages and temperatures.
+		 * Every evaluation simulates all tests with a copy of the cell with the degradation models selected in it.
+		 *
+		 * THROWS
+		 * 1023 	one of the names is not a degradation parameter, or a test has no check-ups or a different number of times and capacities
+		 */
+
+		checkDegradationParam(c, names);
+		for (const auto &d : data)
+			if (d.t.empty() || d.t.size() != d.Q.size())
+			{
+				std::cerr << "ERROR in inference::calendar, a test has " << d.t.size() << " check-up times and " << d.Q.size() << " capacities. Throwing an error.\n";
+				throw 1023;
+			}
+
+		return [c, names, data, nz](const Par &p, double *logL)
+		{
+			double sse = 0, n = 0;
+			std::vector<double> Q;
+			for (const auto &d : data)
+			{
+				Tcell ck = c;
+				setDegradationParam(ck, names, p);
+				if (!calendarFade(ck, d, Q))
+					return false;
+				for (size_t k = 0; k < Q.size(); k++)
+					sse += (Q[k] - d.Q[k]) * (Q[k] - d.Q[k]);
+				n += Q.size();
+			}
+			*logL = gaussian(nz, sse, n);
+			return true;
+		};
+	}
+
+	// uncertainty propagation
+
+	using Draw = std::function<Par(std::mt19937_64 &gen)>; // draws a parameter set
+
+	Draw resample(const std::vector<Par> &samples);					   // draw from samples, e.g. of the posterior (see Sampler::posterior and loadSamples)
+	Draw prior(const std::vector<Parameter> &par);					   // draw from the (log-)uniform distribution between the bounds of the parameters
+	std::vector<Par> loadSamples(const std::string &name, int burnIn); // read the samples after the burn-in of all chains of a Sampler from the results folder
+
+	struct Propagation
+	{
+		std::vector<double> q{0.05, 0.5, 0.95}; // quantiles of the bands [-]
+		int batch{16};							// number of runs which are done in parallel before the convergence is checked
+		int minRuns{64};						// minimum number of successful runs
+		int maxRuns{1024};						// maximum number of runs
+		double tol{0.02};						// the quantiles have converged if none changes over a batch by more than tol relative to its change since the start
+		unsigned seed{1};						// seed of the random number generator, run k draws its parameters with seed + k
+	};
+
+	// quantiles of the capacity and resistance at the check-ups of the ageing protocol
+	struct Bands
+	{
+		std::vector<double> q;					 // quantiles [-]
+		std::vector<int> cycle;					 // cycle number of every check-up, the first one (0) is before the protocol
+		std::vector<std::vector<double>> cap, R; // quantiles of the capacity [Ah] and resistance [Ohm] at every check-up, e.g. cap[check-up][quantile]
+		std::vector<Par> par;					 // parameters of every successful run
+		std::vector<std::vector<double>> capRun; // capacity at every check-up of every successful run [Ah]
+		std::vector<std::vector<double>> RRun;	 // resistance at every check-up of every successful run [Ohm]
+		int failed{0};							 // number of runs which failed or ended early
+		bool converged{false};					 // true if the quantiles converged before maxRuns
+	};
+
+	void write(const Bands &b, const std::string &name); // write the bands to a csv file in the results folder
+
+	// one ageing run with the given parameters, returns false if it fails
+	using Ageing = std::function<bool(const Par &p, std::vector<int> &cycle, std::vector<double> &cap, std::vector<double> &R)>;
+
+	bool age(Cell &c, protocol::Protocol p, std::vector<int> &cycle, std::vector<double> &cap, std::vector<double> &R);	// follow an ageing protocol and record the capacity and resistance at its check-ups
+	Bands propagate(const Ageing &f, const Draw &draw, const Propagation &s);											// do ageing runs until the quantiles converge
+
+	template <typename Tcell, typename Tapply>
+	Bands propagate(const Tcell &c, Tapply apply, const Draw &draw, const protocol::Protocol &p, const Propagation &s)
+	{
+		/*
+		 * Propagate the uncertainty of parameters through an ageing protocol.
+		 * Every run ages a copy of the cell after apply(cell, parameters) has set the drawn parameters in it.
+		 */
+
+		auto run = [c, apply, p](const Par &par, std::vector<int> &cycle, std::vector<double> &cap, std::vector<double> &R) {
+			Tcell ci = c;
+			apply(ci, par);
+			return age(ci, p, cycle, cap, R);
+		};
+		return propagate(run, draw, s);
+	}
+
+	template <typename Tcell>
+	Bands propagate(const Tcell &c, const std::vector<std::string> &names, const Draw &draw, const protocol::Protocol &p, const Propagation &s)
+	{
+		/*
+		 * Propagate the uncertainty of the degradation parameters with the given names (see calendar) through an ageing protocol.
+		 *
+		 * THROWS
+		 * 1023 	one of the names is not a degradation parameter, or the draw gives a different number of parameters
+		 */
+
+		checkDegradationParam(c, names);
+		std::mt19937_64 gen(s.seed);
+		const auto n = draw ? draw(gen).size() : names.size(); // a missing draw is reported by propagate
+		if (n != names.size())
+		{
+			std::cerr << "ERROR in inference::propagate, the parameter sets have " << n << " values but there are " << names.size()
+					  << " names, e.g. the samples come from a sampler with other parameters. Throwing an error.\n";
+			throw 1023;
+		}
+		return propagate(c, [names](Tcell &ci, const Par &par) { setDegradationParam(ci, names, par); }, draw, p, s);
+	}
+} // namespace slide::inference
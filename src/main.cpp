@@ -20,6 +20,8 @@
 #include "determine_characterisation.h"
 #include "cycling.h"
 #include "degradation.h"
+#include "chargeopt.hpp"
+#include "estimator.hpp"
 #include "constants.hpp"
 #include "cell.hpp"
 #include "cell_KokamNMC.hpp"
@@ -130,6 +132,9 @@ int main(int argv, char *argc[])
 
 	deg.pl_id = 1; // Yang lithium plating
 
+	// Models can also be selected by name, e.g. deg.add("SEI_PinsonBazant") instead of setting SEI_n and SEI_id[0].
+	// This is also how user-defined models are selected after registering them with slide::deg::registry().add(...) (see deg_registry.hpp)
+
 	// Then the user has to choose what is simulated.
 	// In the code below, uncomment the line which calls the function you want to execute (uncommenting means removing the // in front of the line)
 	// and comment all the other lines (commenting means putting // in front of the line)
@@ -141,6 +146,7 @@ int main(int argv, char *argc[])
 	// *********************************************** PARAMETRISATION FUNCTION CALLS *********************************************************************
 	// estimateOCVparameters(); // OCV parametrisation
 	// estimateCharacterisation(); // parametrisation of diffusion constant, rate constant and DC resistance
+	// estimateCharacterisationPosterior(); // posterior of the diffusion constants, rate constants and DC resistance with MCMC, see inference.hpp
 
 	// *********************************************** CYCLING FUNCTION CALLS ********************************************************
 	CCCV(M, pref, deg, cellType, settings::verbose);		  // a cell does a few CCCV cycles
@@ -150,6 +156,15 @@ int main(int argv, char *argc[])
 	// CalendarAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of calendar degradation experiments
 	// CycleAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of cycle degradation experiments
 	// ProfileAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of drive cycle degradation experiments
+	// SOCWindowAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of cycle degradation experiments in partial SOC windows
+	// UsageAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of experiments with realistic daily usage of drive cycles, charges and rests
+	// MixedAgeing(M, pref, deg, cellType, settings::verbose); // simulates a bunch of experiments with a daily cycle and rests at different SOCs in between
+	// UncertaintyAgeing(M, pref, deg, cellType, settings::verbose); // propagates the uncertainty of degradation parameters to the capacity and resistance of cycle ageing, see inference.hpp
+	// ChargeOptimisation(M, pref, deg, cellType, settings::verbose); // optimises a fast-charge protocol for the trade-off between charge time and capacity fade
+
+	// *********************************************** STATE ESTIMATION FUNCTION CALLS ********************************************************
+	// StateEstimation(M, pref, deg, cellType, settings::verbose); // estimates the SOC and temperature of a (simulated) log with the EKF and UKF
+	// HealthEstimation(M, pref, deg, cellType, settings::verbose); // estimates the SOH of a (simulated) cycling log with the dual EKF
 
 	// *********************************************** END ********************************************************
 	// Now all the simulations have finished. Print this message, as well as how long it took to do the simulations
@@ -3,9 +3,12 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <string>
+#include <iostream>
 
 #include "../read_CSVfiles.h"
+#include "../deg_registry.hpp"
 
 // Define a structure with the identifications of which degradation model(s) to use
 struct DEG_ID
@@ -21,8 +24,8 @@ struct DEG_ID
 							 * 				2 	Pinson&Bazant model: linear diffusion + Tafel kinetics
 							 * 				3	Christensen and Newman model
 							 */
-	int SEI_n;		  // SEI_N 	number of SEI models to use (length of SEI_ID)
-	int SEI_porosity; // integer deciding whether we reduce the active volume fraction due to SEI growth
+	int SEI_n{0};	  // SEI_N 	number of SEI models to use (length of SEI_ID)
+	int SEI_porosity{0}; // integer deciding whether we reduce the active volume fraction due to SEI growth
 					  /* 				0	don't reduce it
 							 * 				1	use correlation from Ashwin et al. 2016
 							 */
@@ -34,8 +37,8 @@ struct DEG_ID
 							 * 				4 	model from Barai et al
 							 * 				5 	model from Ekstrom et al
 							 */
-	int CS_n;		  // number of surface crack growth models to use (length of CS_ID)
-	int CS_diffusion; // integer deciding whether we reduce the negative diffusion constant due to surface cracks
+	int CS_n{0};	  // number of surface crack growth models to use (length of CS_ID)
+	int CS_diffusion{0}; // integer deciding whether we reduce the negative diffusion constant due to surface cracks
 					  /* 				0 	don't decrease diffusion
 							 * 				1	decrease according to Barai et al. 2015
 							 */
@@ -46,11 +49,108 @@ struct DEG_ID
 							 * 				3 	Kindermann's model for cathode dissolution: tafel kinetics for increased porosity
 							 * 				4 	Narayanrao's correlation which decreases the effective surface area proportionally to itself and j
 							 */
-	int LAM_n;		  // number of LAM models to be used (length of LAM_id)
-	int pl_id;		  // integer deciding which model is to be used for li-plating
+	int LAM_n{0};	  // number of LAM models to be used (length of LAM_id)
+	int pl_id{0};	  // integer deciding which model is to be used for li-plating
 					  /* 				0 	no plating
 							 * 				1	Yang et al thermodynamic plating (Tafel kinetics)
+							 * 				2	O'Kane et al reversible plating with stripping and dead lithium
 							 */
+	int pl_sei{0};	  // integer deciding whether the formation of dead lithium is coupled to SEI growth (only for pl_id 2)
+					  /* 				0 	constant rate of dead lithium formation
+							 * 				1	the rate decreases as the SEI layer becomes thicker, O'Kane et al 2022
+							 */
+	int CAT_id[10];	  // array with the integers deciding which side reactions at the cathode are used. Max length 10
+					  /* 				0 	no side reactions at the cathode
+							 * 				1	electrolyte oxidation (Tafel kinetics), lithiates the cathode and grows a resistive film
+							 * 				2	redox shuttle between both electrodes (Tafel kinetics), lithiates the cathode and delithiates the anode
+							 */
+	int CAT_n{0};	  // number of cathode side reactions to be used (length of CAT_id)
+
+	int user_id[10]; // indices in slide::deg::Registry of the user-defined degradation models to use. Max length 10
+	int user_x0[10]; // index of the first own state of each user-defined model in the block of settings::ns_deg states
+	int user_n{0};	 // number of user-defined degradation models to use (length of user_id)
+	int user_ns{0};	 // number of own states used by the user-defined degradation models
+
+	void add(const std::string &name)
+	{
+		/*
+		 * Select a degradation model by its name in slide::deg::Registry.
+		 * For a built-in model, its identifier is appended to the identifiers of its mechanism (e.g. SEI_id),
+		 * so it is evaluated in exactly the same way as when the identifier is set directly.
+		 * A user-defined model is appended to user_id and gets its own states.
+		 *
+		 * IN
+		 * name 	name of the model, e.g. "SEI_PinsonBazant"
+		 *
+		 * THROWS
+		 * 106 		there is no model with this name
+		 * 107 		too many degradation models or too many states
+		 */
+
+		using namespace slide::deg;
+		const int i = registry().find(name);
+		if (i == -1)
+		{
+			std::cerr << "ERROR in DEG_ID::add, unknown degradation model " << name << ". Throwing an error.\n";
+			throw 106;
+		}
+
+		const Model &m = registry()[i];
+		int *n_mech = nullptr; // number of models of this mechanism which are already used
+		if (m.builtin_id == -1)
+			n_mech = &user_n;
+		else if (m.mech == Mechanism::SEI)
+			n_mech = &SEI_n;
+		else if (m.mech == Mechanism::CS)
+			n_mech = &CS_n;
+		else if (m.mech == Mechanism::LAM)
+			n_mech = &LAM_n;
+		else if (m.mech == Mechanism::CAT)
+			n_mech = &CAT_n;
+
+		if (n_mech == nullptr) // there is only one plating model
+		{
+			pl_id = m.builtin_id;
+			return;
+		}
+		if (*n_mech >= len)
+		{
+			std::cerr << "ERROR in DEG_ID::add, the user wants to use more than " << len << " degradation models. Throwing an error.\n";
+			throw 107;
+		}
+
+		if (m.builtin_id == -1)
+		{
+			if (user_ns + m.nstates > settings::ns_deg)
+			{
+				std::cerr << "ERROR in DEG_ID::add, the degradation model " << name << " needs " << m.nstates << " states but only "
+						  << settings::ns_deg - user_ns << " are still available. Throwing an error.\n";
+				throw 107;
+			}
+			user_id[user_n] = i;
+			user_x0[user_n] = user_ns;
+			user_ns += m.nstates;
+		}
+		else if (m.mech == Mechanism::SEI)
+			SEI_id[SEI_n] = m.builtin_id;
+		else if (m.mech == Mechanism::CS)
+			CS_id[CS_n] = m.builtin_id;
+		else if (m.mech == Mechanism::LAM)
+			LAM_id[LAM_n] = m.builtin_id;
+		else
+			CAT_id[CAT_n] = m.builtin_id;
+
+		(*n_mech)++;
+	}
+
+	bool userNeeds(unsigned flag) const
+	{
+		// check if one of the user-defined degradation models needs the given input (see slide::deg::Input)
+		for (int i = 0; i < user_n; i++)
+			if (slide::deg::registry()[user_id[i]].needs(flag))
+				return true;
+		return false;
+	}
 
 	std::string print() const
 	{
@@ -108,8 +208,18 @@ struct DEG_ID
 		// mechanism separator
 		id += "_";
 
-		// print plating model
+		// print plating model, and the coupling with SEI growth for the reversible plating model
 		id += std::to_string(pl_id);
+		if (pl_id == 2)
+			id += "-" + std::to_string(pl_sei);
+
+		// print the cathode side reactions separated by -, only if there are any such that the names are the same as before they were added
+		for (int i = 0; i < CAT_n; i++)
+			id += (i == 0 ? "_c" : "-") + std::to_string(CAT_id[i]);
+
+		// print the names of the user-defined models, separated by -
+		for (int i = 0; i < user_n; i++)
+			id += (i == 0 ? "_" : "-") + slide::deg::registry()[user_id[i]].name;
 
 		// output
 		return id;
@@ -180,6 +290,95 @@ struct PLparam
 {
 	double pl1k;   // rate constant of the li-plating side reaction at reference temperature in the 1st model
 	double pl1k_T; // activation energy of pl1k
+
+	double pl2k;	  // rate constant of the li-plating side reaction at reference temperature in the 2nd model
+	double pl2k_T;	  // activation energy of pl2k and pl2ks
+	double pl2ks;	  // rate constant of the stripping reaction at reference temperature in the 2nd model [s-1]
+	double pl2alpha;  // charge transfer coefficient of the plating reaction in the 2nd model [-], the one for stripping is 1 - pl2alpha
+	double pl2gamma;  // rate at which plated lithium becomes dead lithium in the 2nd model [s-1]
+	double pl2delta0; // SEI thickness at which the rate of dead lithium formation is halved if it is coupled to SEI growth [m]
+};
+
+// Define a structure with the fitting parameters of the side reactions at the cathode (CAT)
+// Both reactions follow Tafel kinetics in the cathode potential, i = k * exp(Ea/Rg (1/Tref - 1/T)) * exp(alpha F / (Rg T) * (OCVp + etap - U))
+struct CATparam
+{
+	double cat1k{0};	 // rate constant of the electrolyte oxidation at the reference temperature [A m-2]
+	double cat1k_T{0};	 // activation energy of cat1k [J mol-1]
+	double cat1U{0};	 // equilibrium potential of the electrolyte oxidation [V]
+	double cat1alpha{0}; // charge transfer coefficient of the electrolyte oxidation [-]
+	double cat1r{0};	 // increase in the specific resistance per unit of oxidation charge on the cathode surface [Ohm m2 / (C m-2)]
+
+	double cat2k{0};	 // rate constant of the redox shuttle at the reference temperature [A m-2]
+	double cat2k_T{0};	 // activation energy of cat2k [J mol-1]
+	double cat2U{0};	 // equilibrium potential of the shuttle molecule [V]
+	double cat2alpha{0}; // charge transfer coefficient of the redox shuttle [-]
+};
+
+// Define a structure with the parameters of the swelling model
+// The electrodes swell with the lithium they contain (partial molar volumes of the stress model) and with the SEI and plated lithium on the anode particles.
+// The cell is clamped in a fixture with a linear stiffness, and the resulting stack pressure can increase the degradation rates.
+struct SwellParam
+{
+	int nlayer{1};		 // number of electrode pairs stacked in the thickness direction of the cell [-]
+	double fsei{1};		 // fraction of the SEI volume which increases the electrode thickness (the rest fills the pores) [-]
+	double fpl{1};		 // fraction of the plated lithium volume which increases the electrode thickness [-]
+	double K{0};		 // stiffness of the fixture, increase in pressure per unit increase in cell thickness [Pa m-1], 0 means the cell is not clamped
+	double P0{0};		 // stack pressure at the reference thickness [Pa]
+	double dref{0};		 // swelling at the reference thickness [m], set by Cell::setFixture
+	double pref{1e6};	 // reference pressure for the feedback on the degradation rates [Pa]
+	double gsei{0};		 // sensitivity of the SEI growth rate to the pressure, rate * (1 + gsei * (P - P0) / pref) [-]
+	double glam{0};		 // sensitivity of the LAM rates to the pressure [-]
+	double gpl{0};		 // sensitivity of the plating rate to the pressure [-]
+};
+
+// Define a structure with the thermal management of the cell (TM)
+// A heater adds a power to the cell and a coolant loop removes heat through a thermal conductance (on top of the convection with the environment).
+// Both actuators are driven by a controller which is updated every time step (see Cell::controlTemperature):
+// 		on/off 	the heater is switched on below Theat - band/2 and off above Theat + band/2, and the coolant loop the other way round around Tcool
+// 		PI 		the fraction of the heater power (or of the coolant flow) is a PI function of Theat - T (or T - Tcool), with anti-windup
+// The state of the controller, the energy used by the actuators and the time spent idle, heating and cooling are part of State (see State::get_uheat),
+// such that they are restored with the other states when a time step is undone.
+struct ThermalParam
+{
+	int mode{0};		// controller, 0 no thermal management, 1 on/off, 2 PI
+	bool paused{false}; // if true, the actuators are switched off and nothing is accumulated (e.g. during a check-up)
+	double band{2};		// hysteresis band of the on/off controller [K]
+	double Kp{0.5};		// proportional gain of the PI controller [K-1]
+	double Ki{5e-3};	// integral gain of the PI controller [K-1 s-1]
+
+	double Pheat{0};	// maximum power of the heater [W], 0 means there is no heater
+	double Theat{0};	// temperature below which the cell is heated [K]
+	double Hcool{0};	// maximum thermal conductance between the cell and the coolant [W K-1], 0 means there is no coolant loop
+	double Tcoolant{0}; // temperature of the coolant [K]
+	double Tcool{0};	// temperature above which the cell is cooled [K]
+	double COP{3};		// coefficient of performance of the chiller, heat removed per unit of energy used [-]
+};
+
+// Define a structure with the particle-size distribution of the electrodes (PSD)
+// Each electrode is represented by n particle-size classes which share the matrices of slide::Model by scaling them with the radius.
+// Class 0 is the reference particle with radius Rp or Rn and uses the states zp and zn, the other classes have their own states (see State::get_zp_psd)
+// A class can also be made of a different material (blended electrodes, e.g. graphite + SiOx), with its own OCV curve (see OCVcurves::loadMaterial),
+// maximum concentration and diffusion constant (see Cell::setMaterial)
+struct PSDparam
+{
+	int n{1}; // number of particle-size classes per electrode, 1 means a single particle (no distribution)
+
+	double fp[settings::npsd]{1}; // radius of each class of the cathode relative to Rp [-], fp[0] = 1
+	double fn[settings::npsd]{1}; // radius of each class of the anode relative to Rn [-], fn[0] = 1
+	double wp[settings::npsd]{1}; // fraction of the active material volume of the cathode in each class [-], sums to 1
+	double wn[settings::npsd]{1}; // fraction of the active material volume of the anode in each class [-], sums to 1
+
+	// material of each class relative to the material of class 0, set to 1 by Cell::setPSD
+	double cmp[settings::npsd]{1}; // maximum li-concentration of each class of the cathode relative to Cmaxpos [-]
+	double cmn[settings::npsd]{1}; // maximum li-concentration of each class of the anode relative to Cmaxneg [-]
+	double dp[settings::npsd]{1};  // diffusion constant of each class of the cathode relative to Dp [-]
+	double dn[settings::npsd]{1};  // diffusion constant of each class of the anode relative to Dn [-]
+
+	// derived values, set by Cell::setPSD
+	double sp{1}, sn{1};				   // relative total surface of the classes, sum(w/f) [-], so a = 3 e/R * s
+	double alphap[settings::npsd]{1};	   // fraction of the effective surface of the cathode in each class [-], (w/f) / s
+	double alphan[settings::npsd]{1};	   // fraction of the effective surface of the anode in each class [-]
 };
 
 struct StressParam
@@ -219,6 +418,23 @@ struct OCVcurves
 	std::vector<double> dOCV_neg_x, dOCV_tot_x; // lithium fractions of the points of the anode/entire cell entropic coefficient curve
 	std::vector<double> dOCV_neg_y, dOCV_tot_y; // entropic coefficient curve / the entire cell's entropic coefficient [V K-1]
 
+	// optional voltage hysteresis of each electrode (one-state model of Plett, 2004)
+	// the potential interpolates between a charge and a discharge curve with the hysteresis state h of the electrode (see State::get_hp)
+	// 		U = (1 + h) / 2 * U_ch + (1 - h) / 2 * U_dis
+	// h relaxes to 1 when the cell is charged and to -1 when it is discharged at a rate proportional to the change in li-fraction
+	// 		dh/dt = gamma * abs(dz/dt) * (+-1 - h)
+	bool hys_pos{false}, hys_neg{false}; // is hysteresis enabled for the cathode/anode
+	double hys_gammap{0}, hys_gamman{0}; // rate of the hysteresis per unit of change in li-fraction of the cathode/anode [-]
+	bool is_OCV_pos_ch_fixed{false}, is_OCV_pos_dis_fixed{false}, is_OCV_neg_ch_fixed{false}, is_OCV_neg_dis_fixed{false};
+	std::vector<double> OCV_pos_ch_x, OCV_pos_ch_y, OCV_pos_dis_x, OCV_pos_dis_y; // charge and discharge OCV curve of the cathode
+	std::vector<double> OCV_neg_ch_x, OCV_neg_ch_y, OCV_neg_dis_x, OCV_neg_dis_y; // charge and discharge OCV curve of the anode
+
+	// OCV curves of the other materials of blended electrodes, index k is the particle class (see PSDparam)
+	// classes without their own curve (and class 0) use the curves above
+	std::array<bool, settings::npsd> has_OCV_posk{}, has_OCV_negk{};
+	std::array<bool, settings::npsd> is_OCV_posk_fixed{}, is_OCV_negk_fixed{};
+	std::array<std::vector<double>, settings::npsd> OCV_posk_x, OCV_posk_y, OCV_negk_x, OCV_negk_y;
+
 	OCVcurves(const std::string &_namepos, int _OCV_pos_n,
 			  const std::string &_nameneg, int _OCV_neg_n,
 			  const std::string &_nameentropicC, int _dOCV_neg_n,
@@ -258,6 +474,86 @@ struct OCVcurves
 		return ::linInt(print, bound, dOCV_tot_x, dOCV_tot_y, dOCV_tot_n, x, is_dOCV_tot_fixed);
 	}
 
+	// OCV with hysteresis state h, this is the same as linInt_OCV_pos/neg if hysteresis is disabled
+	double linInt_OCV_pos_h(double x, double h, bool print = false, bool bound = true)
+	{
+		if (!hys_pos)
+			return linInt_OCV_pos(x, print, bound);
+		return 0.5 * (1 + h) * ::linInt(print, bound, OCV_pos_ch_x, OCV_pos_ch_y, OCV_pos_ch_x.size(), x, is_OCV_pos_ch_fixed) +
+			   0.5 * (1 - h) * ::linInt(print, bound, OCV_pos_dis_x, OCV_pos_dis_y, OCV_pos_dis_x.size(), x, is_OCV_pos_dis_fixed);
+	}
+	double linInt_OCV_neg_h(double x, double h, bool print = false, bool bound = true)
+	{
+		if (!hys_neg)
+			return linInt_OCV_neg(x, print, bound);
+		return 0.5 * (1 + h) * ::linInt(print, bound, OCV_neg_ch_x, OCV_neg_ch_y, OCV_neg_ch_x.size(), x, is_OCV_neg_ch_fixed) +
+			   0.5 * (1 - h) * ::linInt(print, bound, OCV_neg_dis_x, OCV_neg_dis_y, OCV_neg_dis_x.size(), x, is_OCV_neg_dis_fixed);
+	}
+
+	// OCV of particle class k, this is the same as linInt_OCV_pos/neg_h if the class has no OCV curve of its own
+	double linInt_OCV_pos_k(int k, double x, double h, bool print = false, bool bound = true)
+	{
+		if (!has_OCV_posk[k])
+			return linInt_OCV_pos_h(x, h, print, bound);
+		return ::linInt(print, bound, OCV_posk_x[k], OCV_posk_y[k], OCV_posk_x[k].size(), x, is_OCV_posk_fixed[k]);
+	}
+	double linInt_OCV_neg_k(int k, double x, double h, bool print = false, bool bound = true)
+	{
+		if (!has_OCV_negk[k])
+			return linInt_OCV_neg_h(x, h, print, bound);
+		return ::linInt(print, bound, OCV_negk_x[k], OCV_negk_y[k], OCV_negk_x[k].size(), x, is_OCV_negk_fixed[k]);
+	}
+
+	void loadMaterial(bool pos, int k, const std::string &name)
+	{
+		/*
+		 * Load the OCV curve of the material of particle class k of a blended electrode.
+		 * The file has the same format as the other OCV curves.
+		 *
+		 * IN
+		 * pos 		if true, the curve is for the cathode, else for the anode
+		 * k 		particle class, 1 <= k < settings::npsd
+		 * name 	name of the CSV file with the OCV curve
+		 *
+		 * THROWS
+		 * 2 		the file could not be opened
+		 */
+		auto &x = pos ? OCV_posk_x[k] : OCV_negk_x[k];
+		auto &y = pos ? OCV_posk_y[k] : OCV_negk_y[k];
+		loadCSV_2col(PathVar::data + name, x, y);
+
+		(pos ? is_OCV_posk_fixed : is_OCV_negk_fixed)[k] = check_is_fixed(x);
+		(pos ? has_OCV_posk : has_OCV_negk)[k] = true;
+	}
+
+	void loadHysteresis(bool pos, const std::string &namech, const std::string &namedis, double gamma)
+	{
+		/*
+		 * Enable hysteresis for one electrode.
+		 * The files have the same format as the OCV curves: the first column gives the lithium fractions (increasing), the 2nd column gives the OCV vs li/li+
+		 *
+		 * IN
+		 * pos 		if true, the curves are for the cathode, else for the anode
+		 * namech 	name of the CSV file with the OCV curve while the cell is charged
+		 * namedis 	name of the CSV file with the OCV curve while the cell is discharged
+		 * gamma 	rate of the hysteresis per unit of change in li-fraction [-]
+		 *
+		 * THROWS
+		 * 2 		one of the files could not be opened
+		 */
+		auto &xch = pos ? OCV_pos_ch_x : OCV_neg_ch_x;
+		auto &ych = pos ? OCV_pos_ch_y : OCV_neg_ch_y;
+		auto &xdis = pos ? OCV_pos_dis_x : OCV_neg_dis_x;
+		auto &ydis = pos ? OCV_pos_dis_y : OCV_neg_dis_y;
+		loadCSV_2col(PathVar::data + namech, xch, ych);
+		loadCSV_2col(PathVar::data + namedis, xdis, ydis);
+
+		(pos ? is_OCV_pos_ch_fixed : is_OCV_neg_ch_fixed) = check_is_fixed(xch);
+		(pos ? is_OCV_pos_dis_fixed : is_OCV_neg_dis_fixed) = check_is_fixed(xdis);
+		(pos ? hys_gammap : hys_gamman) = gamma;
+		(pos ? hys_pos : hys_neg) = true;
+	}
+
 	OCVcurves() = default;
 };
 
@@ -0,0 +1,205 @@
+/*
+ * protocol.cpp
+ *
+ * Implements the construction and compilation of cycling protocols.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace slide::protocol
+{
+	Condition every(int n)
+	{
+		// #NOTHOTFUNCTION
+		if (n < 1)
+		{
+			std::cerr << "ERROR in protocol::every, the cycle interval is " << n << " but it must be at least 1. Throwing an error.\n";
+			throw 1020;
+		}
+		return Condition{Var::cycle, Cmp::multipleOf, static_cast<double>(n)};
+	}
+
+	Condition notEvery(int n)
+	{
+		// #NOTHOTFUNCTION
+		if (n < 1)
+		{
+			std::cerr << "ERROR in protocol::notEvery, the cycle interval is " << n << " but it must be at least 1. Throwing an error.\n";
+			throw 1020;
+		}
+		return Condition{Var::cycle, Cmp::notMultipleOf, static_cast<double>(n)};
+	}
+
+	Protocol &Protocol::add(Instr in)
+	{
+		// #NOTHOTFUNCTION
+		if (compiled)
+		{
+			std::cerr << "ERROR in Protocol, instructions can't be added after the protocol has been compiled. Throwing an error.\n";
+			throw 1020;
+		}
+		instr.push_back(std::move(in));
+		return *this;
+	}
+
+	Protocol &Protocol::step(Op op, double value, std::vector<Condition> &limits, double time, double dt)
+	{
+		// #NOTHOTFUNCTION
+		if (static_cast<int>(limits.size()) > maxLim || dt <= 0 || time <= 0)
+		{
+			std::cerr << "ERROR in Protocol, a step has " << limits.size() << " limits (the maximum is " << maxLim << "), time step " << dt
+					  << " and duration " << time << ", both must be positive. Throwing an error.\n";
+			throw 1020;
+		}
+
+		Instr in{op, value, dt, time};
+		in.nlim = static_cast<int>(limits.size());
+		std::copy(limits.begin(), limits.end(), in.lim.begin());
+		return add(in);
+	}
+
+	Protocol &Protocol::CC(double I, std::vector<Condition> limits, double time, double dt) { return step(Op::CC, I, limits, time, dt); }
+	Protocol &Protocol::CV(double V, std::vector<Condition> limits, double time, double dt) { return step(Op::CV, V, limits, time, dt); }
+	Protocol &Protocol::CP(double P, std::vector<Condition> limits, double time, double dt) { return step(Op::CP, P, limits, time, dt); }
+	Protocol &Protocol::rest(double time, std::vector<Condition> limits, double dt) { return step(Op::rest, 0, limits, time, dt); }
+	Protocol &Protocol::restFast(double time, double dtmax, std::vector<Condition> limits) { return step(Op::restFast, dtmax, limits, time, std::min(2.0, dtmax)); }
+	Protocol &Protocol::Tenv(double T) { return add(Instr{Op::Tenv, T}); }
+	Protocol &Protocol::endLoop() { return add(Instr{Op::endLoop}); }
+	Protocol &Protocol::checkUp(int every) { return add(Instr{Op::checkUp, static_cast<double>(std::max(every, 1))}); }
+	Protocol &Protocol::end() { return add(Instr{Op::end}); }
+
+	Protocol &Protocol::loop(int n)
+	{
+		// #NOTHOTFUNCTION
+		if (n < 1)
+		{
+			std::cerr << "ERROR in Protocol::loop, the number of iterations is " << n << " but it must be at least 1. Throwing an error.\n";
+			throw 1020;
+		}
+		return add(Instr{Op::loop, static_cast<double>(n)});
+	}
+
+	Protocol &Protocol::CCpl(double I, double margin, std::vector<Condition> limits, double time, double dt)
+	{
+		// #NOTHOTFUNCTION
+		step(Op::CCpl, I, limits, time, dt);
+		instr.back().margin = margin;
+		return *this;
+	}
+
+	Protocol &Protocol::profile(const std::vector<double> &X, const std::vector<double> &T, bool power)
+	{
+		// #NOTHOTFUNCTION
+		profiles.emplace_back(X, T);
+		return profile(static_cast<int>(profiles.size()) - 1, power);
+	}
+
+	Protocol &Protocol::profile(int index, bool power)
+	{
+		// #NOTHOTFUNCTION
+		if (index < 0 || index >= static_cast<int>(profiles.size()))
+		{
+			std::cerr << "ERROR in Protocol, profile " << index << " does not exist, there are " << profiles.size() << " profiles. Throwing an error.\n";
+			throw 1020;
+		}
+		Instr in{power ? Op::profileP : Op::profileI};
+		in.profile = index;
+		return add(in);
+	}
+
+	Protocol &Protocol::label(const std::string &name)
+	{
+		// #NOTHOTFUNCTION
+		labels.emplace_back(name, static_cast<int>(instr.size()));
+		return *this;
+	}
+
+	Protocol &Protocol::jump(const std::string &name)
+	{
+		// #NOTHOTFUNCTION
+		Instr in{Op::jump};
+		in.label = name;
+		return add(in);
+	}
+
+	Protocol &Protocol::jumpIf(Condition cond, const std::string &name)
+	{
+		// #NOTHOTFUNCTION
+		Instr in{Op::jump};
+		in.conditional = true;
+		in.cond = cond;
+		in.label = name;
+		return add(in);
+	}
+
+	void Protocol::compile()
+	{
+		/*
+		 * Function to turn the protocol into a flat list of instructions.
+		 * 		the start of every loop gets a counter, and its end gets the index of the first instruction of the loop to jump back to
+		 * 		every instruction gets the counter of the innermost loop around it (used for check-ups and conditions on the cycle number)
+		 * 		jumps get the index of the instruction their label points to
+		 * An end instruction is added at the end of the protocol.
+		 *
+		 * THROWS
+		 * 1020 	the loops are not balanced or a label is unknown
+		 */
+
+		if (compiled)
+			return;
+
+		if (instr.empty() || instr.back().op != Op::end)
+			add(Instr{Op::end});
+
+		std::vector<int> open; // index of the start of the loops which have not been closed yet
+		for (int i = 0; i < static_cast<int>(instr.size()); i++)
+		{
+			auto &in = instr[i];
+			if (in.op == Op::loop)
+			{
+				in.counter = ncounter++;
+				open.push_back(i);
+				continue;
+			}
+			in.counter = open.empty() ? -1 : instr[open.back()].counter;
+			if (in.op == Op::endLoop)
+			{
+				if (open.empty())
+				{
+					std::cerr << "ERROR in Protocol::compile, instruction " << i << " closes a loop which was not opened. Throwing an error.\n";
+					throw 1020;
+				}
+				in.target = open.back() + 1;
+				in.value = instr[open.back()].value;
+				open.pop_back();
+			}
+		}
+		if (!open.empty())
+		{
+			std::cerr << "ERROR in Protocol::compile, " << open.size() << " loops are not closed. Throwing an error.\n";
+			throw 1020;
+		}
+
+		for (auto &in : instr)
+		{
+			if (in.op != Op::jump)
+				continue;
+			auto lab = std::find_if(labels.begin(), labels.end(), [&](const auto &l) { return l.first == in.label; });
+			if (lab == labels.end())
+			{
+				std::cerr << "ERROR in Protocol::compile, the label " << in.label << " does not exist. Throwing an error.\n";
+				throw 1020;
+			}
+			in.target = lab->second;
+		}
+
+		compiled = true;
+	}
+} // namespace slide::protocol
@@ -0,0 +1,191 @@
+/*
+ * protocol.hpp
+ *
+ * Programmable cycling protocols, equivalent to the schedule of a battery tester.
+ *
+ * A Protocol is built step by step with the functions below (CC, CV, CP, rest, profiles, loops, jumps and check-ups)
+ * and compiled into a flat list of instructions in which the loops and labels are replaced by the index of the instruction to jump to.
+ * The instructions are executed by Cycler::followProtocol.
+ *
+ * Every step ends when its maximum time has passed or when one of its limits is met.
+ * A limit or condition compares one quantity with a value:
+ * 		V 		cell voltage [V]
+ * 		I 		magnitude of the cell current [A]
+ * 		T 		cell temperature [K]
+ * 		Ah 		magnitude of the charge throughput of the (last) step [Ah]
+ * 		SOC 	state of charge [-] (see Cell::getSOC)
+ * 		t 		time of the (last) step [s]
+ * 		Vpl 	potential of the anode relative to the plating reaction [V], lithium is plated when it is negative (see Cell::getPlatingPotentialAt)
+ * 		SOH 	present capacity relative to the nominal capacity [-] (see Cell::getIndicators)
+ * 		E 		available energy of an equilibrium discharge to the minimum voltage [Wh] (see Cell::getIndicators)
+ * 		cycle 	number of the present iteration of the innermost loop around the instruction, starting at 1
+ *
+ * Example: 100 cycles of a 1C CC CV charge, 30 minutes rest and a 1C discharge, with a check-up every 50 cycles
+ * 		Protocol p;
+ * 		p.loop(100)
+ * 			.CC(-2.7, {above(Var::V, 4.2)})
+ * 			.CV(4.2, {below(Var::I, 0.135)})
+ * 			.rest(1800)
+ * 			.CC(2.7, {below(Var::V, 2.7)})
+ * 			.checkUp(50)
+ * 			.endLoop();
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace slide::protocol
+{
+	constexpr int maxLim = 4;									// maximum number of limits of one step
+	constexpr double tmax = std::numeric_limits<double>::max(); // no time limit
+
+	// quantities which can be used in limits and conditions
+	enum class Var
+	{
+		V,
+		I,
+		T,
+		Ah,
+		SOC,
+		t,
+		Vpl,
+		SOH,
+		E,
+		cycle // must be the last one
+	};
+
+	// comparisons which can be used in limits and conditions
+	enum class Cmp
+	{
+		above,		  // value > limit
+		below,		  // value < limit
+		multipleOf,	  // value is a multiple of the limit (for the cycle number)
+		notMultipleOf // value is not a multiple of the limit
+	};
+
+	struct Condition
+	{
+		Var var{Var::t};
+		Cmp cmp{Cmp::above};
+		double value{0};
+
+		bool met(double x) const
+		{
+			switch (cmp)
+			{
+			case Cmp::above:
+				return x > value;
+			case Cmp::below:
+				return x < value;
+			case Cmp::multipleOf:
+				return static_cast<long>(x) % static_cast<long>(value) == 0;
+			default:
+				return static_cast<long>(x) % static_cast<long>(value) != 0;
+			}
+		}
+	};
+
+	inline Condition above(Var v, double x) { return Condition{v, Cmp::above, x}; }
+	inline Condition below(Var v, double x) { return Condition{v, Cmp::below, x}; }
+	Condition every(int n);	   // met when the cycle number is a multiple of n, n >= 1
+	Condition notEvery(int n); // met when the cycle number is not a multiple of n, n >= 1
+
+	// operations of the instructions
+	enum class Op
+	{
+		CC,		  // constant current [A]
+		CV,		  // constant voltage [V]
+		CP,		  // constant power [W]
+		CCpl,	  // constant (charge) current [A], reduced when needed to keep the anode potential above the plating reaction by margin
+		rest,	  // zero current
+		restFast, // zero current with a growing time step up to value [s], see Cell::ETI_rest
+		profileI, // current profile
+		profileP, // power profile
+		Tenv,	  // set the environmental temperature [K]
+		loop,	  // start of a loop, resets its counter
+		endLoop,  // end of a loop, increases its counter and jumps back to the start until the loop is done
+		jump,	  // (conditional) jump to a label
+		checkUp,  // check-up, done when the iteration number of the innermost loop is a multiple of value
+		end		  // stop the protocol
+	};
+
+	struct Instr
+	{
+		Op op;
+		double value{0};					 // current [A], voltage [V], power [W] or temperature [K] of a step, number of repetitions of a loop, or interval of a check-up
+		double dt{2};						 // time step of a step [s]
+		double time{tmax};					 // maximum duration of a step [s]
+		double margin{0};					 // minimum potential of the anode relative to the plating reaction during a CCpl step [V]
+		int nlim{0};						 // number of limits of a step
+		std::array<Condition, maxLim> lim{}; // limits of a step, the step ends when one of them is met
+		bool conditional{false};			 // a jump is only done if cond is met
+		Condition cond{};					 // condition of a jump
+		int target{-1};						 // index of the instruction to jump to (loops and jumps)
+		int counter{-1};					 // index of the counter of the innermost loop around this instruction, -1 if there is none
+		int profile{-1};					 // index of the profile of a profile step
+		std::string label;					 // label to jump to, only used until the protocol is compiled
+	};
+
+	// totals of a run of a protocol (see BasicCycler::runProtocol)
+	struct Run
+	{
+		double Ah{0};	  // charge throughput [Ah]
+		double Wh{0};	  // energy throughput [Wh]
+		double time{0};	  // time [s]
+		int nrCycles{0};  // cycle number of the last check-up
+		int end{1};		  // end code of the last step, <= 0 if the protocol was stopped because the cell went outside its voltage range
+		double tmark{-1}; // time at which the mark condition was first met [s], -1 if it was not met
+		double Tmax{0};	  // maximum temperature of the cell during the steps [K]
+	};
+
+	class Protocol
+	{
+	public:
+		// steps
+		Protocol &CC(double I, std::vector<Condition> limits = {}, double time = tmax, double dt = 2);
+		Protocol &CV(double V, std::vector<Condition> limits = {}, double time = tmax, double dt = 2);
+		Protocol &CP(double P, std::vector<Condition> limits = {}, double time = tmax, double dt = 2);
+		Protocol &CCpl(double I, double margin, std::vector<Condition> limits = {}, double time = tmax, double dt = 2); // plating-limited charge
+		Protocol &rest(double time, std::vector<Condition> limits = {}, double dt = 2);
+		Protocol &restFast(double time, double dtmax = 600, std::vector<Condition> limits = {});			// long rest with a growing time step
+		Protocol &profile(const std::vector<double> &X, const std::vector<double> &T, bool power = false); // follow a current or power profile, see BasicCycler::followI
+		Protocol &profile(int index, bool power = false);													// follow a profile which was added before
+		Protocol &Tenv(double T);																			// set the environmental temperature
+
+		// flow control
+		Protocol &loop(int n);										 // start a loop which is repeated n times
+		Protocol &endLoop();										 // end the innermost loop
+		Protocol &label(const std::string &name);					 // give a name to the next instruction
+		Protocol &jump(const std::string &name);					 // jump to a label
+		Protocol &jumpIf(Condition cond, const std::string &name); // jump to a label if the condition is met
+		Protocol &checkUp(int every = 1);							 // do a check-up every 'every' iterations of the innermost loop
+		Protocol &end();											 // stop the protocol
+
+		void compile(); // replace the loops and labels by the index of the instructions to jump to
+
+		bool isCompiled() const { return compiled; }
+		int nCounter() const { return ncounter; }
+		int nProfiles() const { return static_cast<int>(profiles.size()); }
+		const std::vector<Instr> &instructions() const { return instr; }
+		const std::vector<double> &profileX(int i) const { return profiles[i].first; }
+		const std::vector<double> &profileT(int i) const { return profiles[i].second; }
+
+	private:
+		std::vector<Instr> instr;												   // instructions
+		std::vector<std::pair<std::vector<double>, std::vector<double>>> profiles; // current or power profiles and their durations
+		std::vector<std::pair<std::string, int>> labels;						   // labels and the index of the instruction they point to
+		int ncounter{0};														   // number of loop counters
+		bool compiled{false};
+
+		Protocol &step(Op op, double value, std::vector<Condition> &limits, double time, double dt);
+		Protocol &add(Instr in);
+	};
+} // namespace slide::protocol
@@ -49,6 +49,24 @@ namespace slide
 		double &get_Dn() { return x[2 * nch + 11]; }	   // get the diffusion constant of the anode at reference temperature [m/s]
 		double &get_r() { return x[2 * nch + 12]; }		   // get the specific resistance (resistance times real surface area of the combined electrodes) [Ohm m2]
 		double &get_delta_pl() { return x[2 * nch + 13]; } // get the thickness of the plated lithium layer
+		double &get_xdeg(int i) { return x[i_xdeg + i]; }						// get the i-th state of the user-defined degradation models
+		double &get_zp_psd(int k, int i) { return x[i_psd + 2 * nch * (k - 1) + i]; }		// get the transformed concentration of particle-size class k >= 1 of the cathode
+		double &get_zn_psd(int k, int i) { return x[i_psd + 2 * nch * (k - 1) + nch + i]; } // get the transformed concentration of particle-size class k >= 1 of the anode
+		double &get_Li_pl() { return x[i_pl + 0]; }			// get the reversibly plated lithium which can still be stripped [As]
+		double &get_Li_dead() { return x[i_pl + 1]; }		// get the dead (irreversibly plated) lithium [As]
+		double &get_Q_pl() { return x[i_pl + 2]; }			// get the cumulative charge of the plating reaction [As]
+		double &get_Q_strip() { return x[i_pl + 3]; }		// get the cumulative charge of the stripping reaction [As]
+		double &get_hp() { return x[i_hys + 0]; }			// get the hysteresis state of the cathode [-], 1 on the charge curve and -1 on the discharge curve
+		double &get_hn() { return x[i_hys + 1]; }			// get the hysteresis state of the anode [-]
+		double &get_Q_ox() { return x[i_cat + 0]; }			// get the cumulative charge of the electrolyte oxidation at the cathode [As]
+		double &get_Q_sh() { return x[i_cat + 1]; }			// get the cumulative charge of the redox shuttle [As]
+		double &get_uheat() { return x[i_tm + 0]; }			// get the fraction of the heater power which is used [-]
+		double &get_ucool() { return x[i_tm + 1]; }			// get the fraction of the coolant flow which is used [-]
+		double &get_Iheat() { return x[i_tm + 2]; }			// get the integral of the heating error of the PI controller [K s]
+		double &get_Icool() { return x[i_tm + 3]; }			// get the integral of the cooling error of the PI controller [K s]
+		double &get_Eheat() { return x[i_tm + 4]; }			// get the cumulative energy used by the heater [J]
+		double &get_Ecool() { return x[i_tm + 5]; }			// get the cumulative energy used by the coolant loop [J]
+		double &get_t_tm(int i) { return x[i_tm + 6 + i]; } // get the cumulative time spent idle (i = 0), heating (1) and cooling (2) [s]
 
 		//bool is_initialised() { return sini_ptr != nullptr; }
 
@@ -73,13 +91,26 @@ namespace slide
 			std::copy(zni.begin(), zni.end(), x.begin() + nch);
 		}																											   // set the transformed concentration
 		void setStates(slide::states_type &&states);																   // set the states to the values in the array
+		void step(const slide::states_type &dstates, double dt, int i0, int n)										   // forward Euler step of the n states from index i0
+		{
+			for (int i = i0; i < i0 + n; i++)
+				x[i] += dt * dstates[i];
+		}
 		void setIniStates(const slide::states_type &si);															   // set the initial states to the values in the array
 		void overwriteGeometricStates(double thickpi, double thickni, double epi, double eni, double api, double ani); // overwrite the states related to the geometry of a cell
 		void overwriteCharacterisationStates(double Dpi, double Dni, double ri);									   // overwrite the states related to the characterisation of a cell
 
+		// index of the first state of each block after the 14 scalar states
+		static constexpr int i_xdeg = 2 * nch + 14;				// own states of the user-defined degradation models
+		static constexpr int i_psd = i_xdeg + settings::ns_deg; // transformed concentrations of the extra particle-size classes
+		static constexpr int i_pl = i_psd + 2 * nch * (settings::npsd - 1); // plated lithium inventory
+		static constexpr int i_hys = i_pl + settings::ns_pl;				 // hysteresis states of the electrodes
+		static constexpr int i_cat = i_hys + settings::ns_hys;				 // charge of the side reactions at the cathode
+		static constexpr int i_tm = i_cat + settings::ns_cat;				 // controller and energy use of the thermal management
+
 	private:
 		// battery states
-		// zp[nch] zn[nch] T delta LLI thickp thickn ep en ap an CS Dp Dn R delta_liPlating
+		// zp[nch] zn[nch] T delta LLI thickp thickn ep en ap an CS Dp Dn R delta_liPlating xdeg[ns_deg] (zp[nch] zn[nch])[npsd-1] Li_pl Li_dead Q_pl Q_strip hp hn Q_ox Q_sh uheat ucool Iheat Icool Eheat Ecool t_tm[3]
 		slide::states_type x{}; // Array to hold all states.
 								//	slide::State *sini_ptr{nullptr}; // array ptr with the initial battery states
 	};
@@ -0,0 +1,274 @@
+/*
+ * usage.cpp
+ *
+ * Implements the synthesis of usage patterns.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#include "usage.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "read_CSVfiles.h"
+#include "constants.hpp"
+
+namespace slide::usage
+{
+	using protocol::above;
+	using protocol::below;
+	using protocol::Var;
+
+	void Stats::addProfile(const std::string &name, double weight)
+	{
+		/*
+		 * Read a drive profile from a csv file in the data folder.
+		 * The first column contains the current [A], positive for a discharge, and the second one the time it is maintained [s].
+		 *
+		 * THROWS
+		 * 1021 	the weight is not positive or the profile is empty
+		 * 2 		the file could not be opened
+		 */
+
+		Profile pr{name, weight};
+		loadCSV_2col(PathVar::data + name, pr.I, pr.T);
+		if (weight <= 0 || pr.I.empty())
+		{
+			std::cerr << "ERROR in usage::Stats::addProfile, the profile " << name << " has weight " << weight << " and "
+					  << pr.I.size() << " rows, both must be positive. Throwing an error.\n";
+			throw 1021;
+		}
+		profiles.push_back(std::move(pr));
+	}
+
+	Stats loadStats(const std::string &name)
+	{
+		/*
+		 * Read the statistics of the usage from a csv file in the data folder.
+		 * Every line has a key followed by its values, keys which are not in the file keep their default value:
+		 * 		profile,<file>,<weight> 	drive profile (one line per profile, at least one is needed)
+		 * 		scale,<x> 					factor for the current of the drive profiles
+		 * 		trips,<min>,<max> 			number of trips per day
+		 * 		repeats,<min>,<max> 		number of repetitions of the drive profile of a trip
+		 * 		departure,<mean>,<sd> 		start of the first trip [h]
+		 * 		rest,<min>,<max> 			rest between two trips [h]
+		 * 		plug,<p>,<SOC> 				probability of a night charge and SOC below which it is done
+		 * 		charge,<C>,<Ccut>,<SOC> 	C rate, cutoff C rate and final SOC of the night charge
+		 * 		fast,<SOCmin>,<C> 			SOC below which an opportunity charge is done before a trip and its C rate
+		 * Empty lines and lines starting with # are skipped.
+		 *
+		 * THROWS
+		 * 1001 	the file could not be opened
+		 * 1021 	an unknown key, a missing value or illegal statistics
+		 */
+
+		std::ifstream in(PathVar::data + name, std::ios_base::in);
+		if (!in.good())
+		{
+			std::cerr << "ERROR in usage::loadStats. File " << name << " could not be opened. Throwing an error.\n";
+			throw 1001;
+		}
+
+		Stats s;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.empty() || line[0] == '#' || line[0] == '\r')
+				continue;
+
+			std::vector<std::string> f; // fields of the line
+			std::stringstream ss(line);
+			for (std::string x; std::getline(ss, x, ',');)
+				f.push_back(x);
+
+			auto val = [&](size_t i) {
+				try
+				{
+					return std::stod(f.at(i));
+				}
+				catch (...)
+				{
+					std::cerr << "ERROR in usage::loadStats, value " << i << " of line '" << line << "' in file " << name << " is missing or not a number. Throwing an error.\n";
+					throw 1021;
+				}
+			};
+
+			const auto &key = f[0];
+			if (key == "profile")
+				s.addProfile(f.size() > 1 ? f[1] : "", f.size() > 2 ? val(2) : 1);
+			else if (key == "scale")
+				s.scale = val(1);
+			else if (key == "trips")
+			{
+				s.tripsMin = static_cast<int>(val(1));
+				s.tripsMax = static_cast<int>(val(2));
+			}
+			else if (key == "repeats")
+			{
+				s.repeatsMin = static_cast<int>(val(1));
+				s.repeatsMax = static_cast<int>(val(2));
+			}
+			else if (key == "departure")
+			{
+				s.departure = val(1);
+				s.departureSd = val(2);
+			}
+			else if (key == "rest")
+			{
+				s.restMin = val(1);
+				s.restMax = val(2);
+			}
+			else if (key == "plug")
+			{
+				s.pPlug = val(1);
+				s.SOCplug = val(2);
+			}
+			else if (key == "charge")
+			{
+				s.Ccha = val(1);
+				s.Ccut = val(2);
+				s.SOCtarget = val(3);
+			}
+			else if (key == "fast")
+			{
+				s.SOCmin = val(1);
+				s.Cfast = val(2);
+			}
+			else
+			{
+				std::cerr << "ERROR in usage::loadStats, unknown key " << key << " in file " << name << ". Throwing an error.\n";
+				throw 1021;
+			}
+		}
+
+		if (s.profiles.empty() || s.tripsMin < 0 || s.tripsMax < s.tripsMin || s.repeatsMin < 1 || s.repeatsMax < s.repeatsMin
+			|| s.restMin < 0 || s.restMax < s.restMin || s.pPlug < 0 || s.pPlug > 1 || s.Ccha <= 0 || s.Ccut <= 0 || s.Cfast < 0
+			|| s.SOCmin < 0 || s.SOCplug > 1 || s.SOCtarget > 1 || s.SOCplug <= s.SOCmin || s.SOCtarget <= s.SOCmin)
+		{
+			std::cerr << "ERROR in usage::loadStats, the statistics in file " << name << " are illegal: there must be a drive profile, "
+					  << "the minima can't be larger than the maxima, there must be at least one repetition, the probability must be between 0 and 1, "
+					  << "the C rates must be positive and the SOCs must be between 0 and 1 with SOCmin below SOCplug and SOCtarget. Throwing an error.\n";
+			throw 1021;
+		}
+
+		return s;
+	}
+
+	Generator::Generator(const Stats &s, unsigned seed) : st(s), gen(seed)
+	{
+		// #NOTHOTFUNCTION
+		if (st.profiles.empty())
+		{
+			std::cerr << "ERROR in usage::Generator, there are no drive profiles. Throwing an error.\n";
+			throw 1021;
+		}
+	}
+
+	Schedule Generator::day()
+	{
+		/*
+		 * Draw the schedule of one day:
+		 * 		a rest until the departure, normally distributed and between midnight and 20h
+		 * 		the trips, each one preceded by an opportunity charge and followed by a rest, uniformly distributed between restMin and restMax
+		 * 		a night charge after the last trip, with probability pPlug
+		 * The day is not padded to 24 hours since the duration of the charges is not known in advance (see Cycler::usageAgeing).
+		 */
+
+		std::vector<double> w;
+		for (const auto &pr : st.profiles)
+			w.push_back(pr.weight);
+		std::discrete_distribution<int> prof(w.begin(), w.end());
+		std::uniform_int_distribution<int> trips(st.tripsMin, st.tripsMax), reps(st.repeatsMin, st.repeatsMax);
+		std::uniform_real_distribution<double> rest(st.restMin, st.restMax), u(0, 1);
+		std::normal_distribution<double> dep(st.departure, st.departureSd);
+
+		Schedule s;
+		s.push_back(Event{Kind::rest, 3600 * std::clamp(dep(gen), 0.0, 20.0)});
+
+		const int n = trips(gen);
+		for (int i = 0; i < n; i++)
+		{
+			if (i > 0)
+				s.push_back(Event{Kind::rest, 3600 * rest(gen)});
+			if (st.Cfast > 0)
+				s.push_back(Event{Kind::charge, 0, -1, 1, st.Cfast, st.SOCmin, st.SOCtarget});
+
+			Event e{Kind::trip};
+			e.profile = prof(gen);
+			e.repeats = reps(gen);
+			s.push_back(e);
+		}
+
+		if (u(gen) < st.pPlug)
+			s.push_back(Event{Kind::charge, 0, -1, 1, st.Ccha, st.SOCplug, st.SOCtarget});
+
+		return s;
+	}
+
+	void build(const Schedule &s, const Stats &st, double cap, double Vmax, protocol::Protocol &p)
+	{
+		/*
+		 * Add the events of a schedule to a protocol.
+		 * 		trips become a loop over the drive profile, the profiles are added to the protocol the first time they are used
+		 * 		rests become restFast steps
+		 * 		charges become a CC CV charge at Vmax which ends at the final SOC, preceded by a jump over the charge if the SOC is above its threshold
+		 *
+		 * IN
+		 * s 		schedule
+		 * st 		statistics with the drive profiles the trips refer to
+		 * cap 		capacity of the cell to convert the C rates to currents [Ah]
+		 * Vmax 	maximum voltage of the charges [V]
+		 *
+		 * OUT
+		 * p 		protocol to which the events are added
+		 *
+		 * THROWS
+		 * 1021 	a trip refers to a drive profile which does not exist
+		 */
+
+		std::vector<int> index(st.profiles.size(), -1); // index of the drive profiles in the protocol
+		for (const auto &e : s)
+		{
+			if (e.kind == Kind::rest)
+			{
+				if (e.time > 0)
+					p.restFast(e.time);
+			}
+			else if (e.kind == Kind::trip)
+			{
+				if (e.profile < 0 || e.profile >= static_cast<int>(st.profiles.size()))
+				{
+					std::cerr << "ERROR in usage::build, a trip uses drive profile " << e.profile << " but there are " << st.profiles.size() << " profiles. Throwing an error.\n";
+					throw 1021;
+				}
+
+				const auto &pr = st.profiles[e.profile];
+				p.loop(e.repeats);
+				if (index[e.profile] < 0)
+				{
+					std::vector<double> I(pr.I);
+					for (auto &x : I)
+						x *= st.scale;
+					p.profile(I, pr.T);
+					index[e.profile] = p.nProfiles() - 1;
+				}
+				else
+					p.profile(index[e.profile]);
+				p.endLoop();
+			}
+			else
+			{
+				const std::string skip = "usage_charge_" + std::to_string(p.instructions().size()); // unique since every charge adds instructions
+				p.jumpIf(above(Var::SOC, e.SOCstart), skip)
+					.CC(-e.Crate * cap, {above(Var::V, Vmax), above(Var::SOC, e.SOCend)})
+					.CV(Vmax, {below(Var::I, st.Ccut * cap), above(Var::SOC, e.SOCend)})
+					.label(skip);
+			}
+		}
+	}
+} // namespace slide::usage
@@ -0,0 +1,95 @@
+/*
+ * usage.hpp
+ *
+ * Synthesis of realistic usage patterns, e.g. of an electric vehicle, from drive profiles, charging sessions and rest periods.
+ *
+ * A Schedule is a list of events:
+ * 		trip 	a drive profile from the data folder, repeated a number of times
+ * 		rest 	zero current for a given time, done with a growing time step (see Protocol::restFast and Cell::ETI_rest)
+ * 		charge 	CC CV charge to a SOC, which is only done if the SOC is below a threshold when the event starts
+ * Schedules can be written by hand (rests of specified length), or drawn day by day by a Generator from the statistics of the usage.
+ * The statistics are read from a csv file with one key and value per line (see loadStats and data/Usage statistics commuter.csv), for example
+ * 		profile,Current Profile drive cycle UDDS.csv,2 	(name and relative weight of a drive profile, one line per profile)
+ * 		trips,1,3 									(minimum and maximum number of trips per day)
+ * 		departure,8,1 								(mean and standard deviation of the start of the first trip [h])
+ * A schedule is turned into a programmable protocol (see protocol.hpp) by build, and a whole day of usage is simulated by Cycler::usageAgeing.
+ *
+ * Copyright (c) 2019, The Chancellor, Masters and Scholars of the University
+ * of Oxford, VITO nv, and the 'Slide' Developers.
+ * See the licence file LICENCE.txt for more information.
+ */
+
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+
+namespace slide::usage
+{
+	// kinds of events of a schedule
+	enum class Kind
+	{
+		trip,
+		rest,
+		charge
+	};
+
+	struct Event
+	{
+		Kind kind{Kind::rest};
+		double time{0};		// duration of a rest [s]
+		int profile{-1};	// index of the drive profile of a trip in Stats::profiles
+		int repeats{1};		// number of times the drive profile of a trip is repeated
+		double Crate{0};	// C rate of a charge [-], > 0
+		double SOCstart{1}; // a charge is only done if the SOC is below this value when it starts [-]
+		double SOCend{1};	// a charge ends at this SOC [-]
+	};
+
+	using Schedule = std::vector<Event>;
+
+	// drive profile, the current is positive for a discharge [A]
+	struct Profile
+	{
+		std::string name;
+		double weight{1}; // relative probability that a trip uses this profile
+		std::vector<double> I, T;
+	};
+
+	// statistics of the usage
+	struct Stats
+	{
+		std::vector<Profile> profiles;
+		double scale{1};									// factor for the current of the drive profiles [-]
+		int tripsMin{2}, tripsMax{2};						// number of trips per day
+		int repeatsMin{1}, repeatsMax{3};					// number of repetitions of the drive profile of a trip
+		double departure{8}, departureSd{1};				// mean and standard deviation of the start of the first trip [h]
+		double restMin{1}, restMax{9};						// rest between two trips [h]
+		double pPlug{0.8};									// probability that the cell is plugged in for the night [-]
+		double SOCplug{1};									// the night charge is only done below this SOC [-]
+		double Ccha{0.3}, Ccut{0.05}, SOCtarget{0.9};		// C rate, cutoff C rate of the CV phase and final SOC of the night charge [-]
+		double SOCmin{0.2}, Cfast{1};						// an opportunity charge at Cfast to SOCtarget is done before a trip which starts below SOCmin, no charge if Cfast is 0
+
+		void addProfile(const std::string &name, double weight = 1); // read a drive profile from the data folder
+	};
+
+	Stats loadStats(const std::string &name); // read statistics from a csv file in the data folder
+
+	// draws daily schedules from the statistics of the usage
+	class Generator
+	{
+	public:
+		Generator(const Stats &s, unsigned seed);
+
+		Schedule day(); // schedule of the next day, the first event is the rest until departure
+		const Stats &stats() const { return st; }
+
+	private:
+		Stats st;
+		std::mt19937 gen;
+	};
+
+	void build(const Schedule &s, const Stats &st, double cap, double Vmax, protocol::Protocol &p); // add the events of a schedule to a protocol
+} // namespace slide::usage
@@ -134,4 +134,67 @@ namespace slide::util::error
             throw 1014;
     }
 
+    void checkInputParam_SOCwindow(double SOCmin, double SOCmax)
+    {
+        // Check the SOC window of Cycler::socWindowAgeing
+        if (SOCmin < 0 || SOCmax > 1 || SOCmin >= SOCmax)
+        {
+            std::cerr << "Error in Cycler::socWindowAgeing. The SOC window " << SOCmin << " to " << SOCmax << " is illegal, it must satisfy 0 <= SOCmin < SOCmax <= 1.\n";
+            throw 1014;
+        }
+    }
+
+    void checkInputParam_Usage(Cell &c, double Vma, double Vmi, double Ti, int nrDays, int daysCheck)
+    {
+        // Check the input parameters of Cycler::usageAgeing
+        bool vmax = Vma > c.getVmax() || Vma <= Vmi; // check if the voltage window is inside the voltage range of the cell
+        bool vmin = Vmi < c.getVmin();
+        if (vmax || vmin)
+            std::cerr << "Error in Cycler::usageAgeing. The voltage window " << Vmi << " to " << Vma << " is illegal, it must be inside the voltage range of the cell "
+                      << c.getVmin() << " to " << c.getVmax() << ".\n";
+
+        bool Te = Ti < settings::Tmin_K || Ti > settings::Tmax_K; // check the temperature is in the allowed range
+        if (Te)
+            std::cerr << "Error in Cycler::usageAgeing. The temperature " << Ti << "K is illegal. It must be between " << settings::Tmin_K << " and " << settings::Tmax_K << ".\n";
+
+        bool days = nrDays <= 0 || daysCheck <= 0; // check the number of days is positive
+        if (days)
+            std::cerr << "Error in Cycler::usageAgeing. The number of days " << nrDays << " and the number of days between two check ups " << daysCheck << " must be positive.\n";
+
+        if (vmax || vmin || Te || days)
+            throw 1014;
+    }
+
+    void checkInputParam_MixedAge(Cell &c, const std::vector<AgeingEvent> &events, int period, double Vma, double Vmi, int nrDays, int daysCheck)
+    {
+        // Check the input parameters of Cycler::mixedAgeing
+        bool vwin = Vma > c.getVmax() || Vmi < c.getVmin() || Vma <= Vmi; // check if the voltage window is inside the voltage range of the cell
+        if (vwin)
+            std::cerr << "Error in Cycler::mixedAgeing. The voltage window " << Vmi << " to " << Vma << " is illegal, it must be inside the voltage range of the cell "
+                      << c.getVmin() << " to " << c.getVmax() << ".\n";
+
+        bool days = period <= 0 || nrDays <= 0 || daysCheck <= 0; // check the number of days is positive
+        if (days)
+            std::cerr << "Error in Cycler::mixedAgeing. The period " << period << ", the number of days " << nrDays
+                      << " and the number of days between two check ups " << daysCheck << " must be positive.\n";
+
+        bool ev = events.empty(); // check there are events, which are in order, inside the period and have legal settings
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const auto &e = events[i];
+            const bool ok = e.start >= 0 && e.start < 24.0 * period && (i == 0 || e.start > events[i - 1].start) && e.nrCycles >= 0
+                            && e.Ccha > 0 && e.Cdis > 0 && e.Ccut > 0 && e.SOCrest > 0 && e.SOCrest <= 1
+                            && e.Tcycle >= settings::Tmin_K && e.Tcycle <= settings::Tmax_K && e.Trest >= settings::Tmin_K && e.Trest <= settings::Tmax_K;
+            if (!ok)
+                std::cerr << "Error in Cycler::mixedAgeing. Event " << i << " is illegal. The events must start in increasing order within the period of " << 24 * period
+                          << " hours, the C rates must be positive, the resting SOC must be in (0, 1] and the temperatures between " << settings::Tmin_K << " and " << settings::Tmax_K << " K.\n";
+            ev = ev || !ok;
+        }
+        if (events.empty())
+            std::cerr << "Error in Cycler::mixedAgeing. There are no events.\n";
+
+        if (vwin || days || ev)
+            throw 1014;
+    }
+
 } // namespace slide::util::error
@@ -17,6 +17,7 @@
 #include "cell.hpp"
 
 class Cell;
+struct AgeingEvent;
 
 namespace slide::util::error
 {
@@ -24,5 +25,8 @@ namespace slide::util::error
     void checkInputParam_CC_V_CV_I(Cell &c, double Crate, double Vset, double Ccut);
     void checkInputParam_CycAge(Cell &c, double Vma, double Vmi, double Ccha, double Ccutcha,
                                 double Cdis, double Ccutdis, double Ti, int nrCycles, int nrCap);
+    void checkInputParam_SOCwindow(double SOCmin, double SOCmax);
+    void checkInputParam_Usage(Cell &c, double Vma, double Vmi, double Ti, int nrDays, int daysCheck);
+    void checkInputParam_MixedAge(Cell &c, const std::vector<AgeingEvent> &events, int period, double Vma, double Vmi, int nrDays, int daysCheck);
 
 }
\ No newline at end of file